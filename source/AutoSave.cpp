@@ -17,11 +17,14 @@
  */
 
 #include "AutoSave.h"
+#include "AutoSaveJournal.h"
 #include "Paths.h"
 #include "FileFormat.h"
 #include <boost/interprocess/sync/named_mutex.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
+#include <boost/interprocess/sync/file_lock.hpp>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
 void autoSave(ColorList &colorList) {
 	using namespace boost::interprocess;
@@ -45,3 +48,21 @@ void autoSave(ColorList &colorList) {
 		std::cerr << "failed to acquire interprocess lock: " << e.what() << std::endl;
 	}
 }
+std::unique_ptr<AutoSaveJournal> openAutoSaveJournal() {
+	using namespace boost::interprocess;
+	static std::unique_ptr<file_lock> instanceLock; // file locks are released by the system when process exits, even after a crash
+	if (!instanceLock) {
+		try {
+			auto fileName = buildConfigPath("autosave.lock");
+			std::ofstream(fileName, std::ios::app).close(); // lock file must exist
+			auto lock = std::make_unique<file_lock>(fileName.c_str());
+			if (!lock->try_lock())
+				return nullptr;
+			instanceLock = std::move(lock);
+		} catch (const interprocess_exception &e) {
+			std::cerr << "failed to acquire autosave lock: " << e.what() << std::endl;
+			return nullptr;
+		}
+	}
+	return std::make_unique<AutoSaveJournal>(buildConfigPath("autosave.gpa"), buildConfigPath("autosave.journal"));
+}
@@ -18,6 +18,19 @@
 
 #ifndef GPICK_AUTO_SAVE_H_
 #define GPICK_AUTO_SAVE_H_
+#include <memory>
 struct ColorList;
+struct AutoSaveJournal;
+/**
+ * Save whole palette to autosave file in configuration directory.
+ * Used when autosave journal is owned by another running instance.
+ * @param[in] colorList Palette colors.
+ */
 void autoSave(ColorList &colorList);
+/**
+ * Open autosave journal in configuration directory.
+ * Only one running instance can own the journal, others get nullptr and should use autoSave() instead.
+ * @return Autosave journal or nullptr.
+ */
+std::unique_ptr<AutoSaveJournal> openAutoSaveJournal();
 #endif /* GPICK_AUTO_SAVE_H_ */
@@ -0,0 +1,693 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "AutoSaveJournal.h"
+#include "ColorList.h"
+#include "ColorObject.h"
+#include "FileFormat.h"
+#include "IPalette.h"
+#include "common/MappedFile.h"
+#include "common/Span.h"
+#include <boost/crc.hpp>
+#include <boost/endian/conversion.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+namespace {
+/*
+ * Journal file starts with a header: 8 byte magic, uint32 version, uint32 snapshot CRC-32, uint64 snapshot size.
+ * Snapshot CRC and size tie journal to the snapshot it was started for, so a journal left from an interrupted compaction is not applied to a newer snapshot.
+ * Header is followed by records: uint32 length, uint8 type, payload, uint32 CRC-32 of type and payload. Length includes type and payload.
+ * All values are little endian. Colors are four floats, names are uint32 length followed by name bytes.
+ */
+const char JournalMagic[8] = { 'G', 'P', 'J', 'O', 'U', 'R', 'N', 'L' };
+const uint32_t JournalVersion = 1;
+const size_t JournalHeaderSize = 24;
+const size_t RecordOverhead = 9;
+const size_t MinEntrySize = 20;
+const uint64_t MinCompactionSize = 256 * 1024;
+enum struct RecordType : uint8_t {
+	/** uint32 position, uint32 count, count entries. */
+	insert = 1,
+	/** uint32 range count, (uint32 first, uint32 end) ranges in ascending order. */
+	remove = 2,
+	/** uint32 count, count uint32 indices: entry i is moved from index order[i]. */
+	reorder = 3,
+	/** uint32 count, count (uint32 index, entry) pairs. */
+	edit = 4,
+	/** No payload. */
+	clear = 5,
+};
+struct Entry {
+	Color color;
+	std::string name;
+	Entry() {
+	}
+	Entry(const Color &color, const std::string &name):
+		color(color),
+		name(name) {
+	}
+};
+struct Fingerprint {
+	uint32_t crc;
+	uint64_t size;
+	bool operator==(const Fingerprint &other) const {
+		return crc == other.crc && size == other.size;
+	}
+};
+Fingerprint fingerprint(const std::string &fileName) {
+	common::MappedFile file;
+	if (!file.open(fileName.c_str()))
+		return Fingerprint { 0, 0 };
+	boost::crc_32_type crc;
+	crc.process_bytes(file.data(), file.size());
+	return Fingerprint { crc.checksum(), file.size() };
+}
+uint32_t checksum(const uint8_t *data, size_t size) {
+	boost::crc_32_type crc;
+	crc.process_bytes(data, size);
+	return crc.checksum();
+}
+void append(std::vector<uint8_t> &data, uint32_t value) {
+	value = boost::endian::native_to_little(value);
+	auto bytes = reinterpret_cast<const uint8_t *>(&value);
+	data.insert(data.end(), bytes, bytes + sizeof(value));
+}
+void append(std::vector<uint8_t> &data, uint64_t value) {
+	value = boost::endian::native_to_little(value);
+	auto bytes = reinterpret_cast<const uint8_t *>(&value);
+	data.insert(data.end(), bytes, bytes + sizeof(value));
+}
+void append(std::vector<uint8_t> &data, const Color &color) {
+	for (int i = 0; i < 4; i++) {
+		float value = color[i];
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		append(data, bits);
+	}
+}
+void append(std::vector<uint8_t> &data, const std::string &value) {
+	append(data, static_cast<uint32_t>(value.length()));
+	data.insert(data.end(), value.begin(), value.end());
+}
+std::vector<uint8_t> journalHeader(const Fingerprint &snapshot) {
+	std::vector<uint8_t> data(JournalMagic, JournalMagic + sizeof(JournalMagic));
+	append(data, JournalVersion);
+	append(data, snapshot.crc);
+	append(data, snapshot.size);
+	return data;
+}
+/** \struct RecordWriter
+ * \brief Appends a single record, filling in length and checksum when finished.
+ */
+struct RecordWriter {
+	RecordWriter(std::vector<uint8_t> &data, RecordType type):
+		data(data),
+		start(data.size()) {
+		append(data, static_cast<uint32_t>(0));
+		data.push_back(static_cast<uint8_t>(type));
+	}
+	~RecordWriter() {
+		uint32_t length = static_cast<uint32_t>(data.size() - start - sizeof(uint32_t));
+		uint32_t crc = checksum(data.data() + start + sizeof(uint32_t), length);
+		length = boost::endian::native_to_little(length);
+		std::memcpy(data.data() + start, &length, sizeof(length));
+		append(data, crc);
+	}
+	std::vector<uint8_t> &data;
+	size_t start;
+};
+/** \struct Reader
+ * \brief Bounds checked little endian reader over a memory buffer.
+ */
+struct Reader {
+	Reader(const uint8_t *data, size_t size):
+		position(data),
+		end(data + size) {
+	}
+	size_t remaining() const {
+		return static_cast<size_t>(end - position);
+	}
+	bool read(uint32_t &value) {
+		if (remaining() < sizeof(value))
+			return false;
+		std::memcpy(&value, position, sizeof(value));
+		value = boost::endian::little_to_native(value);
+		position += sizeof(value);
+		return true;
+	}
+	bool read(uint64_t &value) {
+		if (remaining() < sizeof(value))
+			return false;
+		std::memcpy(&value, position, sizeof(value));
+		value = boost::endian::little_to_native(value);
+		position += sizeof(value);
+		return true;
+	}
+	bool read(Color &color) {
+		for (int i = 0; i < 4; i++) {
+			uint32_t bits;
+			if (!read(bits))
+				return false;
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			color[i] = value;
+		}
+		return true;
+	}
+	bool read(std::string &value) {
+		uint32_t length;
+		if (!read(length) || remaining() < length)
+			return false;
+		value.assign(reinterpret_cast<const char *>(position), length);
+		position += length;
+		return true;
+	}
+	bool read(Entry &entry) {
+		return read(entry.color) && read(entry.name);
+	}
+	const uint8_t *position, *end;
+};
+bool applyRecord(RecordType type, Reader &reader, std::vector<Entry> &entries) {
+	switch (type) {
+	case RecordType::insert: {
+		uint32_t position, count;
+		if (!reader.read(position) || !reader.read(count) || position > entries.size() || count > reader.remaining() / MinEntrySize)
+			return false;
+		std::vector<Entry> inserted(count);
+		for (auto &entry: inserted) {
+			if (!reader.read(entry))
+				return false;
+		}
+		entries.insert(entries.begin() + position, std::make_move_iterator(inserted.begin()), std::make_move_iterator(inserted.end()));
+	} break;
+	case RecordType::remove: {
+		uint32_t rangeCount;
+		if (!reader.read(rangeCount) || rangeCount > reader.remaining() / 8)
+			return false;
+		std::vector<std::pair<uint32_t, uint32_t>> ranges(rangeCount);
+		size_t previousEnd = 0;
+		for (auto &range: ranges) {
+			if (!reader.read(range.first) || !reader.read(range.second) || range.first < previousEnd || range.first >= range.second || range.second > entries.size())
+				return false;
+			previousEnd = range.second;
+		}
+		if (ranges.empty())
+			break;
+		auto position = entries.begin() + ranges.front().first;
+		for (size_t i = 0; i < ranges.size(); i++) {
+			auto next = i + 1 < ranges.size() ? entries.begin() + ranges[i + 1].first : entries.end();
+			position = std::move(entries.begin() + ranges[i].second, next, position);
+		}
+		entries.erase(position, entries.end());
+	} break;
+	case RecordType::reorder: {
+		uint32_t count;
+		if (!reader.read(count) || count != entries.size() || count > reader.remaining() / 4)
+			return false;
+		std::vector<bool> used(count, false);
+		std::vector<Entry> reordered;
+		reordered.reserve(count);
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t from;
+			if (!reader.read(from) || from >= count || used[from])
+				return false;
+			used[from] = true;
+			reordered.push_back(std::move(entries[from]));
+		}
+		entries.swap(reordered);
+	} break;
+	case RecordType::edit: {
+		uint32_t count;
+		if (!reader.read(count) || count > reader.remaining() / (MinEntrySize + 4))
+			return false;
+		std::vector<std::pair<uint32_t, Entry>> edits;
+		edits.reserve(count);
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t index;
+			Entry entry;
+			if (!reader.read(index) || index >= entries.size() || !reader.read(entry))
+				return false;
+			edits.emplace_back(index, std::move(entry));
+		}
+		if (reader.remaining() != 0)
+			return false;
+		for (auto &edit: edits)
+			entries[edit.first] = std::move(edit.second);
+	} break;
+	case RecordType::clear:
+		entries.clear();
+		break;
+	default:
+		return false;
+	}
+	return reader.remaining() == 0;
+}
+/**
+ * Replay journal records.
+ * @param[in] data Journal data.
+ * @param[in] size Journal size in bytes.
+ * @param[in] snapshot Fingerprint of the loaded snapshot.
+ * @param[in,out] entries Snapshot entries, modified by applied records.
+ * @return Length of journal prefix which was applied, or 0 when journal does not belong to the snapshot.
+ */
+size_t replay(const uint8_t *data, size_t size, const Fingerprint &snapshot, std::vector<Entry> &entries) {
+	auto header = journalHeader(snapshot);
+	if (size < JournalHeaderSize || std::memcmp(data, header.data(), JournalHeaderSize) != 0)
+		return 0;
+	Reader reader(data + JournalHeaderSize, size - JournalHeaderSize);
+	size_t valid = JournalHeaderSize;
+	for (;;) {
+		uint32_t length;
+		if (!reader.read(length) || length == 0 || reader.remaining() < static_cast<size_t>(length) + sizeof(uint32_t))
+			break;
+		const uint8_t *record = reader.position;
+		reader.position += length;
+		uint32_t crc;
+		if (!reader.read(crc) || crc != checksum(record, length))
+			break;
+		Reader payload(record + 1, length - 1);
+		if (!applyRecord(static_cast<RecordType>(record[0]), payload, entries))
+			break; // record with valid checksum but invalid contents means journal is damaged, so replay stops at the last good state
+		valid += sizeof(uint32_t) + length + sizeof(uint32_t);
+	}
+	return valid;
+}
+}
+struct AutoSaveJournal::Impl: public IPalette {
+	struct Task {
+		enum struct Type {
+			open,
+			append,
+			snapshot,
+		};
+		Type type = Type::append;
+		std::vector<uint8_t> data;
+		std::vector<Entry> entries;
+		uint64_t length = 0;
+	};
+	std::string snapshotFileName, journalFileName;
+	ColorList *colorList;
+	std::vector<uint8_t> pending;
+	std::optional<RecordWriter> insertRecord;
+	size_t insertPosition, insertCount;
+	uint64_t flushedGeneration;
+	bool restored, clean;
+	uint64_t validLength, journalSize, snapshotSize;
+	size_t records, snapshots;
+	std::mutex mutex;
+	std::condition_variable condition, idle;
+	std::deque<Task> tasks;
+	bool stop, busy;
+	std::thread thread;
+	std::ofstream journal;
+	std::pair<uintmax_t, std::filesystem::file_time_type> snapshotStamp;
+	Impl(const std::string &snapshotFileName, const std::string &journalFileName):
+		snapshotFileName(snapshotFileName),
+		journalFileName(journalFileName),
+		colorList(nullptr),
+		insertPosition(0),
+		insertCount(0),
+		flushedGeneration(0),
+		restored(false),
+		clean(false),
+		validLength(0),
+		journalSize(0),
+		snapshotSize(0),
+		records(0),
+		snapshots(0),
+		stop(false),
+		busy(false) {
+	}
+	virtual ~Impl() {
+		stopThread();
+		if (colorList)
+			colorList->setObserver(nullptr);
+	}
+	common::ResultVoid<ErrorCode> restore(ColorList &colorList) {
+		using Result = common::ResultVoid<ErrorCode>;
+		std::vector<Entry> entries;
+		std::error_code ec;
+		auto snapshot = fingerprint(snapshotFileName);
+		if (std::filesystem::exists(snapshotFileName, ec)) {
+			ColorList snapshotColors;
+			auto result = paletteFileLoad(snapshotFileName.c_str(), snapshotColors);
+			if (!result)
+				return result;
+			entries.reserve(snapshotColors.size());
+			for (auto *colorObject: snapshotColors)
+				entries.emplace_back(colorObject->getColor(), colorObject->getName());
+		}
+		clean = false;
+		common::MappedFile file;
+		if (file.open(journalFileName.c_str())) {
+			validLength = replay(file.data(), file.size(), snapshot, entries);
+			clean = validLength != 0 && validLength == file.size();
+		}
+		std::vector<ColorObject *> colorObjects;
+		colorObjects.reserve(entries.size());
+		for (const auto &entry: entries)
+			colorObjects.push_back(new ColorObject(entry.name, entry.color));
+		colorList.addRange(common::Span<ColorObject *const>(colorObjects.data(), colorObjects.size()));
+		for (auto *colorObject: colorObjects)
+			colorObject->release();
+		snapshotStamp = stamp();
+		restored = true;
+		return Result();
+	}
+	void start(ColorList &colorList) {
+		this->colorList = &colorList;
+		colorList.setObserver(this);
+		insertRecord.reset();
+		pending.clear();
+		flushedGeneration = ColorObject::lastGeneration();
+		records = 0;
+		snapshots = 0;
+		stop = false;
+		thread = std::thread([this]() {
+			run();
+		});
+		if (restored && clean) {
+			journalSize = validLength;
+			snapshotSize = estimateSnapshotSize();
+			Task task;
+			task.type = Task::Type::open;
+			task.length = validLength;
+			queue(std::move(task));
+		} else {
+			queueSnapshot();
+		}
+	}
+	uint64_t estimateSnapshotSize() const {
+		uint64_t size = 0;
+		for (auto *colorObject: *colorList)
+			size += 70 + colorObject->getName().length();
+		return size;
+	}
+	void queue(Task &&task) {
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push_back(std::move(task));
+		condition.notify_one();
+	}
+	void queueSnapshot() {
+		Task task;
+		task.type = Task::Type::snapshot;
+		task.entries.reserve(colorList->size());
+		for (auto *colorObject: *colorList)
+			task.entries.emplace_back(colorObject->getColor(), colorObject->getName());
+		journalSize = JournalHeaderSize;
+		snapshotSize = estimateSnapshotSize();
+		snapshots++;
+		queue(std::move(task));
+	}
+	static void appendEntry(std::vector<uint8_t> &data, const ColorObject &colorObject) {
+		append(data, colorObject.getColor());
+		append(data, colorObject.getName());
+	}
+	/**
+	 * Rows are written when insertion is reported, because later changes can move them. Insert record is kept open, so consecutive additions are stored as a single record.
+	 */
+	void inserted(size_t position, size_t count) {
+		if (count == 0)
+			return;
+		if (!insertRecord || position != insertPosition + insertCount) {
+			closeInsert();
+			insertRecord.emplace(pending, RecordType::insert);
+			append(pending, static_cast<uint32_t>(position));
+			append(pending, static_cast<uint32_t>(0));
+			insertPosition = position;
+			insertCount = 0;
+			records++;
+		}
+		auto begin = colorList->begin() + position;
+		for (auto i = begin, end = begin + count; i != end; ++i)
+			appendEntry(pending, **i);
+		insertCount += count;
+	}
+	void closeInsert() {
+		if (!insertRecord)
+			return;
+		auto count = boost::endian::native_to_little(static_cast<uint32_t>(insertCount));
+		std::memcpy(pending.data() + insertRecord->start + sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint32_t), &count, sizeof(count));
+		insertRecord.reset();
+	}
+	void cleared() {
+		closeInsert();
+		RecordWriter record(pending, RecordType::clear);
+		records++;
+	}
+	virtual void add(ColorList &colorList, ColorObject *colorObject) override {
+		inserted(colorList.size() - 1, 1);
+	}
+	virtual void change(ColorList &colorList, const ColorListChange &change) override {
+		switch (change.type) {
+		case ColorListChange::Type::insert:
+			inserted(change.position, change.count);
+			break;
+		case ColorListChange::Type::remove: {
+			closeInsert();
+			RecordWriter record(pending, RecordType::remove);
+			append(pending, static_cast<uint32_t>(change.ranges.size()));
+			for (const auto &range: change.ranges) {
+				append(pending, static_cast<uint32_t>(range.first));
+				append(pending, static_cast<uint32_t>(range.second));
+			}
+			records++;
+		} break;
+		case ColorListChange::Type::reorder: {
+			closeInsert();
+			RecordWriter record(pending, RecordType::reorder);
+			append(pending, static_cast<uint32_t>(change.order.size()));
+			for (auto from: change.order)
+				append(pending, static_cast<uint32_t>(from));
+			records++;
+		} break;
+		case ColorListChange::Type::replace:
+			cleared();
+			inserted(0, change.count);
+			break;
+		}
+	}
+	virtual void clear(ColorList &colorList) override {
+		cleared();
+	}
+	virtual void update(ColorList &colorList) override {
+	}
+	/**
+	 * Write edit record for color objects changed after the last flush. Color list is only scanned when some color object was changed.
+	 */
+	void writeEdits() {
+		auto generation = ColorObject::lastGeneration();
+		if (generation == flushedGeneration)
+			return;
+		std::vector<uint32_t> edited;
+		uint32_t index = 0;
+		for (auto *colorObject: *colorList) {
+			if (colorObject->generation() > flushedGeneration)
+				edited.push_back(index);
+			index++;
+		}
+		flushedGeneration = generation;
+		if (edited.empty())
+			return;
+		RecordWriter record(pending, RecordType::edit);
+		append(pending, static_cast<uint32_t>(edited.size()));
+		auto begin = colorList->begin();
+		for (auto i: edited) {
+			append(pending, i);
+			appendEntry(pending, **(begin + i));
+		}
+		records++;
+	}
+	bool flush() {
+		if (!colorList)
+			return false;
+		closeInsert();
+		writeEdits();
+		if (pending.empty())
+			return false;
+		journalSize += pending.size();
+		Task task;
+		task.type = Task::Type::append;
+		task.data.swap(pending);
+		queue(std::move(task));
+		if (journalSize > std::max(MinCompactionSize, snapshotSize))
+			queueSnapshot();
+		return true;
+	}
+	void wait() {
+		std::unique_lock<std::mutex> lock(mutex);
+		idle.wait(lock, [this]() {
+			return tasks.empty() && !busy;
+		});
+	}
+	void stopThread() {
+		if (!thread.joinable())
+			return;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+			condition.notify_one();
+		}
+		thread.join();
+		journal.close();
+	}
+	std::pair<uintmax_t, std::filesystem::file_time_type> stamp() const {
+		std::error_code ec;
+		auto size = std::filesystem::file_size(snapshotFileName, ec);
+		auto time = std::filesystem::last_write_time(snapshotFileName, ec);
+		return std::make_pair(size, time);
+	}
+	void close() {
+		if (!colorList)
+			return;
+		flush();
+		wait();
+		if (stamp() != snapshotStamp)
+			queueSnapshot(); // snapshot was replaced by another instance, so journal would be ignored on next start
+		stopThread();
+		colorList->setObserver(nullptr);
+		colorList = nullptr;
+	}
+	void run() {
+		for (;;) {
+			Task task;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [this]() {
+					return stop || !tasks.empty();
+				});
+				if (tasks.empty())
+					return; // stop is only handled after all queued tasks are written
+				task = std::move(tasks.front());
+				tasks.pop_front();
+				busy = true;
+			}
+			process(task);
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				busy = false;
+				if (tasks.empty())
+					idle.notify_all();
+			}
+		}
+	}
+	void openJournal() {
+		journal.close();
+		journal.clear();
+		journal.open(journalFileName, std::ios::binary | std::ios::out | std::ios::app);
+		if (!journal.is_open())
+			std::cerr << "failed to open autosave journal \"" << journalFileName << "\"" << std::endl;
+	}
+	void process(Task &task) {
+		std::error_code ec;
+		switch (task.type) {
+		case Task::Type::open:
+			std::filesystem::resize_file(journalFileName, task.length, ec);
+			openJournal();
+			break;
+		case Task::Type::append:
+			if (!journal.is_open())
+				break;
+			journal.write(reinterpret_cast<const char *>(task.data.data()), task.data.size());
+			journal.flush();
+			if (!journal.good())
+				std::cerr << "failed to write autosave journal \"" << journalFileName << "\"" << std::endl;
+			break;
+		case Task::Type::snapshot:
+			writeSnapshot(task.entries);
+			break;
+		}
+	}
+	void writeSnapshot(const std::vector<Entry> &entries) {
+		journal.close();
+		auto snapshotTmp = snapshotFileName + ".tmp", journalTmp = journalFileName + ".tmp";
+		ColorList colorList;
+		std::vector<ColorObject *> colorObjects;
+		colorObjects.reserve(entries.size());
+		for (const auto &entry: entries)
+			colorObjects.push_back(new ColorObject(entry.name, entry.color));
+		colorList.addRange(common::Span<ColorObject *const>(colorObjects.data(), colorObjects.size()));
+		for (auto *colorObject: colorObjects)
+			colorObject->release();
+		auto result = paletteFileSave(snapshotTmp.c_str(), colorList);
+		if (!result) {
+			std::cerr << "failed to save palette to \"" << snapshotTmp << "\": " << result.error() << std::endl;
+			openJournal(); // keep appending to previous journal, which still matches previous snapshot
+			return;
+		}
+		auto header = journalHeader(fingerprint(snapshotTmp));
+		{
+			std::ofstream file(journalTmp, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char *>(header.data()), header.size());
+			file.close();
+			if (!file.good()) {
+				std::cerr << "failed to write autosave journal \"" << journalTmp << "\"" << std::endl;
+				openJournal();
+				return;
+			}
+		}
+		// A crash between these renames leaves old journal next to new snapshot, which is then ignored because of snapshot fingerprint mismatch.
+		std::error_code ec;
+		std::filesystem::rename(snapshotTmp, snapshotFileName, ec);
+		if (ec) {
+			std::cerr << "failed to move palette file \"" << snapshotTmp << "\" to \"" << snapshotFileName << "\": " << ec << std::endl;
+			openJournal();
+			return;
+		}
+		std::filesystem::rename(journalTmp, journalFileName, ec);
+		if (ec)
+			std::cerr << "failed to move autosave journal \"" << journalTmp << "\" to \"" << journalFileName << "\": " << ec << std::endl;
+		snapshotStamp = stamp();
+		openJournal();
+	}
+};
+AutoSaveJournal::AutoSaveJournal(const std::string &snapshotFileName, const std::string &journalFileName):
+	m_impl(std::make_unique<Impl>(snapshotFileName, journalFileName)) {
+}
+AutoSaveJournal::~AutoSaveJournal() {
+}
+common::ResultVoid<ErrorCode> AutoSaveJournal::restore(ColorList &colorList) {
+	return m_impl->restore(colorList);
+}
+void AutoSaveJournal::start(ColorList &colorList) {
+	m_impl->start(colorList);
+}
+bool AutoSaveJournal::flush() {
+	return m_impl->flush();
+}
+void AutoSaveJournal::wait() {
+	m_impl->wait();
+}
+void AutoSaveJournal::close() {
+	m_impl->close();
+}
+size_t AutoSaveJournal::recordCount() const {
+	return m_impl->records;
+}
+size_t AutoSaveJournal::snapshotCount() const {
+	return m_impl->snapshots;
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include "common/Result.h"
+#include "ErrorCode.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+struct ColorList;
+/** \struct AutoSaveJournal
+ * \brief Crash safe incremental autosave of a color list.
+ *
+ * Palette state is kept as a snapshot GPA file and an append-only journal of changes made after the snapshot was written.
+ * Additions, removals and reordering are recorded from color list change notifications. Edits of colors and names are found by color object modification generation,
+ * so color list is only scanned when some color object was changed, and only changed colors are written.
+ * Writing happens on a background thread. When journal grows larger than the snapshot, journal is compacted into a new snapshot.
+ * Each journal record has a checksum, so a record cut short by a crash is dropped on replay and all records before it are kept.
+ */
+struct AutoSaveJournal {
+	/**
+	 * @param[in] snapshotFileName Snapshot GPA file name.
+	 * @param[in] journalFileName Journal file name.
+	 */
+	AutoSaveJournal(const std::string &snapshotFileName, const std::string &journalFileName);
+	AutoSaveJournal(const AutoSaveJournal &) = delete;
+	AutoSaveJournal &operator=(const AutoSaveJournal &) = delete;
+	~AutoSaveJournal();
+	/**
+	 * Load snapshot and replay journal into a color list.
+	 * Journal written for another snapshot is ignored.
+	 * @param[out] colorList Color list to add restored colors to.
+	 * @return Empty result on success, error code when snapshot could not be loaded.
+	 */
+	common::ResultVoid<ErrorCode> restore(ColorList &colorList);
+	/**
+	 * Start recording changes of a color list. Journal becomes color list observer until close() is called.
+	 * If color list was not restored by restore(), or journal could not be fully replayed, a new snapshot is written first.
+	 * @param[in] colorList Color list to track. Must stay valid until close() is called.
+	 */
+	void start(ColorList &colorList);
+	/**
+	 * Queue changes recorded since the last flush for writing. Must be called from the thread which modifies color list.
+	 * @return True if any changes were found.
+	 */
+	bool flush();
+	/**
+	 * Wait until all queued writes are finished.
+	 */
+	void wait();
+	/**
+	 * Flush changes, wait for writes to finish and stop tracking.
+	 */
+	void close();
+	/**
+	 * @return Number of changes recorded since start().
+	 */
+	size_t recordCount() const;
+	/**
+	 * @return Number of snapshots written since start().
+	 */
+	size_t snapshotCount() const;
+private:
+	struct Impl;
+	std::unique_ptr<Impl> m_impl;
+};
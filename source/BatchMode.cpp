@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "BatchMode.h"
+#include "GlobalState.h"
+#include "ImportExport.h"
+#include "ColorList.h"
+#include "ColorObject.h"
+#include "ColorSort.h"
+#include "Channels.h"
+#include "Converters.h"
+#include "Converter.h"
+#include "color_names/ColorNames.h"
+#include "dynv/Map.h"
+#include "common/Scoped.h"
+#include <glib.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+namespace fs = std::filesystem;
+namespace {
+const struct {
+	const char *name;
+	FileType type;
+	const char *extension;
+} formats[] = {
+	{ "gpa", FileType::gpa, ".gpa" },
+	{ "gpl", FileType::gpl, ".gpl" },
+	{ "ase", FileType::ase, ".ase" },
+	{ "txt", FileType::txt, ".txt" },
+	{ "mtl", FileType::mtl, ".mtl" },
+	{ "css", FileType::css, ".css" },
+	{ "html", FileType::html, ".html" },
+};
+struct Job {
+	fs::path input, output;
+	FileType inputType;
+};
+struct Settings {
+	FileType format;
+	Converter *converter;
+	bool nameColors, imprecisionPostfix, includeNames;
+	ColorSorter::Options sortOptions;
+	PaletteSaveOptions paletteSaveOptions;
+};
+bool canImport(FileType type) {
+	switch (type) {
+	case FileType::gpa:
+	case FileType::gpl:
+	case FileType::ase:
+	case FileType::txt:
+	case FileType::rgbtxt:
+		return true;
+	case FileType::mtl:
+	case FileType::css:
+	case FileType::html:
+	case FileType::unknown:
+		return false;
+	}
+	return false;
+}
+const char *errorMessage(ImportExport::Error error) {
+	switch (error) {
+	case ImportExport::Error::none:
+		break;
+	case ImportExport::Error::couldNotOpenFile:
+		return "could not open file";
+	case ImportExport::Error::fileReadError:
+		return "file read error";
+	case ImportExport::Error::fileWriteError:
+		return "file write error";
+	case ImportExport::Error::noColorsImported:
+		return "no colors imported";
+	case ImportExport::Error::parsingFailed:
+		return "parsing failed";
+	case ImportExport::Error::cancelled:
+		return "cancelled";
+	}
+	return "unknown error";
+}
+bool convert(GlobalState &gs, const Job &job, const Settings &settings, std::mutex &scriptMutex, std::string &error) {
+	ColorList colorList;
+	{
+		std::unique_lock<std::mutex> lock(scriptMutex, std::defer_lock);
+		if (!ImportExport::isThreadSafe(job.inputType, true)) // Lua state can not be used from multiple threads
+			lock.lock();
+		auto input = job.input.string();
+		ImportExport importExport(colorList, input.c_str());
+		if (!importExport.importType(job.inputType)) {
+			error = errorMessage(importExport.getLastError());
+			return false;
+		}
+	}
+	if (settings.nameColors) {
+		for (auto *colorObject: colorList)
+			colorObject->setName(color_names_get(gs.getColorNames(), &colorObject->getColor(), settings.imprecisionPostfix));
+	}
+	ColorList sortedColorList;
+	if (settings.sortOptions.sortChannel) {
+		ColorSorter sorter(colorList, 1);
+		sorter.sort(settings.sortOptions, sortedColorList);
+	}
+	std::unique_lock<std::mutex> lock(scriptMutex, std::defer_lock);
+	if (!ImportExport::isThreadSafe(settings.format, false))
+		lock.lock();
+	auto output = job.output.string();
+	ImportExport importExport(settings.sortOptions.sortChannel ? sortedColorList : colorList, output.c_str());
+	importExport.setConverter(settings.converter);
+	importExport.setIncludeColorNames(settings.includeNames);
+	importExport.setUpperCaseHex(gs.settings().getString("gpick.options.hex_case", "upper") == "upper");
+	importExport.setPaletteSaveOptions(settings.paletteSaveOptions);
+	if (!importExport.exportType(settings.format)) {
+		error = errorMessage(importExport.getLastError());
+		return false;
+	}
+	return true;
+}
+const ChannelDescription *findChannel(const char *id, const char *option) {
+	if (!id)
+		return nullptr;
+	auto channel = findSortChannel(id);
+	if (!channel)
+		std::cerr << "unknown " << option << " channel: " << id << "\n";
+	return channel;
+}
+}
+bool isBatchMode(int argc, char **argv) {
+	for (int i = 1; i < argc; i++) {
+		std::string_view argument = argv[i];
+		if (argument == "--")
+			return false;
+		if (argument == "--batch")
+			return true;
+	}
+	return false;
+}
+int runBatchMode(int, char **argv) {
+	gboolean batch = false, nameColors = false, noNames = false, reverse = false, reverseGroups = false, gpaHalfFloat = false, gpaCompress = false;
+	gchar *outputPath = nullptr, *formatName = nullptr, *converterName = nullptr, *sortBy = nullptr, *groupBy = nullptr, *gpaLayout = nullptr;
+	gint maxGroups = 10, jobCount = 0;
+	gdouble groupSensitivity = 50;
+	gchar **inputPaths = nullptr;
+	GOptionEntry entries[] = {
+		{ "batch", 0, 0, G_OPTION_ARG_NONE, &batch, "Convert palette files without user interface", nullptr },
+		{ "output", 'o', 0, G_OPTION_ARG_FILENAME, &outputPath, "Output file, or output directory when multiple files are converted", "PATH" },
+		{ "format", 'f', 0, G_OPTION_ARG_STRING, &formatName, "Output format: gpa, gpl, ase, txt, mtl, css or html", "FORMAT" },
+		{ "converter", 'c', 0, G_OPTION_ARG_STRING, &converterName, "Converter used for txt and html output", "NAME" },
+		{ "name-colors", 'n', 0, G_OPTION_ARG_NONE, &nameColors, "Name colors using color dictionaries", nullptr },
+		{ "no-names", 0, 0, G_OPTION_ARG_NONE, &noNames, "Do not write color names", nullptr },
+		{ "sort-by", 0, 0, G_OPTION_ARG_STRING, &sortBy, "Sort colors by channel", "CHANNEL" },
+		{ "group-by", 0, 0, G_OPTION_ARG_STRING, &groupBy, "Group colors by channel before sorting", "CHANNEL" },
+		{ "max-groups", 0, 0, G_OPTION_ARG_INT, &maxGroups, "Maximum number of groups", "COUNT" },
+		{ "group-sensitivity", 0, 0, G_OPTION_ARG_DOUBLE, &groupSensitivity, "Group sensitivity in percent", "PERCENT" },
+		{ "reverse", 0, 0, G_OPTION_ARG_NONE, &reverse, "Reverse sort order", nullptr },
+		{ "reverse-groups", 0, 0, G_OPTION_ARG_NONE, &reverseGroups, "Reverse group order", nullptr },
+		{ "jobs", 'j', 0, G_OPTION_ARG_INT, &jobCount, "Number of files converted in parallel", "COUNT" },
+		{ "gpa-layout", 0, 0, G_OPTION_ARG_STRING, &gpaLayout, "GPA file layout: records (default, readable by older versions) or columns", "LAYOUT" },
+		{ "gpa-half-float", 0, 0, G_OPTION_ARG_NONE, &gpaHalfFloat, "Store colors as half precision floats, implies columns layout", nullptr },
+		{ "gpa-compress", 0, 0, G_OPTION_ARG_NONE, &gpaCompress, "Compress GPA files, implies columns layout", nullptr },
+		{ G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &inputPaths, nullptr, "FILE|DIRECTORY..." },
+		{ nullptr },
+	};
+	common::Scoped freeOptions([&]() {
+		g_free(outputPath);
+		g_free(formatName);
+		g_free(converterName);
+		g_free(sortBy);
+		g_free(groupBy);
+		g_free(gpaLayout);
+		g_strfreev(inputPaths);
+	});
+	GOptionContext *context = g_option_context_new("- convert palette files");
+	g_option_context_add_main_entries(context, entries, nullptr);
+	gchar **argvCopy;
+#ifdef WIN32
+	argvCopy = g_win32_get_command_line();
+#else
+	argvCopy = g_strdupv(argv);
+#endif
+	GError *error = nullptr;
+	bool parsed = g_option_context_parse_strv(context, &argvCopy, &error);
+	g_option_context_free(context);
+	g_strfreev(argvCopy);
+	if (!parsed) {
+		std::cerr << "option parsing failed: " << error->message << "\n";
+		g_clear_error(&error);
+		return -1;
+	}
+	if (!inputPaths || !inputPaths[0]) {
+		std::cerr << "no input files\n";
+		return -1;
+	}
+	if (!outputPath) {
+		std::cerr << "output path is not set\n";
+		return -1;
+	}
+	std::vector<Job> jobs;
+	std::error_code ec;
+	bool outputDirectory = fs::is_directory(outputPath, ec) || inputPaths[1] != nullptr;
+	for (auto inputPath = inputPaths; *inputPath; ++inputPath) {
+		if (fs::is_directory(*inputPath, ec)) {
+			outputDirectory = true;
+			std::vector<Job> directoryJobs;
+			for (const auto &entry: fs::directory_iterator(*inputPath, ec)) {
+				if (!entry.is_regular_file(ec))
+					continue;
+				auto type = ImportExport::getFileType(entry.path().string().c_str());
+				if (canImport(type))
+					directoryJobs.push_back(Job { entry.path(), fs::path(), type });
+			}
+			std::sort(directoryJobs.begin(), directoryJobs.end(), [](const Job &a, const Job &b) {
+				return a.input < b.input;
+			});
+			jobs.insert(jobs.end(), directoryJobs.begin(), directoryJobs.end());
+			continue;
+		}
+		auto type = ImportExport::getFileType(*inputPath);
+		if (!canImport(type)) {
+			std::cerr << *inputPath << ": unsupported input file\n";
+			return -1;
+		}
+		jobs.push_back(Job { fs::path(*inputPath), fs::path(), type });
+	}
+	if (jobs.empty()) {
+		std::cerr << "no input files found\n";
+		return -1;
+	}
+	Settings settings;
+	settings.format = FileType::unknown;
+	std::string extension;
+	for (const auto &format: formats) {
+		if (formatName ? format.name == std::string_view(formatName) : ImportExport::getFileTypeByExtension(fs::path(outputPath).extension().string().c_str()) == format.type) {
+			settings.format = format.type;
+			extension = format.extension;
+			break;
+		}
+	}
+	if (settings.format == FileType::unknown) {
+		std::cerr << "unknown output format\n";
+		return -1;
+	}
+	if (outputDirectory) {
+		fs::create_directories(outputPath, ec);
+		std::set<fs::path> outputs;
+		for (auto &job: jobs) {
+			job.output = fs::path(outputPath) / job.input.stem();
+			job.output += extension;
+			if (!outputs.insert(job.output).second) {
+				std::cerr << job.input.string() << ": output file " << job.output.string() << " is also written by another input file\n";
+				return -1;
+			}
+		}
+	} else {
+		jobs.front().output = outputPath;
+	}
+	settings.sortOptions.sortChannel = findChannel(sortBy, "sort");
+	settings.sortOptions.groupChannel = findChannel(groupBy, "group");
+	if ((sortBy && !settings.sortOptions.sortChannel) || (groupBy && !settings.sortOptions.groupChannel))
+		return -1;
+	if (settings.sortOptions.groupChannel && !settings.sortOptions.sortChannel)
+		settings.sortOptions.sortChannel = findSortChannel("rgb_grayscale");
+	settings.sortOptions.maxGroups = static_cast<size_t>(std::max(maxGroups, 1));
+	settings.sortOptions.groupSensitivity = static_cast<float>(std::clamp(groupSensitivity, 0.0, 100.0) / 100.0);
+	settings.sortOptions.reverse = reverse;
+	settings.sortOptions.reverseGroups = reverseGroups;
+	if (gpaLayout && std::string_view(gpaLayout) == "records") {
+		if (gpaHalfFloat || gpaCompress) {
+			std::cerr << "--gpa-half-float and --gpa-compress require columns gpa layout\n";
+			return -1;
+		}
+	} else if (gpaLayout && std::string_view(gpaLayout) != "columns") {
+		std::cerr << "unknown gpa layout: " << gpaLayout << "\n";
+		return -1;
+	} else if (gpaLayout || gpaHalfFloat || gpaCompress) {
+		settings.paletteSaveOptions.layout = PaletteSaveOptions::Layout::columns; // half floats and compression are only available in columns layout
+	}
+	if (gpaHalfFloat)
+		settings.paletteSaveOptions.precision = PaletteSaveOptions::Precision::float16;
+	settings.paletteSaveOptions.compress = gpaCompress;
+	GlobalState gs;
+	gs.loadHeadless();
+	settings.converter = converterName ? gs.converters().byName(converterName) : gs.converters().firstCopyOrAny();
+	if (!settings.converter && (settings.format == FileType::txt || settings.format == FileType::html)) {
+		std::cerr << "converter not found\n";
+		return -1;
+	}
+	settings.nameColors = nameColors;
+	settings.imprecisionPostfix = gs.settings().getBool("gpick.color_names.imprecision_postfix", false);
+	settings.includeNames = !noNames;
+	size_t threadCount = jobCount > 0 ? static_cast<size_t>(jobCount) : std::max(std::thread::hardware_concurrency(), 1u);
+	threadCount = std::min(threadCount, jobs.size());
+	std::atomic<size_t> nextJob = 0, failedJobs = 0;
+	std::mutex scriptMutex, outputMutex;
+	auto worker = [&]() {
+		for (size_t index; (index = nextJob++) < jobs.size();) {
+			std::string error;
+			if (convert(gs, jobs[index], settings, scriptMutex, error))
+				continue;
+			std::lock_guard<std::mutex> lock(outputMutex);
+			std::cerr << jobs[index].input.string() << ": " << error << "\n";
+			failedJobs++;
+		}
+	};
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < threadCount; i++)
+		threads.emplace_back(worker);
+	worker();
+	for (auto &thread: threads)
+		thread.join();
+	return failedJobs == 0 ? 0 : 1;
+}
@@ -24,9 +24,11 @@
 #include "Color.h"
 #include "uiListPalette.h"
 #include "ColorList.h"
+#include "StringUtils.h"
 #include "dynv/Map.h"
 #include <gtk/gtk.h>
 #include <sstream>
+#include <vector>
 namespace clipboard {
 enum class Target : guint {
 	string = 1,
@@ -59,26 +61,10 @@ static void setData(GtkClipboard *, GtkSelectionData *selectionData, Target targ
 		return;
 	switch (targetType) {
 	case Target::string: {
-		std::stringstream text;
-		std::string textLine;
-		ConverterSerializePosition position(args->colors.size());
-		if (position.count() > 0) {
-			for (auto *color: args->colors) {
-				if (position.index() + 1 == position.count())
-					position.last(true);
-				textLine = args->converter->serialize(*color, position);
-				if (position.first()) {
-					text << textLine;
-					position.first(false);
-				} else {
-					text << "\n" << textLine;
-				}
-				position.incrementIndex();
-			}
-		}
-		textLine = text.str();
-		if (textLine.length() > 0)
-			gtk_selection_data_set_text(selectionData, textLine.c_str(), textLine.length());
+		std::string text;
+		args->converter->serialize(args->colors, text);
+		if (text.length() > 0)
+			gtk_selection_data_set_text(selectionData, text.c_str(), text.length());
 	} break;
 	case Target::color: {
 		auto &colorObject = args->colors.front();
@@ -326,10 +312,13 @@ bool colorObjectAvailable() {
 		case Target::string: {
 			auto data = gtk_selection_data_get_data(selectionData);
 			auto text = std::string(reinterpret_cast<const char *>(data), reinterpret_cast<const char *>(data) + gtk_selection_data_get_length(selectionData));
-			ColorObject colorObject;
-			//TODO: multiple colors should be extracted from string, but converters do not support this right now
-			if (gs.converters().deserialize(text.c_str(), colorObject)) {
-				colorList->add(colorObject);
+			std::vector<std::string> lines;
+			split(text, '\n', true, [&lines](const std::string &line) {
+				lines.push_back(line);
+			});
+			for (auto &line: lines)
+				stripLeadingTrailingChars(line, " \t\r");
+			if (gs.converters().deserialize(lines, *colorList) > 0) {
 				success = true;
 				return VisitResult::stop;
 			}
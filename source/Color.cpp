@@ -17,6 +17,7 @@
  */
 
 #include "Color.h"
+#include <array>
 #include <cmath>
 #include <string>
 #include <tuple>
@@ -381,6 +382,48 @@ Color &Color::nonLinearRgbInplace() {
 		rgb.blue = rgb.blue * 12.92f;
 	return *this;
 }
+static float nonLinearRgbCurve(float value) {
+	if (value > 0.0031308f)
+		return (1.055f * std::pow(value, 1.0f / 2.4f)) - 0.055f;
+	else
+		return value * 12.92f;
+}
+static const size_t NonLinearTableSize = 4096;
+static const std::array<float, 256> linearTable = []() {
+	std::array<float, 256> table;
+	for (size_t i = 0; i < table.size(); i++) {
+		Color color(static_cast<int>(i), 0, 0);
+		table[i] = color.linearRgbInplace().red;
+	}
+	return table;
+}();
+static const std::array<float, NonLinearTableSize + 1> nonLinearTable = []() {
+	std::array<float, NonLinearTableSize + 1> table;
+	for (size_t i = 0; i < table.size(); i++) {
+		table[i] = nonLinearRgbCurve(static_cast<float>(i) / NonLinearTableSize);
+	}
+	return table;
+}();
+float Color::linearRgbValue(uint8_t value) {
+	return linearTable[value];
+}
+float Color::nonLinearRgbValue(float value) {
+	if (!(value >= 0.0f && value < 1.0f))
+		return nonLinearRgbCurve(value);
+	float position = value * NonLinearTableSize;
+	size_t index = static_cast<size_t>(position);
+	float fraction = position - static_cast<float>(index);
+	return nonLinearTable[index] + (nonLinearTable[index + 1] - nonLinearTable[index]) * fraction;
+}
+Color Color::nonLinearRgbFast() const {
+	return Color(nonLinearRgbValue(rgb.red), nonLinearRgbValue(rgb.green), nonLinearRgbValue(rgb.blue), alpha);
+}
+Color &Color::nonLinearRgbFastInplace() {
+	rgb.red = nonLinearRgbValue(rgb.red);
+	rgb.green = nonLinearRgbValue(rgb.green);
+	rgb.blue = nonLinearRgbValue(rgb.blue);
+	return *this;
+}
 Color Color::rgbToLch(const Vector3f &referenceWhite, const Matrix3d &transformation, const Matrix3d &adaptationMatrix) const {
 	return rgbToLab(referenceWhite, transformation, adaptationMatrix).labToLch();
 }
@@ -185,6 +185,31 @@ struct Color {
 	 * @return Color in RGB color space.
 	 */
 	Color nonLinearRgb() const;
+	/**
+	 * Transform linear RGB color to RGB color using precomputed table.
+	 * @return Color in RGB color space.
+	 * @see nonLinearRgbValue.
+	 */
+	Color &nonLinearRgbFastInplace();
+	/**
+	 * Transform linear RGB color to RGB color using precomputed table.
+	 * @return Color in RGB color space.
+	 * @see nonLinearRgbValue.
+	 */
+	Color nonLinearRgbFast() const;
+	/**
+	 * Transform 8-bit RGB value to linear RGB value using precomputed table.
+	 * @param[in] value 8-bit RGB value.
+	 * @return Linear RGB value.
+	 */
+	static float linearRgbValue(uint8_t value);
+	/**
+	 * Transform linear RGB value to RGB value using precomputed 4096 entry table with linear interpolation.
+	 * Result differs from nonLinearRgb by less than 2e-5. Values outside of [0, 1] range are transformed without table.
+	 * @param[in] value Linear RGB value.
+	 * @return RGB value.
+	 */
+	static float nonLinearRgbValue(float value);
 	/**
 	 * Set all color values to absolute values.
 	 * @return Color with absolute values.
@@ -0,0 +1,371 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ColorBatch.h"
+#include "ColorBatchKernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#if GPICK_COLOR_BATCH_X86
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+#endif
+namespace color_batch {
+namespace {
+struct Scalar {
+	using Type = float;
+	using Mask = bool;
+	static constexpr size_t width = 1;
+	static Type load(const float *value) {
+		return *value;
+	}
+	static void store(float *destination, Type value) {
+		*destination = value;
+	}
+	static Type set(float value) {
+		return value;
+	}
+	static Type add(Type a, Type b) {
+		return a + b;
+	}
+	static Type sub(Type a, Type b) {
+		return a - b;
+	}
+	static Type mul(Type a, Type b) {
+		return a * b;
+	}
+	static Type div(Type a, Type b) {
+		return a / b;
+	}
+	static Type min(Type a, Type b) {
+		return b < a ? b : a;
+	}
+	static Type max(Type a, Type b) {
+		return a < b ? b : a;
+	}
+	static Type abs(Type a) {
+		return std::abs(a);
+	}
+	static Type sqrt(Type a) {
+		return std::sqrt(a);
+	}
+	static Type floor(Type a) {
+		return std::floor(a);
+	}
+	static Mask greater(Type a, Type b) {
+		return a > b;
+	}
+	static Mask equal(Type a, Type b) {
+		return a == b;
+	}
+	static Type select(Mask mask, Type a, Type b) {
+		return mask ? a : b;
+	}
+	static Type pow(Type a, float exponent) {
+		return std::pow(a, exponent);
+	}
+	static Type atan2(Type y, Type x) {
+		return std::atan2(y, x);
+	}
+};
+#if GPICK_COLOR_BATCH_X86
+struct Sse2 {
+	using Type = __m128;
+	using Mask = __m128;
+	static constexpr size_t width = 4;
+	static Type load(const float *value) {
+		return _mm_loadu_ps(value);
+	}
+	static void store(float *destination, Type value) {
+		_mm_storeu_ps(destination, value);
+	}
+	static Type set(float value) {
+		return _mm_set1_ps(value);
+	}
+	static Type add(Type a, Type b) {
+		return _mm_add_ps(a, b);
+	}
+	static Type sub(Type a, Type b) {
+		return _mm_sub_ps(a, b);
+	}
+	static Type mul(Type a, Type b) {
+		return _mm_mul_ps(a, b);
+	}
+	static Type div(Type a, Type b) {
+		return _mm_div_ps(a, b);
+	}
+	static Type min(Type a, Type b) {
+		return _mm_min_ps(a, b);
+	}
+	static Type max(Type a, Type b) {
+		return _mm_max_ps(a, b);
+	}
+	static Type abs(Type a) {
+		return _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+	}
+	static Type sqrt(Type a) {
+		return _mm_sqrt_ps(a);
+	}
+	static Type floor(Type a) {
+		auto truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+		return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a), _mm_set1_ps(1.0f)));
+	}
+	static Type round(Type a) {
+		return _mm_cvtepi32_ps(_mm_cvtps_epi32(a));
+	}
+	static Mask greater(Type a, Type b) {
+		return _mm_cmpgt_ps(a, b);
+	}
+	static Mask equal(Type a, Type b) {
+		return _mm_cmpeq_ps(a, b);
+	}
+	static Type select(Mask mask, Type a, Type b) {
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+	static Type split(Type a, Type &exponent) {
+		auto bits = _mm_castps_si128(a);
+		exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(_mm_and_si128(bits, _mm_set1_epi32(0x7f800000)), 23), _mm_set1_epi32(127)));
+		return _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+	}
+	static Type pow2(Type a) {
+		return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(a), _mm_set1_epi32(127)), 23));
+	}
+	static Type pow(Type a, float exponent) {
+		return impl::pow<Sse2>(a, exponent);
+	}
+	static Type atan2(Type y, Type x) {
+		return impl::atan2<Sse2>(y, x);
+	}
+};
+#endif
+}
+const Kernels &scalarKernels() {
+	return impl::Implementation<Scalar>::kernels();
+}
+const Kernels *sse2Kernels() {
+#if GPICK_COLOR_BATCH_X86
+	return &impl::Implementation<Sse2>::kernels();
+#else
+	return nullptr;
+#endif
+}
+}
+static ColorBatch::Instructions detectInstructions() {
+#if GPICK_COLOR_BATCH_X86
+	if (!color_batch::avx2Kernels())
+		return ColorBatch::Instructions::sse2;
+#if defined(__GNUC__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return ColorBatch::Instructions::avx2;
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] >= 7) {
+		__cpuidex(info, 7, 0);
+		bool avx2 = (info[1] & (1 << 5)) != 0;
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		if (avx2 && osxsave && (_xgetbv(0) & 6) == 6)
+			return ColorBatch::Instructions::avx2;
+	}
+#endif
+	return ColorBatch::Instructions::sse2;
+#else
+	return ColorBatch::Instructions::scalar;
+#endif
+}
+static std::atomic<ColorBatch::Instructions> &currentInstructions() {
+	static std::atomic<ColorBatch::Instructions> instructions(ColorBatch::supportedInstructions());
+	return instructions;
+}
+static const color_batch::Kernels &kernels() {
+	switch (currentInstructions().load(std::memory_order_relaxed)) {
+	case ColorBatch::Instructions::avx2:
+		return *color_batch::avx2Kernels();
+	case ColorBatch::Instructions::sse2:
+		return *color_batch::sse2Kernels();
+	case ColorBatch::Instructions::scalar:
+		break;
+	}
+	return color_batch::scalarKernels();
+}
+ColorBatch::Instructions ColorBatch::supportedInstructions() {
+	static const Instructions instructions = detectInstructions();
+	return instructions;
+}
+ColorBatch::Instructions ColorBatch::instructions() {
+	return currentInstructions().load();
+}
+void ColorBatch::setInstructions(Instructions instructions) {
+	currentInstructions().store(std::min(instructions, supportedInstructions()));
+}
+// Channel arrays are padded to a multiple of widest vector size, so kernels never need to handle partial vectors.
+static constexpr size_t padding = 8;
+ColorBatch::ColorBatch():
+	m_size(0),
+	m_stride(0) {
+}
+ColorBatch::ColorBatch(size_t size):
+	m_size(0),
+	m_stride(0) {
+	resize(size);
+}
+void ColorBatch::resize(size_t size) {
+	if (size == m_size)
+		return;
+	size_t stride = (size + padding - 1) / padding * padding;
+	size_t keep = std::min(size, m_size);
+	if (stride != m_stride) {
+		std::vector<float> data(stride * Color::MemberCount, 0.0f);
+		for (int i = 0; i < Color::MemberCount; i++)
+			std::copy_n(m_data.begin() + i * m_stride, keep, data.begin() + i * stride);
+		m_data = std::move(data);
+		m_stride = stride;
+	} else {
+		for (int i = 0; i < Color::MemberCount; i++)
+			std::fill(m_data.begin() + i * m_stride + keep, m_data.begin() + (i + 1) * m_stride, 0.0f);
+	}
+	m_size = size;
+}
+size_t ColorBatch::size() const {
+	return m_size;
+}
+bool ColorBatch::empty() const {
+	return m_size == 0;
+}
+float *ColorBatch::operator[](int index) {
+	if (index < 0 || index >= Color::MemberCount)
+		throw std::invalid_argument("index");
+	return m_data.data() + index * m_stride;
+}
+const float *ColorBatch::operator[](int index) const {
+	if (index < 0 || index >= Color::MemberCount)
+		throw std::invalid_argument("index");
+	return m_data.data() + index * m_stride;
+}
+Color ColorBatch::get(size_t index) const {
+	const float *data = m_data.data() + index;
+	return Color(data[0], data[m_stride], data[m_stride * 2], data[m_stride * 3]);
+}
+void ColorBatch::set(size_t index, const Color &color) {
+	float *data = m_data.data() + index;
+	for (int i = 0; i < Color::MemberCount; i++)
+		data[m_stride * i] = color.data[i];
+}
+namespace {
+struct Channels {
+	Channels(const ColorBatch &input, ColorBatch &output) {
+		output.resize(input.size());
+		for (int i = 0; i < 3; i++) {
+			in[i] = input[i];
+			out[i] = output[i];
+		}
+		if (&input != &output)
+			std::copy_n(input[3], input.size(), output[3]);
+	}
+	const float *in[3];
+	float *out[3];
+};
+}
+void ColorBatch::linearRgb(ColorBatch &output) const {
+	Channels channels(*this, output);
+	kernels().linearRgb(channels.in, channels.out, m_stride);
+}
+void ColorBatch::nonLinearRgb(ColorBatch &output) const {
+	Channels channels(*this, output);
+	kernels().nonLinearRgb(channels.in, channels.out, m_stride);
+}
+void ColorBatch::rgbToHsv(ColorBatch &output) const {
+	Channels channels(*this, output);
+	kernels().rgbToHsv(channels.in, channels.out, m_stride);
+}
+void ColorBatch::rgbToHsl(ColorBatch &output) const {
+	Channels channels(*this, output);
+	kernels().rgbToHsl(channels.in, channels.out, m_stride);
+}
+void ColorBatch::rgbToXyz(const Color::Matrix3d &transformation, ColorBatch &output) const {
+	float matrix[9];
+	for (int i = 0; i < 9; i++)
+		matrix[i] = static_cast<float>(transformation[i]);
+	Channels channels(*this, output);
+	kernels().rgbToXyz(channels.in, channels.out, m_stride, matrix);
+}
+void ColorBatch::rgbToLab(const Color::Vector3f &referenceWhite, const Color::Matrix3d &transformation, const Color::Matrix3d &adaptationMatrix, ColorBatch &output) const {
+	color_batch::LabParameters parameters;
+	for (int column = 0; column < 3; column++) {
+		Color::Vector3d basis;
+		basis.data[column] = 1.0;
+		auto value = adaptationMatrix * (transformation * basis);
+		for (int row = 0; row < 3; row++)
+			parameters.matrix[row * 3 + column] = static_cast<float>(value.data[row] / referenceWhite.data[row]);
+	}
+	Channels channels(*this, output);
+	kernels().rgbToLab(channels.in, channels.out, m_stride, parameters);
+}
+void ColorBatch::rgbToLabD50(ColorBatch &output) const {
+	rgbToLab(Color::getReference(ReferenceIlluminant::D50, ReferenceObserver::_2), Color::sRGBMatrix, Color::d65d50AdaptationMatrix, output);
+}
+void ColorBatch::labToLch(ColorBatch &output) const {
+	Channels channels(*this, output);
+	kernels().labToLch(channels.in, channels.out, m_stride);
+}
+void ColorBatch::rgbToLchD50(ColorBatch &output) const {
+	rgbToLabD50(output);
+	output.labToLch(output);
+}
+void ColorBatch::distanceLch(const Color &color, float *distances) const {
+	const float *in[3] = { (*this)[0], (*this)[1], (*this)[2] };
+	size_t vectorized = m_size / padding * padding;
+	kernels().distanceLch(color.data, in, distances, vectorized);
+	if (vectorized == m_size)
+		return;
+	float tail[padding];
+	const float *tailIn[3] = { in[0] + vectorized, in[1] + vectorized, in[2] + vectorized };
+	kernels().distanceLch(color.data, tailIn, tail, padding);
+	std::copy_n(tail, m_size - vectorized, distances + vectorized);
+}
+void ColorBatch::nearest(const ColorBatch &colors, size_t offset, size_t count, uint32_t *indices, float *distances) const {
+	if (offset + count > m_size)
+		throw std::out_of_range("offset");
+	std::vector<float> packedColors(colors.size() * 3);
+	for (size_t i = 0; i < colors.size(); i++) {
+		for (int j = 0; j < 3; j++)
+			packedColors[i * 3 + j] = colors[j][i];
+	}
+	// ranges can start and end anywhere, so values are copied into padded blocks
+	constexpr size_t blockSize = 256;
+	float block[3][blockSize], blockIndices[blockSize];
+	const float *in[3] = { block[0], block[1], block[2] };
+	for (size_t i = 0; i < count; i += blockSize) {
+		size_t length = std::min(blockSize, count - i), vectorLength = (length + padding - 1) / padding * padding;
+		for (int j = 0; j < 3; j++) {
+			std::copy_n((*this)[j] + offset + i, length, block[j]);
+			std::fill(block[j] + length, block[j] + vectorLength, 0.0f);
+		}
+		float blockDistances[blockSize];
+		kernels().nearest(in, blockIndices, blockDistances, vectorLength, packedColors.data(), colors.size());
+		for (size_t j = 0; j < length; j++)
+			indices[i + j] = static_cast<uint32_t>(blockIndices[j]);
+		std::copy_n(blockDistances, length, distances + i);
+	}
+}
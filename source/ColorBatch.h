@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include "Color.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** \file source/ColorBatch.h
+ * \brief Batch color conversion functions working on struct-of-arrays color buffers.
+ */
+
+/** \struct ColorBatch
+ * \brief Colors stored as struct-of-arrays: each of the four color values is kept in a separate contiguous float array.
+ *
+ * Conversion functions process the whole batch in one call. SSE2 or AVX2 code paths are used when the processor supports them, otherwise scalar code is used.
+ * Vectorized results match scalar Color conversions within ColorBatch::rgbTolerance for RGB, HSV and HSL values and within ColorBatch::labTolerance for Lab and LCh values. Distances match within relative ColorBatch::rgbTolerance.
+ * Output batch can be the same object as the input batch.
+ */
+struct ColorBatch {
+	/** \enum Instructions
+	 * \brief Instruction sets used by conversion functions.
+	 */
+	enum class Instructions : uint8_t {
+		scalar = 0,
+		sse2 = 1,
+		avx2 = 2,
+	};
+	static constexpr float rgbTolerance = 1e-4f;
+	static constexpr float labTolerance = 1e-2f;
+	ColorBatch();
+	ColorBatch(size_t size);
+	/**
+	 * Change number of colors in the batch. Existing color values are kept, new colors are set to zero.
+	 * @param[in] size New number of colors.
+	 */
+	void resize(size_t size);
+	size_t size() const;
+	bool empty() const;
+	/**
+	 * Get contiguous array of single color value.
+	 * @param[in] index Value index (0-3).
+	 * @return Array of values.
+	 */
+	float *operator[](int index);
+	/**
+	 * Get contiguous array of single color value.
+	 * @param[in] index Value index (0-3).
+	 * @return Array of values.
+	 */
+	const float *operator[](int index) const;
+	Color get(size_t index) const;
+	void set(size_t index, const Color &color);
+	/**
+	 * Transform RGB colors to linear RGB colors.
+	 * @param[out] output Batch for linear RGB colors.
+	 */
+	void linearRgb(ColorBatch &output) const;
+	/**
+	 * Transform linear RGB colors to RGB colors.
+	 * @param[out] output Batch for RGB colors.
+	 */
+	void nonLinearRgb(ColorBatch &output) const;
+	/**
+	 * Convert RGB colors to HSV colors.
+	 * @param[out] output Batch for HSV colors.
+	 */
+	void rgbToHsv(ColorBatch &output) const;
+	/**
+	 * Convert RGB colors to HSL colors.
+	 * @param[out] output Batch for HSL colors.
+	 */
+	void rgbToHsl(ColorBatch &output) const;
+	/**
+	 * Convert RGB colors to XYZ colors.
+	 * @param[in] transformation Transformation matrix for RGB to XYZ conversion.
+	 * @param[out] output Batch for XYZ colors.
+	 */
+	void rgbToXyz(const Color::Matrix3d &transformation, ColorBatch &output) const;
+	/**
+	 * Convert RGB colors to Lab colors.
+	 * @param[in] referenceWhite Reference white color values.
+	 * @param[in] transformation Transformation matrix for RGB to XYZ conversion.
+	 * @param[in] adaptationMatrix XYZ chromatic adaptation matrix.
+	 * @param[out] output Batch for Lab colors.
+	 */
+	void rgbToLab(const Color::Vector3f &referenceWhite, const Color::Matrix3d &transformation, const Color::Matrix3d &adaptationMatrix, ColorBatch &output) const;
+	/**
+	 * Convert RGB colors to Lab colors with illuminant D50, observer 2, sRGB transformation matrix and D65-D50 adaptation matrix.
+	 * @param[out] output Batch for Lab colors.
+	 */
+	void rgbToLabD50(ColorBatch &output) const;
+	/**
+	 * Convert Lab colors to LCh colors.
+	 * @param[out] output Batch for LCh colors.
+	 */
+	void labToLch(ColorBatch &output) const;
+	/**
+	 * Convert RGB colors to LCh colors with illuminant D50, observer 2, sRGB transformation matrix and D65-D50 adaptation matrix.
+	 * @param[out] output Batch for LCh colors.
+	 */
+	void rgbToLchD50(ColorBatch &output) const;
+	/**
+	 * Get distances between color and all colors in the batch using the same calculation as Color::distanceLch.
+	 * @param[in] color Color in Lab color space.
+	 * @param[out] distances Array of at least size() distances.
+	 */
+	void distanceLch(const Color &color, float *distances) const;
+	/**
+	 * Find nearest color in another batch for a range of colors in this batch. Distance is Euclidean distance of the first three color values, so for Lab colors it is CIE76 color difference.
+	 * @param[in] colors Colors to search.
+	 * @param[in] offset Index of the first color in this batch.
+	 * @param[in] count Number of colors.
+	 * @param[out] indices Array of at least count indexes of nearest colors. When several colors are equally near, the one with the lowest index is used.
+	 * @param[out] distances Array of at least count squared distances to nearest colors.
+	 */
+	void nearest(const ColorBatch &colors, size_t offset, size_t count, uint32_t *indices, float *distances) const;
+	/**
+	 * Get best instruction set supported by the processor.
+	 * @return Instruction set.
+	 */
+	static Instructions supportedInstructions();
+	/**
+	 * Get instruction set used by conversion functions.
+	 * @return Instruction set.
+	 */
+	static Instructions instructions();
+	/**
+	 * Select instruction set used by conversion functions. Instruction sets not supported by the processor are replaced by the best supported one.
+	 * @param[in] instructions Instruction set.
+	 */
+	static void setInstructions(Instructions instructions);
+private:
+	std::vector<float> m_data;
+	size_t m_size, m_stride;
+};
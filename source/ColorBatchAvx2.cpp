@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// AVX2 kernels are compiled with target specific options enabled only in this file, so the rest of the program runs on processors without AVX2.
+// Standard headers must be included before target options are changed, otherwise inline functions compiled with AVX2 could be shared with other files.
+#include <cstddef>
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#define GPICK_COLOR_BATCH_AVX2 1
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#define GPICK_COLOR_BATCH_AVX2 1
+#elif defined(_MSC_VER)
+#define GPICK_COLOR_BATCH_AVX2 1
+#endif
+#endif
+#include "ColorBatchKernels.h"
+#if GPICK_COLOR_BATCH_AVX2
+#include <immintrin.h>
+namespace color_batch {
+namespace {
+struct Avx2 {
+	using Type = __m256;
+	using Mask = __m256;
+	static constexpr size_t width = 8;
+	static Type load(const float *value) {
+		return _mm256_loadu_ps(value);
+	}
+	static void store(float *destination, Type value) {
+		_mm256_storeu_ps(destination, value);
+	}
+	static Type set(float value) {
+		return _mm256_set1_ps(value);
+	}
+	static Type add(Type a, Type b) {
+		return _mm256_add_ps(a, b);
+	}
+	static Type sub(Type a, Type b) {
+		return _mm256_sub_ps(a, b);
+	}
+	static Type mul(Type a, Type b) {
+		return _mm256_mul_ps(a, b);
+	}
+	static Type div(Type a, Type b) {
+		return _mm256_div_ps(a, b);
+	}
+	static Type min(Type a, Type b) {
+		return _mm256_min_ps(a, b);
+	}
+	static Type max(Type a, Type b) {
+		return _mm256_max_ps(a, b);
+	}
+	static Type abs(Type a) {
+		return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a);
+	}
+	static Type sqrt(Type a) {
+		return _mm256_sqrt_ps(a);
+	}
+	static Type floor(Type a) {
+		return _mm256_floor_ps(a);
+	}
+	static Type round(Type a) {
+		return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	}
+	static Mask greater(Type a, Type b) {
+		return _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+	}
+	static Mask equal(Type a, Type b) {
+		return _mm256_cmp_ps(a, b, _CMP_EQ_OQ);
+	}
+	static Type select(Mask mask, Type a, Type b) {
+		return _mm256_blendv_ps(b, a, mask);
+	}
+	static Type split(Type a, Type &exponent) {
+		auto bits = _mm256_castps_si256(a);
+		exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(_mm256_and_si256(bits, _mm256_set1_epi32(0x7f800000)), 23), _mm256_set1_epi32(127)));
+		return _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f800000)));
+	}
+	static Type pow2(Type a) {
+		return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(a), _mm256_set1_epi32(127)), 23));
+	}
+	static Type pow(Type a, float exponent) {
+		return impl::pow<Avx2>(a, exponent);
+	}
+	static Type atan2(Type y, Type x) {
+		return impl::atan2<Avx2>(y, x);
+	}
+};
+}
+const Kernels *avx2Kernels() {
+	return &impl::Implementation<Avx2>::kernels();
+}
+}
+#else
+namespace color_batch {
+const Kernels *avx2Kernels() {
+	return nullptr;
+}
+}
+#endif
+#if defined(__clang__) && GPICK_COLOR_BATCH_AVX2
+#pragma clang attribute pop
+#elif defined(__GNUC__) && GPICK_COLOR_BATCH_AVX2
+#pragma GCC pop_options
+#endif
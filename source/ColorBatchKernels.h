@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include <cstddef>
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GPICK_COLOR_BATCH_X86 1
+#else
+#define GPICK_COLOR_BATCH_X86 0
+#endif
+
+/** \file source/ColorBatchKernels.h
+ * \brief Conversion kernels shared by all ColorBatch instruction set implementations.
+ *
+ * Kernels are templates over a vector type V which provides Type, Mask, width and basic arithmetic operations.
+ * Vector types must have internal linkage in every translation unit including this file, so that kernels compiled with different instruction sets never get merged by the linker.
+ */
+namespace color_batch {
+struct LabParameters {
+	float matrix[9]; /**< RGB to XYZ, chromatic adaptation and reference white division combined into a single matrix */
+};
+struct Kernels {
+	void (*linearRgb)(const float *const input[3], float *const output[3], size_t count);
+	void (*nonLinearRgb)(const float *const input[3], float *const output[3], size_t count);
+	void (*rgbToHsv)(const float *const input[3], float *const output[3], size_t count);
+	void (*rgbToHsl)(const float *const input[3], float *const output[3], size_t count);
+	void (*rgbToXyz)(const float *const input[3], float *const output[3], size_t count, const float matrix[9]);
+	void (*rgbToLab)(const float *const input[3], float *const output[3], size_t count, const LabParameters &parameters);
+	void (*labToLch)(const float *const input[3], float *const output[3], size_t count);
+	void (*distanceLch)(const float color[3], const float *const input[3], float *output, size_t count);
+	void (*nearest)(const float *const input[3], float *indices, float *distances, size_t count, const float *colors, size_t colorCount);
+};
+const Kernels &scalarKernels();
+const Kernels *sse2Kernels();
+const Kernels *avx2Kernels();
+namespace impl {
+constexpr float Epsilon = 216.0f / 24389.0f;
+constexpr float Kk = 24389.0f / 27.0f;
+constexpr float Pi = 3.14159265359f;
+constexpr float MaxFloat = 3.402823466e+38f;
+template<typename V>
+inline typename V::Type log2(typename V::Type x) {
+	typename V::Type exponent;
+	auto mantissa = V::split(x, exponent);
+	auto large = V::greater(mantissa, V::set(1.41421356f));
+	mantissa = V::select(large, V::mul(mantissa, V::set(0.5f)), mantissa);
+	exponent = V::select(large, V::add(exponent, V::set(1.0f)), exponent);
+	auto t = V::div(V::sub(mantissa, V::set(1.0f)), V::add(mantissa, V::set(1.0f)));
+	auto t2 = V::mul(t, t);
+	auto p = V::add(V::mul(t2, V::set(1.0f / 11.0f)), V::set(1.0f / 9.0f));
+	p = V::add(V::mul(p, t2), V::set(1.0f / 7.0f));
+	p = V::add(V::mul(p, t2), V::set(1.0f / 5.0f));
+	p = V::add(V::mul(p, t2), V::set(1.0f / 3.0f));
+	p = V::add(V::mul(p, t2), V::set(1.0f));
+	return V::add(V::mul(V::mul(p, t), V::set(2.0f * 1.44269504089f)), exponent);
+}
+template<typename V>
+inline typename V::Type exp2(typename V::Type x) {
+	x = V::min(V::max(x, V::set(-126.0f)), V::set(127.0f));
+	auto n = V::round(x);
+	auto z = V::mul(V::sub(x, n), V::set(0.69314718056f));
+	auto p = V::add(V::mul(z, V::set(1.0f / 5040.0f)), V::set(1.0f / 720.0f));
+	p = V::add(V::mul(p, z), V::set(1.0f / 120.0f));
+	p = V::add(V::mul(p, z), V::set(1.0f / 24.0f));
+	p = V::add(V::mul(p, z), V::set(1.0f / 6.0f));
+	p = V::add(V::mul(p, z), V::set(0.5f));
+	p = V::add(V::mul(p, z), V::set(1.0f));
+	p = V::add(V::mul(p, z), V::set(1.0f));
+	return V::mul(p, V::pow2(n));
+}
+/** Power function approximation for positive x. */
+template<typename V>
+inline typename V::Type pow(typename V::Type x, float exponent) {
+	return exp2<V>(V::mul(log2<V>(x), V::set(exponent)));
+}
+/** Arc tangent approximation based on Cephes atanf, returns angle in radians. */
+template<typename V>
+inline typename V::Type atan2(typename V::Type y, typename V::Type x) {
+	auto ax = V::abs(x), ay = V::abs(y);
+	auto max = V::max(ax, ay);
+	auto a = V::div(V::min(ax, ay), max);
+	auto reduce = V::greater(a, V::set(0.41421356f));
+	auto r = V::select(reduce, V::div(V::sub(a, V::set(1.0f)), V::add(a, V::set(1.0f))), a);
+	auto z = V::mul(r, r);
+	auto p = V::sub(V::mul(z, V::set(8.05374449538e-2f)), V::set(1.38776856032e-1f));
+	p = V::add(V::mul(p, z), V::set(1.99777106478e-1f));
+	p = V::sub(V::mul(p, z), V::set(3.33329491539e-1f));
+	auto angle = V::add(V::add(V::mul(V::mul(p, z), r), r), V::select(reduce, V::set(Pi / 4), V::set(0.0f)));
+	angle = V::select(V::greater(ay, ax), V::sub(V::set(Pi / 2), angle), angle);
+	angle = V::select(V::greater(V::set(0.0f), x), V::sub(V::set(Pi), angle), angle);
+	angle = V::select(V::greater(V::set(0.0f), y), V::sub(V::set(0.0f), angle), angle);
+	return V::select(V::equal(max, V::set(0.0f)), V::set(0.0f), angle);
+}
+template<typename V>
+inline typename V::Type linear(typename V::Type value) {
+	auto curve = V::pow(V::div(V::add(value, V::set(0.055f)), V::set(1.055f)), 2.4f);
+	return V::select(V::greater(value, V::set(0.04045f)), curve, V::div(value, V::set(12.92f)));
+}
+template<typename V>
+inline typename V::Type nonLinear(typename V::Type value) {
+	auto curve = V::sub(V::mul(V::set(1.055f), V::pow(value, 1.0f / 2.4f)), V::set(0.055f));
+	return V::select(V::greater(value, V::set(0.0031308f)), curve, V::mul(value, V::set(12.92f)));
+}
+template<typename V>
+inline typename V::Type labCurve(typename V::Type value) {
+	auto curve = V::pow(value, 1.0f / 3.0f);
+	return V::select(V::greater(value, V::set(Epsilon)), curve, V::div(V::add(V::mul(value, V::set(Kk)), V::set(16.0f)), V::set(116.0f)));
+}
+/** Hue calculation shared by HSV and HSL conversions. Result is undefined when delta is zero. */
+template<typename V>
+inline typename V::Type hue(typename V::Type r, typename V::Type g, typename V::Type b, typename V::Type max, typename V::Type delta) {
+	auto hr = V::div(V::sub(g, b), delta);
+	auto hg = V::add(V::set(2.0f), V::div(V::sub(b, r), delta));
+	auto hb = V::add(V::set(4.0f), V::div(V::sub(r, g), delta));
+	auto h = V::select(V::equal(r, max), hr, V::select(V::equal(g, max), hg, hb));
+	h = V::mul(h, V::set(1 / 6.0f));
+	return V::sub(h, V::floor(h));
+}
+template<typename V>
+struct Implementation {
+	using Type = typename V::Type;
+	static void linearRgb(const float *const input[3], float *const output[3], size_t count) {
+		for (int c = 0; c < 3; c++) {
+			for (size_t i = 0; i < count; i += V::width) {
+				V::store(output[c] + i, linear<V>(V::load(input[c] + i)));
+			}
+		}
+	}
+	static void nonLinearRgb(const float *const input[3], float *const output[3], size_t count) {
+		for (int c = 0; c < 3; c++) {
+			for (size_t i = 0; i < count; i += V::width) {
+				V::store(output[c] + i, nonLinear<V>(V::load(input[c] + i)));
+			}
+		}
+	}
+	static void rgbToHsv(const float *const input[3], float *const output[3], size_t count) {
+		for (size_t i = 0; i < count; i += V::width) {
+			auto r = V::load(input[0] + i), g = V::load(input[1] + i), b = V::load(input[2] + i);
+			auto min = V::min(V::min(r, g), b), max = V::max(V::max(r, g), b);
+			auto delta = V::sub(max, min);
+			auto zero = V::set(0.0f);
+			auto saturation = V::select(V::equal(max, zero), zero, V::div(delta, max));
+			auto h = V::select(V::equal(saturation, zero), zero, hue<V>(r, g, b, max, delta));
+			V::store(output[0] + i, h);
+			V::store(output[1] + i, saturation);
+			V::store(output[2] + i, max);
+		}
+	}
+	static void rgbToHsl(const float *const input[3], float *const output[3], size_t count) {
+		for (size_t i = 0; i < count; i += V::width) {
+			auto r = V::load(input[0] + i), g = V::load(input[1] + i), b = V::load(input[2] + i);
+			auto min = V::min(V::min(r, g), b), max = V::max(V::max(r, g), b);
+			auto delta = V::sub(max, min);
+			auto sum = V::add(max, min);
+			auto lightness = V::mul(sum, V::set(0.5f));
+			auto zero = V::set(0.0f);
+			auto saturation = V::div(delta, V::select(V::greater(V::set(0.5f), lightness), sum, V::sub(V::set(2.0f), sum)));
+			auto flat = V::equal(delta, zero);
+			V::store(output[0] + i, V::select(flat, zero, hue<V>(r, g, b, max, delta)));
+			V::store(output[1] + i, V::select(flat, zero, saturation));
+			V::store(output[2] + i, lightness);
+		}
+	}
+	static void rgbToXyz(const float *const input[3], float *const output[3], size_t count, const float matrix[9]) {
+		Type m[9];
+		for (int j = 0; j < 9; j++)
+			m[j] = V::set(matrix[j]);
+		for (size_t i = 0; i < count; i += V::width) {
+			auto r = linear<V>(V::load(input[0] + i)), g = linear<V>(V::load(input[1] + i)), b = linear<V>(V::load(input[2] + i));
+			for (int c = 0; c < 3; c++) {
+				V::store(output[c] + i, V::add(V::add(V::mul(m[c * 3], r), V::mul(m[c * 3 + 1], g)), V::mul(m[c * 3 + 2], b)));
+			}
+		}
+	}
+	static void rgbToLab(const float *const input[3], float *const output[3], size_t count, const LabParameters &parameters) {
+		Type m[9];
+		for (int j = 0; j < 9; j++)
+			m[j] = V::set(parameters.matrix[j]);
+		for (size_t i = 0; i < count; i += V::width) {
+			auto r = linear<V>(V::load(input[0] + i)), g = linear<V>(V::load(input[1] + i)), b = linear<V>(V::load(input[2] + i));
+			Type f[3];
+			for (int c = 0; c < 3; c++) {
+				f[c] = labCurve<V>(V::add(V::add(V::mul(m[c * 3], r), V::mul(m[c * 3 + 1], g)), V::mul(m[c * 3 + 2], b)));
+			}
+			V::store(output[0] + i, V::sub(V::mul(V::set(116.0f), f[1]), V::set(16.0f)));
+			V::store(output[1] + i, V::mul(V::set(500.0f), V::sub(f[0], f[1])));
+			V::store(output[2] + i, V::mul(V::set(200.0f), V::sub(f[1], f[2])));
+		}
+	}
+	static void labToLch(const float *const input[3], float *const output[3], size_t count) {
+		for (size_t i = 0; i < count; i += V::width) {
+			auto L = V::load(input[0] + i), a = V::load(input[1] + i), b = V::load(input[2] + i);
+			auto h = V::mul(V::atan2(b, a), V::set(180.0f / Pi));
+			h = V::select(V::greater(V::set(0.0f), h), V::add(h, V::set(360.0f)), h);
+			h = V::select(V::greater(V::set(360.0f), h), h, V::sub(h, V::set(360.0f)));
+			V::store(output[0] + i, L);
+			V::store(output[1] + i, V::sqrt(V::add(V::mul(a, a), V::mul(b, b))));
+			V::store(output[2] + i, h);
+		}
+	}
+	static void distanceLch(const float color[3], const float *const input[3], float *output, size_t count) {
+		auto aL = V::set(color[0]), aa = V::set(color[1]), ab = V::set(color[2]);
+		auto aC = V::sqrt(V::add(V::mul(aa, aa), V::mul(ab, ab)));
+		auto chromaWeight = V::div(V::set(1.0f), V::add(V::set(1.0f), V::mul(aC, V::set(0.045f))));
+		auto hueWeight = V::div(V::set(1.0f), V::add(V::set(1.0f), V::mul(aC, V::set(0.015f))));
+		for (size_t i = 0; i < count; i += V::width) {
+			auto L = V::load(input[0] + i), a = V::load(input[1] + i), b = V::load(input[2] + i);
+			auto dL = V::sub(L, aL);
+			auto dC = V::sub(V::sqrt(V::add(V::mul(a, a), V::mul(b, b))), aC);
+			auto da = V::sub(aa, a), db = V::sub(ab, b);
+			auto chroma = V::mul(dC, chromaWeight);
+			auto hueTerm = V::mul(V::sub(V::add(V::mul(da, da), V::mul(db, db)), dC), hueWeight);
+			V::store(output + i, V::sqrt(V::add(V::add(V::mul(dL, dL), V::mul(chroma, chroma)), V::mul(hueTerm, hueTerm))));
+		}
+	}
+	// indexes are kept as floats so they can be selected with the same masks as distances, they are exact up to 2^24 colors
+	static void nearest(const float *const input[3], float *indices, float *distances, size_t count, const float *colors, size_t colorCount) {
+		for (size_t i = 0; i < count; i += V::width) {
+			auto x = V::load(input[0] + i), y = V::load(input[1] + i), z = V::load(input[2] + i);
+			auto best = V::set(MaxFloat), bestIndex = V::set(0.0f);
+			for (size_t j = 0; j < colorCount; j++) {
+				auto dx = V::sub(x, V::set(colors[j * 3])), dy = V::sub(y, V::set(colors[j * 3 + 1])), dz = V::sub(z, V::set(colors[j * 3 + 2]));
+				auto distance = V::add(V::add(V::mul(dx, dx), V::mul(dy, dy)), V::mul(dz, dz));
+				bestIndex = V::select(V::greater(best, distance), V::set(static_cast<float>(j)), bestIndex);
+				best = V::min(best, distance);
+			}
+			V::store(distances + i, best);
+			V::store(indices + i, bestIndex);
+		}
+	}
+	static const Kernels &kernels() {
+		static const Kernels kernels = { linearRgb, nonLinearRgb, rgbToHsv, rgbToHsl, rgbToXyz, rgbToLab, labToLch, distanceLch, nearest };
+		return kernels;
+	}
+};
+}
+}
@@ -20,15 +20,14 @@
 #include "ColorObject.h"
 #include "IPalette.h"
 #include <algorithm>
+#include <stdexcept>
 namespace {
 struct NullPalette: public IPalette {
 	virtual ~NullPalette() {
 	}
 	virtual void add(ColorList &colorList, ColorObject *colorObject) override {
 	}
-	virtual void remove(ColorList &colorList, ColorObject *colorObject) override {
-	}
-	virtual void removeSelected(ColorList &colorList) override {
+	virtual void change(ColorList &colorList, const ColorListChange &change) override {
 	}
 	virtual void clear(ColorList &colorList) override {
 	}
@@ -39,11 +38,13 @@ static NullPalette nullPalette = {};
 }
 ColorList::ColorList():
 	m_palette(nullPalette),
+	m_observer(nullptr),
 	m_blocked(false),
 	m_changed(false) {
 }
 ColorList::ColorList(IPalette &palette):
 	m_palette(palette),
+	m_observer(nullptr),
 	m_blocked(false),
 	m_changed(false) {
 }
@@ -57,6 +58,7 @@ ColorList::ColorList(ColorList &&colorList):
 	Counter(std::move(colorList)),
 	m_colors(std::move(colorList.m_colors)),
 	m_palette(colorList.m_palette),
+	m_observer(nullptr),
 	m_blocked(colorList.m_blocked),
 	m_changed(colorList.m_changed) {
 }
@@ -68,28 +70,77 @@ ColorList::ColorList(ColorList &&colorList):
 }
 void ColorList::add(ColorObject *colorObject) {
 	m_colors.push_back(colorObject->reference());
-	m_palette.add(*this, colorObject);
-	m_changed = true;
-}
-void ColorList::add(ColorObject *colorObject, size_t position, bool updatePalette) {
-	m_colors.insert(m_colors.begin() + position, colorObject->reference());
-	if (updatePalette)
-		m_palette.add(*this, colorObject);
+	paletteAdd(colorObject);
 	m_changed = true;
 }
 void ColorList::add(const ColorObject &colorObject) {
 	auto *copy = colorObject.copy().unwrap();
 	m_colors.push_back(copy);
-	m_palette.add(*this, copy);
+	paletteAdd(copy);
 	m_changed = true;
 }
 void ColorList::add(ColorList &colorList) {
-	auto guard = changeGuard();
-	for (auto *colorObject: colorList) {
-		m_colors.push_back(colorObject->reference());
-		m_palette.add(*this, colorObject);
-		m_changed = true;
+	addRange(common::Span<ColorObject *const>(colorList.m_colors.data(), colorList.m_colors.size()));
+}
+void ColorList::addRange(common::Span<ColorObject *const> colorObjects) {
+	addRange(m_colors.size(), colorObjects);
+}
+void ColorList::addRange(size_t position, common::Span<ColorObject *const> colorObjects) {
+	if (colorObjects.size() == 0)
+		return;
+	position = std::min(position, m_colors.size());
+	m_colors.insert(m_colors.begin() + position, colorObjects.data(), colorObjects.data() + colorObjects.size());
+	for (size_t i = 0; i < colorObjects.size(); i++)
+		m_colors[position + i]->reference();
+	ColorListChange change = {};
+	change.type = ColorListChange::Type::insert;
+	change.position = position;
+	change.count = colorObjects.size();
+	paletteChange(change);
+	m_changed = true;
+}
+void ColorList::reorder(common::Span<const size_t> order) {
+	size_t count = m_colors.size();
+	if (order.size() != count)
+		throw std::invalid_argument("order size does not match list size");
+	std::vector<bool> used(count, false);
+	size_t first = count, last = 0;
+	for (size_t i = 0; i < count; i++) {
+		size_t from = order[i];
+		if (from >= count || used[from])
+			throw std::invalid_argument("order is not a permutation");
+		used[from] = true;
+		if (from != i) {
+			first = std::min(first, i);
+			last = i + 1;
+		}
 	}
+	if (first == count)
+		return;
+	std::vector<ColorObject *> colors(count);
+	for (size_t i = 0; i < count; i++)
+		colors[i] = m_colors[order[i]];
+	m_colors.swap(colors);
+	ColorListChange change = {};
+	change.type = ColorListChange::Type::reorder;
+	change.position = first;
+	change.count = last - first;
+	change.order = order;
+	paletteChange(change);
+	m_changed = true;
+}
+void ColorList::replaceAll(common::Span<ColorObject *const> colorObjects) {
+	std::vector<ColorObject *> colors(colorObjects.data(), colorObjects.data() + colorObjects.size());
+	for (auto *colorObject: colors)
+		colorObject->reference();
+	m_colors.swap(colors);
+	for (auto *colorObject: colors)
+		colorObject->release();
+	ColorListChange change = {};
+	change.type = ColorListChange::Type::replace;
+	change.count = m_colors.size();
+	paletteChange(change);
+	m_changed = true;
 }
 bool ColorList::startChanges() {
 	if (m_blocked)
@@ -99,8 +150,11 @@ bool ColorList::startChanges() {
 	return true;
 }
 bool ColorList::endChanges() {
-	if (m_changed)
+	if (m_changed) {
 		m_palette.update(*this);
+		if (m_observer)
+			m_observer->update(*this);
+	}
 	m_blocked = false;
 	return true;
 }
@@ -122,8 +176,13 @@ void ColorList::removeAll() {
 	}
 	m_colors.clear();
 	m_palette.clear(*this);
+	if (m_observer)
+		m_observer->clear(*this);
 	m_changed = true;
 }
+void ColorList::setObserver(IPalette *observer) {
+	m_observer = observer;
+}
 std::vector<ColorObject *>::iterator ColorList::begin() {
 	return m_colors.begin();
 }
@@ -163,9 +222,22 @@ void ColorList::onEndChanges(ColorList *colorList) {
 void ColorList::releaseItem(ColorObject *colorObject) {
 	colorObject->release();
 }
-void ColorList::paletteRemoveSelected() {
-	m_palette.removeSelected(*this);
-}
-void ColorList::paletteRemove(ColorObject *colorObject) {
-	m_palette.remove(*this, colorObject);
+void ColorList::paletteAdd(ColorObject *colorObject) {
+	m_palette.add(*this, colorObject);
+	if (m_observer)
+		m_observer->add(*this, colorObject);
+}
+void ColorList::paletteChange(const ColorListChange &change) {
+	m_palette.change(*this, change);
+	if (m_observer)
+		m_observer->change(*this, change);
+}
+void ColorList::paletteRemoved(const std::vector<std::pair<size_t, size_t>> &ranges) {
+	ColorListChange change = {};
+	change.type = ColorListChange::Type::remove;
+	for (auto &range: ranges)
+		change.count += range.second - range.first;
+	change.ranges = common::Span<const std::pair<size_t, size_t>>(ranges.data(), ranges.size());
+	paletteChange(change);
+	m_changed = true;
 }
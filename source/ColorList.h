@@ -20,10 +20,13 @@
 #include "Color.h"
 #include "common/Ref.h"
 #include "common/Guard.h"
+#include "common/Span.h"
 #include <vector>
+#include <utility>
 #include <cstddef>
 struct ColorObject;
 struct IPalette;
+struct ColorListChange;
 struct ColorList: public common::Ref<ColorList>::Counter {
 	using value_type = ColorList *;
 	using iterator = std::vector<ColorObject *>::iterator;
@@ -37,26 +40,61 @@ struct ColorList: public common::Ref<ColorList>::Counter {
 	bool empty() const;
 	void add(const ColorObject &colorObject);
 	void add(ColorObject *colorObject);
-	void add(ColorObject *colorObject, size_t position, bool updatePalette = false);
 	void add(ColorList &colorList);
+	/** Append color objects to the end of the list.
+	 * Palette receives a single change notification.
+	 * @param[in] colorObjects Color objects to reference and append.
+	 */
+	void addRange(common::Span<ColorObject *const> colorObjects);
+	/** Insert color objects at specified position.
+	 * Palette receives a single change notification.
+	 * @param[in] position Position in the list, clamped to list size.
+	 * @param[in] colorObjects Color objects to reference and insert.
+	 */
+	void addRange(size_t position, common::Span<ColorObject *const> colorObjects);
+	/** Remove all color objects matching a predicate in a single pass, keeping order of remaining color objects.
+	 * Palette receives a single change notification listing removed row ranges.
+	 * @param[in] callback Predicate returning true for color objects which should be removed.
+	 * @return Number of removed color objects.
+	 */
 	template<typename Callback>
-	void remove(Callback &&callback, bool selected, bool updatePalette) {
-		auto i = m_colors.begin();
-		while (i != m_colors.end()) {
-			if (callback(*i)) {
-				if (updatePalette && !selected) {
-					paletteRemove(*i);
-				}
-				releaseItem(*i);
-				i = m_colors.erase(i);
-			} else
-				++i;
+	size_t removeIf(Callback &&callback) {
+		std::vector<std::pair<size_t, size_t>> ranges;
+		size_t position = 0;
+		for (size_t i = 0, count = m_colors.size(); i < count; i++) {
+			auto *colorObject = m_colors[i];
+			if (callback(colorObject)) {
+				if (!ranges.empty() && ranges.back().second == i)
+					ranges.back().second++;
+				else
+					ranges.emplace_back(i, i + 1);
+				releaseItem(colorObject);
+			} else {
+				m_colors[position++] = colorObject;
+			}
 		}
-		if (updatePalette && selected)
-			paletteRemoveSelected();
-		m_changed = true;
+		size_t removed = m_colors.size() - position;
+		m_colors.resize(position);
+		if (removed != 0)
+			paletteRemoved(ranges);
+		return removed;
 	}
+	/** Reorder color objects.
+	 * Palette receives a single change notification.
+	 * @param[in] order Permutation of list indices: color object at index i is moved from index order[i].
+	 * @throw std::invalid_argument When order is not a permutation of list indices.
+	 */
+	void reorder(common::Span<const size_t> order);
+	/** Replace all color objects.
+	 * Palette receives a single change notification.
+	 * @param[in] colorObjects New color objects to reference.
+	 */
+	void replaceAll(common::Span<ColorObject *const> colorObjects);
 	void removeAll();
+	/** Set palette which receives the same notifications as list palette.
+	 * @param[in] observer Palette to notify, or nullptr to stop notifying.
+	 */
+	void setObserver(IPalette *observer);
 	bool startChanges();
 	bool endChanges();
 	bool blocked() const;
@@ -78,9 +116,11 @@ struct ColorList: public common::Ref<ColorList>::Counter {
 private:
 	std::vector<ColorObject *> m_colors;
 	IPalette &m_palette;
+	IPalette *m_observer;
 	bool m_blocked, m_changed;
 	static void onEndChanges(ColorList *colorList);
 	void releaseItem(ColorObject *colorObject);
-	void paletteRemoveSelected();
-	void paletteRemove(ColorObject *colorObject);
+	void paletteAdd(ColorObject *colorObject);
+	void paletteChange(const ColorListChange &change);
+	void paletteRemoved(const std::vector<std::pair<size_t, size_t>> &ranges);
 };
@@ -17,24 +17,44 @@
  */
 
 #include "ColorObject.h"
+#include "common/SlabAllocator.h"
+#include <atomic>
+namespace {
+std::atomic<uint64_t> generationCounter = 0;
+uint64_t nextGeneration() {
+	return generationCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+common::SlabAllocator &allocator() {
+	// Allocator is never destroyed, because color objects can be released during static destruction.
+	static auto *allocator = new common::SlabAllocator(sizeof(ColorObject));
+	return *allocator;
+}
+}
 ColorObject::ColorObject():
 	m_name(),
-	m_color() {
+	m_color(),
+	m_generation(0) {
 }
 ColorObject::ColorObject(const Color &color):
-	m_color(color) {
+	m_color(color),
+	m_generation(0) {
 }
 ColorObject::ColorObject(std::string_view name, const Color &color):
 	m_name(name),
-	m_color(color) {
+	m_color(color),
+	m_generation(0) {
 }
 ColorObject::ColorObject(const ColorObject &colorObject):
 	m_name(colorObject.m_name),
-	m_color(colorObject.m_color) {
+	m_color(colorObject.m_color),
+	m_generation(0) {
 }
 ColorObject &ColorObject::operator=(const ColorObject &colorObject) {
 	m_name = colorObject.m_name;
 	m_color = colorObject.m_color;
+	m_generation = nextGeneration();
+	if (m_convertedColors)
+		m_convertedColors->valid = 0;
 	return *this;
 }
 const Color &ColorObject::getColor() const {
@@ -42,13 +62,78 @@ const Color &ColorObject::getColor() const {
 }
 void ColorObject::setColor(const Color &color) {
 	m_color = color;
+	m_generation = nextGeneration();
+	if (m_convertedColors)
+		m_convertedColors->valid = 0;
+}
+const Color &ColorObject::getColor(ColorSpace colorSpace) const {
+	auto index = static_cast<size_t>(colorSpace) - 1;
+	if (index >= ConvertedColors::count)
+		return m_color;
+	if (!m_convertedColors) {
+		m_convertedColors = std::make_unique<ConvertedColors>();
+		m_convertedColors->valid = 0;
+	}
+	auto &color = m_convertedColors->colors[index];
+	if (m_convertedColors->valid & (1 << index))
+		return color;
+	switch (colorSpace) {
+	case ColorSpace::rgb:
+		color = m_color.linearRgb();
+		break;
+	case ColorSpace::hsl:
+		color = m_color.rgbToHsl();
+		break;
+	case ColorSpace::hsv:
+		color = m_color.rgbToHsv();
+		break;
+	case ColorSpace::cmyk:
+		color = m_color.rgbToCmyk();
+		break;
+	case ColorSpace::lab:
+		color = m_color.rgbToLabD50();
+		break;
+	case ColorSpace::lch:
+		color = m_color.rgbToLchD50();
+		break;
+	}
+	m_convertedColors->valid |= 1 << index;
+	return color;
 }
 const std::string &ColorObject::getName() const {
 	return m_name;
 }
 void ColorObject::setName(const std::string &name) {
 	m_name = name;
+	m_generation = nextGeneration();
+}
+uint64_t ColorObject::generation() const {
+	return m_generation;
+}
+uint64_t ColorObject::lastGeneration() {
+	return generationCounter.load(std::memory_order_relaxed);
 }
 [[nodiscard]] common::Ref<ColorObject> ColorObject::copy() const {
 	return common::Ref(new ColorObject(*this));
 }
+void *ColorObject::operator new(size_t size) {
+	if (size != sizeof(ColorObject))
+		return ::operator new(size);
+	return allocator().allocate();
+}
+void ColorObject::operator delete(void *pointer, size_t size) {
+	if (size != sizeof(ColorObject)) {
+		::operator delete(pointer);
+		return;
+	}
+	allocator().deallocate(pointer);
+}
+template<>
+bool common::Ref<ColorObject>::Counter::release() {
+	if (m_referenceCounter > 1) {
+		m_referenceCounter--;
+		return false;
+	}
+	delete this;
+	return true;
+}
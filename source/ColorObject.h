@@ -18,9 +18,12 @@
 
 #pragma once
 #include "Color.h"
+#include "ColorSpace.h"
 #include "common/Ref.h"
 #include <string>
 #include <string_view>
+#include <memory>
+#include <cstdint>
 struct ColorObject: public common::Ref<ColorObject>::Counter {
 	ColorObject();
 	ColorObject(const Color &color);
@@ -28,11 +31,48 @@ struct ColorObject: public common::Ref<ColorObject>::Counter {
 	ColorObject(const ColorObject &colorObject);
 	ColorObject &operator=(const ColorObject &colorObject);
 	const Color &getColor() const;
+	/**
+	 * Get color converted into another color space. Conversion results are calculated once and kept until color is changed.
+	 * Result is the same as using ColorSpaceDescription::convertTo of the color space.
+	 * Cache is not thread safe, so color objects shared between threads must not be converted concurrently.
+	 * @param[in] colorSpace Color space.
+	 * @return Converted color.
+	 */
+	const Color &getColor(ColorSpace colorSpace) const;
 	void setColor(const Color &color);
 	const std::string &getName() const;
 	void setName(const std::string &name);
+	/**
+	 * Each change of color or name gives color object a new modification generation, greater than generation of any earlier change.
+	 * Generation counter is shared by all color objects and is thread safe.
+	 * @return Modification generation of the last change, or 0 if color object was not changed after construction.
+	 */
+	uint64_t generation() const;
+	/**
+	 * @return Modification generation of the last change made to any color object.
+	 */
+	static uint64_t lastGeneration();
 	[[nodiscard]] common::Ref<ColorObject> copy() const;
+	/**
+	 * Color objects are allocated from shared slabs, so color objects created one after another, for example when a palette is loaded, are stored next to each other.
+	 */
+	static void *operator new(size_t size);
+	static void operator delete(void *pointer, size_t size);
 private:
+	struct ConvertedColors {
+		static constexpr size_t count = static_cast<size_t>(ColorSpace::lch);
+		Color colors[count];
+		uint32_t valid;
+	};
 	std::string m_name;
 	Color m_color;
+	uint64_t m_generation;
+	mutable std::unique_ptr<ConvertedColors> m_convertedColors;
 };
+namespace common {
+/**
+ * Color object release is not inlined, so the compiler always sees destruction through the class specific operator delete matching operator new.
+ */
+template<>
+bool Ref<ColorObject>::Counter::release();
+}
@@ -42,6 +42,7 @@
 #include "color_names/ColorNames.h"
 #include "ScreenReader.h"
 #include "Sampler.h"
+#include "PickerScheduler.h"
 #include "EventBus.h"
 #include "common/Guard.h"
 #include <gdk/gdkkeysyms.h>
@@ -79,12 +80,19 @@ struct ColorPickerArgs: public IColorPicker, public IEventHandler {
 	GtkWidget *pickButton;
 	GtkWidget *colorWidget;
 	GtkWidget *colorInput;
-	guint timeoutSourceId;
+	PickerScheduler scheduler;
+	math::Vector2i lastPointer;
+	math::Rectangle<int> lastZoomedRect;
+	std::optional<Color> lastColor;
+	uint64_t lastGeneration;
 	FloatingPicker floatingPicker;
 	dynv::Ref options, mainOptions;
 	GlobalState &gs;
 	bool ignoreCallback;
 	ColorPickerArgs(GlobalState &gs, const dynv::Ref &options):
+		scheduler([this]() {
+			return updateMainColor();
+		}),
 		options(options),
 		gs(gs) {
 		swatchEditable.emplace(*this);
@@ -94,7 +102,7 @@ struct ColorPickerArgs: public IColorPicker, public IEventHandler {
 		statusBar = gs.getStatusBar();
 		floatingPicker = nullptr;
 		ignoreCallback = false;
-		timeoutSourceId = 0;
+		lastGeneration = 0;
 		gs.eventBus().subscribe(EventType::optionsUpdate, *this);
 		gs.eventBus().subscribe(EventType::convertersUpdate, *this);
 		gs.eventBus().subscribe(EventType::displayFiltersUpdate, *this);
@@ -125,6 +133,7 @@ struct ColorPickerArgs: public IColorPicker, public IEventHandler {
 		gtk_color_get_color(GTK_COLOR(contrastCheck), &c);
 		options->set("contrast.color", c);
 		options->set("color_input_text", gtk_entry_get_text(GTK_ENTRY(colorInput)));
+		scheduler.stop();
 		gtk_widget_destroy(main);
 		gs.eventBus().unsubscribe(*this);
 	}
@@ -132,41 +141,32 @@ struct ColorPickerArgs: public IColorPicker, public IEventHandler {
 		return "color_picker";
 	}
 	virtual void activate() override {
-		if (timeoutSourceId > 0) {
-			g_source_remove(timeoutSourceId);
-			timeoutSourceId = 0;
-		}
+		scheduler.stop();
+		lastColor.reset();
 		if (options->getBool("zoomed_enabled", true)){
-			auto refresh_rate = mainOptions->getInt32("refresh_rate", 30);
-			timeoutSourceId = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, static_cast<int>(1000 / refresh_rate), (GSourceFunc)updateMainColorTimer, this, (GDestroyNotify)nullptr);
+			scheduler.start(zoomed_display, mainOptions->getInt32("refresh_rate", 30));
 		}
 		gtk_statusbar_push(GTK_STATUSBAR(statusBar), gtk_statusbar_get_context_id(GTK_STATUSBAR(statusBar), "focus_swatch"), _("Click on swatch area to begin adding colors to palette"));
 	}
-	static gboolean updateMainColorTimer(ColorPickerArgs *args) {
-		args->updateMainColor();
-		return true;
-	}
 	static void onZoomedActivate(GtkWidget *widget, ColorPickerArgs *args) {
 		if (args->options->getBool("zoomed_enabled", true)){
 			gtk_zoomed_set_fade(GTK_ZOOMED(args->zoomed_display), true);
 			args->options->set("zoomed_enabled", false);
-			if (args->timeoutSourceId > 0){
-				g_source_remove(args->timeoutSourceId);
-				args->timeoutSourceId = 0;
-			}
+			args->scheduler.stop();
 		}else{
 			gtk_zoomed_set_fade(GTK_ZOOMED(args->zoomed_display), false);
 			args->options->set("zoomed_enabled", true);
-			if (args->timeoutSourceId > 0){
-				g_source_remove(args->timeoutSourceId);
-				args->timeoutSourceId = 0;
-			}
-			auto refresh_rate = args->mainOptions->getInt32("refresh_rate", 30);
-			args->timeoutSourceId = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, static_cast<int>(1000 / refresh_rate), (GSourceFunc)updateMainColorTimer, args, (GDestroyNotify)nullptr);
+			args->lastColor.reset();
+			args->scheduler.start(args->zoomed_display, args->mainOptions->getInt32("refresh_rate", 30));
 		}
 		return;
 	}
-	void updateMainColor() {
+	/**
+	 * Sample color under the pointer and update main color and zoomed view.
+	 * Widgets are only updated when their content changes.
+	 * @return True if pointer position or sampled color changed since the last update.
+	 */
+	bool updateMainColor() {
 		GdkScreen *screen;
 		GdkModifierType state;
 		int x, y;
@@ -191,20 +191,27 @@ struct ColorPickerArgs: public IColorPicker, public IEventHandler {
 		offset = sampler_rect.position() - final_rect.position();
 		Color c;
 		sampler_get_color_sample(gs.getSampler(), pointer, screen_rect, offset, &c);
-		std::string text = gs.converters().serialize(c, Converters::Type::display);
-		gtk_color_set_color(GTK_COLOR(colorCode), &c, text.c_str());
-		gtk_swatch_set_main_color(GTK_SWATCH(swatch_display), &c);
-		if (zoomed_enabled){
+		bool colorChanged = !lastColor || *lastColor != c;
+		if (colorChanged) {
+			std::string text = gs.converters().serialize(c, Converters::Type::display);
+			gtk_color_set_color(GTK_COLOR(colorCode), &c, text.c_str());
+			gtk_swatch_set_main_color(GTK_SWATCH(swatch_display), &c);
+			lastColor = c;
+		}
+		bool pointerChanged = pointer != lastPointer;
+		lastPointer = pointer;
+		uint64_t generation = screen_reader_get_generation(screen_reader);
+		if (zoomed_enabled && (pointerChanged || generation != lastGeneration || zoomed_rect != lastZoomedRect)){
 			offset = final_rect.position() - zoomed_rect.position();
 			gtk_zoomed_update(GTK_ZOOMED(zoomed_display), pointer, screen_rect, offset, screen_reader_get_surface(screen_reader));
 		}
+		lastGeneration = generation;
+		lastZoomedRect = zoomed_rect;
+		return colorChanged || pointerChanged;
 	}
 	virtual void deactivate() override {
 		gtk_statusbar_pop(GTK_STATUSBAR(statusBar), gtk_statusbar_get_context_id(GTK_STATUSBAR(statusBar), "focus_swatch"));
-		if (timeoutSourceId > 0) {
-			g_source_remove(timeoutSourceId);
-			timeoutSourceId = 0;
-		}
+		scheduler.stop();
 	}
 	virtual GtkWidget *getWidget() override {
 		return main;
@@ -215,6 +222,9 @@ struct ColorPickerArgs: public IColorPicker, public IEventHandler {
 		gtk_color_set_transformation_chain(GTK_COLOR(colorCode), chain);
 		gtk_color_set_transformation_chain(GTK_COLOR(contrastCheck), chain);
 		gtk_color_set_transformation_chain(GTK_COLOR(colorWidget), chain);
+		gtk_zoomed_set_transformation_chain(GTK_ZOOMED(zoomed_display), chain);
+		for (auto widget: { hslControl, hsvControl, rgbControl, cmykControl, labControl, lchControl })
+			gtk_color_component_set_transformation_chain(GTK_COLOR_COMPONENT(widget), chain);
 	}
 	void setOptions() {
 		struct{
@@ -265,6 +275,8 @@ struct ColorPickerArgs: public IColorPicker, public IEventHandler {
 		case EventType::convertersUpdate:
 			setOptions();
 			updateColorWidget();
+			lastColor.reset();
+			scheduler.wake();
 			break;
 		case EventType::displayFiltersUpdate:
 			setTransformationChain();
@@ -685,11 +697,13 @@ static gboolean onSwatchKeyPress(GtkWidget *widget, GdkEventKey *event, ColorPic
 static void on_oversample_value_changed(GtkRange *slider, gpointer data){
 	ColorPickerArgs* args=(ColorPickerArgs*)data;
 	sampler_set_oversample(args->gs.getSampler(), (int)gtk_range_get_value(GTK_RANGE(slider)));
+	args->scheduler.wake();
 }
 
 static void on_zoom_value_changed(GtkRange *slider, gpointer data){
 	ColorPickerArgs* args=(ColorPickerArgs*)data;
 	gtk_zoomed_set_zoom(GTK_ZOOMED(args->zoomed_display), static_cast<float>(gtk_range_get_value(GTK_RANGE(slider))));
+	args->scheduler.wake();
 }
 
 static void color_component_change_value(GtkWidget *widget, Color* c, ColorPickerArgs* args){
@@ -816,6 +830,7 @@ static void on_oversample_falloff_changed(GtkWidget *widget, gpointer data) {
 
 		ColorPickerArgs* args = (ColorPickerArgs*)data;
 		sampler_set_falloff(args->gs.getSampler(), (SamplerFalloff) falloff_id);
+		args->scheduler.wake();
 
 	}
 }
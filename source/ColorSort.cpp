@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "ColorSort.h"
+#include "ColorList.h"
+#include "ColorObject.h"
+#include "I18N.h"
+#include "math/RadixSort.h"
+#include <algorithm>
+#include <numeric>
+#include <thread>
+namespace {
+static float toGrayscale(const Color &color) {
+	Color r = color.linearRgb();
+	return (r.red + r.green + r.blue) / 3;
+}
+static const ChannelDescription sortChannelDescriptions[] = {
+	{ "rgb_grayscale", N_("RGB Grayscale"), ColorSpace::rgb, Channel::userDefined, ChannelFlags::useConvertTo, { .convertTo = toGrayscale }, 0, 1 },
+};
+// Same conversions as ColorObject::getColor(ColorSpace), without using color object cache, which is not thread safe.
+static Color convert(const Color &color, ColorSpace colorSpace) {
+	switch (colorSpace) {
+	case ColorSpace::rgb:
+		return color.linearRgb();
+	case ColorSpace::hsl:
+		return color.rgbToHsl();
+	case ColorSpace::hsv:
+		return color.rgbToHsv();
+	case ColorSpace::cmyk:
+		return color.rgbToCmyk();
+	case ColorSpace::lab:
+		return color.rgbToLabD50();
+	case ColorSpace::lch:
+		return color.rgbToLchD50();
+	}
+	return color;
+}
+static float channelValue(const ChannelDescription &channel, const Color &color) {
+	if (channel.useConvertTo())
+		return channel.convertTo(color);
+	return (convert(color, channel.colorSpace).data[channel.index] - channel.min) / (channel.max - channel.min);
+}
+template<typename Callback>
+void parallelFor(size_t count, size_t threads, Callback &&callback) {
+	constexpr size_t minChunkSize = 16384;
+	threads = std::max<size_t>(1, std::min(threads, count / minChunkSize));
+	if (threads == 1) {
+		callback(0, count);
+		return;
+	}
+	size_t chunkSize = (count + threads - 1) / threads;
+	std::vector<std::thread> workers;
+	workers.reserve(threads);
+	for (size_t i = 0; i < threads; i++) {
+		size_t begin = std::min(count, i * chunkSize), end = std::min(count, begin + chunkSize);
+		workers.emplace_back([&callback, begin, end]() {
+			callback(begin, end);
+		});
+	}
+	for (auto &worker: workers)
+		worker.join();
+}
+}
+common::Span<const ChannelDescription> sortChannels() {
+	return common::Span(sortChannelDescriptions, sizeof(sortChannelDescriptions) / sizeof(sortChannelDescriptions[0]));
+}
+const ChannelDescription *findSortChannel(std::string_view id) {
+	for (const auto &channel: channels()) {
+		if (channel.id == id)
+			return &channel;
+	}
+	for (const auto &channel: sortChannels()) {
+		if (channel.id == id)
+			return &channel;
+	}
+	return nullptr;
+}
+ColorSorter::ColorSorter(const ColorList &colors, size_t threads):
+	ColorSorter(std::vector<ColorObject *>(colors.begin(), colors.end()), threads) {
+}
+ColorSorter::ColorSorter(std::vector<ColorObject *> colors, size_t threads):
+	m_colors(std::move(colors)),
+	m_threads(threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads) {
+}
+ColorSorter::~ColorSorter() {
+}
+size_t ColorSorter::size() const {
+	return m_colors.size();
+}
+const std::vector<float> &ColorSorter::values(const ChannelDescription &channel) {
+	auto &values = m_values[&channel];
+	if (values.size() == m_colors.size())
+		return values;
+	values.resize(m_colors.size());
+	parallelFor(m_colors.size(), m_threads, [this, &channel, &values](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+			values[i] = channelValue(channel, m_colors[i]->getColor());
+	});
+	return values;
+}
+const math::BinaryTreeQuantization<float> &ColorSorter::groupTree(const ChannelDescription &channel) {
+	auto &tree = m_groupTrees[&channel];
+	if (tree)
+		return *tree;
+	tree = std::make_unique<math::BinaryTreeQuantization<float>>();
+	for (float value: values(channel))
+		tree->add(value);
+	return *tree;
+}
+const std::vector<uint32_t> &ColorSorter::nameRanks() {
+	if (m_nameRanks.size() == m_colors.size())
+		return m_nameRanks;
+	std::vector<uint32_t> indexes(m_colors.size());
+	std::iota(indexes.begin(), indexes.end(), 0);
+	std::stable_sort(indexes.begin(), indexes.end(), [this](uint32_t a, uint32_t b) {
+		return m_colors[a]->getName() < m_colors[b]->getName();
+	});
+	m_nameRanks.resize(m_colors.size());
+	uint32_t rank = 0;
+	for (size_t i = 0; i < indexes.size(); i++) {
+		if (i > 0 && m_colors[indexes[i - 1]]->getName() != m_colors[indexes[i]]->getName())
+			rank++;
+		m_nameRanks[indexes[i]] = rank;
+	}
+	return m_nameRanks;
+}
+template<typename Key>
+void ColorSorter::sortBy(Key &&key) {
+	m_keys.resize(m_order.size());
+	parallelFor(m_order.size(), m_threads, [this, &key](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+			m_keys[i] = key(m_order[i]);
+	});
+	math::radixSort(m_keys, m_order, m_threads);
+}
+const std::vector<uint32_t> &ColorSorter::sort(const Options &options) {
+	m_order.resize(m_colors.size());
+	std::iota(m_order.begin(), m_order.end(), 0);
+	if (m_colors.empty())
+		return m_order;
+	// Each pass is stable, so keys are sorted from the least significant to the most significant one.
+	if (options.tieBreakByName) {
+		const auto &ranks = nameRanks();
+		sortBy([&ranks](uint32_t index) {
+			return ranks[index];
+		});
+	}
+	if (options.sortChannel) {
+		const auto &sortValues = values(*options.sortChannel);
+		uint32_t mask = options.reverse ? ~0u : 0u;
+		sortBy([&sortValues, mask](uint32_t index) {
+			return math::sortableKey(sortValues[index]) ^ mask;
+		});
+	}
+	if (options.groupChannel && options.maxGroups > 1) {
+		const auto &groupValues = values(*options.groupChannel);
+		math::BinaryTreeQuantization<float> tree(groupTree(*options.groupChannel));
+		tree.reduce(options.maxGroups);
+		tree.reduceByMinDistance(options.groupSensitivity);
+		uint32_t mask = options.reverseGroups ? ~0u : 0u;
+		sortBy([&groupValues, &tree, mask](uint32_t index) {
+			return math::sortableKey(tree.find(groupValues[index])) ^ mask;
+		});
+	}
+	return m_order;
+}
+void ColorSorter::sort(const Options &options, ColorList &colorList) {
+	const auto &order = sort(options);
+	std::vector<ColorObject *> colors;
+	colors.reserve(order.size());
+	for (auto index: order)
+		colors.push_back(m_colors[index]);
+	colorList.replaceAll(common::Span<ColorObject *const>(colors.data(), colors.size()));
+}
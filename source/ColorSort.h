@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include "Channels.h"
+#include "math/BinaryTreeQuantization.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string_view>
+#include <vector>
+struct ColorObject;
+struct ColorList;
+/**
+ * Get channels which are only used for sorting, in addition to channels().
+ * @return Sorting channels.
+ */
+common::Span<const ChannelDescription> sortChannels();
+/**
+ * Find channel by id in channels() and sortChannels().
+ * @param[in] id Channel id.
+ * @return Channel or nullptr if id is unknown.
+ */
+const ChannelDescription *findSortChannel(std::string_view id);
+/** \struct ColorSorter
+ * \brief Group and sort color objects by channel values.
+ *
+ * Channel values are extracted into packed arrays once per channel and kept, so sorting the same colors again with different options only quantizes groups and sorts keys.
+ * Keys are sorted by stable radix sort: first by name (if enabled), then by sort channel and then by group.
+ */
+struct ColorSorter {
+	struct Options {
+		/** Channel to sort by. */
+		const ChannelDescription *sortChannel = nullptr;
+		/** Channel to group by or nullptr when colors are not grouped. */
+		const ChannelDescription *groupChannel = nullptr;
+		/** Maximum number of groups. */
+		size_t maxGroups = 10;
+		/** Minimum distance between groups in channel value range [0, 1]. */
+		float groupSensitivity = 0.5f;
+		bool reverse = false;
+		bool reverseGroups = false;
+		/** Order colors with equal values by name. */
+		bool tieBreakByName = false;
+	};
+	/**
+	 * @param[in] colors Colors to sort. Color objects must stay alive and unchanged while sorter is used.
+	 * @param[in] threads Number of threads. Zero selects the number of hardware threads.
+	 */
+	ColorSorter(const ColorList &colors, size_t threads = 0);
+	ColorSorter(std::vector<ColorObject *> colors, size_t threads = 0);
+	~ColorSorter();
+	/**
+	 * Sort colors.
+	 * @param[in] options Sort options.
+	 * @return Indexes of colors in sorted order.
+	 */
+	const std::vector<uint32_t> &sort(const Options &options);
+	/**
+	 * Sort colors and replace color list contents with them.
+	 * @param[in] options Sort options.
+	 * @param[out] colorList Color list to fill with sorted colors.
+	 */
+	void sort(const Options &options, ColorList &colorList);
+	size_t size() const;
+private:
+	std::vector<ColorObject *> m_colors;
+	size_t m_threads;
+	std::map<const ChannelDescription *, std::vector<float>> m_values;
+	std::map<const ChannelDescription *, std::unique_ptr<math::BinaryTreeQuantization<float>>> m_groupTrees;
+	std::vector<uint32_t> m_nameRanks, m_order, m_keys;
+	const std::vector<float> &values(const ChannelDescription &channel);
+	const math::BinaryTreeQuantization<float> &groupTree(const ChannelDescription &channel);
+	const std::vector<uint32_t> &nameRanks();
+	template<typename Key>
+	void sortBy(Key &&key);
+};
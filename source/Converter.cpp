@@ -19,18 +19,31 @@
 #include "Converter.h"
 #include "GlobalState.h"
 #include "ColorObject.h"
+#include "ColorList.h"
 #include "lua/Color.h"
 #include "lua/ColorObject.h"
 #include "lua/Script.h"
 #include "lua/Lua.h"
 #include <string>
 #include <iostream>
+#include <algorithm>
 Converter::Options Converter::emptyOptions = {};
 Converter::Converter(const char *name, const char *label, lua::Ref &&serialize, lua::Ref &&deserialize):
 	m_name(name),
 	m_label(label),
 	m_serialize(std::move(serialize)),
 	m_deserialize(std::move(deserialize)),
+	m_requiredFeatures(ConverterInputFeatures::none),
+	m_copy(false),
+	m_paste(false) {
+}
+Converter::Converter(const char *name, const char *label, lua::Ref &&serialize, lua::Ref &&deserialize, lua::Ref &&serializeBatch):
+	m_name(name),
+	m_label(label),
+	m_serialize(std::move(serialize)),
+	m_deserialize(std::move(deserialize)),
+	m_serializeBatch(std::move(serializeBatch)),
+	m_requiredFeatures(ConverterInputFeatures::none),
 	m_copy(false),
 	m_paste(false) {
 }
@@ -39,14 +52,51 @@ Converter::Converter(const char *name, const char *label, Callback<Serialize> se
 	m_label(label),
 	m_serializeCallback(serialize),
 	m_deserializeCallback(deserialize),
+	m_requiredFeatures(ConverterInputFeatures::none),
 	m_copy(false),
 	m_paste(false) {
 }
-std::string Converter::serialize(const ColorObject &colorObject, const ConverterSerializePosition &position) {
-	if (m_serializeCallback)
-		return m_serializeCallback(colorObject, position);
-	if (!m_serialize.valid())
-		return "";
+namespace {
+std::string cacheKey(const ColorObject &colorObject, const ConverterSerializePosition &position) {
+	const Color &color = colorObject.getColor();
+	const float values[4] = { color.red, color.green, color.blue, color.alpha };
+	const uint64_t positionValues[2] = { position.index(), position.count() };
+	const auto &name = colorObject.getName();
+	std::string key;
+	key.reserve(sizeof(values) + sizeof(positionValues) + 1 + name.length());
+	key.append(reinterpret_cast<const char *>(values), sizeof(values));
+	key.append(reinterpret_cast<const char *>(positionValues), sizeof(positionValues));
+	key += static_cast<char>((position.first() ? 1 : 0) | (position.last() ? 2 : 0));
+	key += name;
+	return key;
+}
+}
+void Converter::serialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output) {
+	if (m_serializeCallback) {
+		m_serializeCallback(colorObject, position, output);
+		return;
+	}
+	if (!m_serialize.valid() && !m_serializeBatch.valid())
+		return;
+	auto key = cacheKey(colorObject, position);
+	if (auto value = cacheFind(key)) {
+		output += *value;
+		return;
+	}
+	std::string result;
+	bool success;
+	if (m_serialize.valid()) {
+		success = serializeLua(colorObject, position, result);
+	} else {
+		const ColorObject *colorObjects[] = { &colorObject };
+		size_t index = position.index();
+		success = serializeLuaBatch(colorObjects, &index, 1, position.count(), &result);
+	}
+	if (success)
+		cacheStore(std::move(key), result);
+	output += result;
+}
+bool Converter::serializeLua(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output) {
 	lua_State *L = m_serialize.script();
 	int stackTop = lua_gettop(L);
 	m_serialize.get();
@@ -62,11 +112,13 @@ std::string Converter::serialize(const ColorObject &colorObject, const Converter
 	lua_pushinteger(L, position.count());
 	lua_setfield(L, -2, "count");
 	int status = lua_pcall(L, 2, 1, 0);
+	bool success = false;
 	if (status == 0) {
 		if (lua_type(L, -1) == LUA_TSTRING) {
-			std::string result = luaL_checkstring(L, -1);
-			lua_settop(L, stackTop);
-			return result;
+			size_t length;
+			const char *result = lua_tolstring(L, -1, &length);
+			output.assign(result, length);
+			success = true;
 		} else {
 			std::cerr << "serialize: returned not a string value \"" << m_name << "\"\n";
 		}
@@ -74,7 +126,130 @@ std::string Converter::serialize(const ColorObject &colorObject, const Converter
 		std::cerr << "serialize: " << lua_tostring(L, -1) << '\n';
 	}
 	lua_settop(L, stackTop);
-	return "";
+	return success;
+}
+bool Converter::serializeLuaBatch(const ColorObject *const *colorObjects, const size_t *indexes, size_t count, size_t totalCount, std::string *outputs) {
+	lua_State *L = m_serializeBatch.script();
+	int stackTop = lua_gettop(L);
+	std::vector<ColorObject> copies;
+	copies.reserve(count);
+	for (size_t i = 0; i < count; i++)
+		copies.push_back(*colorObjects[i]);
+	m_serializeBatch.get();
+	lua_createtable(L, static_cast<int>(count), 0);
+	for (size_t i = 0; i < count; i++) {
+		lua::pushColorObject(L, &copies[i]);
+		lua_rawseti(L, -2, static_cast<int>(i + 1));
+	}
+	lua_createtable(L, static_cast<int>(count), 0);
+	for (size_t i = 0; i < count; i++) {
+		lua_pushinteger(L, indexes[i]);
+		lua_rawseti(L, -2, static_cast<int>(i + 1));
+	}
+	lua_pushinteger(L, totalCount);
+	int status = lua_pcall(L, 3, 1, 0);
+	bool success = false;
+	if (status == 0) {
+		if (lua_type(L, -1) == LUA_TTABLE) {
+			success = true;
+			for (size_t i = 0; i < count && success; i++) {
+				lua_rawgeti(L, -1, static_cast<int>(i + 1));
+				if (lua_type(L, -1) == LUA_TSTRING) {
+					size_t length;
+					const char *result = lua_tolstring(L, -1, &length);
+					outputs[i].assign(result, length);
+				} else {
+					std::cerr << "serialize batch: returned table without string value at index " << i + 1 << " \"" << m_name << "\"\n";
+					success = false;
+				}
+				lua_pop(L, 1);
+			}
+		} else {
+			std::cerr << "serialize batch: returned not a table value \"" << m_name << "\"\n";
+		}
+	} else {
+		std::cerr << "serialize batch: " << lua_tostring(L, -1) << '\n';
+	}
+	lua_settop(L, stackTop);
+	return success;
+}
+const std::string *Converter::cacheFind(const std::string &key) {
+	auto i = m_cache.find(key);
+	if (i == m_cache.end())
+		return nullptr;
+	m_cacheEntries.splice(m_cacheEntries.begin(), m_cacheEntries, i->second);
+	return &i->second->second;
+}
+void Converter::cacheStore(std::string &&key, const std::string &value) {
+	if (m_cache.find(key) != m_cache.end())
+		return;
+	if (m_cacheEntries.size() >= cacheSize) {
+		m_cache.erase(m_cacheEntries.back().first);
+		m_cacheEntries.pop_back();
+	}
+	m_cacheEntries.emplace_front(std::move(key), value);
+	m_cache.emplace(m_cacheEntries.front().first, m_cacheEntries.begin());
+}
+void Converter::clearCache() {
+	m_cache.clear();
+	m_cacheEntries.clear();
+}
+std::string Converter::serialize(const ColorObject &colorObject, const ConverterSerializePosition &position) {
+	std::string result;
+	serialize(colorObject, position, result);
+	return result;
+}
+void Converter::serialize(const ColorList &colorList, std::string &output, const char *separator, bool includeNames) {
+	size_t count = colorList.size();
+	std::vector<const ColorObject *> colorObjects(colorList.begin(), colorList.end());
+	std::vector<std::string> results;
+	if (!m_serializeCallback && m_serializeBatch.valid()) {
+		// Serialize colors missing from cache in batches, so Lua is entered once per batch instead of once per color.
+		results.resize(count);
+		std::vector<const ColorObject *> missingColorObjects;
+		std::vector<size_t> missingIndexes;
+		std::vector<std::string> missingKeys, missingResults;
+		for (size_t begin = 0; begin < count; begin += batchSize) {
+			size_t end = std::min(begin + batchSize, count);
+			missingColorObjects.clear();
+			missingIndexes.clear();
+			missingKeys.clear();
+			for (size_t i = begin; i < end; i++) {
+				auto key = cacheKey(*colorObjects[i], ConverterSerializePosition(i, count));
+				if (auto value = cacheFind(key)) {
+					results[i] = *value;
+					continue;
+				}
+				missingColorObjects.push_back(colorObjects[i]);
+				missingIndexes.push_back(i);
+				missingKeys.push_back(std::move(key));
+			}
+			if (missingColorObjects.empty())
+				continue;
+			missingResults.assign(missingColorObjects.size(), std::string());
+			if (serializeLuaBatch(missingColorObjects.data(), missingIndexes.data(), missingColorObjects.size(), count, missingResults.data())) {
+				for (size_t j = 0; j < missingResults.size(); j++) {
+					cacheStore(std::move(missingKeys[j]), missingResults[j]);
+					results[missingIndexes[j]] = std::move(missingResults[j]);
+				}
+			} else if (m_serialize.valid()) {
+				for (size_t j = 0; j < missingIndexes.size(); j++)
+					serialize(*missingColorObjects[j], ConverterSerializePosition(missingIndexes[j], count), results[missingIndexes[j]]);
+			}
+		}
+	}
+	for (size_t i = 0; i < count; i++) {
+		if (i != 0)
+			output += separator;
+		if (results.empty())
+			serialize(*colorObjects[i], ConverterSerializePosition(i, count), output);
+		else
+			output += results[i];
+		if (includeNames) {
+			output += ' ';
+			output += colorObjects[i]->getName();
+		}
+	}
 }
 bool Converter::deserialize(const char *value, ColorObject &colorObject, float &quality) {
 	if (m_deserializeCallback)
@@ -101,6 +276,17 @@ bool Converter::deserialize(const char *value, ColorObject &colorObject, float &
 	lua_settop(L, stackTop);
 	return false;
 }
+bool Converter::deserialize(const ConverterInput &input, ColorObject &colorObject, float &quality) {
+	if (!input.has(m_requiredFeatures))
+		return false;
+	return deserialize(input.value(), colorObject, quality);
+}
+void Converter::requiredFeatures(ConverterInputFeatures features) {
+	m_requiredFeatures = features;
+}
+ConverterInputFeatures Converter::requiredFeatures() const {
+	return m_requiredFeatures;
+}
 std::string Converter::serialize(const ColorObject &colorObject) {
 	ConverterSerializePosition position;
 	return serialize(colorObject, position);
@@ -117,7 +303,7 @@ const std::string &Converter::label() const {
 	return m_label;
 }
 bool Converter::hasSerialize() const {
-	return m_serialize.valid() || m_serializeCallback;
+	return m_serialize.valid() || m_serializeBatch.valid() || m_serializeCallback;
 }
 bool Converter::hasDeserialize() const {
 	return m_deserialize.valid() || m_deserializeCallback;
@@ -146,6 +332,12 @@ ConverterSerializePosition::ConverterSerializePosition(size_t count):
 	m_index(0),
 	m_count(count) {
 }
+ConverterSerializePosition::ConverterSerializePosition(size_t index, size_t count):
+	m_first(index == 0),
+	m_last(index + 1 >= count),
+	m_index(index),
+	m_count(count) {
+}
 bool ConverterSerializePosition::first() const {
 	return m_first;
 }
@@ -167,3 +359,40 @@ void ConverterSerializePosition::first(bool value) {
 void ConverterSerializePosition::last(bool value) {
 	m_last = value;
 }
+ConverterInput::ConverterInput(const char *value):
+	m_value(value),
+	m_features(ConverterInputFeatures::none) {
+	std::string_view text(value);
+	for (size_t i = 0; i < text.length(); i++) {
+		char c = text[i];
+		if (c >= '0' && c <= '9') {
+			m_features = m_features | ConverterInputFeatures::digit | ConverterInputFeatures::hexDigit;
+		} else if ((c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F')) {
+			m_features = m_features | ConverterInputFeatures::hexDigit;
+		} else if (c == '#') {
+			m_features = m_features | ConverterInputFeatures::hash;
+		} else if (c == '(') {
+			auto prefix = text.substr(0, i);
+			auto endsWith = [prefix](std::string_view name) {
+				return prefix.length() >= name.length() && prefix.substr(prefix.length() - name.length()) == name;
+			};
+			if (endsWith("rgb"))
+				m_features = m_features | ConverterInputFeatures::rgbFunction;
+			else if (endsWith("rgba"))
+				m_features = m_features | ConverterInputFeatures::rgbaFunction;
+			else if (endsWith("hsl"))
+				m_features = m_features | ConverterInputFeatures::hslFunction;
+			else if (endsWith("hsla"))
+				m_features = m_features | ConverterInputFeatures::hslaFunction;
+		}
+	}
+}
+const char *ConverterInput::value() const {
+	return m_value;
+}
+ConverterInputFeatures ConverterInput::features() const {
+	return m_features;
+}
+bool ConverterInput::has(ConverterInputFeatures features) const {
+	return (m_features & features) == features;
+}
@@ -19,14 +19,20 @@
 #ifndef GPICK_CONVERTER_H_
 #define GPICK_CONVERTER_H_
 #include "lua/Ref.h"
-#include "common/Scoped.h"
+#include "common/Bitmask.h"
+#include <cstdint>
 #include <string>
-#include <locale>
+#include <string_view>
+#include <list>
+#include <unordered_map>
+#include <vector>
 struct ColorObject;
+struct ColorList;
 struct Color;
 struct ConverterSerializePosition {
 	ConverterSerializePosition();
 	ConverterSerializePosition(size_t count);
+	ConverterSerializePosition(size_t index, size_t count);
 	bool first() const;
 	bool last() const;
 	size_t index() const;
@@ -38,6 +44,44 @@ private:
 	bool m_first, m_last;
 	size_t m_index, m_count;
 };
+/** \enum ConverterInputFeatures
+ * \brief Text features which must be present for a converter to be able to deserialize the text.
+ */
+enum struct ConverterInputFeatures: uint32_t {
+	none = 0,
+	/** Hash symbol. */
+	hash = 1,
+	/** Hexadecimal digit. */
+	hexDigit = 2,
+	/** Decimal digit. */
+	digit = 4,
+	/** "rgb(" function. */
+	rgbFunction = 8,
+	/** "rgba(" function. */
+	rgbaFunction = 16,
+	/** "hsl(" function. */
+	hslFunction = 32,
+	/** "hsla(" function. */
+	hslaFunction = 64,
+};
+ENABLE_BITMASK_OPERATORS(ConverterInputFeatures);
+/** \struct ConverterInput
+ * \brief Text prepared for deserialization by multiple converters. Text is scanned once and converters requiring features missing from the text are skipped.
+ */
+struct ConverterInput {
+	ConverterInput(const char *value);
+	const char *value() const;
+	ConverterInputFeatures features() const;
+	/**
+	 * Check if text contains all features.
+	 * @param[in] features Required features.
+	 * @return True if all features are present.
+	 */
+	bool has(ConverterInputFeatures features) const;
+private:
+	const char *m_value;
+	ConverterInputFeatures m_features;
+};
 struct Converter {
 	struct Options {
 		bool upperCaseHex;
@@ -57,8 +101,6 @@ struct Converter {
 		}
 		template<typename... Args>
 		auto operator()(Args &... args) const {
-			auto locale = std::setlocale(LC_NUMERIC, "C");
-			common::Scoped resetLocale(std::setlocale, LC_NUMERIC, locale);
 			return m_callback(args..., m_options);
 		}
 		explicit operator bool() const {
@@ -68,10 +110,23 @@ struct Converter {
 		T m_callback;
 		const Options &m_options;
 	};
-	using Serialize = std::string (*)(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options);
+	/**
+	 * Serialization callback. Callbacks append text to the output without clearing it and must not depend on the current locale.
+	 */
+	using Serialize = void (*)(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options);
 	using Deserialize = bool (*)(const char *value, ColorObject &colorObject, float &quality, const Options &options);
 	Converter(const char *name, const char *label, Callback<Serialize> serialize, Callback<Deserialize> deserialize);
 	Converter(const char *name, const char *label, lua::Ref &&serialize, lua::Ref &&deserialize);
+	/**
+	 * Create Lua converter with batch serialization function.
+	 * Batch function is called with array of color objects, array of their position indexes and total color object count, and must return array of strings.
+	 * @param[in] name Converter name.
+	 * @param[in] label Converter label.
+	 * @param[in] serialize Serialization function. Can be invalid if batch function is valid.
+	 * @param[in] deserialize Deserialization function.
+	 * @param[in] serializeBatch Batch serialization function.
+	 */
+	Converter(const char *name, const char *label, lua::Ref &&serialize, lua::Ref &&deserialize, lua::Ref &&serializeBatch);
 	const std::string &name() const;
 	const std::string &label() const;
 	bool hasSerialize() const;
@@ -81,15 +136,60 @@ struct Converter {
 	void copy(bool value);
 	void paste(bool value);
 	std::string serialize(const ColorObject &colorObject, const ConverterSerializePosition &position);
+	/**
+	 * Serialize color object and append result to the output.
+	 * @param[in] colorObject Color object.
+	 * @param[in] position Position of color object in a list of serialized color objects.
+	 * @param[out] output Output text.
+	 */
+	void serialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output);
+	/**
+	 * Serialize all color objects in a list and append results to the output.
+	 * @param[in] colorList Color objects.
+	 * @param[out] output Output text.
+	 * @param[in] separator Text added between serialized color objects.
+	 * @param[in] includeNames Add space and color object name after each serialized color object.
+	 */
+	void serialize(const ColorList &colorList, std::string &output, const char *separator = "\n", bool includeNames = false);
 	std::string serialize(const ColorObject &colorObject);
 	std::string serialize(const Color &color);
 	bool deserialize(const char *value, ColorObject &colorObject, float &quality);
+	/**
+	 * Deserialize prepared text. Converters with required features missing from the text fail without running deserialization callback.
+	 * @param[in] input Prepared text.
+	 * @param[out] colorObject Deserialized color object.
+	 * @param[out] quality Match quality in range [0, 1].
+	 * @return True on success.
+	 */
+	bool deserialize(const ConverterInput &input, ColorObject &colorObject, float &quality);
+	/**
+	 * Set text features required for deserialization. Converters without required features are used for all texts.
+	 * @param[in] features Required features.
+	 */
+	void requiredFeatures(ConverterInputFeatures features);
+	ConverterInputFeatures requiredFeatures() const;
+	/**
+	 * Remove remembered Lua serialization results. Must be called when Lua converter output can change for the same color object, for example after options change.
+	 */
+	void clearCache();
+	/** Maximum number of remembered Lua serialization results. */
+	static constexpr size_t cacheSize = 1024;
+	/** Maximum number of color objects passed to Lua batch serialization function in one call. */
+	static constexpr size_t batchSize = 256;
 private:
 	std::string m_name;
 	std::string m_label;
-	lua::Ref m_serialize, m_deserialize;
+	lua::Ref m_serialize, m_deserialize, m_serializeBatch;
+	using CacheEntries = std::list<std::pair<std::string, std::string>>;
+	CacheEntries m_cacheEntries;
+	std::unordered_map<std::string_view, CacheEntries::iterator> m_cache;
 	Callback<Serialize> m_serializeCallback;
 	Callback<Deserialize> m_deserializeCallback;
+	ConverterInputFeatures m_requiredFeatures;
 	bool m_copy, m_paste;
+	bool serializeLua(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output);
+	bool serializeLuaBatch(const ColorObject *const *colorObjects, const size_t *indexes, size_t count, size_t totalCount, std::string *outputs);
+	const std::string *cacheFind(const std::string &key);
+	void cacheStore(std::string &&key, const std::string &value);
 };
 #endif /* GPICK_CONVERTER_H_ */
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ConverterOptions.h"
+#include "Converters.h"
+#include "dynv/Map.h"
+ConverterOptions::ConverterOptions(const dynv::Map &settings, Converters &converters):
+	m_settings(settings),
+	m_converters(converters) {
+}
+ConverterOptions::~ConverterOptions() {
+}
+void ConverterOptions::update() {
+	auto options = m_settings.getMap("gpick.options");
+	upperCaseHex = options->getString("hex_case", "upper") == "upper";
+	cssPercentages = options->getBool("css_percentages", false);
+	cssAlphaPercentage = options->getBool("css_alpha_percentage", false);
+}
+void ConverterOptions::onEvent(EventType eventType) {
+	switch (eventType) {
+	case EventType::optionsUpdate:
+		update();
+		m_converters.clearCache();
+		break;
+	case EventType::convertersUpdate:
+		m_converters.clearCache();
+		break;
+	case EventType::displayFiltersUpdate:
+	case EventType::colorDictionaryUpdate:
+	case EventType::paletteChanged:
+		break;
+	}
+}
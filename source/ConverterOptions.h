@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include "Converter.h"
+#include "EventBus.h"
+namespace dynv {
+struct Map;
+}
+struct Converters;
+/** \struct ConverterOptions
+ * \brief Converter options read from application settings.
+ *
+ * Options are read again on options update. Lua converter output can depend on options and on converter scripts, so remembered Lua serialization results of all converters are removed on options and converters updates.
+ */
+struct ConverterOptions: public Converter::Options, public IEventHandler {
+	/**
+	 * @param[in] settings Application settings. Must stay valid while converter options exist.
+	 * @param[in] converters Converters which remembered results are removed on updates.
+	 */
+	ConverterOptions(const dynv::Map &settings, Converters &converters);
+	virtual ~ConverterOptions();
+	/**
+	 * Read options from settings.
+	 */
+	void update();
+	virtual void onEvent(EventType eventType) override;
+private:
+	const dynv::Map &m_settings;
+	Converters &m_converters;
+};
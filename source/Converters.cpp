@@ -19,9 +19,12 @@
 #include "Converters.h"
 #include "Converter.h"
 #include "ColorObject.h"
+#include "ColorList.h"
 #include "common/First.h"
 #include <unordered_set>
-Converters::Converters() {
+Converters::Converters():
+	m_displayConverter(nullptr),
+	m_colorListConverter(nullptr) {
 }
 Converters::~Converters() {
 	for (auto converter: m_allConverters) {
@@ -40,11 +43,13 @@ void Converters::add(Converter *converter) {
 		m_pasteConverters.push_back(converter);
 	m_converters[converter->name()] = converter;
 }
-void Converters::add(const char *name, const char *label, Converter::Callback<Converter::Serialize> serialize, Converter::Callback<Converter::Deserialize> deserialize) {
-	add(new Converter(name, label, serialize, deserialize));
+void Converters::add(const char *name, const char *label, Converter::Callback<Converter::Serialize> serialize, Converter::Callback<Converter::Deserialize> deserialize, ConverterInputFeatures requiredFeatures) {
+	auto converter = new Converter(name, label, serialize, deserialize);
+	converter->requiredFeatures(requiredFeatures);
+	add(converter);
 }
-void Converters::add(const char *name, const std::string &label, Converter::Callback<Converter::Serialize> serialize, Converter::Callback<Converter::Deserialize> deserialize) {
-	add(new Converter(name, label.c_str(), serialize, deserialize));
+void Converters::add(const char *name, const std::string &label, Converter::Callback<Converter::Serialize> serialize, Converter::Callback<Converter::Deserialize> deserialize, ConverterInputFeatures requiredFeatures) {
+	add(name, label.c_str(), serialize, deserialize, requiredFeatures);
 }
 void Converters::rebuildCopyPasteArrays() {
 	m_copyConverters.clear();
@@ -56,6 +61,10 @@ void Converters::rebuildCopyPasteArrays() {
 			m_pasteConverters.push_back(converter);
 	}
 }
+void Converters::clearCache() {
+	for (auto converter: m_allConverters)
+		converter->clearCache();
+}
 const std::vector<Converter *> &Converters::all() const {
 	return m_allConverters;
 }
@@ -157,38 +166,52 @@ std::string Converters::serialize(const ColorObject &colorObject, Type type) {
 		return converter->serialize(colorObject);
 	return "";
 }
+void Converters::serialize(const ColorList &colorList, Type type, std::string &output) {
+	Converter *converter = forType(type);
+	if (!converter)
+		converter = firstCopyOrAny();
+	if (converter)
+		converter->serialize(colorList, output);
+}
 std::string Converters::serialize(const Color &color, Type type) {
 	ColorObject colorObject("", color);
 	return serialize(colorObject, type);
 }
 bool Converters::deserialize(const std::string &value, ColorObject &outputColorObject) {
+	ConverterInput input(value.c_str());
 	common::First<float, std::greater<float>, ColorObject> bestConversion;
 	ColorObject colorObject;
 	float quality;
-	if (m_displayConverter) {
-		Converter *converter = m_displayConverter;
-		if (converter->hasDeserialize()) {
-			if (converter->deserialize(value.c_str(), colorObject, quality)) {
-				if (quality > 0) {
-					bestConversion(quality, colorObject);
-				}
-			}
-		}
-	}
-	for (auto &converter: m_pasteConverters) {
-		if (converter == m_displayConverter || !converter->hasDeserialize())
+	auto tryConverter = [&](Converter *converter) {
+		if (!converter->hasDeserialize())
+			return false;
+		if (!converter->deserialize(input, colorObject, quality) || quality <= 0)
+			return false;
+		bestConversion(quality, colorObject);
+		return quality >= 1.0f;
+	};
+	bool done = m_displayConverter && tryConverter(m_displayConverter);
+	for (auto i = m_pasteConverters.begin(); !done && i != m_pasteConverters.end(); ++i) {
+		if (*i == m_displayConverter)
 			continue;
-		if (converter->deserialize(value.c_str(), colorObject, quality)) {
-			if (quality > 0) {
-				bestConversion(quality, colorObject);
-			}
-		}
+		done = tryConverter(*i);
 	}
 	if (!bestConversion)
 		return false;
 	outputColorObject = bestConversion.data<ColorObject>();
 	return true;
 }
+size_t Converters::deserialize(const std::vector<std::string> &values, ColorList &colorList) {
+	size_t count = 0;
+	ColorObject colorObject;
+	for (const auto &value: values) {
+		if (!deserialize(value, colorObject))
+			continue;
+		colorList.add(colorObject);
+		count++;
+	}
+	return count;
+}
 void Converters::reorder(const char **names, size_t count) {
 	std::unordered_set<Converter *> used;
 	std::vector<Converter *> converters;
@@ -23,6 +23,7 @@
 #include <vector>
 #include <string>
 struct ColorObject;
+struct ColorList;
 struct Color;
 struct Converters {
 	enum class Type {
@@ -33,8 +34,8 @@ struct Converters {
 	Converters();
 	~Converters();
 	void add(Converter *converter);
-	void add(const char *name, const char *label, Converter::Callback<Converter::Serialize> serialize, Converter::Callback<Converter::Deserialize> deserialize);
-	void add(const char *name, const std::string &label, Converter::Callback<Converter::Serialize> serialize, Converter::Callback<Converter::Deserialize> deserialize);
+	void add(const char *name, const char *label, Converter::Callback<Converter::Serialize> serialize, Converter::Callback<Converter::Deserialize> deserialize, ConverterInputFeatures requiredFeatures = ConverterInputFeatures::none);
+	void add(const char *name, const std::string &label, Converter::Callback<Converter::Serialize> serialize, Converter::Callback<Converter::Deserialize> deserialize, ConverterInputFeatures requiredFeatures = ConverterInputFeatures::none);
 	const std::vector<Converter *> &all() const;
 	const std::vector<Converter *> &allCopy() const;
 	const std::vector<Converter *> &allPaste() const;
@@ -54,8 +55,33 @@ struct Converters {
 	Converter *byNameOrFirstCopy(const char *name) const;
 	std::string serialize(const ColorObject &colorObject, Type type);
 	std::string serialize(const Color &color, Type type);
+	/**
+	 * Serialize all color objects in a list into one text, separating them by new line characters.
+	 * @param[in] colorList Color objects.
+	 * @param[in] type Converter type. First copy converter or any converter is used if converter of this type is not set.
+	 * @param[out] output Output text. Serialized colors are appended to existing text.
+	 */
+	void serialize(const ColorList &colorList, Type type, std::string &output);
+	/**
+	 * Deserialize text using display converter and all paste converters. Text is scanned once and converters which can not match it are skipped.
+	 * Search stops at the first converter reporting the best possible quality of 1.
+	 * @param[in] value Text.
+	 * @param[out] outputColorObject Color object from converter with the highest quality.
+	 * @return True on success.
+	 */
 	bool deserialize(const std::string &value, ColorObject &outputColorObject);
+	/**
+	 * Deserialize multiple texts and add resulting color objects to a list. Texts which can not be deserialized are skipped.
+	 * @param[in] values Texts.
+	 * @param[out] colorList Color list for deserialized color objects.
+	 * @return Number of color objects added.
+	 */
+	size_t deserialize(const std::vector<std::string> &values, ColorList &colorList);
 	void rebuildCopyPasteArrays();
+	/**
+	 * Remove remembered Lua serialization results from all converters.
+	 */
+	void clearCache();
 	void reorder(const char **names, size_t count);
 	void reorder(const std::vector<std::string> &names);
 	bool hasCopy() const;
@@ -27,6 +27,7 @@ enum class ErrorCode : int {
 	badHeader,
 	badVersion,
 	badFile,
+	cancelled,
 };
 std::ostream &operator<<(std::ostream &stream, const ErrorCode &errorCode);
 #endif /* GPICK_ERROR_CODE_H_ */
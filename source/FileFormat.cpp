@@ -23,11 +23,18 @@
 #include "dynv/Map.h"
 #include "common/Scoped.h"
 #include "common/Result.h"
+#include "common/MappedFile.h"
+#include "common/Span.h"
+#include "common/Lz4.h"
 #include "version/Version.h"
 #include <string.h>
 #include <fstream>
-#include <list>
 #include <algorithm>
+#include <array>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <vector>
 #include <boost/endian/conversion.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 
@@ -36,12 +43,19 @@
 #define CHUNK_TYPE_COLOR_LIST "color_list"
 #define CHUNK_TYPE_COLOR_POSITIONS "color_positions"
 #define CHUNK_TYPE_COLOR_ACTIONS "color_actions"
+#define CHUNK_TYPE_COLOR_COLUMNS "color_columns"
 constexpr uint32_t toVersion(uint16_t major, uint16_t minor) {
 	return (static_cast<uint32_t>(major) << 16) | minor;
 }
 const uint32_t MinSupportedVersion = toVersion(1, 0);
 const uint32_t Version = toVersion(2, 0);
-const uint32_t MaxSupportedVersion = Version | 0xffffu;
+const uint32_t ColumnsVersion = toVersion(3, 0);
+const uint32_t MaxSupportedVersion = ColumnsVersion | 0xffffu;
+// number of colors between progress callback calls
+const size_t ProgressInterval = 256;
+static bool reportProgress(const PaletteProgressCallback &progress, size_t done, size_t total) {
+	return !progress || progress(total > 0 ? std::min(1.0f, static_cast<float>(done) / total) : 0.0f);
+}
 struct ChunkHeader {
 	void prepareWrite(const std::string &type, uint64_t size) {
 		size_t length = type.length();
@@ -72,127 +86,536 @@ private:
 	char m_type[16];
 	uint64_t m_size;
 };
-static bool read(std::istream &stream, ChunkHeader &header) {
-	stream.read(reinterpret_cast<char *>(&header), sizeof(header));
-	header.prepareRead();
-	return stream.good();
-}
-static bool read(std::istream &stream, uint32_t &value) {
-	stream.read(reinterpret_cast<char *>(&value), sizeof(value));
-	value = boost::endian::little_to_native<uint32_t>(value);
-	return stream.good();
+namespace {
+uint32_t loadUint32(const uint8_t *data) {
+	uint32_t value;
+	memcpy(&value, data, sizeof(value));
+	return boost::endian::little_to_native(value);
 }
-static bool read(std::istream &stream, std::string &value) {
-	uint32_t length;
-	if (!read(stream, length))
-		return false;
-	value.resize(length);
-	if (length == 0)
+/** \struct BufferReader
+ * \brief Bounds checked little endian reader over a memory buffer.
+ */
+struct BufferReader {
+	BufferReader(const uint8_t *data, size_t size):
+		m_position(data),
+		m_end(data + size) {
+	}
+	size_t remaining() const {
+		return static_cast<size_t>(m_end - m_position);
+	}
+	const uint8_t *position() const {
+		return m_position;
+	}
+	bool skip(size_t length) {
+		if (remaining() < length)
+			return false;
+		m_position += length;
 		return true;
-	stream.read(reinterpret_cast<char *>(&value.front()), length);
-	return stream.good();
+	}
+	bool read(uint8_t &value) {
+		if (remaining() < 1)
+			return false;
+		value = *m_position++;
+		return true;
+	}
+	bool read(uint32_t &value) {
+		if (remaining() < sizeof(uint32_t))
+			return false;
+		value = loadUint32(m_position);
+		m_position += sizeof(uint32_t);
+		return true;
+	}
+	bool read(std::string_view &value) {
+		uint32_t length;
+		if (!read(length) || remaining() < length)
+			return false;
+		value = std::string_view(reinterpret_cast<const char *>(m_position), length);
+		m_position += length;
+		return true;
+	}
+	bool read(ChunkHeader &header) {
+		if (remaining() < sizeof(ChunkHeader))
+			return false;
+		memcpy(&header, m_position, sizeof(ChunkHeader));
+		m_position += sizeof(ChunkHeader);
+		header.prepareRead();
+		return true;
+	}
+private:
+	const uint8_t *m_position, *m_end;
+};
+float loadFloat(const uint8_t *data) {
+	uint32_t bits = loadUint32(data);
+	float value;
+	static_assert(sizeof(value) == sizeof(bits), "sizeof(float) != 4");
+	memcpy(&value, &bits, sizeof(value));
+	return value;
 }
-common::ResultVoid<ErrorCode> paletteFileLoad(const char* filename, ColorList &colorList) {
+/** \struct ChunkIndex
+ * \brief Locations of palette chunks inside a buffer, collected in a single pass over chunk headers.
+ */
+struct ChunkIndex {
+	uint32_t version;
+	common::Span<const uint8_t> handlerMap, colorList, positions, colorColumns;
+	bool hasHandlerMap, hasColorList, hasPositions, hasColorColumns;
+	ChunkIndex():
+		version(0),
+		hasHandlerMap(false),
+		hasColorList(false),
+		hasPositions(false),
+		hasColorColumns(false) {
+	}
+};
+common::ResultVoid<ErrorCode> indexChunks(const uint8_t *data, size_t size, ChunkIndex &index) {
 	using Result = common::ResultVoid<ErrorCode>;
-	std::ifstream file(filename, std::ios::binary);
-	if (!file.is_open())
-		return Result(ErrorCode::fileCouldNotBeOpened);
+	BufferReader reader(data, size);
 	ChunkHeader header;
-	if (!read(file, header) || !header.valid() || !header.startsWith(CHUNK_TYPE_VERSION))
+	if (!reader.read(header) || !header.valid() || !header.startsWith(CHUNK_TYPE_VERSION))
 		return Result(ErrorCode::readFailed);
 	if (header.size() < 4)
 		return Result(ErrorCode::badHeader);
-	uint32_t version;
-	if (!read(file, version))
+	if (!reader.read(index.version))
 		return Result(ErrorCode::readFailed);
-	if (!(version >= MinSupportedVersion && version <= MaxSupportedVersion))
+	if (!(index.version >= MinSupportedVersion && index.version <= MaxSupportedVersion))
 		return Result(ErrorCode::badVersion);
-	bool noAlphaChannel = version < 0x20000u;
-	file.seekg(header.size() - 4, std::ios::cur);
-	if (!file.good())
+	if (!reader.skip(header.size() - 4))
 		return Result(ErrorCode::readFailed);
-	if (!read(file, header) || !header.valid()) {
-		return file.eof() ? Result() : Result(ErrorCode::readFailed);
-	}
-	std::vector<ColorObject *> colorObjects;
-	common::Scoped releaseColorObjects([&colorObjects]() {
-		for (auto colorObject: colorObjects)
-			if (colorObject)
-				colorObject->release();
-	});
-	std::vector<uint32_t> positions;
-	std::unordered_map<uint8_t, dynv::types::ValueType> typeMap;
-	std::vector<std::string> handlers;
-	bool hasPositions = false;
-	for (;;) {
-		if (header.is(CHUNK_TYPE_HANDLER_MAP)) {
-			uint32_t handlerCount;
-			if (!read(file, handlerCount))
+	while (reader.remaining() > 0) {
+		if (!reader.read(header))
+			break; // trailing partial header is treated as end of file
+		if (!header.valid())
+			return Result(ErrorCode::readFailed);
+		bool known = header.is(CHUNK_TYPE_HANDLER_MAP) || header.is(CHUNK_TYPE_COLOR_LIST) || header.is(CHUNK_TYPE_COLOR_POSITIONS) || header.is(CHUNK_TYPE_COLOR_COLUMNS);
+		if (header.size() > reader.remaining()) {
+			if (known)
 				return Result(ErrorCode::readFailed);
-			if (handlerCount > 255)
-				return Result(ErrorCode::badFile);
-			for (size_t i = 0; i < handlerCount; i++) {
-				std::string typeName;
-				if (!read(file, typeName))
-					return Result(ErrorCode::readFailed);
-				typeMap[static_cast<uint8_t>(handlers.size())] = dynv::types::stringToType(typeName);
-				handlers.push_back(typeName);
-			}
+			break; // unknown chunk extending past end of file is ignored
+		}
+		common::Span<const uint8_t> chunk(reader.position(), static_cast<size_t>(header.size()));
+		if (header.is(CHUNK_TYPE_HANDLER_MAP)) {
+			index.handlerMap = chunk;
+			index.hasHandlerMap = true;
 		} else if (header.is(CHUNK_TYPE_COLOR_LIST)) {
-			std::streamoff end = file.tellg() + static_cast<std::streamoff>(header.size());
-			while (file.tellg() < end) {
-				dynv::Map options;
-				if (!options.deserialize(file, typeMap))
-					return file.good() ? Result(ErrorCode::badFile) : Result(ErrorCode::readFailed);
-				auto color = options.getColor("color", Color());
-				auto name = options.getString("name", "");
-				if (noAlphaChannel)
-					color.alpha = 1.0f;
-				colorObjects.push_back(new ColorObject(name, color));
-			}
+			index.colorList = chunk;
+			index.hasColorList = true;
 		} else if (header.is(CHUNK_TYPE_COLOR_POSITIONS)) {
-			hasPositions = true;
-			positions.resize(header.size() / sizeof(uint32_t));
-			if (!positions.empty())
-				file.read(reinterpret_cast<char *>(&positions.front()), positions.size() * sizeof(uint32_t));
-			if (!file.good())
+			index.positions = chunk;
+			index.hasPositions = true;
+		} else if (header.is(CHUNK_TYPE_COLOR_COLUMNS)) {
+			index.colorColumns = chunk;
+			index.hasColorColumns = true;
+		}
+		reader.skip(chunk.size());
+	}
+	return Result();
+}
+using TypeMap = std::array<dynv::types::ValueType, 256>;
+common::ResultVoid<ErrorCode> readHandlerMap(common::Span<const uint8_t> chunk, TypeMap &typeMap) {
+	using Result = common::ResultVoid<ErrorCode>;
+	BufferReader reader(chunk.data(), chunk.size());
+	uint32_t handlerCount;
+	if (!reader.read(handlerCount))
+		return Result(ErrorCode::readFailed);
+	if (handlerCount > 255)
+		return Result(ErrorCode::badFile);
+	for (uint32_t i = 0; i < handlerCount; i++) {
+		std::string_view typeName;
+		if (!reader.read(typeName))
+			return Result(ErrorCode::readFailed);
+		typeMap[i] = dynv::types::stringToType(std::string(typeName));
+	}
+	return Result();
+}
+/** \struct DecodedColors
+ * \brief Colors and names decoded from color list or color columns chunk.
+ * Names point into source buffer or into decompressed blocks kept in storage.
+ */
+struct DecodedColors {
+	std::vector<Color> colors;
+	std::vector<std::string_view> names;
+	std::vector<std::vector<uint8_t>> storage;
+};
+/**
+ * Decode color list records without building intermediate maps.
+ * Each record is a value count followed by (handler id, value name, value) triples. Only "color" and "name" values are kept, everything else is skipped.
+ */
+common::ResultVoid<ErrorCode> readColorList(common::Span<const uint8_t> chunk, const TypeMap &typeMap, bool noAlphaChannel, DecodedColors &decoded, const PaletteProgressCallback &progress) {
+	using Result = common::ResultVoid<ErrorCode>;
+	using ValueType = dynv::types::ValueType;
+	BufferReader reader(chunk.data(), chunk.size());
+	while (reader.remaining() > 0) {
+		if (decoded.colors.size() % ProgressInterval == 0 && !reportProgress(progress, chunk.size() - reader.remaining(), chunk.size()))
+			return Result(ErrorCode::cancelled);
+		uint32_t count;
+		if (!reader.read(count))
+			return Result(ErrorCode::readFailed);
+		Color color;
+		std::string_view name;
+		for (uint32_t i = 0; i < count; i++) {
+			uint8_t handlerId;
+			std::string_view valueName;
+			if (!reader.read(handlerId) || !reader.read(valueName))
 				return Result(ErrorCode::readFailed);
-			for (auto &position: positions) {
-				position = boost::endian::little_to_native<uint32_t>(position);
-			}
-		} else {
-			file.seekg(header.size(), std::ios::cur);
-			if (file.eof())
+			auto type = typeMap[handlerId];
+			bool ok = true;
+			switch (type) {
+			case ValueType::basicBool:
+				ok = reader.skip(1);
 				break;
-			if (!file.good())
-				return Result(ErrorCode::readFailed);
-		}
-		if (!read(file, header) || !header.valid()) {
-			if (file.eof())
+			case ValueType::basicFloat:
+			case ValueType::basicInt32:
+				ok = reader.skip(4);
 				break;
-			else
+			case ValueType::string: {
+				std::string_view value;
+				ok = reader.read(value);
+				if (ok && valueName == "name")
+					name = value;
+			} break;
+			case ValueType::color: {
+				uint32_t storeLength;
+				ok = reader.read(storeLength) && reader.remaining() >= storeLength;
+				if (!ok)
+					break;
+				if (valueName == "color") {
+					uint8_t buffer[sizeof(float) * 4] = {};
+					memcpy(buffer, reader.position(), std::min<size_t>(storeLength, sizeof(buffer)));
+					for (int j = 0; j < 4; j++)
+						color[j] = loadFloat(buffer + j * sizeof(float));
+				}
+				reader.skip(storeLength);
+			} break;
+			case ValueType::map:
+				return Result(ErrorCode::badFile);
+			case ValueType::unknown: {
+				uint32_t skip;
+				ok = reader.read(skip) && reader.skip(skip);
+			} break;
+			}
+			if (!ok)
 				return Result(ErrorCode::readFailed);
 		}
+		if (noAlphaChannel)
+			color.alpha = 1.0f;
+		decoded.colors.push_back(color);
+		decoded.names.push_back(name);
+	}
+	return Result();
+}
+/**
+ * Build load order from stored positions, so that order[i] is the index of decoded color placed at position i.
+ * Positions written by older versions form a permutation, which is applied directly. Anything else (duplicates, gaps) falls back to a stable sort, keeping file order for equal positions.
+ * Colors without a position are dropped.
+ */
+std::vector<uint32_t> positionsToOrder(common::Span<const uint8_t> chunk, size_t colorCount) {
+	size_t count = std::min(colorCount, chunk.size() / sizeof(uint32_t));
+	std::vector<uint32_t> positions(count), order(count, std::numeric_limits<uint32_t>::max());
+	bool permutation = true;
+	for (size_t i = 0; i < count; i++) {
+		uint32_t position = loadUint32(chunk.data() + i * sizeof(uint32_t));
+		positions[i] = position;
+		if (permutation && position < count && order[position] == std::numeric_limits<uint32_t>::max())
+			order[position] = static_cast<uint32_t>(i);
+		else
+			permutation = false;
+	}
+	if (permutation)
+		return order;
+	for (size_t i = 0; i < count; i++)
+		order[i] = static_cast<uint32_t>(i);
+	std::stable_sort(order.begin(), order.end(), [&positions](uint32_t a, uint32_t b) {
+		return positions[a] < positions[b];
+	});
+	return order;
+}
+/*
+ * Color columns chunk stores colors in independently compressed blocks:
+ *
+ *   header: uint32 color count, uint32 colors per block, uint8 color encoding, uint8 compression, uint16 reserved, uint32 block count
+ *   blocks: color column (RGBA values), (count + 1) uint32 name offsets, name bytes
+ *   index: for each block uint64 offset from chunk start, uint32 stored size, uint32 raw size
+ *   footer: uint64 index offset, uint32 block count, uint32 magic
+ *
+ * Color column of compressed chunks is byte shuffled (all first bytes of values, then all second bytes, ...), which makes float data a lot more compressible.
+ * Blocks which do not get smaller when compressed are stored as is, which is indicated by equal stored and raw sizes.
+ * Footer at a fixed distance from the chunk end allows reading any single block without touching the rest of the chunk.
+ */
+enum struct ColorEncoding : uint8_t {
+	float32 = 0,
+	float16 = 1,
+};
+enum struct BlockCompression : uint8_t {
+	none = 0,
+	lz4 = 1,
+};
+const uint32_t ColumnsFooterMagic = 0x49415047u; // "GPAI"
+const size_t ColumnsHeaderSize = 16, ColumnsIndexEntrySize = 16, ColumnsFooterSize = 16;
+uint16_t loadUint16(const uint8_t *data) {
+	uint16_t value;
+	memcpy(&value, data, sizeof(value));
+	return boost::endian::little_to_native(value);
+}
+uint64_t loadUint64(const uint8_t *data) {
+	uint64_t value;
+	memcpy(&value, data, sizeof(value));
+	return boost::endian::little_to_native(value);
+}
+uint16_t floatToHalf(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+	bits &= 0x7fffffffu;
+	if (bits >= 0x7f800000u) // infinity or NaN
+		return sign | 0x7c00u | (bits > 0x7f800000u ? 0x200u : 0u);
+	if (bits >= 0x477ff000u) // rounds to a value out of half range
+		return sign | 0x7c00u;
+	uint32_t exponent = bits >> 23, mantissa = bits & 0x7fffffu;
+	if (exponent < 113) { // subnormal half or zero
+		if (exponent < 102)
+			return sign;
+		mantissa |= 0x800000u;
+		uint32_t shift = 126 - exponent;
+		uint32_t result = mantissa >> shift, remainder = mantissa & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (result & 1)))
+			result++;
+		return sign | static_cast<uint16_t>(result);
+	}
+	uint32_t result = ((exponent - 112) << 10) | (mantissa >> 13), remainder = mantissa & 0x1fffu;
+	if (remainder > 0x1000u || (remainder == 0x1000u && (result & 1)))
+		result++; // carry into exponent is correct rounding
+	return sign | static_cast<uint16_t>(result);
+}
+float halfToFloat(uint16_t value) {
+	uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16, exponent = (value >> 10) & 0x1fu, mantissa = value & 0x3ffu, bits;
+	if (exponent == 0) {
+		float result = mantissa * (1.0f / 16777216.0f);
+		return sign ? -result : result;
+	} else if (exponent == 31) {
+		bits = sign | 0x7f800000u | (mantissa << 13);
+	} else {
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
 	}
-	if (hasPositions) {
-		std::vector<std::pair<ColorObject *, size_t>> colorObjectsWithPositions;
-		colorObjectsWithPositions.reserve(colorObjects.size());
-		for (size_t i = 0, end = std::min(colorObjects.size(), positions.size()); i < end; i++) {
-			colorObjectsWithPositions.emplace_back(colorObjects[i], positions[i]);
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+size_t colorValueSize(ColorEncoding encoding) {
+	return encoding == ColorEncoding::float16 ? 2 : 4;
+}
+/** \struct ColumnsIndex
+ * \brief Color columns chunk header and block index.
+ */
+struct ColumnsIndex {
+	struct Block {
+		common::Span<const uint8_t> data;
+		uint32_t rawSize, count;
+	};
+	uint32_t colorCount, blockSize;
+	ColorEncoding encoding;
+	BlockCompression compression;
+	std::vector<Block> blocks;
+};
+common::ResultVoid<ErrorCode> readColumnsIndex(common::Span<const uint8_t> chunk, ColumnsIndex &index) {
+	using Result = common::ResultVoid<ErrorCode>;
+	if (chunk.size() < ColumnsHeaderSize + ColumnsFooterSize)
+		return Result(ErrorCode::badFile);
+	const uint8_t *data = chunk.data();
+	index.colorCount = loadUint32(data);
+	index.blockSize = loadUint32(data + 4);
+	uint8_t encoding = data[8], compression = data[9];
+	uint32_t blockCount = loadUint32(data + 12);
+	if (encoding > static_cast<uint8_t>(ColorEncoding::float16) || compression > static_cast<uint8_t>(BlockCompression::lz4) || index.blockSize == 0)
+		return Result(ErrorCode::badFile);
+	index.encoding = static_cast<ColorEncoding>(encoding);
+	index.compression = static_cast<BlockCompression>(compression);
+	if (blockCount != (static_cast<uint64_t>(index.colorCount) + index.blockSize - 1) / index.blockSize)
+		return Result(ErrorCode::badFile);
+	const uint8_t *footer = data + chunk.size() - ColumnsFooterSize;
+	uint64_t indexOffset = loadUint64(footer);
+	if (loadUint32(footer + 12) != ColumnsFooterMagic || loadUint32(footer + 8) != blockCount)
+		return Result(ErrorCode::badFile);
+	uint64_t indexEnd = chunk.size() - ColumnsFooterSize;
+	if (indexOffset < ColumnsHeaderSize || indexOffset > indexEnd || (indexEnd - indexOffset) / ColumnsIndexEntrySize < blockCount)
+		return Result(ErrorCode::badFile);
+	size_t valueSize = colorValueSize(index.encoding);
+	index.blocks.resize(blockCount);
+	for (uint32_t i = 0; i < blockCount; i++) {
+		const uint8_t *entry = data + indexOffset + i * ColumnsIndexEntrySize;
+		uint64_t offset = loadUint64(entry);
+		uint32_t storedSize = loadUint32(entry + 8), rawSize = loadUint32(entry + 12);
+		if (offset < ColumnsHeaderSize || offset > indexOffset || indexOffset - offset < storedSize)
+			return Result(ErrorCode::badFile);
+		auto &block = index.blocks[i];
+		block.count = std::min(index.blockSize, index.colorCount - i * index.blockSize);
+		if (rawSize < static_cast<uint64_t>(block.count) * (valueSize * 4 + 4) + 4)
+			return Result(ErrorCode::badFile);
+		if (storedSize != rawSize && index.compression == BlockCompression::none)
+			return Result(ErrorCode::badFile);
+		if (rawSize > common::lz4::decompressBound(storedSize)) // checked before any allocation, so damaged sizes can not cause huge allocations
+			return Result(ErrorCode::badFile);
+		block.data = common::Span<const uint8_t>(data + offset, storedSize);
+		block.rawSize = rawSize;
+	}
+	return Result();
+}
+/** \struct BlockView
+ * \brief Decoded color columns block. Pointers refer to source buffer or to block storage.
+ */
+struct BlockView {
+	const uint8_t *colors, *offsets, *names;
+	uint32_t count;
+	ColorEncoding encoding;
+	Color color(size_t i) const {
+		Color result;
+		if (encoding == ColorEncoding::float16) {
+			for (int j = 0; j < 4; j++)
+				result[j] = halfToFloat(loadUint16(colors + (i * 4 + j) * 2));
+		} else {
+			for (int j = 0; j < 4; j++)
+				result[j] = loadFloat(colors + (i * 4 + j) * 4);
 		}
-		std::stable_sort(colorObjectsWithPositions.begin(), colorObjectsWithPositions.end(), [](const std::pair<ColorObject *, size_t> &a, const std::pair<ColorObject *, size_t> &b) {
-			return a.second < b.second;
-		});
-		for (auto colorObjectWithPosition: colorObjectsWithPositions) {
-			colorList.add(colorObjectWithPosition.first);
+		return result;
+	}
+	std::string_view name(size_t i) const {
+		uint32_t start = loadUint32(offsets + i * 4), end = loadUint32(offsets + i * 4 + 4);
+		return std::string_view(reinterpret_cast<const char *>(names + start), end - start);
+	}
+};
+/**
+ * Prepare block for reading, decompressing and unshuffling it into storage when needed.
+ * @param[in] index Chunk index.
+ * @param[in] block Block to open.
+ * @param[out] storage Buffer for decoded block data, which must be kept while view is used.
+ * @param[out] view Block view.
+ */
+common::ResultVoid<ErrorCode> openBlock(const ColumnsIndex &index, const ColumnsIndex::Block &block, std::vector<uint8_t> &storage, BlockView &view) {
+	using Result = common::ResultVoid<ErrorCode>;
+	size_t valueSize = colorValueSize(index.encoding);
+	size_t colorsSize = static_cast<size_t>(block.count) * valueSize * 4;
+	const uint8_t *raw = block.data.data();
+	bool shuffled = index.compression != BlockCompression::none;
+	if (shuffled) {
+		storage.resize(block.rawSize + colorsSize);
+		uint8_t *decompressed = storage.data() + colorsSize;
+		if (block.data.size() != block.rawSize) {
+			if (!common::lz4::decompress(block.data.data(), block.data.size(), decompressed, block.rawSize))
+				return Result(ErrorCode::badFile);
+		} else {
+			memcpy(decompressed, block.data.data(), block.rawSize);
 		}
-	} else {
-		for (auto colorObject: colorObjects) {
-			colorList.add(colorObject);
+		size_t valueCount = static_cast<size_t>(block.count) * 4;
+		for (size_t i = 0; i < valueCount; i++) {
+			for (size_t j = 0; j < valueSize; j++)
+				storage[i * valueSize + j] = decompressed[j * valueCount + i];
 		}
+		raw = decompressed;
 	}
-	file.close();
-	return (file.good() || file.eof()) ? Result() : Result(ErrorCode::readFailed);
+	view.colors = shuffled ? storage.data() : raw;
+	view.offsets = raw + colorsSize;
+	view.names = view.offsets + (static_cast<size_t>(block.count) + 1) * 4;
+	view.count = block.count;
+	view.encoding = index.encoding;
+	size_t namesSize = block.rawSize - colorsSize - (static_cast<size_t>(block.count) + 1) * 4;
+	uint32_t previous = 0;
+	for (size_t i = 0; i <= block.count; i++) {
+		uint32_t offset = loadUint32(view.offsets + i * 4);
+		if (offset < previous || offset > namesSize || (i == 0 && offset != 0))
+			return Result(ErrorCode::badFile);
+		previous = offset;
+	}
+	if (previous != namesSize)
+		return Result(ErrorCode::badFile);
+	return Result();
+}
+common::ResultVoid<ErrorCode> readColorColumns(common::Span<const uint8_t> chunk, DecodedColors &decoded, const PaletteProgressCallback &progress) {
+	using Result = common::ResultVoid<ErrorCode>;
+	ColumnsIndex index;
+	auto result = readColumnsIndex(chunk, index);
+	if (!result)
+		return result;
+	// Color count is only limited by block sizes, which can be much larger than the chunk, so reserved size is also limited by chunk size.
+	size_t reserveCount = std::min<size_t>(index.colorCount, chunk.size());
+	decoded.colors.reserve(reserveCount);
+	decoded.names.reserve(reserveCount);
+	for (size_t blockIndex = 0; blockIndex < index.blocks.size(); blockIndex++) {
+		if (!reportProgress(progress, blockIndex, index.blocks.size()))
+			return Result(ErrorCode::cancelled);
+		const auto &block = index.blocks[blockIndex];
+		std::vector<uint8_t> storage;
+		BlockView view;
+		result = openBlock(index, block, storage, view);
+		if (!result)
+			return result;
+		for (size_t i = 0; i < view.count; i++) {
+			decoded.colors.push_back(view.color(i));
+			decoded.names.push_back(view.name(i));
+		}
+		if (!storage.empty())
+			decoded.storage.push_back(std::move(storage)); // keep names alive, moving vector does not move its data
+	}
+	return Result();
+}
+common::ResultVoid<ErrorCode> decodeColors(const ChunkIndex &index, DecodedColors &decoded, const PaletteProgressCallback &progress) {
+	using Result = common::ResultVoid<ErrorCode>;
+	if (index.hasColorColumns)
+		return readColorColumns(index.colorColumns, decoded, progress);
+	if (!index.hasColorList)
+		return Result();
+	bool noAlphaChannel = index.version < 0x20000u;
+	TypeMap typeMap;
+	typeMap.fill(dynv::types::ValueType::unknown);
+	if (index.hasHandlerMap) {
+		auto result = readHandlerMap(index.handlerMap, typeMap);
+		if (!result)
+			return result;
+	}
+	return readColorList(index.colorList, typeMap, noAlphaChannel, decoded, progress);
+}
+}
+common::ResultVoid<ErrorCode> paletteBufferLoad(const uint8_t *data, size_t size, ColorList &colorList, const PaletteProgressCallback &progress) {
+	using Result = common::ResultVoid<ErrorCode>;
+	if (!data && size > 0)
+		return Result(ErrorCode::invalidArguments);
+	ChunkIndex index;
+	auto result = indexChunks(data, size, index);
+	if (!result)
+		return result;
+	DecodedColors decoded;
+	result = decodeColors(index, decoded, progress);
+	if (!result)
+		return result;
+	if (!reportProgress(progress, 1, 1))
+		return Result(ErrorCode::cancelled);
+	std::vector<ColorObject *> colorObjects;
+	common::Scoped releaseColorObjects([&colorObjects]() {
+		for (auto colorObject: colorObjects)
+			colorObject->release();
+	});
+	if (index.hasPositions) {
+		auto order = positionsToOrder(index.positions, decoded.colors.size());
+		colorObjects.reserve(order.size());
+		for (auto i: order)
+			colorObjects.push_back(new ColorObject(decoded.names[i], decoded.colors[i]));
+	} else {
+		colorObjects.reserve(decoded.colors.size());
+		for (size_t i = 0; i < decoded.colors.size(); i++)
+			colorObjects.push_back(new ColorObject(decoded.names[i], decoded.colors[i]));
+	}
+	colorList.addRange(common::Span<ColorObject *const>(colorObjects.data(), colorObjects.size()));
+	return Result();
+}
+common::ResultVoid<ErrorCode> paletteBufferLoad(const uint8_t *data, size_t size, ColorList &colorList) {
+	return paletteBufferLoad(data, size, colorList, PaletteProgressCallback());
+}
+common::ResultVoid<ErrorCode> paletteFileLoad(const char* filename, ColorList &colorList, const PaletteProgressCallback &progress) {
+	using Result = common::ResultVoid<ErrorCode>;
+	common::MappedFile file;
+	if (!file.open(filename))
+		return Result(ErrorCode::fileCouldNotBeOpened);
+	return paletteBufferLoad(file.data(), file.size(), colorList, progress);
+}
+common::ResultVoid<ErrorCode> paletteFileLoad(const char* filename, ColorList &colorList) {
+	return paletteFileLoad(filename, colorList, PaletteProgressCallback());
 }
 static bool write(std::ostream &stream, uint32_t value) {
 	auto data = boost::endian::native_to_little<uint32_t>(value);
@@ -212,7 +635,7 @@ static bool write(std::ostream &stream, const std::string &value) {
 		stream.write(reinterpret_cast<const char *>(&value.front()), value.length());
 	return stream.good();
 }
-common::ResultVoid<ErrorCode> paletteStreamSave(std::ostream &stream, ColorList &colorList) {
+static common::ResultVoid<ErrorCode> saveRecords(std::ostream &stream, ColorList &colorList, const PaletteProgressCallback &progress) {
 	using Result = common::ResultVoid<ErrorCode>;
 	ChunkHeader header;
 	header.prepareWrite(std::string(CHUNK_TYPE_VERSION) + " " + version::versionFull, 4);
@@ -242,7 +665,10 @@ common::ResultVoid<ErrorCode> paletteStreamSave(std::ostream &stream, ColorList
 	if (!write(stream, header)) // write temporary chunk header
 		return Result(ErrorCode::writeFailed);
 	dynv::Map options;
+	size_t index = 0, count = colorList.size();
 	for (auto *colorObject: colorList) {
+		if (index++ % ProgressInterval == 0 && !reportProgress(progress, index - 1, count))
+			return Result(ErrorCode::cancelled);
 		options.set("name", colorObject->getName());
 		options.set("color", colorObject->getColor());
 		if (!options.serialize(stream, typeMap))
@@ -255,16 +681,236 @@ common::ResultVoid<ErrorCode> paletteStreamSave(std::ostream &stream, ColorList
 		return Result(ErrorCode::writeFailed);
 	return Result();
 }
-common::ResultVoid<ErrorCode> paletteFileSave(const char* filename, ColorList &colorList) {
+static void append(std::vector<uint8_t> &data, uint16_t value) {
+	value = boost::endian::native_to_little(value);
+	auto bytes = reinterpret_cast<const uint8_t *>(&value);
+	data.insert(data.end(), bytes, bytes + sizeof(value));
+}
+static void append(std::vector<uint8_t> &data, uint32_t value) {
+	value = boost::endian::native_to_little(value);
+	auto bytes = reinterpret_cast<const uint8_t *>(&value);
+	data.insert(data.end(), bytes, bytes + sizeof(value));
+}
+static void append(std::vector<uint8_t> &data, uint64_t value) {
+	value = boost::endian::native_to_little(value);
+	auto bytes = reinterpret_cast<const uint8_t *>(&value);
+	data.insert(data.end(), bytes, bytes + sizeof(value));
+}
+static void append(std::vector<uint8_t> &data, float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	append(data, bits);
+}
+static common::ResultVoid<ErrorCode> saveColumns(std::ostream &stream, ColorList &colorList, const PaletteSaveOptions &options, const PaletteProgressCallback &progress) {
+	using Result = common::ResultVoid<ErrorCode>;
+	if (options.blockSize == 0 || options.blockSize > std::numeric_limits<uint32_t>::max() || colorList.size() > std::numeric_limits<uint32_t>::max())
+		return Result(ErrorCode::invalidArguments);
+	auto encoding = options.precision == PaletteSaveOptions::Precision::float16 ? ColorEncoding::float16 : ColorEncoding::float32;
+	auto compression = options.compress ? BlockCompression::lz4 : BlockCompression::none;
+	size_t valueSize = colorValueSize(encoding);
+	uint32_t colorCount = static_cast<uint32_t>(colorList.size()), blockSize = static_cast<uint32_t>(options.blockSize);
+	uint32_t blockCount = static_cast<uint32_t>((static_cast<uint64_t>(colorCount) + blockSize - 1) / blockSize);
+	std::vector<uint8_t> chunk, raw, shuffled, compressed;
+	append(chunk, colorCount);
+	append(chunk, blockSize);
+	chunk.push_back(static_cast<uint8_t>(encoding));
+	chunk.push_back(static_cast<uint8_t>(compression));
+	append(chunk, static_cast<uint16_t>(0));
+	append(chunk, blockCount);
+	std::vector<uint8_t> index;
+	auto colorObject = colorList.begin();
+	for (uint32_t block = 0; block < blockCount; block++) {
+		if (!reportProgress(progress, block, blockCount))
+			return Result(ErrorCode::cancelled);
+		uint32_t count = std::min(blockSize, colorCount - block * blockSize);
+		raw.clear();
+		auto blockStart = colorObject;
+		for (uint32_t i = 0; i < count; i++, ++colorObject) {
+			const auto &color = (*colorObject)->getColor();
+			for (int j = 0; j < 4; j++) {
+				if (encoding == ColorEncoding::float16)
+					append(raw, floatToHalf(color[j]));
+				else
+					append(raw, color[j]);
+			}
+		}
+		if (compression != BlockCompression::none) {
+			size_t valueCount = static_cast<size_t>(count) * 4;
+			shuffled.resize(raw.size());
+			for (size_t i = 0; i < valueCount; i++) {
+				for (size_t j = 0; j < valueSize; j++)
+					shuffled[j * valueCount + i] = raw[i * valueSize + j];
+			}
+			raw.swap(shuffled);
+		}
+		uint32_t offset = 0;
+		append(raw, offset);
+		for (auto i = blockStart; i != colorObject; ++i) {
+			auto length = (*i)->getName().length();
+			if (length > std::numeric_limits<uint32_t>::max() - offset)
+				return Result(ErrorCode::invalidArguments);
+			offset += static_cast<uint32_t>(length);
+			append(raw, offset);
+		}
+		for (auto i = blockStart; i != colorObject; ++i) {
+			const auto &name = (*i)->getName();
+			raw.insert(raw.end(), name.begin(), name.end());
+		}
+		if (raw.size() > std::numeric_limits<uint32_t>::max())
+			return Result(ErrorCode::invalidArguments);
+		append(index, static_cast<uint64_t>(chunk.size()));
+		size_t storedSize = 0;
+		if (compression == BlockCompression::lz4) {
+			compressed.resize(common::lz4::compressBound(raw.size()));
+			storedSize = common::lz4::compress(raw.data(), raw.size(), compressed.data(), compressed.size());
+		}
+		if (storedSize > 0 && storedSize < raw.size()) {
+			chunk.insert(chunk.end(), compressed.begin(), compressed.begin() + storedSize);
+		} else {
+			storedSize = raw.size();
+			chunk.insert(chunk.end(), raw.begin(), raw.end());
+		}
+		append(index, static_cast<uint32_t>(storedSize));
+		append(index, static_cast<uint32_t>(raw.size()));
+	}
+	uint64_t indexOffset = chunk.size();
+	chunk.insert(chunk.end(), index.begin(), index.end());
+	append(chunk, indexOffset);
+	append(chunk, blockCount);
+	append(chunk, ColumnsFooterMagic);
+	ChunkHeader header;
+	header.prepareWrite(std::string(CHUNK_TYPE_VERSION) + " " + version::versionFull, 4);
+	if (!write(stream, header))
+		return Result(ErrorCode::writeFailed);
+	if (!write(stream, ColumnsVersion))
+		return Result(ErrorCode::writeFailed);
+	header.prepareWrite(CHUNK_TYPE_COLOR_COLUMNS, chunk.size());
+	if (!write(stream, header))
+		return Result(ErrorCode::writeFailed);
+	stream.write(reinterpret_cast<const char *>(chunk.data()), chunk.size());
+	return stream.good() ? Result() : Result(ErrorCode::writeFailed);
+}
+common::ResultVoid<ErrorCode> paletteStreamSave(std::ostream &stream, ColorList &colorList, const PaletteSaveOptions &options, const PaletteProgressCallback &progress) {
+	if (options.layout == PaletteSaveOptions::Layout::columns)
+		return saveColumns(stream, colorList, options, progress);
+	return saveRecords(stream, colorList, progress);
+}
+common::ResultVoid<ErrorCode> paletteStreamSave(std::ostream &stream, ColorList &colorList, const PaletteSaveOptions &options) {
+	return paletteStreamSave(stream, colorList, options, PaletteProgressCallback());
+}
+common::ResultVoid<ErrorCode> paletteStreamSave(std::ostream &stream, ColorList &colorList) {
+	return paletteStreamSave(stream, colorList, PaletteSaveOptions());
+}
+common::ResultVoid<ErrorCode> paletteFileSave(const char* filename, ColorList &colorList, const PaletteSaveOptions &options, const PaletteProgressCallback &progress) {
 	using Result = common::ResultVoid<ErrorCode>;
 	if (!filename)
 		return Result(ErrorCode::invalidArguments);
 	std::ofstream file(filename, std::ios::binary);
 	if (!file.is_open())
 		return Result(ErrorCode::fileCouldNotBeOpened);
-	auto result = paletteStreamSave(file, colorList);
+	auto result = paletteStreamSave(file, colorList, options, progress);
 	if (!result)
 		return result;
 	file.close();
 	return file.good() ? Result() : Result(ErrorCode::writeFailed);
 }
+common::ResultVoid<ErrorCode> paletteFileSave(const char* filename, ColorList &colorList, const PaletteSaveOptions &options) {
+	return paletteFileSave(filename, colorList, options, PaletteProgressCallback());
+}
+common::ResultVoid<ErrorCode> paletteFileSave(const char* filename, ColorList &colorList) {
+	return paletteFileSave(filename, colorList, PaletteSaveOptions());
+}
+struct PaletteReader::Impl {
+	common::MappedFile file;
+	bool columns;
+	ColumnsIndex index;
+	DecodedColors decoded;
+	std::vector<uint32_t> order;
+	bool hasOrder;
+	size_t cachedBlock;
+	std::vector<uint8_t> blockStorage;
+	BlockView blockView;
+	Impl():
+		columns(false),
+		hasOrder(false),
+		cachedBlock(std::numeric_limits<size_t>::max()) {
+	}
+	common::ResultVoid<ErrorCode> open(const char *filename) {
+		using Result = common::ResultVoid<ErrorCode>;
+		if (!file.open(filename))
+			return Result(ErrorCode::fileCouldNotBeOpened);
+		ChunkIndex chunks;
+		auto result = indexChunks(file.data(), file.size(), chunks);
+		if (!result)
+			return result;
+		size_t count;
+		if (chunks.hasColorColumns) {
+			columns = true;
+			result = readColumnsIndex(chunks.colorColumns, index);
+			if (!result)
+				return result;
+			count = index.colorCount;
+		} else {
+			result = decodeColors(chunks, decoded, PaletteProgressCallback());
+			if (!result)
+				return result;
+			count = decoded.colors.size();
+		}
+		if (chunks.hasPositions) {
+			order = positionsToOrder(chunks.positions, count);
+			hasOrder = true;
+		}
+		return Result();
+	}
+	size_t size() const {
+		if (hasOrder)
+			return order.size();
+		return columns ? index.colorCount : decoded.colors.size();
+	}
+	common::ResultVoid<ErrorCode> read(size_t i, Color &color, std::string &name) {
+		using Result = common::ResultVoid<ErrorCode>;
+		if (i >= size())
+			return Result(ErrorCode::invalidArguments);
+		if (hasOrder)
+			i = order[i];
+		if (!columns) {
+			color = decoded.colors[i];
+			name = decoded.names[i];
+			return Result();
+		}
+		size_t block = i / index.blockSize;
+		if (block != cachedBlock) {
+			cachedBlock = std::numeric_limits<size_t>::max();
+			auto result = openBlock(index, index.blocks[block], blockStorage, blockView);
+			if (!result)
+				return result;
+			cachedBlock = block;
+		}
+		i -= block * index.blockSize;
+		color = blockView.color(i);
+		name = blockView.name(i);
+		return Result();
+	}
+};
+PaletteReader::PaletteReader() {
+}
+PaletteReader::~PaletteReader() {
+}
+common::ResultVoid<ErrorCode> PaletteReader::open(const char *filename) {
+	m_impl = std::make_unique<Impl>();
+	auto result = m_impl->open(filename);
+	if (!result)
+		m_impl.reset();
+	return result;
+}
+void PaletteReader::close() {
+	m_impl.reset();
+}
+size_t PaletteReader::size() const {
+	return m_impl ? m_impl->size() : 0;
+}
+common::ResultVoid<ErrorCode> PaletteReader::read(size_t index, Color &color, std::string &name) {
+	if (!m_impl)
+		return common::ResultVoid<ErrorCode>(ErrorCode::invalidArguments);
+	return m_impl->read(index, color, name);
+}
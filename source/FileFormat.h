@@ -21,8 +21,100 @@
 #include "common/Result.h"
 #include "ErrorCode.h"
 #include <iosfwd>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+struct Color;
 struct ColorList;
+/** \struct PaletteSaveOptions
+ * \brief GPA file layout options.
+ */
+struct PaletteSaveOptions {
+	enum struct Layout {
+		/** Version 2 layout with a record per color. Readable by all Gpick versions since 0.3. */
+		records,
+		/** Version 3 layout with colors and names stored in separate columns and split into blocks which can be read independently. */
+		columns,
+	};
+	enum struct Precision {
+		float32,
+		/** Half precision floats, enough for 8 bits per channel colors and values outside [0, 1] range. */
+		float16,
+	};
+	Layout layout = Layout::records;
+	/** Color value precision, only used by columns layout. */
+	Precision precision = Precision::float32;
+	/** Compress blocks, only used by columns layout. */
+	bool compress = false;
+	/** Number of colors in a block, only used by columns layout. */
+	size_t blockSize = 4096;
+};
+/**
+ * Palette load and save progress callback. Called with fraction of work done in range [0, 1].
+ * Loading or saving stops with ErrorCode::cancelled when callback returns false.
+ */
+using PaletteProgressCallback = std::function<bool(float progress)>;
 common::ResultVoid<ErrorCode> paletteFileSave(const char *filename, ColorList &colorList);
+common::ResultVoid<ErrorCode> paletteFileSave(const char *filename, ColorList &colorList, const PaletteSaveOptions &options);
+/**
+ * Save palette to GPA file.
+ * @param[in] filename File name.
+ * @param[in] colorList Colors to save.
+ * @param[in] options File layout options.
+ * @param[in] progress Progress callback, can be empty.
+ * @return Empty result on success, error code otherwise. File contents are incomplete when saving fails or is cancelled.
+ */
+common::ResultVoid<ErrorCode> paletteFileSave(const char *filename, ColorList &colorList, const PaletteSaveOptions &options, const PaletteProgressCallback &progress);
 common::ResultVoid<ErrorCode> paletteStreamSave(std::ostream &stream, ColorList &colorList);
+common::ResultVoid<ErrorCode> paletteStreamSave(std::ostream &stream, ColorList &colorList, const PaletteSaveOptions &options);
+common::ResultVoid<ErrorCode> paletteStreamSave(std::ostream &stream, ColorList &colorList, const PaletteSaveOptions &options, const PaletteProgressCallback &progress);
 common::ResultVoid<ErrorCode> paletteFileLoad(const char *filename, ColorList &colorList);
+/**
+ * Load palette from GPA file.
+ * @param[in] filename File name.
+ * @param[out] colorList Color list to add loaded colors to. Colors are only added when loading succeeds.
+ * @param[in] progress Progress callback, can be empty.
+ * @return Empty result on success, error code otherwise.
+ */
+common::ResultVoid<ErrorCode> paletteFileLoad(const char *filename, ColorList &colorList, const PaletteProgressCallback &progress);
+/**
+ * Load palette from GPA file contents already in memory.
+ * @param[in] data File data.
+ * @param[in] size File data size in bytes.
+ * @param[out] colorList Color list to add loaded colors to.
+ * @return Empty result on success, error code otherwise.
+ */
+common::ResultVoid<ErrorCode> paletteBufferLoad(const uint8_t *data, size_t size, ColorList &colorList);
+common::ResultVoid<ErrorCode> paletteBufferLoad(const uint8_t *data, size_t size, ColorList &colorList, const PaletteProgressCallback &progress);
+/** \struct PaletteReader
+ * \brief Random access to colors of a GPA file.
+ *
+ * Columns layout files are memory mapped and only the block containing requested color is decoded, so opening a file and reading a few colors does not depend on file size.
+ * Records layout files are fully decoded when opened.
+ */
+struct PaletteReader {
+	PaletteReader();
+	PaletteReader(const PaletteReader &) = delete;
+	PaletteReader &operator=(const PaletteReader &) = delete;
+	~PaletteReader();
+	common::ResultVoid<ErrorCode> open(const char *filename);
+	void close();
+	/**
+	 * @return Number of colors in opened file.
+	 */
+	size_t size() const;
+	/**
+	 * Read a single color.
+	 * @param[in] index Color index in palette order.
+	 * @param[out] color Color value.
+	 * @param[out] name Color name.
+	 * @return Empty result on success, error code otherwise.
+	 */
+	common::ResultVoid<ErrorCode> read(size_t index, Color &color, std::string &name);
+private:
+	struct Impl;
+	std::unique_ptr<Impl> m_impl;
+};
 #endif /* GPICK_FILE_FORMAT_H_ */
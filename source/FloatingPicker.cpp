@@ -32,18 +32,24 @@
 #include "ToolColorNaming.h"
 #include "ScreenReader.h"
 #include "Sampler.h"
+#include "PickerScheduler.h"
 #include "color_names/ColorNames.h"
 #include "common/SetOnScopeEnd.h"
 #include <gdk/gdkkeysyms.h>
 #include <string>
 #include <sstream>
+#include <optional>
 using namespace std;
 
 struct FloatingPickerArgs {
 	GtkWidget* window;
 	GtkWidget* zoomed;
 	GtkWidget* color_widget;
-	guint timeout_source_id;
+	PickerScheduler *scheduler;
+	math::Vector2i last_pointer;
+	math::Rectangle<int> last_zoomed_rect;
+	std::optional<Color> last_color;
+	uint64_t last_generation;
 	IColorPicker *colorPicker;
 	Converter *converter;
 	GlobalState* gs;
@@ -96,17 +102,25 @@ static void get_color_sample(FloatingPickerArgs *args, bool update_widgets, Colo
 	offset = sampler_rect.position() - final_rect.position();
 	sampler_get_color_sample(args->gs->getSampler(), pointer, screen_rect, offset, c);
 	if (update_widgets){
-		offset = final_rect.position() - zoomed_rect.position();
-		gtk_zoomed_update(GTK_ZOOMED(args->zoomed), pointer, screen_rect, offset, screen_reader_get_surface(screen_reader));
+		uint64_t generation = screen_reader_get_generation(screen_reader);
+		if (pointer != args->last_pointer || generation != args->last_generation || zoomed_rect != args->last_zoomed_rect){
+			offset = final_rect.position() - zoomed_rect.position();
+			gtk_zoomed_update(GTK_ZOOMED(args->zoomed), pointer, screen_rect, offset, screen_reader_get_surface(screen_reader));
+		}
+		args->last_pointer = pointer;
+		args->last_generation = generation;
+		args->last_zoomed_rect = zoomed_rect;
 	}
 }
-static gboolean update_display(FloatingPickerArgs *args)
+// Returns true if pointer position or sampled color changed since the last update.
+static bool update_display(FloatingPickerArgs *args)
 {
 	GdkScreen *screen;
 	GdkModifierType state;
 	int x, y;
 	int width, height;
 	gdk_display_get_pointer(gdk_display_get_default(), &screen, &x, &y, &state);
+	bool pointer_changed = math::Vector2i(x, y) != args->last_pointer;
 	width = gdk_screen_get_width(screen);
 	height = gdk_screen_get_height(screen);
 	gint sx, sy;
@@ -124,9 +138,13 @@ static gboolean update_display(FloatingPickerArgs *args)
 	if (gtk_window_get_screen(GTK_WINDOW(args->window)) != screen){
 		gtk_window_set_screen(GTK_WINDOW(args->window), screen);
 	}
-	gtk_window_move(GTK_WINDOW(args->window), x, y);
+	if (pointer_changed)
+		gtk_window_move(GTK_WINDOW(args->window), x, y);
 	Color c;
 	get_color_sample(args, true, &c);
+	if (args->last_color && *args->last_color == c)
+		return pointer_changed;
+	args->last_color = c;
 	string text;
 	auto converter = args->converter;
 	if (!converter){
@@ -153,12 +171,13 @@ void floating_picker_activate(FloatingPickerArgs *args, bool hide_on_mouse_relea
 		cursor = gdk_cursor_new(GDK_BLANK_CURSOR);
 	else
 		cursor = gdk_cursor_new(GDK_TCROSS);
+	args->last_color.reset();
+	args->last_zoomed_rect = math::Rectangle<int>();
 	update_display(args);
 	gtk_widget_show(args->window);
 	gdk_pointer_grab(gtk_widget_get_window(args->window), false, GdkEventMask(GDK_POINTER_MOTION_MASK | GDK_BUTTON_RELEASE_MASK | GDK_BUTTON_PRESS_MASK | GDK_SCROLL_MASK), nullptr, cursor, GDK_CURRENT_TIME);
 	gdk_keyboard_grab(gtk_widget_get_window(args->window), false, GDK_CURRENT_TIME);
-	auto refresh_rate = args->gs->settings().getInt32("gpick.picker.refresh_rate", 30);
-	args->timeout_source_id = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, static_cast<int>(1000 / refresh_rate), (GSourceFunc)update_display, args, (GDestroyNotify)nullptr);
+	args->scheduler->start(args->zoomed, args->gs->settings().getInt32("gpick.picker.refresh_rate", 30));
 #if GTK_MAJOR_VERSION >= 3
 	g_object_unref(cursor);
 #else
@@ -170,10 +189,7 @@ void floating_picker_deactivate(FloatingPickerArgs *args)
 {
 	gdk_pointer_ungrab(GDK_CURRENT_TIME);
 	gdk_keyboard_ungrab(GDK_CURRENT_TIME);
-	if (args->timeout_source_id > 0){
-		g_source_remove(args->timeout_source_id);
-		args->timeout_source_id = 0;
-	}
+	args->scheduler->stop();
 	gtk_widget_hide(args->window);
 }
 static gboolean scroll_event_cb(GtkWidget *widget, GdkEventScroll *event, FloatingPickerArgs *args)
@@ -182,9 +198,11 @@ static gboolean scroll_event_cb(GtkWidget *widget, GdkEventScroll *event, Floati
 	if ((event->direction == GDK_SCROLL_UP) || (event->direction == GDK_SCROLL_RIGHT)) {
 		zoom += 1;
 		gtk_zoomed_set_zoom(GTK_ZOOMED(args->zoomed), zoom);
+		args->scheduler->wake();
 	} else if ((event->direction == GDK_SCROLL_DOWN) || (event->direction == GDK_SCROLL_LEFT)) {
 		zoom -= 1;
 		gtk_zoomed_set_zoom(GTK_ZOOMED(args->zoomed), zoom);
+		args->scheduler->wake();
 	} else
 		return false;
 	return true;
@@ -349,12 +367,16 @@ static gboolean key_up_cb(GtkWidget *widget, GdkEventKey *event, FloatingPickerA
 }
 static void destroy_cb(GtkWidget *widget, FloatingPickerArgs *args)
 {
+	delete args->scheduler;
 	delete args;
 }
 FloatingPickerArgs* floating_picker_new(GlobalState *gs)
 {
 	FloatingPickerArgs *args = new FloatingPickerArgs;
-	args->timeout_source_id = 0;
+	args->scheduler = new PickerScheduler([args]() {
+		return update_display(args);
+	});
+	args->last_generation = 0;
 	args->gs = gs;
 	args->window = gtk_window_new(GTK_WINDOW_POPUP);
 	args->colorPicker = nullptr;
@@ -388,6 +410,7 @@ void floating_picker_set_picker_source(FloatingPickerArgs *args, IColorPicker *c
 }
 void floating_picker_free(FloatingPickerArgs *args)
 {
+	args->scheduler->stop();
 	gtk_widget_destroy(args->window);
 }
 void floating_picker_enable_custom_pick_action(FloatingPickerArgs *args)
@@ -119,6 +119,7 @@ struct GenerateSchemeArgs: public IColorSource, public IEventHandler {
 	}
 	void setTransformationChain() {
 		auto chain = gs.getTransformationChain();
+		gtk_color_wheel_set_transformation_chain(GTK_COLOR_WHEEL(colorWheel), chain);
 		for (int i = 0; i < maxColors; ++i) {
 			gtk_color_set_transformation_chain(GTK_COLOR(items[i].widget), chain);
 		}
@@ -21,6 +21,7 @@
 #include "ScreenReader.h"
 #include "Converters.h"
 #include "Converter.h"
+#include "ConverterOptions.h"
 #include "InternalConverters.h"
 #include "Random.h"
 #include "color_names/ColorNames.h"
@@ -43,32 +44,14 @@
 #include <iostream>
 #include <stdexcept>
 namespace {
-struct ConverterOptions: public Converter::Options, public IEventHandler {
-	ConverterOptions(const dynv::Map &settings):
-		m_settings(settings) {
-	}
-	void update() {
-		auto options = m_settings.getMap("gpick.options");
-		upperCaseHex = options->getString("hex_case", "upper") == "upper";
-		cssPercentages = options->getBool("css_percentages", false);
-		cssAlphaPercentage = options->getBool("css_alpha_percentage", false);
-	}
-	virtual ~ConverterOptions() {
+struct TransformationChainUpdater: public IEventHandler {
+	transformation::Chain *chain = nullptr;
+	virtual ~TransformationChainUpdater() {
 	}
 	virtual void onEvent(EventType eventType) override {
-		switch (eventType) {
-		case EventType::optionsUpdate:
-			update();
-			break;
-		case EventType::convertersUpdate:
-		case EventType::displayFiltersUpdate:
-		case EventType::colorDictionaryUpdate:
-		case EventType::paletteChanged:
-			break;
-		}
+		if (eventType == EventType::displayFiltersUpdate && chain)
+			chain->invalidate();
 	}
-private:
-	const dynv::Map &m_settings;
 };
 }
 struct GlobalState::Impl {
@@ -88,6 +71,7 @@ struct GlobalState::Impl {
 	IColorSource *m_colorSource;
 	EventBus m_eventBus;
 	ConverterOptions m_converterOptions;
+	TransformationChainUpdater m_transformationChainUpdater;
 	Impl(GlobalState *decl):
 		m_decl(decl),
 		m_colorNames(nullptr),
@@ -97,10 +81,11 @@ struct GlobalState::Impl {
 		m_transformationChain(nullptr),
 		m_statusBar(nullptr),
 		m_colorSource(nullptr),
-		m_converterOptions(m_settings) {
+		m_converterOptions(m_settings, m_converters) {
 	}
 	virtual ~Impl() {
 		m_eventBus.unsubscribe(m_converterOptions);
+		m_eventBus.unsubscribe(m_transformationChainUpdater);
 		if (m_transformationChain != nullptr)
 			delete m_transformationChain;
 		if (m_random != nullptr)
@@ -189,6 +174,7 @@ struct GlobalState::Impl {
 	}
 	void initializeConverters() {
 		m_eventBus.subscribe(EventType::optionsUpdate, m_converterOptions);
+		m_eventBus.subscribe(EventType::convertersUpdate, m_converterOptions);
 		m_converterOptions.update();
 		addInternalConverters(m_converters, m_converterOptions);
 	}
@@ -232,6 +218,7 @@ struct GlobalState::Impl {
 		if (m_transformationChain != nullptr) return false;
 		transformation::Chain *chain = new transformation::Chain();
 		chain->setEnabled(m_settings.getBool("gpick.transformations.enabled", false));
+		chain->setLutSize(m_settings.getInt32("gpick.transformations.lut_size", 33));
 		auto items = m_settings.getMaps("gpick.transformations.items");
 		for (auto values: items) {
 			if (!values)
@@ -246,6 +233,8 @@ struct GlobalState::Impl {
 			chain->add(std::move(transformation));
 		}
 		m_transformationChain = chain;
+		m_transformationChainUpdater.chain = chain;
+		m_eventBus.subscribe(EventType::displayFiltersUpdate, m_transformationChainUpdater); // subscribed before widgets, so lookup table is rebuilt before they redraw
 		return true;
 	}
 	bool loadAll() {
@@ -262,6 +251,15 @@ struct GlobalState::Impl {
 		loadTransformationChain();
 		return true;
 	}
+	bool loadHeadless() {
+		initializeRandomGenerator();
+		loadSettings();
+		loadColorNames();
+		initializeConverters();
+		initializeLua();
+		loadConverters();
+		return true;
+	}
 };
 
 GlobalState::GlobalState() {
@@ -275,6 +273,9 @@ bool GlobalState::loadSettings() {
 bool GlobalState::loadAll() {
 	return m_impl->loadAll();
 }
+bool GlobalState::loadHeadless() {
+	return m_impl->loadHeadless();
+}
 bool GlobalState::writeSettings() {
 	return m_impl->writeSettings();
 }
@@ -47,6 +47,12 @@ struct GlobalState {
 	~GlobalState();
 	bool loadSettings();
 	bool loadAll();
+	/**
+	 * Load settings, color names, converters and Lua scripts without screen sampling and display filters.
+	 * Configuration directory is not created, so color dictionary cache is only written when the directory already exists. No display is needed.
+	 * @return True on success.
+	 */
+	bool loadHeadless();
 	bool writeSettings();
 	ColorNames *getColorNames();
 	Sampler *getSampler();
@@ -17,13 +17,36 @@
  */
 
 #pragma once
+#include "common/Span.h"
+#include <utility>
+#include <cstddef>
 struct ColorList;
 struct ColorObject;
+/** \struct ColorListChange
+ * \brief Compact description of a bulk change made to a color list.
+ *
+ * Change is reported after color list has been modified, so rows can be read from color list directly.
+ */
+struct ColorListChange {
+	enum struct Type {
+		/** Rows [position, position + count) were inserted. */
+		insert,
+		/** Row ranges [first, second) were removed, count rows in total. Ranges are in ascending order and use row indices from before the change. */
+		remove,
+		/** Rows were reordered: row i was row order[i] before the change. Only rows [position, position + count) were moved. */
+		reorder,
+		/** All rows were replaced by count new rows. */
+		replace,
+	};
+	Type type;
+	size_t position, count;
+	common::Span<const std::pair<size_t, size_t>> ranges;
+	common::Span<const size_t> order;
+};
 struct IPalette {
 	virtual ~IPalette() = default;
 	virtual void add(ColorList &colorList, ColorObject *colorObject) = 0;
-	virtual void remove(ColorList &colorList, ColorObject *colorObject) = 0;
-	virtual void removeSelected(ColorList &colorList) = 0;
+	virtual void change(ColorList &colorList, const ColorListChange &change) = 0;
 	virtual void clear(ColorList &colorList) = 0;
 	virtual void update(ColorList &colorList) = 0;
 };
@@ -25,7 +25,6 @@
 #include "I18N.h"
 #include "StringUtils.h"
 #include "HtmlUtils.h"
-#include "GlobalState.h"
 #include "dynv/Map.h"
 #include "version/Version.h"
 #include "parser/TextFile.h"
@@ -35,20 +34,21 @@
 #include <string>
 #include <sstream>
 #include <vector>
+#include <algorithm>
 #include <filesystem>
 #include <boost/math/special_functions/round.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/endian/conversion.hpp>
 
-ImportExport::ImportExport(ColorList &colorList, const char *filename, GlobalState &gs):
+ImportExport::ImportExport(ColorList &colorList, const char *filename):
 	m_colorList(colorList),
 	m_converter(nullptr),
 	m_converters(nullptr),
 	m_filename(filename),
 	m_itemSize(ItemSize::medium),
 	m_background(Background::none),
-	m_gs(gs),
 	m_includeColorNames(true),
+	m_upperCaseHex(true),
 	m_lastError(Error::none) {
 }
 void ImportExport::fixFileExtension(const char *selected_filter) {
@@ -119,6 +119,34 @@ void ImportExport::setBackground(const char *background) {
 void ImportExport::setIncludeColorNames(bool include_color_names) {
 	m_includeColorNames = include_color_names;
 }
+void ImportExport::setUpperCaseHex(bool upperCaseHex) {
+	m_upperCaseHex = upperCaseHex;
+}
+void ImportExport::setPaletteSaveOptions(const PaletteSaveOptions &options) {
+	m_paletteSaveOptions = options;
+}
+void ImportExport::setProgressCallback(ProgressCallback callback) {
+	m_progressCallback = std::move(callback);
+}
+// number of colors or lines between progress callback calls
+static const size_t progressInterval = 256;
+bool ImportExport::progress(size_t done, size_t total) {
+	if (!m_progressCallback || m_progressCallback(total > 0 ? std::min(1.0f, static_cast<float>(done) / total) : 0.0f))
+		return true;
+	m_lastError = Error::cancelled;
+	return false;
+}
+bool ImportExport::abortExport(std::ofstream &file) {
+	file.close();
+	std::error_code ec;
+	std::filesystem::remove(m_filename, ec); // do not leave partially written file
+	return false;
+}
+static size_t fileSize(const std::string &filename) {
+	std::error_code ec;
+	auto size = std::filesystem::file_size(filename, ec);
+	return ec ? 0 : static_cast<size_t>(size);
+}
 static void gplColor(ColorObject *colorObject, std::ostream &stream) {
 	using boost::math::iround;
 	Color color = colorObject->getColor();
@@ -138,7 +166,10 @@ bool ImportExport::exportGPL() {
 	f << "Name: " << path.filename().string() << '\n';
 	f << "Columns: 1" << '\n';
 	f << "#" << '\n';
+	size_t index = 0, count = m_colorList.size();
 	for (auto color: m_colorList) {
+		if (index++ % progressInterval == 0 && !progress(index, count))
+			return abortExport(f);
 		gplColor(color, f);
 		if (!f.good()) {
 			f.close();
@@ -168,8 +199,11 @@ bool ImportExport::importGPL() {
 	int r, g, b;
 	Color c;
 	std::string stripChars = " \t";
+	size_t lines = 0, size = fileSize(m_filename);
 	for (;;) {
 		if (!f.good()) break;
+		if (lines++ % progressInterval == 0 && !progress(static_cast<size_t>(f.tellg()), size))
+			return false;
 		stripLeadingTrailingChars(line, stripChars);
 		if (line.length() > 0 && line[0] == '#') { // skip comment lines
 			getline(f, line);
@@ -196,11 +230,35 @@ bool ImportExport::importGPL() {
 	f.close();
 	return true;
 }
+static ImportExport::Error toError(ErrorCode errorCode, bool import) {
+	switch (errorCode) {
+	case ErrorCode::fileCouldNotBeOpened:
+		return ImportExport::Error::couldNotOpenFile;
+	case ErrorCode::cancelled:
+		return ImportExport::Error::cancelled;
+	default:
+		return import ? ImportExport::Error::fileReadError : ImportExport::Error::fileWriteError;
+	}
+}
 bool ImportExport::importGPA() {
-	return paletteFileLoad(m_filename.c_str(), m_colorList);
+	auto result = paletteFileLoad(m_filename.c_str(), m_colorList, m_progressCallback);
+	if (!result) {
+		m_lastError = toError(result.error(), true);
+		return false;
+	}
+	return true;
 }
 bool ImportExport::exportGPA() {
-	return paletteFileSave(m_filename.c_str(), m_colorList);
+	auto result = paletteFileSave(m_filename.c_str(), m_colorList, m_paletteSaveOptions, m_progressCallback);
+	if (!result) {
+		m_lastError = toError(result.error(), false);
+		if (result.error() == ErrorCode::cancelled) {
+			std::error_code ec;
+			std::filesystem::remove(m_filename, ec); // do not leave partially written file
+		}
+		return false;
+	}
+	return true;
 }
 bool ImportExport::exportTXT() {
 	std::ofstream f(m_filename.c_str(), std::ios::out | std::ios::trunc);
@@ -208,25 +266,15 @@ bool ImportExport::exportTXT() {
 		m_lastError = Error::couldNotOpenFile;
 		return false;
 	}
-	ConverterSerializePosition position(m_colorList.size());
-	for (auto color: m_colorList) {
-		std::string line = m_converter->serialize(*color, position);
-		if (m_includeColorNames) {
-			f << line << " " << color->getName() << '\n';
-		} else {
-			f << line << '\n';
-		}
-		position.incrementIndex();
-		if (position.index() + 1 == position.count()) {
-			position.last(true);
-		}
-		if (position.first())
-			position.first(false);
-		if (!f.good()) {
-			f.close();
-			m_lastError = Error::fileWriteError;
-			return false;
-		}
+	std::string text;
+	m_converter->serialize(m_colorList, text, "\n", m_includeColorNames);
+	if (!m_colorList.empty())
+		text += '\n';
+	f.write(text.data(), text.length());
+	if (!f.good()) {
+		f.close();
+		m_lastError = Error::fileWriteError;
+		return false;
 	}
 	f.close();
 	return true;
@@ -237,30 +285,13 @@ bool ImportExport::importTXT() {
 		m_lastError = Error::couldNotOpenFile;
 		return false;
 	}
-	common::First<float, std::greater<float>, ColorObject> bestConversion;
-	ColorObject colorObject;
-	float quality;
+	std::vector<std::string> lines;
 	std::string line, stripChars = " \t";
-	bool imported = false;
 	for (;;) {
 		std::getline(f, line);
 		stripLeadingTrailingChars(line, stripChars);
-		if (!line.empty()) {
-			for (auto &converter: m_converters->allPaste()) {
-				if (!converter->hasDeserialize())
-					continue;
-				if (converter->deserialize(line.c_str(), colorObject, quality)) {
-					if (quality > 0) {
-						bestConversion(quality, colorObject);
-					}
-				}
-			}
-			if (bestConversion) {
-				m_colorList.add(bestConversion.data<ColorObject>());
-				imported = true;
-				bestConversion.reset();
-			}
-		}
+		if (!line.empty())
+			lines.push_back(std::move(line));
 		if (!f.good()) {
 			if (f.eof())
 				break;
@@ -270,6 +301,7 @@ bool ImportExport::importTXT() {
 		}
 	}
 	f.close();
+	bool imported = m_converters->deserialize(lines, m_colorList) > 0;
 	if (!imported) {
 		m_lastError = Error::noColorsImported;
 	}
@@ -293,7 +325,10 @@ bool ImportExport::exportCSS() {
 	}
 	f << "/**" << '\n'
 		<< " * Generated by Gpick " << version::versionFull << '\n';
+	size_t index = 0, count = m_colorList.size();
 	for (auto color: m_colorList) {
+		if (index++ % progressInterval == 0 && !progress(index, count))
+			return abortExport(f);
 		cssColor(color, f);
 		if (!f.good()) {
 			f.close();
@@ -419,13 +454,15 @@ bool ImportExport::exportHTML() {
 		f << "</form>" << '\n';
 	}
 	f << "<div id=\"colors\">" << '\n';
-	std::string hexCase = m_gs.settings().getString("gpick.options.hex_case", "upper");
-	if (hexCase == "upper") {
+	if (m_upperCaseHex) {
 		f << std::uppercase;
 	} else {
 		f << std::nouppercase;
 	}
+	size_t index = 0, count = m_colorList.size();
 	for (auto color: m_colorList) {
+		if (index++ % progressInterval == 0 && !progress(index, count))
+			return abortExport(f);
 		htmlColor(color, m_converter, m_includeColorNames, f);
 		if (!f.good()) {
 			f.close();
@@ -485,7 +522,10 @@ bool ImportExport::exportMTL() {
 		m_lastError = Error::couldNotOpenFile;
 		return false;
 	}
+	size_t index = 0, count = m_colorList.size();
 	for (auto color: m_colorList) {
+		if (index++ % progressInterval == 0 && !progress(index, count))
+			return abortExport(f);
 		mtlColor(color, f);
 		if (!f.good()) {
 			f.close();
@@ -543,7 +583,10 @@ bool ImportExport::exportASE() {
 	uint32_t blocks = m_colorList.size();
 	blocks = boost::endian::native_to_big<uint32_t>(blocks);
 	f.write((char *)&blocks, 4);
+	size_t index = 0, count = m_colorList.size();
 	for (auto color: m_colorList) {
+		if (index++ % progressInterval == 0 && !progress(index, count))
+			return abortExport(f);
 		aseColor(color, f);
 		if (!f.good()) {
 			f.close();
@@ -577,6 +620,8 @@ bool ImportExport::importASE() {
 	uint32_t block_size;
 	int color_supported;
 	for (uint32_t i = 0; i < blocks; ++i) {
+		if (i % progressInterval == 0 && !progress(i, blocks))
+			return false;
 		f.read((char *)&block_type, 2);
 		block_type = boost::endian::big_to_native<uint16_t>(block_type);
 		f.read((char *)&block_size, 4);
@@ -694,7 +739,10 @@ bool ImportExport::importRGBTXT() {
 	std::string line;
 	Color c;
 	std::string stripChars = " \t";
+	size_t lines = 0, size = fileSize(m_filename);
 	for (;;) {
+		if (lines++ % progressInterval == 0 && !progress(static_cast<size_t>(f.tellg()), size))
+			return false;
 		getline(f, line);
 		if (!f.good()) break;
 		stripLeadingTrailingChars(line, stripChars);
@@ -819,15 +867,30 @@ bool ImportExport::importType(FileType type) {
 	}
 	return false;
 }
+bool ImportExport::isThreadSafe(FileType type, bool import) {
+	switch (type) {
+	case FileType::txt:
+		return false;
+	case FileType::html:
+		return import;
+	default:
+		return true;
+	}
+}
 ImportExport::Error ImportExport::getLastError() const {
 	return m_lastError;
 }
 struct ImportTextFile: public text_file_parser::TextFile {
 	std::ifstream m_file;
 	std::vector<Color> m_colors;
-	bool m_failed;
-	ImportTextFile(const std::string &filename) {
+	std::function<bool(size_t)> m_progress;
+	size_t m_bytesRead;
+	bool m_failed, m_cancelled;
+	ImportTextFile(const std::string &filename, std::function<bool(size_t)> progress):
+		m_progress(std::move(progress)),
+		m_bytesRead(0) {
 		m_failed = false;
+		m_cancelled = false;
 		m_file.open(filename, std::ios::in);
 	}
 	bool isOpen() {
@@ -843,8 +906,13 @@ struct ImportTextFile: public text_file_parser::TextFile {
 		m_failed = true;
 	}
 	virtual size_t read(char *buffer, size_t length) {
+		if (m_cancelled || !m_progress(m_bytesRead)) {
+			m_cancelled = true;
+			return 0; // parser stops at the end of input
+		}
 		m_file.read(buffer, length);
 		size_t bytes = m_file.gcount();
+		m_bytesRead += bytes;
 		if (bytes > 0) return bytes;
 		if (m_file.eof()) return 0;
 		if (!m_file.good()) {
@@ -857,12 +925,18 @@ struct ImportTextFile: public text_file_parser::TextFile {
 	}
 };
 bool ImportExport::importTextFile(const text_file_parser::Configuration &configuration) {
-	ImportTextFile importTextFile(m_filename);
+	size_t size = fileSize(m_filename);
+	ImportTextFile importTextFile(m_filename, [this, size](size_t bytesRead) {
+		return progress(bytesRead, size);
+	});
 	if (!importTextFile.isOpen()) {
 		m_lastError = Error::couldNotOpenFile;
 		return false;
 	}
-	if (!importTextFile.parse(configuration)) {
+	bool parsed = importTextFile.parse(configuration);
+	if (importTextFile.m_cancelled)
+		return false;
+	if (!parsed) {
 		m_lastError = Error::parsingFailed;
 		return false;
 	}
@@ -874,8 +948,14 @@ bool ImportExport::importTextFile(const text_file_parser::Configuration &configu
 		m_lastError = Error::noColorsImported;
 		return false;
 	}
+	std::vector<ColorObject *> colorObjects;
+	colorObjects.reserve(importTextFile.m_colors.size());
 	for (auto color: importTextFile.m_colors) {
-		m_colorList.add(ColorObject("", color));
+		colorObjects.push_back(new ColorObject("", color));
+	}
+	m_colorList.addRange(common::Span<ColorObject *const>(colorObjects.data(), colorObjects.size()));
+	for (auto colorObject: colorObjects) {
+		colorObject->release();
 	}
 	return true;
 }
@@ -17,11 +17,13 @@
  */
 
 #pragma once
+#include "FileFormat.h"
 #include <string>
+#include <functional>
+#include <iosfwd>
 struct ColorList;
 struct Converter;
 struct Converters;
-struct GlobalState;
 namespace text_file_parser {
 struct Configuration;
 }
@@ -44,6 +46,7 @@ struct ImportExport {
 		fileWriteError,
 		noColorsImported,
 		parsingFailed,
+		cancelled,
 	};
 	enum struct ItemSize {
 		small,
@@ -60,7 +63,12 @@ struct ImportExport {
 		lastColor,
 		controllable,
 	};
-	ImportExport(ColorList &colorList, const char *filename, GlobalState &gs);
+	/**
+	 * Progress callback. Called with fraction of work done in range [0, 1] while file is read or written.
+	 * Import or export is cancelled when callback returns false.
+	 */
+	using ProgressCallback = std::function<bool(float progress)>;
+	ImportExport(ColorList &colorList, const char *filename);
 	void setConverter(Converter *converter);
 	void setConverters(Converters *converters);
 	void setItemSize(ItemSize itemSize);
@@ -68,6 +76,13 @@ struct ImportExport {
 	void setBackground(Background background);
 	void setBackground(const char *background);
 	void setIncludeColorNames(bool includeColorNames);
+	/**
+	 * Set case of hexadecimal color values written by HTML export. Upper case is used by default.
+	 * @param[in] upperCaseHex True for upper case, false for lower case.
+	 */
+	void setUpperCaseHex(bool upperCaseHex);
+	void setPaletteSaveOptions(const PaletteSaveOptions &options);
+	void setProgressCallback(ProgressCallback callback);
 	bool exportGPL();
 	bool importGPL();
 	bool exportASE();
@@ -87,6 +102,14 @@ struct ImportExport {
 	static FileType getFileType(const char *filename);
 	static FileType getFileTypeByExtension(const char *extension);
 	static FileType getFileTypeByContent(const char *filename);
+	/**
+	 * Check if file type can be imported or exported on a background thread.
+	 * Converters run Lua scripts, so file types using them must be handled on the main thread.
+	 * @param[in] type File type.
+	 * @param[in] import True for import, false for export.
+	 * @return True if import or export does not use converters.
+	 */
+	static bool isThreadSafe(FileType type, bool import);
 	void fixFileExtension(const char *selectedFilter);
 	const std::string &getFilename() const;
 private:
@@ -96,7 +119,10 @@ private:
 	std::string m_filename;
 	ItemSize m_itemSize;
 	Background m_background;
-	GlobalState &m_gs;
-	bool m_includeColorNames;
+	bool m_includeColorNames, m_upperCaseHex;
+	PaletteSaveOptions m_paletteSaveOptions;
+	ProgressCallback m_progressCallback;
 	Error m_lastError;
+	bool progress(size_t done, size_t total);
+	bool abortExport(std::ofstream &file);
 };
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ImportExportTask.h"
+#include "ColorList.h"
+#include "ColorObject.h"
+#include "parser/TextFile.h"
+#include <atomic>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <algorithm>
+namespace {
+// number of colors added to the target color list in one change notification
+const size_t chunkSize = 256;
+// part of import progress taken by reading, the rest is taken by adding colors to the target color list
+const float readShare = 0.8f;
+}
+struct ImportExportTask::Impl {
+	using Run = std::function<bool(ImportExport &importExport)>;
+	ColorList *target;
+	ColorList colors;
+	ImportExport importExport;
+	Run run;
+	bool background, started, joined, succeeded;
+	std::thread thread;
+	std::atomic<bool> cancelled, done;
+	std::atomic<float> readProgress;
+	size_t delivered;
+	State state;
+	Impl(ColorList *target, const std::string &filename, Run run, bool background):
+		target(target),
+		importExport(colors, filename.c_str()),
+		run(std::move(run)),
+		background(background),
+		started(false),
+		joined(false),
+		succeeded(false),
+		cancelled(false),
+		done(false),
+		readProgress(0.0f),
+		delivered(0),
+		state(State::running) {
+		importExport.setProgressCallback([this](float value) {
+			readProgress = value;
+			return !cancelled;
+		});
+	}
+	~Impl() {
+		if (target) {
+			cancelled = true;
+		} else if (!started && !cancelled) {
+			started = true;
+			run(importExport); // export which was not polled yet is written now, so closing application does not lose it
+		}
+		if (thread.joinable())
+			thread.join();
+		if (target && state == State::running)
+			rollback();
+	}
+	/**
+	 * Remove colors which were already added to the target color list.
+	 */
+	void rollback() {
+		if (delivered == 0)
+			return;
+		std::unordered_set<ColorObject *> added(colors.begin(), colors.begin() + delivered);
+		target->removeIf([&added](ColorObject *colorObject) {
+			return added.count(colorObject) != 0;
+		});
+		delivered = 0;
+	}
+	void start() {
+		if (!background)
+			return; // started by the first poll() call
+		started = true;
+		thread = std::thread([this]() {
+			succeeded = execute();
+			done = true;
+		});
+	}
+	bool execute() {
+		if (cancelled)
+			return false; // export of a task cancelled before start must not truncate existing file
+		return run(importExport);
+	}
+	State poll(std::chrono::milliseconds budget) {
+		if (state != State::running)
+			return state;
+		if (!started) {
+			started = true;
+			succeeded = execute();
+			done = true;
+		}
+		if (!done)
+			return state;
+		if (!joined) {
+			if (thread.joinable())
+				thread.join();
+			joined = true;
+			if (!succeeded)
+				return state = cancelled || importExport.getLastError() == ImportExport::Error::cancelled ? State::cancelled : State::failed;
+			if (!target)
+				return state = State::finished;
+		}
+		auto deadline = std::chrono::steady_clock::now() + budget;
+		while (delivered < colors.size()) {
+			if (cancelled) {
+				rollback();
+				return state = State::cancelled;
+			}
+			size_t count = std::min(chunkSize, colors.size() - delivered);
+			target->addRange(common::Span<ColorObject *const>(&*(colors.begin() + delivered), count));
+			delivered += count;
+			if (std::chrono::steady_clock::now() >= deadline)
+				return state;
+		}
+		colors.removeAll();
+		return state = State::finished;
+	}
+	float progress() const {
+		if (state == State::finished)
+			return 1.0f;
+		if (!target)
+			return readProgress;
+		if (!joined)
+			return readProgress * readShare;
+		return readShare + (1.0f - readShare) * delivered / std::max<size_t>(colors.size(), 1);
+	}
+};
+ImportExportTask::ImportExportTask(std::unique_ptr<Impl> impl):
+	m_impl(std::move(impl)) {
+}
+ImportExportTask::~ImportExportTask() {
+}
+std::unique_ptr<ImportExportTask> ImportExportTask::startImport(ColorList &colorList, const std::string &filename, FileType type, Setup setup) {
+	auto run = [type](ImportExport &importExport) {
+		return importExport.importType(type);
+	};
+	auto impl = std::make_unique<Impl>(&colorList, filename, run, ImportExport::isThreadSafe(type, true));
+	if (setup)
+		setup(impl->importExport);
+	impl->start();
+	return std::unique_ptr<ImportExportTask>(new ImportExportTask(std::move(impl)));
+}
+std::unique_ptr<ImportExportTask> ImportExportTask::startImportTextFile(ColorList &colorList, const std::string &filename, const text_file_parser::Configuration &configuration) {
+	auto run = [configuration](ImportExport &importExport) {
+		return importExport.importTextFile(configuration);
+	};
+	auto impl = std::make_unique<Impl>(&colorList, filename, run, true);
+	impl->start();
+	return std::unique_ptr<ImportExportTask>(new ImportExportTask(std::move(impl)));
+}
+std::unique_ptr<ImportExportTask> ImportExportTask::startExport(const ColorList &colorList, const std::string &filename, FileType type, Setup setup) {
+	auto run = [type](ImportExport &importExport) {
+		return importExport.exportType(type);
+	};
+	auto impl = std::make_unique<Impl>(nullptr, filename, run, ImportExport::isThreadSafe(type, false));
+	// worker thread writes copies, because color objects in the source list can be edited or converted while export is running
+	std::vector<ColorObject *> colorObjects;
+	colorObjects.reserve(colorList.size());
+	for (auto *colorObject: colorList)
+		colorObjects.push_back(new ColorObject(*colorObject));
+	impl->colors.addRange(common::Span<ColorObject *const>(colorObjects.data(), colorObjects.size()));
+	for (auto *colorObject: colorObjects)
+		colorObject->release();
+	if (setup)
+		setup(impl->importExport);
+	impl->start();
+	return std::unique_ptr<ImportExportTask>(new ImportExportTask(std::move(impl)));
+}
+ImportExportTask::State ImportExportTask::poll(std::chrono::milliseconds budget) {
+	return m_impl->poll(budget);
+}
+void ImportExportTask::cancel() {
+	m_impl->cancelled = true;
+}
+float ImportExportTask::progress() const {
+	return m_impl->progress();
+}
+ImportExport::Error ImportExportTask::error() const {
+	return m_impl->joined ? m_impl->importExport.getLastError() : ImportExport::Error::none;
+}
+const std::string &ImportExportTask::filename() const {
+	return m_impl->importExport.getFilename();
+}
+size_t ImportExportTask::count() const {
+	return m_impl->delivered;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include "ImportExport.h"
+#include <chrono>
+#include <memory>
+#include <string>
+struct ColorList;
+namespace text_file_parser {
+struct Configuration;
+}
+/** \struct ImportExportTask
+ * \brief Import or export running on a background thread.
+ *
+ * Import reads a file into a detached color list on a worker thread. When reading is finished, poll() adds imported colors to the target color list in chunks, so the main loop is never blocked for long.
+ * Export writes copies of colors taken when the task is started, so the source color list can be modified while the file is written.
+ * File types using converters can not be handled on a background thread, so they are imported or exported by the first poll() call instead.
+ */
+struct ImportExportTask {
+	enum struct State {
+		running,
+		finished,
+		failed,
+		cancelled,
+	};
+	/**
+	 * Callback used to set import or export options before the task starts.
+	 */
+	using Setup = std::function<void(ImportExport &importExport)>;
+	/**
+	 * Start importing a file.
+	 * @param[in] colorList Color list which receives imported colors. Must stay valid while task exists.
+	 * @param[in] filename File name.
+	 * @param[in] type File type.
+	 * @param[in] setup Import options callback.
+	 * @return Running task.
+	 */
+	static std::unique_ptr<ImportExportTask> startImport(ColorList &colorList, const std::string &filename, FileType type, Setup setup = Setup());
+	/**
+	 * Start importing colors found in a text file.
+	 * @param[in] colorList Color list which receives imported colors. Must stay valid while task exists.
+	 * @param[in] filename File name.
+	 * @param[in] configuration Text parser configuration.
+	 * @return Running task.
+	 */
+	static std::unique_ptr<ImportExportTask> startImportTextFile(ColorList &colorList, const std::string &filename, const text_file_parser::Configuration &configuration);
+	/**
+	 * Start exporting colors to a file.
+	 * @param[in] colorList Colors to export. Colors are copied, so color list can be modified or destroyed after this call.
+	 * @param[in] filename File name.
+	 * @param[in] type File type.
+	 * @param[in] setup Export options callback.
+	 * @return Running task.
+	 */
+	static std::unique_ptr<ImportExportTask> startExport(const ColorList &colorList, const std::string &filename, FileType type, Setup setup = Setup());
+	ImportExportTask(const ImportExportTask &) = delete;
+	ImportExportTask &operator=(const ImportExportTask &) = delete;
+	/**
+	 * Cancel import and remove colors it has already added to the target color list. Export which was not cancelled is finished before destructor returns.
+	 */
+	~ImportExportTask();
+	/**
+	 * Check task state and add imported colors to the target color list. Must be called from the main thread until a state other than running is returned.
+	 * @param[in] budget Time spent adding imported colors before returning.
+	 * @return Task state.
+	 */
+	State poll(std::chrono::milliseconds budget = std::chrono::milliseconds(20));
+	/**
+	 * Request task cancellation. Cancelled import removes colors it has already added to the target color list and cancelled export removes partially written file.
+	 */
+	void cancel();
+	/**
+	 * @return Fraction of work done in range [0, 1].
+	 */
+	float progress() const;
+	ImportExport::Error error() const;
+	/**
+	 * @return File name, with extension fixed by setup callback.
+	 */
+	const std::string &filename() const;
+	/**
+	 * @return Number of colors added to the target color list.
+	 */
+	size_t count() const;
+private:
+	struct Impl;
+	std::unique_ptr<Impl> m_impl;
+	ImportExportTask(std::unique_ptr<Impl> impl);
+};
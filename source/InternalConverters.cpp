@@ -26,6 +26,9 @@
 #include "version/Version.h"
 #include <cstddef>
 #include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
 using namespace std::string_literals;
 using namespace std::string_view_literals;
 using namespace common;
@@ -56,6 +59,49 @@ static int fromHex(char value) {
 	else
 		return 0;
 }
+static void appendHexDigit(std::string &output, int value, bool upperCase) {
+	output += (upperCase ? "0123456789ABCDEF" : "0123456789abcdef")[value & 0xf];
+}
+static void appendHex(std::string &output, int value, bool upperCase) {
+	appendHexDigit(output, value >> 4, upperCase);
+	appendHexDigit(output, value, upperCase);
+}
+template<typename T>
+static void appendInteger(std::string &output, T value) {
+	char buffer[24];
+	auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+	output.append(buffer, result.ptr);
+}
+static void appendFixed(std::string &output, float value) {
+	// Produces the same text as "%0.3f" format in "C" locale. Float multiplied by 1000 is exact in double precision,
+	// so rounding to integer matches printf rounding, including ties.
+	double scaled = std::abs(static_cast<double>(value)) * 1000.0;
+	if (!(scaled < 1e15)) {
+		char buffer[64];
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, 3);
+		output.append(buffer, result.ptr);
+		return;
+	}
+	auto integer = static_cast<uint64_t>(std::nearbyint(scaled));
+	if (std::signbit(value))
+		output += '-';
+	appendInteger(output, integer / 1000);
+	auto fraction = static_cast<int>(integer % 1000);
+	char digits[4] = { '.', static_cast<char>('0' + fraction / 100), static_cast<char>('0' + fraction / 10 % 10), static_cast<char>('0' + fraction % 10) };
+	output.append(digits, 4);
+}
+static void appendValue(std::string &output, int value) {
+	appendInteger(output, value);
+}
+static void appendValue(std::string &output, float value) {
+	appendFixed(output, value);
+}
+template<typename Value, typename... Values>
+static void appendValues(std::string &output, const char *separator, const char *suffix, Value value, Values... values) {
+	appendValue(output, value);
+	output += suffix;
+	((output += separator, appendValue(output, values), output += suffix), ...);
+}
 static float toQuality(size_t start, size_t end, size_t length) {
 	return 1.0f - static_cast<float>(std::atan(start) / math::PI) - static_cast<float>(std::atan(length - end) / math::PI);
 }
@@ -66,15 +112,12 @@ inline auto percentage(std::string_view &value) {
 	return sequence(save(number, value), single('%'));
 }
 const auto valueSeparator = oneOrMore(single({',', ';', '\t', ' '}));
-static std::string webHexSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[8];
+static void webHexSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	auto &c = colorObject.getColor();
-	if (options.upperCaseHex) {
-		std::snprintf(result, sizeof(result), "#%02X%02X%02X", toInteger(c.red), toInteger(c.green), toInteger(c.blue));
-	} else {
-		std::snprintf(result, sizeof(result), "#%02x%02x%02x", toInteger(c.red), toInteger(c.green), toInteger(c.blue));
-	}
-	return result;
+	output += '#';
+	appendHex(output, toInteger(c.red), options.upperCaseHex);
+	appendHex(output, toInteger(c.green), options.upperCaseHex);
+	appendHex(output, toInteger(c.blue), options.upperCaseHex);
 }
 static bool webHexDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view matched;
@@ -90,15 +133,13 @@ static bool webHexDeserialize(const char *value, ColorObject &colorObject, float
 	quality = toQuality(start - 1, end, std::string_view(value).length());
 	return true;
 }
-static std::string webHexWithAlphaSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[10];
+static void webHexWithAlphaSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	auto &c = colorObject.getColor();
-	if (options.upperCaseHex) {
-		std::snprintf(result, sizeof(result), "#%02X%02X%02X%02X", toInteger(c.red), toInteger(c.green), toInteger(c.blue), toInteger(c.alpha));
-	} else {
-		std::snprintf(result, sizeof(result), "#%02x%02x%02x%02x", toInteger(c.red), toInteger(c.green), toInteger(c.blue), toInteger(c.alpha));
-	}
-	return result;
+	output += '#';
+	appendHex(output, toInteger(c.red), options.upperCaseHex);
+	appendHex(output, toInteger(c.green), options.upperCaseHex);
+	appendHex(output, toInteger(c.blue), options.upperCaseHex);
+	appendHex(output, toInteger(c.alpha), options.upperCaseHex);
 }
 static bool webHexWithAlphaDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view matched;
@@ -114,15 +155,11 @@ static bool webHexWithAlphaDeserialize(const char *value, ColorObject &colorObje
 	quality = toQuality(start - 1, end, std::string_view(value).length());
 	return true;
 }
-static std::string webHexNoHashSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[7];
+static void webHexNoHashSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	auto &c = colorObject.getColor();
-	if (options.upperCaseHex) {
-		std::snprintf(result, sizeof(result), "%02X%02X%02X", toInteger(c.red), toInteger(c.green), toInteger(c.blue));
-	} else {
-		std::snprintf(result, sizeof(result), "%02x%02x%02x", toInteger(c.red), toInteger(c.green), toInteger(c.blue));
-	}
-	return result;
+	appendHex(output, toInteger(c.red), options.upperCaseHex);
+	appendHex(output, toInteger(c.green), options.upperCaseHex);
+	appendHex(output, toInteger(c.blue), options.upperCaseHex);
 }
 static bool webHexNoHashDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view matched;
@@ -138,15 +175,12 @@ static bool webHexNoHashDeserialize(const char *value, ColorObject &colorObject,
 	quality = toQuality(start, end, std::string_view(value).length());
 	return true;
 }
-static std::string webHexShortSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[5];
+static void webHexShortSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	auto &c = colorObject.getColor();
-	if (options.upperCaseHex) {
-		std::snprintf(result, sizeof(result), "#%X%X%X", toShortInteger(c.red), toShortInteger(c.green), toShortInteger(c.blue));
-	} else {
-		std::snprintf(result, sizeof(result), "#%x%x%x", toShortInteger(c.red), toShortInteger(c.green), toShortInteger(c.blue));
-	}
-	return result;
+	output += '#';
+	appendHexDigit(output, toShortInteger(c.red), options.upperCaseHex);
+	appendHexDigit(output, toShortInteger(c.green), options.upperCaseHex);
+	appendHexDigit(output, toShortInteger(c.blue), options.upperCaseHex);
 }
 static bool webHexShortDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view matched;
@@ -162,15 +196,13 @@ static bool webHexShortDeserialize(const char *value, ColorObject &colorObject,
 	quality = toQuality(start - 1, end, std::string_view(value).length());
 	return true;
 }
-static std::string webHexShortWithAlphaSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[6];
+static void webHexShortWithAlphaSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	auto &c = colorObject.getColor();
-	if (options.upperCaseHex) {
-		std::snprintf(result, sizeof(result), "#%X%X%X%X", toShortInteger(c.red), toShortInteger(c.green), toShortInteger(c.blue), toShortInteger(c.alpha));
-	} else {
-		std::snprintf(result, sizeof(result), "#%x%x%x%x", toShortInteger(c.red), toShortInteger(c.green), toShortInteger(c.blue), toShortInteger(c.alpha));
-	}
-	return result;
+	output += '#';
+	appendHexDigit(output, toShortInteger(c.red), options.upperCaseHex);
+	appendHexDigit(output, toShortInteger(c.green), options.upperCaseHex);
+	appendHexDigit(output, toShortInteger(c.blue), options.upperCaseHex);
+	appendHexDigit(output, toShortInteger(c.alpha), options.upperCaseHex);
 }
 static bool webHexShortWithAlphaDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view matched;
@@ -186,15 +218,15 @@ static bool webHexShortWithAlphaDeserialize(const char *value, ColorObject &colo
 	quality = toQuality(start - 1, end, std::string_view(value).length());
 	return true;
 }
-static std::string cssRgbSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[22];
+static void cssRgbSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	auto &c = colorObject.getColor();
+	output += "rgb(";
 	if (options.cssPercentages) {
-		std::snprintf(result, sizeof(result), "rgb(%d%%, %d%%, %d%%)", toPercentage(c.red), toPercentage(c.green), toPercentage(c.blue));
+		appendValues(output, ", ", "%", toPercentage(c.red), toPercentage(c.green), toPercentage(c.blue));
 	} else {
-		std::snprintf(result, sizeof(result), "rgb(%d, %d, %d)", toInteger(c.red), toInteger(c.green), toInteger(c.blue));
+		appendValues(output, ", ", "", toInteger(c.red), toInteger(c.green), toInteger(c.blue));
 	}
-	return result;
+	output += ')';
 }
 static bool cssRgbDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue;
@@ -211,23 +243,22 @@ static bool cssRgbDeserialize(const char *value, ColorObject &colorObject, float
 	quality = toQuality(start - 4, end, std::string_view(value).length());
 	return true;
 }
-static std::string cssRgbaSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[30];
+static void cssRgbaSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	auto &c = colorObject.getColor();
+	output += "rgba(";
+	if (options.cssPercentages) {
+		appendValues(output, ", ", "%", toPercentage(c.red), toPercentage(c.green), toPercentage(c.blue));
+	} else {
+		appendValues(output, ", ", "", toInteger(c.red), toInteger(c.green), toInteger(c.blue));
+	}
+	output += ", ";
 	if (options.cssAlphaPercentage) {
-		if (options.cssPercentages) {
-			std::snprintf(result, sizeof(result), "rgba(%d%%, %d%%, %d%%, %d%%)", toPercentage(c.red), toPercentage(c.green), toPercentage(c.blue), toPercentage(c.alpha));
-		} else {
-			std::snprintf(result, sizeof(result), "rgba(%d, %d, %d, %d%%)", toInteger(c.red), toInteger(c.green), toInteger(c.blue), toPercentage(c.alpha));
-		}
+		appendInteger(output, toPercentage(c.alpha));
+		output += '%';
 	} else {
-		if (options.cssPercentages) {
-			std::snprintf(result, sizeof(result), "rgba(%d%%, %d%%, %d%%, %0.3f)", toPercentage(c.red), toPercentage(c.green), toPercentage(c.blue), c.alpha);
-		} else {
-			std::snprintf(result, sizeof(result), "rgba(%d, %d, %d, %0.3f)", toInteger(c.red), toInteger(c.green), toInteger(c.blue), c.alpha);
-		}
+		appendFixed(output, c.alpha);
 	}
-	return result;
+	output += ')';
 }
 static bool cssRgbaDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue, alpha;
@@ -244,11 +275,13 @@ static bool cssRgbaDeserialize(const char *value, ColorObject &colorObject, floa
 	quality = toQuality(start - 5, end, std::string_view(value).length());
 	return true;
 }
-static std::string cssHslSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[21];
+static void cssHslSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	auto c = colorObject.getColor().rgbToHsl();
-	std::snprintf(result, sizeof(result), "hsl(%d, %d%%, %d%%)", toDegrees(c.hsl.hue), toPercentage(c.hsl.saturation), toPercentage(c.hsl.lightness));
-	return result;
+	output += "hsl(";
+	appendInteger(output, toDegrees(c.hsl.hue));
+	output += ", ";
+	appendValues(output, ", ", "%", toPercentage(c.hsl.saturation), toPercentage(c.hsl.lightness));
+	output += ')';
 }
 static bool cssHslDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view hue, saturation, lightness;
@@ -264,11 +297,15 @@ static bool cssHslDeserialize(const char *value, ColorObject &colorObject, float
 	quality = toQuality(start - 4, end, std::string_view(value).length());
 	return true;
 }
-static std::string cssHslaSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[29];
+static void cssHslaSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	auto c = colorObject.getColor().rgbToHsl();
-	std::snprintf(result, sizeof(result), "hsla(%d, %d%%, %d%%, %0.3f)", toDegrees(c.hsl.hue), toPercentage(c.hsl.saturation), toPercentage(c.hsl.lightness), c.alpha);
-	return result;
+	output += "hsla(";
+	appendInteger(output, toDegrees(c.hsl.hue));
+	output += ", ";
+	appendValues(output, ", ", "%", toPercentage(c.hsl.saturation), toPercentage(c.hsl.lightness));
+	output += ", ";
+	appendFixed(output, c.alpha);
+	output += ')';
 }
 static bool cssHslaDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view hue, saturation, lightness, alpha;
@@ -285,11 +322,9 @@ static bool cssHslaDeserialize(const char *value, ColorObject &colorObject, floa
 	quality = toQuality(start - 5, end, std::string_view(value).length());
 	return true;
 }
-static std::string csvRgbSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[18];
+static void csvRgbSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	auto &c = colorObject.getColor();
-	std::snprintf(result, sizeof(result), "%0.3f,%0.3f,%0.3f", c.red, c.green, c.blue);
-	return result;
+	appendValues(output, ",", "", c.red, c.green, c.blue);
 }
 static bool csvRgbDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue;
@@ -305,11 +340,9 @@ static bool csvRgbDeserialize(const char *value, ColorObject &colorObject, float
 	quality = toQuality(start, end, std::string_view(value).length());
 	return true;
 }
-static std::string csvRgbTabSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[18];
+static void csvRgbTabSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	auto &c = colorObject.getColor();
-	std::snprintf(result, sizeof(result), "%0.3f\t%0.3f\t%0.3f", c.red, c.green, c.blue);
-	return result;
+	appendValues(output, "\t", "", c.red, c.green, c.blue);
 }
 static bool csvRgbTabDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue;
@@ -325,11 +358,9 @@ static bool csvRgbTabDeserialize(const char *value, ColorObject &colorObject, fl
 	quality = toQuality(start, end, std::string_view(value).length());
 	return true;
 }
-static std::string csvRgbSemicolonSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[18];
+static void csvRgbSemicolonSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	auto &c = colorObject.getColor();
-	std::snprintf(result, sizeof(result), "%0.3f;%0.3f;%0.3f", c.red, c.green, c.blue);
-	return result;
+	appendValues(output, ";", "", c.red, c.green, c.blue);
 }
 static bool csvRgbSemicolonDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue;
@@ -345,11 +376,9 @@ static bool csvRgbSemicolonDeserialize(const char *value, ColorObject &colorObje
 	quality = toQuality(start, end, std::string_view(value).length());
 	return true;
 }
-static std::string csvRgbaSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[24];
+static void csvRgbaSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	auto &c = colorObject.getColor();
-	std::snprintf(result, sizeof(result), "%0.3f,%0.3f,%0.3f,%0.3f", c.red, c.green, c.blue, c.alpha);
-	return result;
+	appendValues(output, ",", "", c.red, c.green, c.blue, c.alpha);
 }
 static bool csvRgbaDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue, alpha;
@@ -365,11 +394,9 @@ static bool csvRgbaDeserialize(const char *value, ColorObject &colorObject, floa
 	quality = toQuality(start, end, std::string_view(value).length());
 	return true;
 }
-static std::string csvRgbaTabSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[24];
+static void csvRgbaTabSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	auto &c = colorObject.getColor();
-	std::snprintf(result, sizeof(result), "%0.3f\t%0.3f\t%0.3f\t%0.3f", c.red, c.green, c.blue, c.alpha);
-	return result;
+	appendValues(output, "\t", "", c.red, c.green, c.blue, c.alpha);
 }
 static bool csvRgbaTabDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue, alpha;
@@ -385,11 +412,9 @@ static bool csvRgbaTabDeserialize(const char *value, ColorObject &colorObject, f
 	quality = toQuality(start, end, std::string_view(value).length());
 	return true;
 }
-static std::string csvRgbaSemicolonSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[24];
+static void csvRgbaSemicolonSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	auto &c = colorObject.getColor();
-	std::snprintf(result, sizeof(result), "%0.3f;%0.3f;%0.3f;%0.3f", c.red, c.green, c.blue, c.alpha);
-	return result;
+	appendValues(output, ";", "", c.red, c.green, c.blue, c.alpha);
 }
 static bool csvRgbaSemicolonDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue, alpha;
@@ -405,11 +430,9 @@ static bool csvRgbaSemicolonDeserialize(const char *value, ColorObject &colorObj
 	quality = toQuality(start, end, std::string_view(value).length());
 	return true;
 }
-static std::string valueRgbSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[20];
+static void valueRgbSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	auto &c = colorObject.getColor();
-	std::snprintf(result, sizeof(result), "%0.3f, %0.3f, %0.3f", c.red, c.green, c.blue);
-	return result;
+	appendValues(output, ", ", "", c.red, c.green, c.blue);
 }
 static bool valueRgbDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue;
@@ -425,11 +448,9 @@ static bool valueRgbDeserialize(const char *value, ColorObject &colorObject, flo
 	quality = toQuality(start, end, std::string_view(value).length());
 	return true;
 }
-static std::string valueRgbaSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[27];
+static void valueRgbaSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	auto &c = colorObject.getColor();
-	std::snprintf(result, sizeof(result), "%0.3f, %0.3f, %0.3f, %0.3f", c.red, c.green, c.blue, c.alpha);
-	return result;
+	appendValues(output, ", ", "", c.red, c.green, c.blue, c.alpha);
 }
 static bool valueRgbaDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue, alpha;
@@ -445,80 +466,82 @@ static bool valueRgbaDeserialize(const char *value, ColorObject &colorObject, fl
 	quality = toQuality(start, end, std::string_view(value).length());
 	return true;
 }
-static std::string cssColorHexSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	return "color: " + webHexSerialize(colorObject, position, options);
+static void cssColorHexSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
+	output += "color: ";
+	webHexSerialize(colorObject, position, output, options);
 }
-static std::string cssBackgroundColorHexSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	return "background-color: " + webHexSerialize(colorObject, position, options);
+static void cssBackgroundColorHexSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
+	output += "background-color: ";
+	webHexSerialize(colorObject, position, output, options);
 }
-static std::string cssBorderColorHexSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	return "border-color: " + webHexSerialize(colorObject, position, options);
+static void cssBorderColorHexSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
+	output += "border-color: ";
+	webHexSerialize(colorObject, position, output, options);
 }
-static std::string cssBorderTopColorHexSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	return "border-top-color: " + webHexSerialize(colorObject, position, options);
+static void cssBorderTopColorHexSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
+	output += "border-top-color: ";
+	webHexSerialize(colorObject, position, output, options);
 }
-static std::string cssBorderRightColorHexSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	return "border-right-color: " + webHexSerialize(colorObject, position, options);
+static void cssBorderRightColorHexSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
+	output += "border-right-color: ";
+	webHexSerialize(colorObject, position, output, options);
 }
-static std::string cssBorderBottomColorHexSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	return "border-bottom-color: " + webHexSerialize(colorObject, position, options);
+static void cssBorderBottomColorHexSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
+	output += "border-bottom-color: ";
+	webHexSerialize(colorObject, position, output, options);
 }
-static std::string cssBorderLeftColorHexSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	return "border-left-color: " + webHexSerialize(colorObject, position, options);
+static void cssBorderLeftColorHexSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
+	output += "border-left-color: ";
+	webHexSerialize(colorObject, position, output, options);
 }
-static std::string cssBlockSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	std::string result;
-	result.reserve(100);
+static void cssBlockSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	if (position.first()) {
-		result += "/**\n * Generated by Gpick ";
-		result += version::versionFull;
-		result += '\n';
+		output += "/**\n * Generated by Gpick ";
+		output += version::versionFull;
+		output += '\n';
 	}
-	result += " * ";
-	result += colorObject.getName();
-	result += ": ";
-	result += webHexSerialize(colorObject, position, options);
-	result += ", ";
-	result += cssRgbSerialize(colorObject, position, options);
-	result += ", ";
-	result += cssHslSerialize(colorObject, position, options);
+	output += " * ";
+	output += colorObject.getName();
+	output += ": ";
+	webHexSerialize(colorObject, position, output, options);
+	output += ", ";
+	cssRgbSerialize(colorObject, position, output, options);
+	output += ", ";
+	cssHslSerialize(colorObject, position, output, options);
 	if (position.last()) {
-		result += "\n */";
+		output += "\n */";
 	}
-	return result;
 }
-static std::string cssBlockWithAlphaSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	std::string result;
-	result.reserve(100);
+static void cssBlockWithAlphaSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, std::string &output, const Options &options) {
 	if (position.first()) {
-		result += "/**\n * Generated by Gpick ";
-		result += version::versionFull;
-		result += '\n';
+		output += "/**\n * Generated by Gpick ";
+		output += version::versionFull;
+		output += '\n';
 	}
-	result += " * ";
-	result += colorObject.getName();
-	result += ": ";
-	result += webHexWithAlphaSerialize(colorObject, position, options);
-	result += ", ";
-	result += cssRgbaSerialize(colorObject, position, options);
-	result += ", ";
-	result += cssHslaSerialize(colorObject, position, options);
+	output += " * ";
+	output += colorObject.getName();
+	output += ": ";
+	webHexWithAlphaSerialize(colorObject, position, output, options);
+	output += ", ";
+	cssRgbaSerialize(colorObject, position, output, options);
+	output += ", ";
+	cssHslaSerialize(colorObject, position, output, options);
 	if (position.last()) {
-		result += "\n */";
+		output += "\n */";
 	}
-	return result;
 }
 }
 void addInternalConverters(Converters &converters, Converter::Options &options) {
-	converters.add("color_web_hex", _("Web: hex code"), Serialize(webHexSerialize, options), Deserialize(webHexDeserialize, options));
-	converters.add("color_web_hex_with_alpha", _("Web: hex code with alpha"), Serialize(webHexWithAlphaSerialize, options), Deserialize(webHexWithAlphaDeserialize, options));
-	converters.add("color_web_hex_no_hash", _("Web: hex code (no hash symbol)"), Serialize(webHexNoHashSerialize, options), Deserialize(webHexNoHashDeserialize, options));
-	converters.add("color_web_hex_short", _("Web: short hex code"), Serialize(webHexShortSerialize, options), Deserialize(webHexShortDeserialize, options));
-	converters.add("color_web_hex_short_with_alpha", _("Web: short hex code with alpha"), Serialize(webHexShortWithAlphaSerialize, options), Deserialize(webHexShortWithAlphaDeserialize, options));
-	converters.add("color_css_rgb", _("CSS: red green blue"), Serialize(cssRgbSerialize, options), Deserialize(cssRgbDeserialize, options));
-	converters.add("color_css_rgba", _("CSS: red green blue alpha"), Serialize(cssRgbaSerialize, options), Deserialize(cssRgbaDeserialize, options));
-	converters.add("color_css_hsl", _("CSS: hue saturation lightness"), Serialize(cssHslSerialize, options), Deserialize(cssHslDeserialize, options));
-	converters.add("color_css_hsla", _("CSS: hue saturation lightness alpha"), Serialize(cssHslaSerialize, options), Deserialize(cssHslaDeserialize, options));
+	using Features = ConverterInputFeatures;
+	converters.add("color_web_hex", _("Web: hex code"), Serialize(webHexSerialize, options), Deserialize(webHexDeserialize, options), Features::hash | Features::hexDigit);
+	converters.add("color_web_hex_with_alpha", _("Web: hex code with alpha"), Serialize(webHexWithAlphaSerialize, options), Deserialize(webHexWithAlphaDeserialize, options), Features::hash | Features::hexDigit);
+	converters.add("color_web_hex_no_hash", _("Web: hex code (no hash symbol)"), Serialize(webHexNoHashSerialize, options), Deserialize(webHexNoHashDeserialize, options), Features::hexDigit);
+	converters.add("color_web_hex_short", _("Web: short hex code"), Serialize(webHexShortSerialize, options), Deserialize(webHexShortDeserialize, options), Features::hash | Features::hexDigit);
+	converters.add("color_web_hex_short_with_alpha", _("Web: short hex code with alpha"), Serialize(webHexShortWithAlphaSerialize, options), Deserialize(webHexShortWithAlphaDeserialize, options), Features::hash | Features::hexDigit);
+	converters.add("color_css_rgb", _("CSS: red green blue"), Serialize(cssRgbSerialize, options), Deserialize(cssRgbDeserialize, options), Features::rgbFunction | Features::digit);
+	converters.add("color_css_rgba", _("CSS: red green blue alpha"), Serialize(cssRgbaSerialize, options), Deserialize(cssRgbaDeserialize, options), Features::rgbaFunction | Features::digit);
+	converters.add("color_css_hsl", _("CSS: hue saturation lightness"), Serialize(cssHslSerialize, options), Deserialize(cssHslDeserialize, options), Features::hslFunction | Features::digit);
+	converters.add("color_css_hsla", _("CSS: hue saturation lightness alpha"), Serialize(cssHslaSerialize, options), Deserialize(cssHslaDeserialize, options), Features::hslaFunction | Features::digit);
 	converters.add("css_color_hex", "CSS(color)", Serialize(cssColorHexSerialize, options), Deserialize());
 	converters.add("css_background_color_hex", "CSS(background-color)", Serialize(cssBackgroundColorHexSerialize, options), Deserialize());
 	converters.add("css_border_color_hex", "CSS(border-color)", Serialize(cssBorderColorHexSerialize, options), Deserialize());
@@ -528,12 +551,12 @@ void addInternalConverters(Converters &converters, Converter::Options &options)
 	converters.add("css_border_left_hex", "CSS(border-left-color)", Serialize(cssBorderLeftColorHexSerialize, options), Deserialize());
 	converters.add("color_css_block", _("CSS block"), Serialize(cssBlockSerialize, options), Deserialize());
 	converters.add("color_css_block_with_alpha", _("CSS block with alpha"), Serialize(cssBlockWithAlphaSerialize, options), Deserialize());
-	converters.add("csv_rgb", "CSV RGB", Serialize(csvRgbSerialize, options), Deserialize(csvRgbDeserialize, options));
-	converters.add("csv_rgb_tab", "CSV RGB "s + _("(tab separator)"), Serialize(csvRgbTabSerialize, options), Deserialize(csvRgbTabDeserialize, options));
-	converters.add("csv_rgb_semicolon", "CSV RGB "s + _("(semicolon separator)"), Serialize(csvRgbSemicolonSerialize, options), Deserialize(csvRgbSemicolonDeserialize, options));
-	converters.add("csv_rgba", "CSV RGBA", Serialize(csvRgbaSerialize, options), Deserialize(csvRgbaDeserialize, options));
-	converters.add("csv_rgba_tab", "CSV RGBA "s + _("(tab separator)"), Serialize(csvRgbaTabSerialize, options), Deserialize(csvRgbaTabDeserialize, options));
-	converters.add("csv_rgba_semicolon", "CSV RGBA "s + _("(semicolon separator)"), Serialize(csvRgbaSemicolonSerialize, options), Deserialize(csvRgbaSemicolonDeserialize, options));
-	converters.add("value_rgb", _("RGB values"), Serialize(valueRgbSerialize, options), Deserialize(valueRgbDeserialize, options));
-	converters.add("value_rgba", _("RGBA values"), Serialize(valueRgbaSerialize, options), Deserialize(valueRgbaDeserialize, options));
+	converters.add("csv_rgb", "CSV RGB", Serialize(csvRgbSerialize, options), Deserialize(csvRgbDeserialize, options), Features::digit);
+	converters.add("csv_rgb_tab", "CSV RGB "s + _("(tab separator)"), Serialize(csvRgbTabSerialize, options), Deserialize(csvRgbTabDeserialize, options), Features::digit);
+	converters.add("csv_rgb_semicolon", "CSV RGB "s + _("(semicolon separator)"), Serialize(csvRgbSemicolonSerialize, options), Deserialize(csvRgbSemicolonDeserialize, options), Features::digit);
+	converters.add("csv_rgba", "CSV RGBA", Serialize(csvRgbaSerialize, options), Deserialize(csvRgbaDeserialize, options), Features::digit);
+	converters.add("csv_rgba_tab", "CSV RGBA "s + _("(tab separator)"), Serialize(csvRgbaTabSerialize, options), Deserialize(csvRgbaTabDeserialize, options), Features::digit);
+	converters.add("csv_rgba_semicolon", "CSV RGBA "s + _("(semicolon separator)"), Serialize(csvRgbaSemicolonSerialize, options), Deserialize(csvRgbaSemicolonDeserialize, options), Features::digit);
+	converters.add("value_rgb", _("RGB values"), Serialize(valueRgbSerialize, options), Deserialize(valueRgbDeserialize, options), Features::digit);
+	converters.add("value_rgba", _("RGBA values"), Serialize(valueRgbaSerialize, options), Deserialize(valueRgbaDeserialize, options), Features::digit);
 }
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "PickerScheduler.h"
+// Time without changes before switching to low update rate, in microseconds.
+static const gint64 idleDelay = 500000;
+// Low update rate interval, in microseconds.
+static const gint64 idleInterval = 250000;
+// Frame times are not exact, so frames which come slightly earlier than the update interval are also used.
+static const gint64 frameTolerance = 2000;
+PickerScheduler::PickerScheduler(Update update):
+	m_update(update),
+	m_widget(nullptr),
+	m_interval(0),
+	m_lastUpdate(0),
+	m_lastChange(0),
+	m_timeoutId(0),
+	m_tickId(0),
+	m_mapHandler(0),
+	m_unmapHandler(0),
+	m_running(false),
+	m_idle(false) {
+}
+PickerScheduler::~PickerScheduler() {
+	stop();
+}
+void PickerScheduler::start(GtkWidget *widget, int refreshRate) {
+	stop();
+	if (refreshRate < 1)
+		refreshRate = 1;
+	m_widget = widget;
+	m_interval = G_USEC_PER_SEC / refreshRate;
+	m_lastUpdate = 0;
+	m_lastChange = g_get_monotonic_time();
+	m_running = true;
+	m_idle = false;
+#if GTK_MAJOR_VERSION >= 3
+	if (m_widget) {
+		m_mapHandler = g_signal_connect_after(G_OBJECT(m_widget), "map", G_CALLBACK(onMapChanged), this);
+		m_unmapHandler = g_signal_connect_after(G_OBJECT(m_widget), "unmap", G_CALLBACK(onMapChanged), this);
+	}
+#endif
+	schedule();
+}
+void PickerScheduler::stop() {
+	unschedule();
+#if GTK_MAJOR_VERSION >= 3
+	if (m_mapHandler > 0) {
+		g_signal_handler_disconnect(m_widget, m_mapHandler);
+		g_signal_handler_disconnect(m_widget, m_unmapHandler);
+		m_mapHandler = m_unmapHandler = 0;
+	}
+#endif
+	m_running = false;
+	m_widget = nullptr;
+}
+bool PickerScheduler::running() const {
+	return m_running;
+}
+void PickerScheduler::wake() {
+	if (!m_running)
+		return;
+	m_lastChange = g_get_monotonic_time();
+	if (!m_idle)
+		return;
+	m_idle = false;
+	unschedule();
+	schedule();
+}
+void PickerScheduler::schedule() {
+	if (m_idle) {
+		m_timeoutId = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, static_cast<guint>(idleInterval / 1000), (GSourceFunc)onTimeout, this, nullptr);
+		return;
+	}
+#if GTK_MAJOR_VERSION >= 3
+	if (m_widget && gtk_widget_get_mapped(m_widget)) {
+		m_tickId = gtk_widget_add_tick_callback(m_widget, (GtkTickCallback)onTick, this, nullptr);
+		return;
+	}
+#endif
+	m_timeoutId = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, static_cast<guint>(m_interval / 1000), (GSourceFunc)onTimeout, this, nullptr);
+}
+void PickerScheduler::unschedule() {
+	if (m_timeoutId > 0) {
+		g_source_remove(m_timeoutId);
+		m_timeoutId = 0;
+	}
+#if GTK_MAJOR_VERSION >= 3
+	if (m_tickId > 0) {
+		gtk_widget_remove_tick_callback(m_widget, m_tickId);
+		m_tickId = 0;
+	}
+#endif
+}
+bool PickerScheduler::update(gint64 now) {
+	m_lastUpdate = now;
+	if (m_update())
+		m_lastChange = now;
+	bool idle = now - m_lastChange > idleDelay;
+	if (idle == m_idle)
+		return false;
+	m_idle = idle;
+	return true;
+}
+gboolean PickerScheduler::onTimeout(PickerScheduler *scheduler) {
+	if (!scheduler->update(g_get_monotonic_time()))
+		return true;
+	scheduler->m_timeoutId = 0;
+	scheduler->schedule();
+	return false;
+}
+#if GTK_MAJOR_VERSION >= 3
+gboolean PickerScheduler::onTick(GtkWidget *widget, GdkFrameClock *frameClock, PickerScheduler *scheduler) {
+	gint64 now = gdk_frame_clock_get_frame_time(frameClock);
+	if (now - scheduler->m_lastUpdate + frameTolerance < scheduler->m_interval)
+		return true;
+	if (!scheduler->update(now))
+		return true;
+	scheduler->m_tickId = 0;
+	scheduler->schedule();
+	return false;
+}
+// Frame clock of unmapped widget does not run, so full rate updates switch between frame clock and timer when widget is mapped or unmapped.
+void PickerScheduler::onMapChanged(GtkWidget *widget, PickerScheduler *scheduler) {
+	if (scheduler->m_idle)
+		return;
+	scheduler->unschedule();
+	scheduler->schedule();
+}
+#endif
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include <gtk/gtk.h>
+#include <functional>
+
+/** \struct PickerScheduler
+ * \brief Calls screen picker update function while the picker is visible.
+ *
+ * Updates run at the configured refresh rate while the update function reports changes. When nothing changes for a while, updates slow down to a few per second, and return to full rate after the first change.
+ * With GTK3 full rate updates are driven by the frame clock of the widget, so they run in sync with drawing. While the widget is not mapped, frame clock does not run and a timer is used instead.
+ */
+struct PickerScheduler {
+	/** Update function, returns true when pointer position or picked color changed since the previous call. */
+	using Update = std::function<bool()>;
+	PickerScheduler(Update update);
+	~PickerScheduler();
+	/**
+	 * Start calling update function.
+	 * @param[in] widget Widget which frame clock is used for full rate updates.
+	 * @param[in] refreshRate Full update rate in updates per second.
+	 */
+	void start(GtkWidget *widget, int refreshRate);
+	void stop();
+	bool running() const;
+	/**
+	 * Return to full update rate, as if update function had reported a change.
+	 */
+	void wake();
+private:
+	Update m_update;
+	GtkWidget *m_widget;
+	gint64 m_interval, m_lastUpdate, m_lastChange;
+	guint m_timeoutId, m_tickId;
+	gulong m_mapHandler, m_unmapHandler;
+	bool m_running, m_idle;
+	void schedule();
+	void unschedule();
+	bool update(gint64 now);
+	static gboolean onTimeout(PickerScheduler *scheduler);
+#if GTK_MAJOR_VERSION >= 3
+	static gboolean onTick(GtkWidget *widget, GdkFrameClock *frameClock, PickerScheduler *scheduler);
+	static void onMapChanged(GtkWidget *widget, PickerScheduler *scheduler);
+#endif
+};
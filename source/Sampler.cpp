@@ -19,6 +19,7 @@
 #include "Sampler.h"
 #include "ScreenReader.h"
 #include <cmath>
+#include <vector>
 #include <gdk/gdk.h>
 
 struct Sampler {
@@ -26,6 +27,9 @@ struct Sampler {
 	SamplerFalloff falloff;
 	float (*falloff_fnc)(float distance);
 	ScreenReader *screen_reader;
+	// Falloff weights for every pixel in (2 * oversample + 1)^2 window, rebuilt when oversample or falloff changes.
+	std::vector<float> weights;
+	bool weightsValid;
 };
 static float sampler_falloff_none(float distance) {
 	return 1;
@@ -45,6 +49,7 @@ static float sampler_falloff_exponential(float distance) {
 struct Sampler *sampler_new(ScreenReader *screen_reader) {
 	Sampler *sampler = new Sampler;
 	sampler->oversample = 0;
+	sampler->weightsValid = false;
 	sampler_set_falloff(sampler, SamplerFalloff::none);
 	sampler->screen_reader = screen_reader;
 	return sampler;
@@ -54,6 +59,7 @@ void sampler_destroy(Sampler *sampler) {
 }
 void sampler_set_falloff(Sampler *sampler, SamplerFalloff falloff) {
 	sampler->falloff = falloff;
+	sampler->weightsValid = false;
 	switch (falloff) {
 	case SamplerFalloff::none:
 		sampler->falloff_fnc = sampler_falloff_none;
@@ -75,18 +81,31 @@ void sampler_set_falloff(Sampler *sampler, SamplerFalloff falloff) {
 	}
 }
 void sampler_set_oversample(Sampler *sampler, int oversample) {
+	if (sampler->oversample == oversample)
+		return;
 	sampler->oversample = oversample;
+	sampler->weightsValid = false;
 }
-static void getPixel(unsigned char *data, int stride, int x, int y, Color *color) {
-	unsigned char *p;
-	p = data + y * stride + x * 4;
-	color->rgb.red = p[2] * (1 / 255.0f);
-	color->rgb.green = p[1] * (1 / 255.0f);
-	color->rgb.blue = p[0] * (1 / 255.0f);
+static void updateWeights(Sampler *sampler) {
+	if (sampler->weightsValid)
+		return;
+	int oversample = sampler->oversample, size = 2 * oversample + 1;
+	sampler->weights.resize(size * size);
+	float max_distance = oversample ? static_cast<float>(1 / std::sqrt(2 * std::pow((double)oversample, 2))) : 0;
+	for (int y = -oversample; y <= oversample; ++y) {
+		for (int x = -oversample; x <= oversample; ++x) {
+			float f;
+			if (oversample && sampler->falloff_fnc) {
+				f = sampler->falloff_fnc(static_cast<float>(std::sqrt((double)(x * x + y * y)) * max_distance));
+			} else {
+				f = 1;
+			}
+			sampler->weights[(y + oversample) * size + x + oversample] = f;
+		}
+	}
+	sampler->weightsValid = true;
 }
 int sampler_get_color_sample(Sampler *sampler, math::Vector2i &pointer, math::Rectangle<int> &screen_rect, math::Vector2i &offset, Color *color) {
-	Color sample, result = { 0.0f };
-	float divider = 0;
 	cairo_surface_t *surface = screen_reader_get_surface(sampler->screen_reader);
 	int x = pointer.x, y = pointer.y;
 	int left, right, top, bottom;
@@ -94,32 +113,33 @@ int sampler_get_color_sample(Sampler *sampler, math::Vector2i &pointer, math::Re
 	right = math::min(screen_rect.getRight(), x + sampler->oversample + 1);
 	top = math::max(screen_rect.getTop(), y - sampler->oversample);
 	bottom = math::min(screen_rect.getBottom(), y + sampler->oversample + 1);
-	int width = right - left;
-	int height = bottom - top;
-	int center_x = x - left;
-	int center_y = y - top;
-	float max_distance = static_cast<float>(1 / std::sqrt(2 * std::pow((double)sampler->oversample, 2)));
+	*color = Color(0.0f, 0.0f, 0.0f, 1.0f);
+	if (left >= right || top >= bottom)
+		return 0;
 	unsigned char *data = cairo_image_surface_get_data(surface);
 	int stride = cairo_image_surface_get_stride(surface);
-	for (int x = -sampler->oversample; x <= sampler->oversample; ++x) {
-		for (int y = -sampler->oversample; y <= sampler->oversample; ++y) {
-			if ((center_x + x < 0) || (center_y + y < 0)) continue;
-			if ((center_x + x >= width) || (center_y + y >= height)) continue;
-			getPixel(data, stride, offset.x + center_x + x, offset.y + center_y + y, &sample);
-			float f;
-			if (sampler->oversample) {
-				f = sampler->falloff_fnc(static_cast<float>(std::sqrt((double)(x * x + y * y)) * max_distance));
-			} else {
-				f = 1;
-			}
-			result += sample * f;
+	// Window in surface coordinates.
+	int surfaceLeft = offset.x, surfaceTop = offset.y;
+	updateWeights(sampler);
+	int size = 2 * sampler->oversample + 1;
+	float red = 0, green = 0, blue = 0, divider = 0;
+	for (int sy = top; sy < bottom; ++sy) {
+		const float *weights = sampler->weights.data() + (sy - y + sampler->oversample) * size + (left - x + sampler->oversample);
+		const unsigned char *p = data + (surfaceTop + sy - top) * stride + surfaceLeft * 4;
+		for (int sx = left; sx < right; ++sx, p += 4, ++weights) {
+			float f = *weights;
+			red += p[2] * f;
+			green += p[1] * f;
+			blue += p[0] * f;
 			divider += f;
 		}
 	}
-	if (divider > 0)
-		result *= 1 / divider;
-	result.alpha = 1;
-	*color = result;
+	if (divider > 0) {
+		divider = 1 / (255.0f * divider);
+		color->rgb.red = red * divider;
+		color->rgb.green = green * divider;
+		color->rgb.blue = blue * divider;
+	}
 	return 0;
 }
 SamplerFalloff sampler_get_falloff(Sampler *sampler) {
@@ -19,21 +19,59 @@
 #include "ScreenReader.h"
 #include <gtk/gtk.h>
 #include <algorithm>
+#include <cstring>
 #include <iostream>
+// Reused surface content is considered up to date for this long, after that the whole read area is copied again.
+static const gint64 maxContentAge = 100000;
 struct ScreenReader {
 	cairo_surface_t *surface;
 	int maxSize;
 	GdkScreen *screen;
 	math::Rectangle<int> readArea;
+	GdkScreen *rootScreen;
+	cairo_t *rootCairo;
+	gulong sizeChangedHandler, monitorsChangedHandler;
+	math::Rectangle<int> surfaceArea;
+	gint64 captureTime;
+	uint64_t generation;
+	ScreenReaderStatistics statistics;
+	gint64 rateTime;
+	uint64_t rateCaptures;
 };
 struct ScreenReader *screen_reader_new() {
 	ScreenReader *screen = new ScreenReader;
 	screen->maxSize = 0;
 	screen->surface = 0;
 	screen->screen = 0;
+	screen->rootScreen = 0;
+	screen->rootCairo = 0;
+	screen->sizeChangedHandler = 0;
+	screen->monitorsChangedHandler = 0;
+	screen->captureTime = 0;
+	screen->generation = 0;
+	screen->statistics = ScreenReaderStatistics();
+	screen->rateTime = g_get_monotonic_time();
+	screen->rateCaptures = 0;
 	return screen;
 }
+// Root window surface has the size of the screen at the time it was created, so it is dropped when screen size or monitor layout changes.
+static void releaseRootCairo(ScreenReader *screen) {
+	if (screen->rootScreen) {
+		g_signal_handler_disconnect(screen->rootScreen, screen->sizeChangedHandler);
+		g_signal_handler_disconnect(screen->rootScreen, screen->monitorsChangedHandler);
+		screen->rootScreen = 0;
+	}
+	if (screen->rootCairo) {
+		cairo_destroy(screen->rootCairo);
+		screen->rootCairo = 0;
+	}
+	screen->surfaceArea = math::Rectangle<int>();
+}
+static void onScreenChanged(GdkScreen *gdkScreen, ScreenReader *screen) {
+	releaseRootCairo(screen);
+}
 void screen_reader_destroy(ScreenReader *screen) {
+	releaseRootCairo(screen);
 	if (screen->surface) cairo_surface_destroy(screen->surface);
 	delete screen;
 }
@@ -49,35 +87,109 @@ void screen_reader_reset_rect(ScreenReader *screen) {
 	screen->readArea = math::Rectangle<int>();
 	screen->screen = NULL;
 }
+static bool updateRootCairo(ScreenReader *screen) {
+	if (screen->rootCairo && screen->rootScreen == screen->screen)
+		return true;
+	releaseRootCairo(screen);
+	GdkWindow *rootWindow = gdk_screen_get_root_window(screen->screen);
+	cairo_t *rootCairo = gdk_cairo_create(rootWindow);
+	if (cairo_surface_status(cairo_get_target(rootCairo)) != CAIRO_STATUS_SUCCESS) {
+		cairo_destroy(rootCairo);
+		return false;
+	}
+	screen->rootCairo = rootCairo;
+	screen->rootScreen = screen->screen;
+	screen->sizeChangedHandler = g_signal_connect(G_OBJECT(screen->rootScreen), "size-changed", G_CALLBACK(onScreenChanged), screen);
+	screen->monitorsChangedHandler = g_signal_connect(G_OBJECT(screen->rootScreen), "monitors-changed", G_CALLBACK(onScreenChanged), screen);
+	return true;
+}
+// Move surface content of previous capture to the position of the same screen pixels in the current read area.
+static void moveContent(ScreenReader *screen, const math::Rectangle<int> &overlap) {
+	cairo_surface_flush(screen->surface);
+	unsigned char *data = cairo_image_surface_get_data(screen->surface);
+	int stride = cairo_image_surface_get_stride(screen->surface);
+	int sourceX = overlap.getLeft() - screen->surfaceArea.getLeft(), sourceY = overlap.getTop() - screen->surfaceArea.getTop();
+	int targetX = overlap.getLeft() - screen->readArea.getLeft(), targetY = overlap.getTop() - screen->readArea.getTop();
+	size_t rowSize = overlap.getWidth() * 4;
+	auto moveRow = [&](int y) {
+		std::memmove(data + (targetY + y) * stride + targetX * 4, data + (sourceY + y) * stride + sourceX * 4, rowSize);
+	};
+	if (targetY <= sourceY) {
+		for (int y = 0; y < overlap.getHeight(); y++)
+			moveRow(y);
+	} else {
+		for (int y = overlap.getHeight() - 1; y >= 0; y--)
+			moveRow(y);
+	}
+	cairo_surface_mark_dirty(screen->surface);
+}
+static void copyArea(ScreenReader *screen, cairo_t *cr, cairo_surface_t *rootSurface, const math::Rectangle<int> &rect) {
+	if (rect.isEmpty())
+		return;
+	cairo_surface_mark_dirty_rectangle(rootSurface, rect.getLeft(), rect.getTop(), rect.getWidth(), rect.getHeight());
+	cairo_rectangle(cr, rect.getLeft() - screen->readArea.getLeft(), rect.getTop() - screen->readArea.getTop(), rect.getWidth(), rect.getHeight());
+	cairo_fill(cr);
+	screen->statistics.bytesCopied += static_cast<uint64_t>(rect.getWidth()) * rect.getHeight() * 4;
+}
+static void updateRate(ScreenReader *screen, gint64 now) {
+	if (now - screen->rateTime < G_USEC_PER_SEC)
+		return;
+	screen->statistics.capturesPerSecond = static_cast<float>((screen->statistics.captures - screen->rateCaptures) * G_USEC_PER_SEC) / (now - screen->rateTime);
+	screen->rateTime = now;
+	screen->rateCaptures = screen->statistics.captures;
+}
 void screen_reader_update_surface(ScreenReader *screen, math::Rectangle<int> *updateRect) {
 	if (!screen->screen) return;
-	int left = screen->readArea.getX();
-	int top = screen->readArea.getY();
 	int width = screen->readArea.getWidth();
 	int height = screen->readArea.getHeight();
 	if (width > screen->maxSize || height > screen->maxSize) {
 		if (screen->surface) cairo_surface_destroy(screen->surface);
 		screen->maxSize = (std::max(width, height) / 150 + 1) * 150;
 		screen->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, screen->maxSize, screen->maxSize);
+		screen->surfaceArea = math::Rectangle<int>();
 	}
-	GdkWindow *rootWindow = gdk_screen_get_root_window(screen->screen);
-	cairo_t *rootCairo = gdk_cairo_create(rootWindow);
-	cairo_surface_t *rootSurface = cairo_get_target(rootCairo);
-	if (cairo_surface_status(rootSurface) != CAIRO_STATUS_SUCCESS) {
+	if (!updateRootCairo(screen)) {
 		std::cerr << "can not get root window surface" << std::endl;
 		return;
 	}
-	cairo_surface_mark_dirty_rectangle(rootSurface, left, top, width, height);
+	*updateRect = screen->readArea;
+	gint64 now = g_get_monotonic_time();
+	updateRate(screen, now);
+	bool recent = !screen->surfaceArea.isEmpty() && now - screen->captureTime < maxContentAge;
+	if (recent && screen->surfaceArea == screen->readArea) {
+		screen->statistics.skipped++;
+		return;
+	}
+	cairo_surface_t *rootSurface = cairo_get_target(screen->rootCairo);
 	cairo_t *cr = cairo_create(screen->surface);
 	cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
-	cairo_set_source_surface(cr, rootSurface, -left, -top);
+	cairo_set_source_surface(cr, rootSurface, -screen->readArea.getLeft(), -screen->readArea.getTop());
 	cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_NEAREST);
-	cairo_rectangle(cr, 0, 0, width, height);
-	cairo_fill(cr);
+	math::Rectangle<int> overlap = recent ? screen->surfaceArea.intersect(screen->readArea) : math::Rectangle<int>();
+	if (overlap.isEmpty()) {
+		copyArea(screen, cr, rootSurface, screen->readArea);
+		screen->captureTime = now;
+	} else {
+		// Keep the content of overlapping area and only copy bands which were not visible in the previous capture.
+		// Capture time is not changed, so the whole area is copied again when the overlapping content gets too old.
+		moveContent(screen, overlap);
+		const auto &area = screen->readArea;
+		copyArea(screen, cr, rootSurface, math::Rectangle<int>(area.getLeft(), area.getTop(), area.getRight(), overlap.getTop()).intersect(area));
+		copyArea(screen, cr, rootSurface, math::Rectangle<int>(area.getLeft(), overlap.getBottom(), area.getRight(), area.getBottom()).intersect(area));
+		copyArea(screen, cr, rootSurface, math::Rectangle<int>(area.getLeft(), overlap.getTop(), overlap.getLeft(), overlap.getBottom()).intersect(area));
+		copyArea(screen, cr, rootSurface, math::Rectangle<int>(overlap.getRight(), overlap.getTop(), area.getRight(), overlap.getBottom()).intersect(area));
+	}
 	cairo_destroy(cr);
-	cairo_destroy(rootCairo);
-	*updateRect = screen->readArea;
+	screen->surfaceArea = screen->readArea;
+	screen->generation++;
+	screen->statistics.captures++;
 }
 cairo_surface_t *screen_reader_get_surface(ScreenReader *screen) {
 	return screen->surface;
 }
+uint64_t screen_reader_get_generation(ScreenReader *screen) {
+	return screen->generation;
+}
+const ScreenReaderStatistics &screen_reader_get_statistics(ScreenReader *screen) {
+	return screen->statistics;
+}
@@ -21,11 +21,38 @@
 #include <gdk/gdk.h>
 #include <cairo/cairo.h>
 #include "math/Rectangle.h"
+#include <cstdint>
 struct ScreenReader;
+/** \struct ScreenReaderStatistics
+ * \brief Screen capture counters.
+ */
+struct ScreenReaderStatistics {
+	/** Number of surface updates which copied screen content. */
+	uint64_t captures;
+	/** Number of surface updates skipped because read area did not change and surface content was recent. */
+	uint64_t skipped;
+	/** Number of bytes copied from the screen. */
+	uint64_t bytesCopied;
+	/** Captures per second, measured over the last second of updates. */
+	float capturesPerSecond;
+};
 ScreenReader *screen_reader_new();
 void screen_reader_reset_rect(ScreenReader *screen);
 void screen_reader_add_rect(ScreenReader *screen, GdkScreen *gdkScreen, math::Rectangle<int> &rect);
 void screen_reader_update_surface(ScreenReader *screen, math::Rectangle<int> *updateRect);
 cairo_surface_t *screen_reader_get_surface(ScreenReader *screen);
+/**
+ * Get surface generation number, which changes every time the surface content is updated.
+ * Callers can use it to reuse data derived from the surface until the next update.
+ * @param[in] screen Screen reader.
+ * @return Generation number.
+ */
+uint64_t screen_reader_get_generation(ScreenReader *screen);
+/**
+ * Get screen capture counters.
+ * @param[in] screen Screen reader.
+ * @return Counters.
+ */
+const ScreenReaderStatistics &screen_reader_get_statistics(ScreenReader *screen);
 void screen_reader_destroy(ScreenReader *screen);
 #endif /* GPICK_SCREEN_READER_H_ */
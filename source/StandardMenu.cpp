@@ -23,6 +23,7 @@
 #include "Converter.h"
 #include "GlobalState.h"
 #include "ColorList.h"
+#include "ColorBatch.h"
 #include "uiUtilities.h"
 #include "uiColorInput.h"
 #include "I18N.h"
@@ -31,7 +32,9 @@
 #include "common/Unused.h"
 #include "IMenuExtension.h"
 #include <gdk/gdkkeysyms.h>
-#include <map>
+#include <algorithm>
+#include <numeric>
+#include <vector>
 
 struct CopyMenuItemState {
 	CopyMenuItemState(Converter *converter, const ColorObject &colorObject, GlobalState &gs):
@@ -133,16 +136,23 @@ GtkWidget *StandardMenu::newMenu(const ColorObject &colorObject, IReadonlyColorU
 }
 GtkWidget *StandardMenu::newNearestColorsMenu(const ColorObject &colorObject, GlobalState *gs) {
 	GtkWidget *menu = gtk_menu_new();
-	std::multimap<float, ColorObject *> colorDistances;
-	Color sourceColor = colorObject.getColor().rgbToLabD50();
-	for (auto *colorObject: gs->colorList()) {
-		Color targetColor = colorObject->getColor().rgbToLabD50();
-		colorDistances.insert(std::pair<float, ColorObject *>(Color::distanceLch(sourceColor, targetColor), colorObject));
-	}
-	int count = 0;
-	for (auto item: colorDistances) {
-		gtk_menu_shell_append(GTK_MENU_SHELL(menu), newItem(*item.second, gs, true));
-		if (++count >= 3) break;
+	auto &colorList = gs->colorList();
+	ColorBatch colors(colorList.size());
+	size_t index = 0;
+	for (auto *colorObject: colorList)
+		colors.set(index++, colorObject->getColor());
+	colors.rgbToLabD50(colors);
+	std::vector<float> distances(colors.size());
+	colors.distanceLch(colorObject.getColor(ColorSpace::lab), distances.data());
+	std::vector<size_t> order(colors.size());
+	std::iota(order.begin(), order.end(), 0);
+	auto count = std::min<size_t>(order.size(), 3);
+	std::partial_sort(order.begin(), order.begin() + count, order.end(), [&distances](size_t a, size_t b) {
+		return distances[a] < distances[b] || (distances[a] == distances[b] && a < b);
+	});
+	auto colorObjects = colorList.begin();
+	for (size_t i = 0; i < count; i++) {
+		gtk_menu_shell_append(GTK_MENU_SHELL(menu), newItem(*colorObjects[order[i]], gs, true));
 	}
 	return menu;
 }
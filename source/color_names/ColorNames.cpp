@@ -22,31 +22,184 @@
 #include "Color.h"
 #include "Paths.h"
 #include "dynv/Map.h"
-#include <string.h>
+#include "math/ColorIndex.h"
+#include <glib.h>
 #include <sstream>
 #include <fstream>
-#include <functional>
-#include <list>
+#include <filesystem>
+#include <cstring>
+#include <memory>
 #include <algorithm>
-#include <map>
+#include <iostream>
+#include <tuple>
 using namespace std;
 
-struct ColorNameEntry
+/** Names, colors and search index of a single dictionary file or color list. */
+struct ColorDictionary
 {
-	std::string name;
+	ColorDictionary():
+		mappedFile(nullptr),
+		mappedNames(nullptr)
+	{
+	}
+	~ColorDictionary()
+	{
+		if (mappedFile)
+			g_mapped_file_unref(mappedFile);
+	}
+	const char *name(uint32_t index) const
+	{
+		return (mappedNames ? mappedNames : ownNames.data()) + nameOffsets[index];
+	}
+	void add(const std::string &name, const Color &color)
+	{
+		index.add(color.rgbToLabD50(), static_cast<uint32_t>(colors.size()));
+		nameOffsets.push_back(static_cast<uint32_t>(ownNames.size()));
+		ownNames.insert(ownNames.end(), name.c_str(), name.c_str() + name.size() + 1);
+		colors.push_back(color);
+	}
+	GMappedFile *mappedFile;
+	const char *mappedNames;
+	std::vector<char> ownNames;
+	std::vector<uint32_t> nameOffsets;
+	std::vector<Color> colors;
+	math::ColorIndex index;
 };
-struct ColorEntry
+struct ColorNames
 {
-	Color color;
-	Color original_color;
-	ColorNameEntry* name;
+	std::vector<std::unique_ptr<ColorDictionary>> dictionaries;
 };
-const int SpaceDivisions = 8;
-struct ColorNames
+namespace {
+/** Compiled dictionary cache file header. All values are stored in native byte order, byteOrder field is used to reject caches written on other architectures. */
+struct CacheHeader
 {
-	std::list<ColorNameEntry*> names;
-	std::vector<ColorEntry*> colors[SpaceDivisions][SpaceDivisions][SpaceDivisions];
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint64_t sourceSize;
+	int64_t sourceModificationTime;
+	uint64_t sourcePathHash;
+	uint32_t count;
+	uint32_t namesSize;
+	uint64_t indexSize;
 };
+const char CacheMagic[8] = { 'G', 'P', 'C', 'N', 'A', 'M', 'E', 'S' };
+const uint32_t CacheVersion = 1;
+const uint32_t CacheByteOrder = 0x01020304;
+uint64_t hashString(const std::string &value)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (unsigned char c: value){
+		hash ^= c;
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+size_t alignSize(size_t size)
+{
+	return (size + 7) & ~size_t(7);
+}
+/** Source file properties stored in cache header. Cache is used only when they match current file. */
+bool getSourceProperties(const std::string &filename, CacheHeader &header, std::string &cacheFilename)
+{
+	namespace fs = std::filesystem;
+	std::error_code ec;
+	fs::path path = fs::absolute(fs::path(filename), ec);
+	if (ec)
+		return false;
+	auto size = fs::file_size(path, ec);
+	if (ec)
+		return false;
+	auto modificationTime = fs::last_write_time(path, ec);
+	if (ec)
+		return false;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+	header.version = CacheVersion;
+	header.byteOrder = CacheByteOrder;
+	header.sourceSize = size;
+	header.sourceModificationTime = modificationTime.time_since_epoch().count();
+	header.sourcePathHash = hashString(path.string());
+	char hashText[17];
+	g_snprintf(hashText, sizeof(hashText), "%016" G_GINT64_MODIFIER "x", static_cast<guint64>(header.sourcePathHash));
+	cacheFilename = (fs::path(buildConfigPath("color_dictionaries")) / (std::string(hashText) + ".cache")).string();
+	return true;
+}
+std::unique_ptr<ColorDictionary> loadCache(const std::string &cacheFilename, const CacheHeader &expectedHeader)
+{
+	GMappedFile *mappedFile = g_mapped_file_new(cacheFilename.c_str(), false, nullptr);
+	if (!mappedFile)
+		return nullptr;
+	auto dictionary = std::make_unique<ColorDictionary>();
+	dictionary->mappedFile = mappedFile;
+	auto data = reinterpret_cast<const uint8_t *>(g_mapped_file_get_contents(mappedFile));
+	size_t size = g_mapped_file_get_length(mappedFile);
+	CacheHeader header;
+	if (size < sizeof(header))
+		return nullptr;
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.magic, expectedHeader.magic, sizeof(header.magic)) != 0 || header.version != expectedHeader.version || header.byteOrder != expectedHeader.byteOrder)
+		return nullptr;
+	if (header.sourceSize != expectedHeader.sourceSize || header.sourceModificationTime != expectedHeader.sourceModificationTime || header.sourcePathHash != expectedHeader.sourcePathHash)
+		return nullptr;
+	size_t colorsSize = header.count * 4 * sizeof(float), offsetsSize = header.count * sizeof(uint32_t), namesSize = alignSize(header.namesSize);
+	if (size != sizeof(header) + colorsSize + offsetsSize + namesSize + header.indexSize)
+		return nullptr;
+	data += sizeof(header);
+	dictionary->colors.resize(header.count);
+	for (auto &color: dictionary->colors){
+		float values[4];
+		memcpy(values, data, sizeof(values));
+		color = Color(values[0], values[1], values[2], values[3]);
+		data += sizeof(values);
+	}
+	dictionary->nameOffsets.resize(header.count);
+	memcpy(dictionary->nameOffsets.data(), data, offsetsSize);
+	data += offsetsSize;
+	dictionary->mappedNames = reinterpret_cast<const char *>(data);
+	if (header.namesSize > 0 && dictionary->mappedNames[header.namesSize - 1] != 0)
+		return nullptr;
+	for (auto offset: dictionary->nameOffsets){
+		if (offset >= header.namesSize)
+			return nullptr;
+	}
+	data += namesSize;
+	if (!dictionary->index.load(data, header.indexSize) || dictionary->index.size() != header.count)
+		return nullptr;
+	return dictionary;
+}
+void saveCache(const std::string &cacheFilename, CacheHeader header, const ColorDictionary &dictionary)
+{
+	std::vector<uint8_t> data;
+	header.count = static_cast<uint32_t>(dictionary.colors.size());
+	header.namesSize = static_cast<uint32_t>(dictionary.ownNames.size());
+	size_t indexOffset = sizeof(header) + header.count * (4 * sizeof(float) + sizeof(uint32_t)) + alignSize(header.namesSize);
+	data.resize(indexOffset);
+	uint8_t *position = data.data() + sizeof(header);
+	for (const auto &color: dictionary.colors){
+		float values[4] = { color.red, color.green, color.blue, color.alpha };
+		memcpy(position, values, sizeof(values));
+		position += sizeof(values);
+	}
+	memcpy(position, dictionary.nameOffsets.data(), header.count * sizeof(uint32_t));
+	position += header.count * sizeof(uint32_t);
+	memcpy(position, dictionary.ownNames.data(), header.namesSize);
+	dictionary.index.save(data);
+	header.indexSize = data.size() - indexOffset;
+	memcpy(data.data(), &header, sizeof(header));
+	// only cache directory itself is created, so configuration directory is never created just for the cache, for example in batch mode
+	auto cacheDirectory = std::filesystem::path(cacheFilename).parent_path();
+	std::error_code ec;
+	std::filesystem::create_directory(cacheDirectory, ec);
+	if (!std::filesystem::is_directory(cacheDirectory, ec))
+		return;
+	GError *error = nullptr;
+	if (!g_file_set_contents(cacheFilename.c_str(), reinterpret_cast<const gchar *>(data.data()), data.size(), &error)){
+		std::cerr << "failed to save color dictionary cache \"" << cacheFilename << "\": " << error->message << std::endl;
+		g_error_free(error);
+	}
+}
+}
 ColorNames* color_names_new()
 {
 	ColorNames* color_names = new ColorNames;
@@ -54,20 +207,7 @@ ColorNames* color_names_new()
 }
 void color_names_clear(ColorNames *color_names)
 {
-	for (auto i = color_names->names.begin(); i != color_names->names.end(); i++){
-		delete *i;
-	}
-	color_names->names.clear();
-	for (int x = 0; x < SpaceDivisions; x++){
-		for (int y = 0; y < SpaceDivisions; y++){
-			for (int z = 0; z < SpaceDivisions; z++){
-				for (auto i = color_names->colors[x][y][z].begin(); i != color_names->colors[x][y][z].end(); ++i){
-					delete *i;
-				}
-				color_names->colors[x][y][z].clear();
-			}
-		}
-	}
+	color_names->dictionaries.clear();
 }
 static void color_names_strip_spaces(string& string_x, const string& strip_chars)
 {
@@ -81,136 +221,91 @@ static void color_names_strip_spaces(string& string_x, const string& strip_chars
 	}
 	string_x = string_x.substr(start_index, (end_index - start_index) + 1);
 }
-void color_names_normalize(const Color &color, Color &out)
-{
-	out.xyz.x = color.xyz.x / 100.0f;
-	out.xyz.y = (color.xyz.y + 86.1825f) / (86.1825f + 98.2346f);
-	out.xyz.z = (color.xyz.z + 107.86f) / (107.86f + 94.478f);
-}
-void color_names_get_color_xyz(ColorNames* color_names, Color* c, int* x1, int* y1, int* z1, int* x2, int* y2, int* z2)
+static unique_ptr<ColorDictionary> color_names_parse_file(const std::string &filename)
 {
-	*x1 = math::clamp(int(c->xyz.x / 100 * SpaceDivisions - 0.5), 0, SpaceDivisions - 1);
-	*y1 = math::clamp(int((c->xyz.y + 100) / 200 * SpaceDivisions - 0.5), 0, SpaceDivisions - 1);
-	*z1 = math::clamp(int((c->xyz.z + 100) / 200 * SpaceDivisions - 0.5), 0, SpaceDivisions - 1);
-	*x2 = math::clamp(int(c->xyz.x / 100 * SpaceDivisions + 0.5), 0, SpaceDivisions - 1);
-	*y2 = math::clamp(int((c->xyz.y + 100) / 200 * SpaceDivisions + 0.5), 0, SpaceDivisions - 1);
-	*z2 = math::clamp(int((c->xyz.z + 100) / 200 * SpaceDivisions + 0.5), 0, SpaceDivisions - 1);
-}
-static vector<ColorEntry*>* color_names_get_color_list(ColorNames* color_names, Color* c)
-{
-	int x,y,z;
-	x = math::clamp(int(c->xyz.x / 100 * SpaceDivisions), 0, SpaceDivisions - 1);
-	y = math::clamp(int((c->xyz.y + 100) / 200 * SpaceDivisions), 0, SpaceDivisions - 1);
-	z = math::clamp(int((c->xyz.z + 100) / 200 * SpaceDivisions), 0, SpaceDivisions - 1);
-	return &color_names->colors[x][y][z];
+	ifstream file(filename.c_str(), ifstream::in);
+	if (!file.is_open())
+		return nullptr;
+	auto dictionary = make_unique<ColorDictionary>();
+	string line;
+	stringstream rline (ios::in | ios::out);
+	Color color;
+	string name;
+	while (!(file.eof())){
+		getline(file, line);
+		if (line.empty()) continue;
+		if (line.at(0) == '!') continue;
+		rline.clear();
+		rline.str(line);
+		rline >> color.red >> color.green >> color.blue;
+		getline(rline, name);
+		const string strip_chars = " \t,.\n\r";
+		color_names_strip_spaces(name, strip_chars);
+		string::iterator i(name.begin());
+		if (i != name.end()){
+			name[0] = toupper((unsigned char)name[0]);
+			while(++i != name.end()){
+				*i = tolower((unsigned char)*i);
+			}
+			color *= 1 / 255.0f;
+			color.alpha = 1;
+			dictionary->add(name, color);
+		}
+	}
+	file.close();
+	dictionary->index.build();
+	return dictionary;
 }
 int color_names_load_from_file(ColorNames* color_names, const std::string &filename)
 {
-	ifstream file(filename.c_str(), ifstream::in);
-	if (file.is_open()){
-		string line;
-		stringstream rline (ios::in | ios::out);
-		Color color;
-		string name;
-		while (!(file.eof())){
-			getline(file, line);
-			if (line.empty()) continue;
-			if (line.at(0) == '!') continue;
-			rline.clear();
-			rline.str(line);
-			rline >> color.red >> color.green >> color.blue;
-			getline(rline, name);
-			const string strip_chars = " \t,.\n\r";
-			color_names_strip_spaces(name, strip_chars);
-			string::iterator i(name.begin());
-			if (i != name.end()){
-				name[0] = toupper((unsigned char)name[0]);
-				while(++i != name.end()){
-					*i = tolower((unsigned char)*i);
-				}
-				color *= 1 / 255.0f;
-				color.alpha = 1;
-				ColorNameEntry* name_entry = new ColorNameEntry;
-				name_entry->name = name;
-				color_names->names.push_back(name_entry);
-				ColorEntry* color_entry = new ColorEntry;
-				color_entry->name = name_entry;
-				color_entry->color = color.rgbToLabD50();
-				color_entry->original_color = color;
-				color_names_get_color_list(color_names, &color_entry->color)->push_back(color_entry);
-			}
+	CacheHeader header;
+	string cacheFilename;
+	bool cacheable = getSourceProperties(filename, header, cacheFilename);
+	if (cacheable){
+		auto dictionary = loadCache(cacheFilename, header);
+		if (dictionary){
+			color_names->dictionaries.push_back(std::move(dictionary));
+			return 0;
 		}
-		file.close();
-		return 0;
 	}
-	return -1;
+	auto dictionary = color_names_parse_file(filename);
+	if (!dictionary)
+		return -1;
+	if (cacheable)
+		saveCache(cacheFilename, header, *dictionary);
+	color_names->dictionaries.push_back(std::move(dictionary));
+	return 0;
 }
 void color_names_load_from_list(ColorNames *color_names, const ColorList &colorList)
 {
-	Color color;
+	auto dictionary = make_unique<ColorDictionary>();
+	dictionary->index.reserve(colorList.size());
 	for (auto *colorObject: colorList) {
-		ColorNameEntry* name_entry = new ColorNameEntry;
-		name_entry->name = colorObject->getName();
-		color_names->names.push_back(name_entry);
-		ColorEntry* color_entry = new ColorEntry;
-		color_entry->name = name_entry;
-		color = colorObject->getColor();
-		color_entry->color = color.rgbToLabD50();
-		color_entry->original_color = color;
-		color_names_get_color_list(color_names, &color_entry->color)->push_back(color_entry);
+		dictionary->add(colorObject->getName(), colorObject->getColor());
 	}
+	dictionary->index.build();
+	color_names->dictionaries.push_back(std::move(dictionary));
 }
 void color_names_destroy(ColorNames* color_names)
 {
 	color_names_clear(color_names);
 	delete color_names;
 }
-static void color_names_iterate(ColorNames* color_names, const Color* color, function<bool(ColorEntry*, float)> on_color, function<bool()> on_expansion)
-{
-	Color c1 = color->rgbToLabD50();
-	int x1, y1, z1, x2, y2, z2;
-	color_names_get_color_xyz(color_names, &c1, &x1, &y1, &z1, &x2, &y2, &z2);
-	char skip_mask[SpaceDivisions][SpaceDivisions][SpaceDivisions];
-	memset(&skip_mask, 0, sizeof(skip_mask));
-	/* Search expansion should be from 0 to SpaceDivisions, but this would only increase search time and return
-	 * wrong color names when no closely matching color is found. Search expansion is only useful
-	 * when color name database is very small (16 colors)
-	 */
-	for (int expansion = 0; expansion < SpaceDivisions - 1; ++expansion){
-		int x_start = std::max(x1 - expansion, 0), x_end = std::min(x2 + expansion, SpaceDivisions - 1);
-		int y_start = std::max(y1 - expansion, 0), y_end = std::min(y2 + expansion, SpaceDivisions - 1);
-		int z_start = std::max(z1 - expansion, 0), z_end = std::min(z2 + expansion, SpaceDivisions - 1);
-		for (int x_i = x_start; x_i <= x_end; ++x_i){
-			for (int y_i = y_start; y_i <= y_end; ++y_i){
-				for (int z_i = z_start; z_i <= z_end; ++z_i){
-					if (skip_mask[x_i][y_i][z_i]) continue; // skip checked items
-					skip_mask[x_i][y_i][z_i] = 1;
-					for (auto i = color_names->colors[x_i][y_i][z_i].begin(); i != color_names->colors[x_i][y_i][z_i].end(); ++i){
-						float delta = Color::distanceLch((*i)->color, c1);
-						if (!on_color(*i, delta)) return;
-					}
-				}
-			}
-		}
-		if (on_expansion && !on_expansion()) return;
-	}
-}
 string color_names_get(ColorNames* color_names, const Color* color, bool imprecision_postfix)
 {
-	float result_delta = 1e5;
-	ColorEntry* found_color_entry = nullptr;
-	color_names_iterate(color_names, color, [&](ColorEntry *color_entry, float delta){
-		if (delta < result_delta){
-			result_delta = delta;
-			found_color_entry = color_entry;
+	Color lab = color->rgbToLabD50();
+	const char *name = nullptr;
+	float result_delta = 0;
+	for (const auto &dictionary: color_names->dictionaries){
+		auto result = dictionary->index.findNearest(lab);
+		if (result && (!name || result->second < result_delta)){
+			name = dictionary->name(result->first);
+			result_delta = result->second;
 		}
-		return true;
-	}, [&](){
-		return found_color_entry == nullptr; // stop further expansion if we have found a match
-	});
-	if (found_color_entry){
+	}
+	if (name){
 		stringstream s;
-		s << found_color_entry->name->name;
+		s << name;
 		if (imprecision_postfix) if (result_delta > 0.1) s << " ~";
 		return s.str();
 	}
@@ -236,22 +331,28 @@ void color_names_load(ColorNames *color_names, const dynv::Map &params) {
 		}
 	}
 }
-void color_names_find_nearest(ColorNames *color_names, const Color &color, size_t count, std::vector<std::pair<const char*, Color>> &colors)
+/** Merge per dictionary results sorted by distance. Results with equal distances keep dictionary order. */
+static void color_names_merge(ColorNames *color_names, const vector<vector<math::ColorIndex::Result>> &results, size_t count, std::vector<std::pair<const char*, Color>> &colors)
 {
-	multimap<float, ColorEntry*> found_colors;
-	color_names_iterate(color_names, &color, [&](ColorEntry *color_entry, float delta){
-		found_colors.insert(pair<float, ColorEntry*>(delta, color_entry));
-		return true;
-	}, [&](){
-		return found_colors.size() < count;
+	vector<tuple<float, size_t, uint32_t>> found;
+	for (size_t i = 0; i < results.size(); i++){
+		for (const auto &result: results[i])
+			found.emplace_back(result.second, i, result.first);
+	}
+	stable_sort(found.begin(), found.end(), [](const tuple<float, size_t, uint32_t> &a, const tuple<float, size_t, uint32_t> &b){
+		return get<0>(a) < get<0>(b);
 	});
-	if (found_colors.size() >= count)
-		colors.resize(count);
-	else
-		colors.resize(found_colors.size());
-	size_t index = 0;
-	for (auto &item: found_colors){
-		if (index >= count) break;
-		colors[index++] = pair<const char*, Color>(item.second->name->name.c_str(), item.second->original_color);
+	colors.resize(std::min(count, found.size()));
+	for (size_t i = 0; i < colors.size(); i++){
+		const auto &dictionary = *color_names->dictionaries[get<1>(found[i])];
+		colors[i] = pair<const char*, Color>(dictionary.name(get<2>(found[i])), dictionary.colors[get<2>(found[i])]);
 	}
 }
+void color_names_find_nearest(ColorNames *color_names, const Color &color, size_t count, std::vector<std::pair<const char*, Color>> &colors)
+{
+	Color lab = color.rgbToLabD50();
+	vector<vector<math::ColorIndex::Result>> results(color_names->dictionaries.size());
+	for (size_t i = 0; i < results.size(); i++)
+		color_names->dictionaries[i]->index.findNearest(lab, count, results[i]);
+	color_names_merge(color_names, results, count, colors);
+}
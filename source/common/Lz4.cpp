@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Lz4.h"
+#include <cstring>
+#include <limits>
+namespace common {
+namespace lz4 {
+const size_t minMatch = 4;
+const size_t lastLiterals = 5; // last bytes of a block are always literals
+const size_t matchFindLimit = 12; // last match must start at least this far from block end
+const size_t maxOffset = 65535;
+const int hashBits = 12;
+static uint32_t load32(const uint8_t *data) {
+	uint32_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return value;
+}
+static uint32_t hash(uint32_t sequence) {
+	return (sequence * 2654435761u) >> (32 - hashBits);
+}
+size_t compressBound(size_t size) {
+	return size + size / 255 + 16;
+}
+uint64_t decompressBound(size_t size) {
+	return static_cast<uint64_t>(size) * 255 + 16;
+}
+namespace {
+struct Writer {
+	Writer(uint8_t *destination, size_t capacity):
+		m_position(destination),
+		m_end(destination + capacity) {
+	}
+	bool length(size_t value) {
+		while (value >= 255) {
+			if (!byte(255))
+				return false;
+			value -= 255;
+		}
+		return byte(static_cast<uint8_t>(value));
+	}
+	bool byte(uint8_t value) {
+		if (m_position == m_end)
+			return false;
+		*m_position++ = value;
+		return true;
+	}
+	bool bytes(const uint8_t *data, size_t size) {
+		if (static_cast<size_t>(m_end - m_position) < size)
+			return false;
+		if (size > 0)
+			std::memcpy(m_position, data, size);
+		m_position += size;
+		return true;
+	}
+	bool sequence(const uint8_t *literals, size_t literalLength, size_t offset, size_t matchLength) {
+		uint8_t token = static_cast<uint8_t>((literalLength < 15 ? literalLength : 15) << 4);
+		if (matchLength > 0) {
+			size_t length = matchLength - minMatch;
+			token |= static_cast<uint8_t>(length < 15 ? length : 15);
+		}
+		if (!byte(token))
+			return false;
+		if (literalLength >= 15 && !length(literalLength - 15))
+			return false;
+		if (!bytes(literals, literalLength))
+			return false;
+		if (matchLength == 0)
+			return true;
+		if (!byte(static_cast<uint8_t>(offset & 0xff)) || !byte(static_cast<uint8_t>(offset >> 8)))
+			return false;
+		if (matchLength - minMatch >= 15 && !length(matchLength - minMatch - 15))
+			return false;
+		return true;
+	}
+	uint8_t *m_position, *m_end;
+};
+}
+size_t compress(const uint8_t *source, size_t size, uint8_t *destination, size_t capacity) {
+	Writer writer(destination, capacity);
+	size_t anchor = 0;
+	if (size > matchFindLimit) {
+		const uint32_t empty = std::numeric_limits<uint32_t>::max();
+		uint32_t table[1 << hashBits];
+		for (auto &entry: table)
+			entry = empty;
+		const size_t matchLimit = size - lastLiterals;
+		const size_t searchLimit = size - matchFindLimit;
+		size_t position = 0;
+		while (position <= searchLimit) {
+			uint32_t sequence = load32(source + position);
+			uint32_t &entry = table[hash(sequence)];
+			size_t reference = entry;
+			entry = static_cast<uint32_t>(position);
+			if (reference == empty || position - reference > maxOffset || load32(source + reference) != sequence) {
+				position++;
+				continue;
+			}
+			size_t matchLength = minMatch;
+			while (position + matchLength < matchLimit && source[reference + matchLength] == source[position + matchLength])
+				matchLength++;
+			if (!writer.sequence(source + anchor, position - anchor, position - reference, matchLength))
+				return 0;
+			position += matchLength;
+			anchor = position;
+		}
+	}
+	if (!writer.sequence(source + anchor, size - anchor, 0, 0))
+		return 0;
+	return static_cast<size_t>(writer.m_position - destination);
+}
+bool decompress(const uint8_t *source, size_t size, uint8_t *destination, size_t decompressedSize) {
+	const uint8_t *input = source, *inputEnd = source + size;
+	uint8_t *output = destination, *outputEnd = destination + decompressedSize;
+	auto readLength = [&input, inputEnd](size_t &length) -> bool {
+		for (;;) {
+			if (input == inputEnd)
+				return false;
+			uint8_t value = *input++;
+			length += value;
+			if (value != 255)
+				return true;
+		}
+	};
+	while (input < inputEnd) {
+		uint8_t token = *input++;
+		size_t literalLength = token >> 4;
+		if (literalLength == 15 && !readLength(literalLength))
+			return false;
+		if (static_cast<size_t>(inputEnd - input) < literalLength || static_cast<size_t>(outputEnd - output) < literalLength)
+			return false;
+		if (literalLength > 0)
+			std::memcpy(output, input, literalLength);
+		input += literalLength;
+		output += literalLength;
+		if (input == inputEnd)
+			break; // last sequence has no match
+		if (inputEnd - input < 2)
+			return false;
+		size_t offset = input[0] | (static_cast<size_t>(input[1]) << 8);
+		input += 2;
+		if (offset == 0 || offset > static_cast<size_t>(output - destination))
+			return false;
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !readLength(matchLength))
+			return false;
+		matchLength += minMatch;
+		if (static_cast<size_t>(outputEnd - output) < matchLength)
+			return false;
+		const uint8_t *match = output - offset;
+		for (size_t i = 0; i < matchLength; i++) // byte by byte, as match may overlap output
+			output[i] = match[i];
+		output += matchLength;
+	}
+	return output == outputEnd;
+}
+}
+}
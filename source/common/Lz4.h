@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_COMMON_LZ4_H_
+#define GPICK_COMMON_LZ4_H_
+#include <cstddef>
+#include <cstdint>
+namespace common {
+namespace lz4 {
+/**
+ * Get maximum compressed size of a block.
+ * @param[in] size Uncompressed block size in bytes.
+ * @return Output buffer size which is always enough for compress().
+ */
+size_t compressBound(size_t size);
+/**
+ * Get maximum decompressed size of a valid block.
+ * Each compressed byte can expand to at most 255 bytes, so larger expected sizes show that block is damaged.
+ * @param[in] size Compressed block size in bytes.
+ * @return Largest decompressed size which compressed block of given size can have.
+ */
+uint64_t decompressBound(size_t size);
+/**
+ * Compress a block into LZ4 block format (without frame header).
+ * Fast greedy matcher, intended for small independent blocks.
+ * @param[in] source Uncompressed data.
+ * @param[in] size Uncompressed data size in bytes.
+ * @param[out] destination Output buffer.
+ * @param[in] capacity Output buffer size in bytes.
+ * @return Compressed size in bytes, or 0 when output does not fit into capacity.
+ */
+size_t compress(const uint8_t *source, size_t size, uint8_t *destination, size_t capacity);
+/**
+ * Decompress a block in LZ4 block format.
+ * Input is fully validated, so damaged or malicious data can not cause reads or writes outside of given buffers.
+ * @param[in] source Compressed data.
+ * @param[in] size Compressed data size in bytes.
+ * @param[out] destination Output buffer.
+ * @param[in] decompressedSize Exact expected decompressed size in bytes.
+ * @return True when block was decompressed and had exactly expected size.
+ */
+bool decompress(const uint8_t *source, size_t size, uint8_t *destination, size_t decompressedSize);
+}
+}
+#endif /* GPICK_COMMON_LZ4_H_ */
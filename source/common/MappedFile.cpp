@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "MappedFile.h"
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+namespace common {
+MappedFile::MappedFile():
+	m_data(nullptr),
+	m_size(0),
+	m_open(false)
+#if defined(_WIN32)
+	,
+	m_file(INVALID_HANDLE_VALUE),
+	m_mapping(nullptr)
+#endif
+{
+}
+MappedFile::~MappedFile() {
+	close();
+}
+#if defined(_WIN32)
+bool MappedFile::open(const char *filename) {
+	close();
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || static_cast<uint64_t>(size.QuadPart) > SIZE_MAX) {
+		CloseHandle(file);
+		return false;
+	}
+	m_file = file;
+	m_size = static_cast<size_t>(size.QuadPart);
+	m_open = true;
+	if (m_size == 0)
+		return true;
+	m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_mapping) {
+		close();
+		return false;
+	}
+	m_data = reinterpret_cast<const uint8_t *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!m_data) {
+		close();
+		return false;
+	}
+	return true;
+}
+void MappedFile::close() {
+	if (m_data)
+		UnmapViewOfFile(m_data);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+	if (m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+	m_data = nullptr;
+	m_mapping = nullptr;
+	m_file = INVALID_HANDLE_VALUE;
+	m_size = 0;
+	m_open = false;
+}
+#else
+bool MappedFile::open(const char *filename) {
+	close();
+	int file = ::open(filename, O_RDONLY | O_CLOEXEC);
+	if (file < 0)
+		return false;
+	struct stat status;
+	if (fstat(file, &status) != 0 || !S_ISREG(status.st_mode) || static_cast<uint64_t>(status.st_size) > SIZE_MAX) {
+		::close(file);
+		return false;
+	}
+	size_t size = static_cast<size_t>(status.st_size);
+	if (size > 0) {
+		void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (data == MAP_FAILED) {
+			::close(file);
+			return false;
+		}
+#if defined(POSIX_MADV_SEQUENTIAL)
+		posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+#endif
+		m_data = reinterpret_cast<const uint8_t *>(data);
+	}
+	::close(file); // mapping keeps its own reference to the file
+	m_size = size;
+	m_open = true;
+	return true;
+}
+void MappedFile::close() {
+	if (m_data)
+		munmap(const_cast<uint8_t *>(m_data), m_size);
+	m_data = nullptr;
+	m_size = 0;
+	m_open = false;
+}
+#endif
+bool MappedFile::isOpen() const {
+	return m_open;
+}
+const uint8_t *MappedFile::data() const {
+	return m_data;
+}
+size_t MappedFile::size() const {
+	return m_size;
+}
+}
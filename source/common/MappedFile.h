@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_COMMON_MAPPED_FILE_H_
+#define GPICK_COMMON_MAPPED_FILE_H_
+#include <cstddef>
+#include <cstdint>
+namespace common {
+/** \struct MappedFile
+ * \brief Read-only memory mapping of a whole file.
+ *
+ * File contents are paged in by the operating system on first access, so parsing code can work directly on file data without copying it into intermediate buffers.
+ * Mapping stays valid until close() is called or the object is destroyed.
+ */
+struct MappedFile {
+	MappedFile();
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+	~MappedFile();
+	/**
+	 * Map a file into memory. Previously mapped file is closed.
+	 * @param[in] filename File name.
+	 * @return True on success, false when file could not be opened or mapped.
+	 */
+	bool open(const char *filename);
+	void close();
+	bool isOpen() const;
+	/**
+	 * @return Pointer to the first byte of file data. Empty files have no data and return nullptr.
+	 */
+	const uint8_t *data() const;
+	size_t size() const;
+private:
+	const uint8_t *m_data;
+	size_t m_size;
+	bool m_open;
+#if defined(_WIN32)
+	void *m_file, *m_mapping;
+#endif
+};
+}
+#endif /* GPICK_COMMON_MAPPED_FILE_H_ */
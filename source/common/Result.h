@@ -94,6 +94,7 @@ template<typename BothT> struct Result<BothT, BothT> {
 	}
 	Result &operator=(const Result &) = delete;
 	Result &operator=(Result &&result) {
+		m_status = result.m_status;
 		m_value = std::move(result.m_value);
 		return *this;
 	}
@@ -137,6 +138,7 @@ template<typename ErrorT> struct Result<void, ErrorT> {
 	}
 	Result &operator=(const Result &) = delete;
 	Result &operator=(Result &&result) {
+		m_status = result.m_status;
 		m_error = std::move(result.m_error);
 		return *this;
 	}
@@ -174,6 +176,7 @@ template<typename ValueT> struct Result<ValueT, void> {
 	}
 	Result &operator=(const Result &) = delete;
 	Result &operator=(Result &&result) {
+		m_status = result.m_status;
 		m_value = std::move(result.m_value);
 		return *this;
 	}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SlabAllocator.h"
+#include <new>
+#include <stdexcept>
+#include <cstdint>
+namespace common {
+namespace {
+size_t alignUp(size_t value, size_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+}
+struct SlabAllocator::Slab {
+	Slab *previous, *next;
+	void *free;
+	char *unused;
+	size_t unusedCount, used;
+	bool linked;
+};
+SlabAllocator::SlabAllocator(size_t blockSize, size_t slabSize):
+	m_blockSize(alignUp(blockSize < sizeof(void *) ? sizeof(void *) : blockSize, alignof(std::max_align_t))),
+	m_slabSize(slabSize),
+	m_blocksOffset(alignUp(sizeof(Slab), alignof(std::max_align_t))),
+	m_available(nullptr),
+	m_slabs(0),
+	m_emptySlabs(0) {
+	if (slabSize == 0 || (slabSize & (slabSize - 1)) != 0)
+		throw std::invalid_argument("slab size must be a power of two");
+	if (m_blocksOffset + m_blockSize > slabSize)
+		throw std::invalid_argument("block does not fit into slab");
+	m_blocksPerSlab = (slabSize - m_blocksOffset) / m_blockSize;
+}
+SlabAllocator::~SlabAllocator() {
+	while (m_available) {
+		auto slab = m_available;
+		unlink(slab);
+		::operator delete(slab, std::align_val_t(m_slabSize));
+	}
+}
+SlabAllocator::Slab *SlabAllocator::newSlab() {
+	auto slab = static_cast<Slab *>(::operator new(m_slabSize, std::align_val_t(m_slabSize)));
+	slab->previous = slab->next = nullptr;
+	slab->free = nullptr;
+	slab->unused = reinterpret_cast<char *>(slab) + m_blocksOffset;
+	slab->unusedCount = m_blocksPerSlab;
+	slab->used = 0;
+	slab->linked = false;
+	m_slabs++;
+	m_emptySlabs++;
+	return slab;
+}
+void SlabAllocator::link(Slab *slab) {
+	slab->previous = nullptr;
+	slab->next = m_available;
+	if (m_available)
+		m_available->previous = slab;
+	m_available = slab;
+	slab->linked = true;
+}
+void SlabAllocator::unlink(Slab *slab) {
+	if (slab->previous)
+		slab->previous->next = slab->next;
+	else
+		m_available = slab->next;
+	if (slab->next)
+		slab->next->previous = slab->previous;
+	slab->previous = slab->next = nullptr;
+	slab->linked = false;
+}
+void *SlabAllocator::allocate() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_available)
+		link(newSlab());
+	auto slab = m_available;
+	void *block;
+	if (slab->free) {
+		block = slab->free;
+		slab->free = *static_cast<void **>(block);
+	} else {
+		block = slab->unused;
+		slab->unused += m_blockSize;
+		slab->unusedCount--;
+	}
+	if (slab->used++ == 0)
+		m_emptySlabs--;
+	if (!slab->free && slab->unusedCount == 0)
+		unlink(slab);
+	return block;
+}
+void SlabAllocator::deallocate(void *block) {
+	if (!block)
+		return;
+	auto slab = reinterpret_cast<Slab *>(reinterpret_cast<uintptr_t>(block) & ~static_cast<uintptr_t>(m_slabSize - 1));
+	std::lock_guard<std::mutex> lock(m_mutex);
+	*static_cast<void **>(block) = slab->free;
+	slab->free = block;
+	if (!slab->linked)
+		link(slab);
+	if (--slab->used != 0)
+		return;
+	if (m_emptySlabs == 0) {
+		m_emptySlabs++;
+		return;
+	}
+	unlink(slab);
+	::operator delete(slab, std::align_val_t(m_slabSize));
+	m_slabs--;
+}
+size_t SlabAllocator::blockSize() const {
+	return m_blockSize;
+}
+size_t SlabAllocator::slabCount() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_slabs;
+}
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef GPICK_COMMON_SLAB_ALLOCATOR_H_
+#define GPICK_COMMON_SLAB_ALLOCATOR_H_
+#include <mutex>
+#include <cstddef>
+namespace common {
+/** \struct SlabAllocator
+ * \brief Allocator of fixed size memory blocks.
+ *
+ * Blocks are taken from large slabs, so blocks allocated one after another are placed next to each other in memory and system allocator is used once per slab instead of once per block.
+ * Released blocks are reused before new slabs are allocated. Empty slabs are returned to system allocator, except one which is kept for reuse.
+ * Allocator is thread safe. All blocks must be released before allocator is destroyed.
+ */
+struct SlabAllocator {
+	/**
+	 * @param[in] blockSize Size of a single block in bytes.
+	 * @param[in] slabSize Size of a slab in bytes. Must be a power of two.
+	 * @throw std::invalid_argument When slab size is not a power of two or a block does not fit into a slab.
+	 */
+	SlabAllocator(size_t blockSize, size_t slabSize = 1 << 16);
+	SlabAllocator(const SlabAllocator &) = delete;
+	SlabAllocator &operator=(const SlabAllocator &) = delete;
+	~SlabAllocator();
+	/**
+	 * Allocate a block.
+	 * @return Block of blockSize() bytes aligned for any standard type.
+	 * @throw std::bad_alloc When a new slab can not be allocated.
+	 */
+	void *allocate();
+	/**
+	 * Release a block allocated by this allocator.
+	 * @param[in] block Block to release.
+	 */
+	void deallocate(void *block);
+	size_t blockSize() const;
+	size_t slabCount() const;
+private:
+	struct Slab;
+	size_t m_blockSize, m_slabSize, m_blocksOffset, m_blocksPerSlab;
+	Slab *m_available;
+	size_t m_slabs, m_emptySlabs;
+	mutable std::mutex m_mutex;
+	Slab *newSlab();
+	void link(Slab *slab);
+	void unlink(Slab *slab);
+};
+}
+#endif /* GPICK_COMMON_SLAB_ALLOCATOR_H_ */
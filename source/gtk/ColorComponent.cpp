@@ -41,6 +41,7 @@ struct GtkColorComponentPrivate {
 	ReferenceObserver labObserver;
 	cairo_surface_t *patternSurface;
 	cairo_pattern_t *pattern;
+	transformation::Chain *transformationChain;
 	const char *label[maxNumberOfChannels][2];
 	gchar *text[maxNumberOfChannels];
 	double range[maxNumberOfChannels];
@@ -158,6 +159,7 @@ GtkWidget *gtk_color_component_new(ColorSpace colorSpace) {
 	ns->labIlluminant = ReferenceIlluminant::D50;
 	ns->labObserver = ReferenceObserver::_2;
 	ns->outOfGamutMask = false;
+	ns->transformationChain = nullptr;
 #if GTK_MAJOR_VERSION >= 3
 	ns->pointerGrab = nullptr;
 #endif
@@ -201,15 +203,20 @@ const char *gtk_color_component_get_text(GtkColorComponent *colorComponent, gint
 }
 void gtk_color_component_set_texts(GtkColorComponent *colorComponent, const char **text) {
 	GtkColorComponentPrivate *ns = GET_PRIVATE(colorComponent);
+	bool changed = false;
 	for (int i = 0; i != sizeof(ns->text) / sizeof(gchar *); i++) {
 		if (!text[i])
 			break;
 		if (ns->text[i]) {
+			if (g_strcmp0(ns->text[i], text[i]) == 0)
+				continue;
 			g_free(ns->text[i]);
 		}
 		ns->text[i] = g_strdup(text[i]);
+		changed = true;
 	}
-	gtk_widget_queue_draw(GTK_WIDGET(colorComponent));
+	if (changed)
+		gtk_widget_queue_draw(GTK_WIDGET(colorComponent));
 }
 void gtk_color_component_set_labels(GtkColorComponent *colorComponent, const char **label) {
 	GtkColorComponentPrivate *ns = GET_PRIVATE(colorComponent);
@@ -222,6 +229,8 @@ void gtk_color_component_set_labels(GtkColorComponent *colorComponent, const cha
 }
 void gtk_color_component_set_color(GtkColorComponent *colorComponent, const Color &color) {
 	GtkColorComponentPrivate *ns = GET_PRIVATE(colorComponent);
+	Color previousColor = ns->color;
+	float previousAlpha = ns->alpha;
 	ns->originalColor = color;
 	ns->alpha = ns->originalColor.alpha;
 	switch (ns->colorSpace) {
@@ -246,13 +255,18 @@ void gtk_color_component_set_color(GtkColorComponent *colorComponent, const Colo
 		ns->color = ns->originalColor.rgbToLch(Color::getReference(ns->labIlluminant, ns->labObserver), Color::sRGBMatrix, adaptationMatrix);
 	} break;
 	}
-	gtk_widget_queue_draw(GTK_WIDGET(colorComponent));
+	if (ns->color != previousColor || ns->alpha != previousAlpha)
+		gtk_widget_queue_draw(GTK_WIDGET(colorComponent));
 }
 static void interpolateColors(Color *color1, Color *color2, float position, Color *result) {
 	result->rgb.red = color1->rgb.red * (1 - position) + color2->rgb.red * position;
 	result->rgb.green = color1->rgb.green * (1 - position) + color2->rgb.green * position;
 	result->rgb.blue = color1->rgb.blue * (1 - position) + color2->rgb.blue * position;
 }
+static Color labToRgbFast(const Color &color, const Color::Vector3f &referenceWhite, const Color::Matrix3d &adaptationMatrixInverted) {
+	Color xyz = color.labToXyz(referenceWhite).xyzChromaticAdaptation(adaptationMatrixInverted);
+	return Color(Color::sRGBInvertedMatrix * xyz.rgbVector<double>()).nonLinearRgbFastInplace();
+}
 #if GTK_MAJOR_VERSION >= 3
 #else
 static void onSizeRequest(GtkWidget *widget, GtkRequisition *requisition) {
@@ -431,7 +445,7 @@ static gboolean onDraw(GtkWidget *widget, cairo_t *cr) {
 			out_of_gamut[j] = std::vector<bool>(steps + 1, false);
 			for (i = 0; i <= steps; ++i) {
 				c[j][j] = static_cast<float>((i / static_cast<float>(steps)) * ns->range[j] + ns->offset[j]);
-				rgb_points[j * (steps + 1) + i] = c[j].labToRgb(Color::getReference(ns->labIlluminant, ns->labObserver), Color::sRGBInvertedMatrix, adaptationMatrix);
+				rgb_points[j * (steps + 1) + i] = labToRgbFast(c[j], Color::getReference(ns->labIlluminant, ns->labObserver), adaptationMatrix);
 				if (rgb_points[j * (steps + 1) + i].isOutOfRgbGamut()) {
 					out_of_gamut[j][i] = true;
 				}
@@ -470,7 +484,7 @@ static gboolean onDraw(GtkWidget *widget, cairo_t *cr) {
 			out_of_gamut[j] = std::vector<bool>(steps + 1, false);
 			for (i = 0; i <= steps; ++i) {
 				c[j][j] = static_cast<float>((i / static_cast<float>(steps)) * ns->range[j] + ns->offset[j]);
-				rgb_points[j * (steps + 1) + i] = c[j].lchToRgb(Color::getReference(ns->labIlluminant, ns->labObserver), Color::sRGBInvertedMatrix, adaptationMatrix);
+				rgb_points[j * (steps + 1) + i] = labToRgbFast(c[j].lchToLab(), Color::getReference(ns->labIlluminant, ns->labObserver), adaptationMatrix);
 				if (rgb_points[j * (steps + 1) + i].isOutOfRgbGamut()) {
 					out_of_gamut[j][i] = true;
 				}
@@ -506,6 +520,8 @@ static gboolean onDraw(GtkWidget *widget, cairo_t *cr) {
 	}
 	delete[] rgb_points;
 	cairo_surface_mark_dirty(surface);
+	if (ns->transformationChain)
+		ns->transformationChain->apply(surface);
 	cairo_save(cr);
 	int offset_x = get_x_offset(widget);
 	cairo_set_source_surface(cr, surface, offset_x, 0);
@@ -748,6 +764,11 @@ void gtk_color_component_set_lab_observer(GtkColorComponent *colorComponent, Ref
 	gtk_color_component_set_color(colorComponent, ns->originalColor);
 	gtk_widget_queue_draw(GTK_WIDGET(colorComponent));
 }
+void gtk_color_component_set_transformation_chain(GtkColorComponent *colorComponent, transformation::Chain *chain) {
+	GtkColorComponentPrivate *ns = GET_PRIVATE(colorComponent);
+	ns->transformationChain = chain;
+	gtk_widget_queue_draw(GTK_WIDGET(colorComponent));
+}
 void gtk_color_component_set_out_of_gamut_mask(GtkColorComponent *colorComponent, bool maskEnabled) {
 	GtkColorComponentPrivate *ns = GET_PRIVATE(colorComponent);
 	ns->outOfGamutMask = maskEnabled;
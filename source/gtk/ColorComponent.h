@@ -22,6 +22,7 @@
 #include <gtk/gtk.h>
 #include "Color.h"
 #include "ColorSpaces.h"
+#include "transformation/Chain.h"
 
 #define GTK_TYPE_COLOR_COMPONENT (gtk_color_component_get_type())
 #define GTK_COLOR_COMPONENT(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), GTK_TYPE_COLOR_COMPONENT, GtkColorComponent))
@@ -55,6 +56,7 @@ void gtk_color_component_set_lab_illuminant(GtkColorComponent *colorComponent, R
 void gtk_color_component_set_lab_observer(GtkColorComponent *colorComponent, ReferenceObserver observer);
 ColorSpace gtk_color_component_get_color_space(GtkColorComponent *colorComponent);
 void gtk_color_component_set_color_space(GtkColorComponent *colorComponent, ColorSpace colorSpace);
+void gtk_color_component_set_transformation_chain(GtkColorComponent *colorComponent, transformation::Chain *chain);
 int gtk_color_component_get_channel_at(GtkColorComponent *colorComponent, gint x, gint y);
 GType gtk_color_component_get_type();
 #endif /* GPICK_GTK_COLOR_COMPONENT_H_ */
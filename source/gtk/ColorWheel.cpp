@@ -43,6 +43,7 @@ struct GtkColorWheelPrivate {
 	bool block_editable;
 	const ColorWheelType *color_wheel_type;
 	cairo_surface_t *cache_color_wheel;
+	transformation::Chain *transformation_chain;
 #if GTK_MAJOR_VERSION >= 3
 	GdkDevice *pointer_grab;
 #endif
@@ -109,6 +110,7 @@ GtkWidget* gtk_color_wheel_new()
 	ns->block_editable = true;
 	ns->color_wheel_type = &color_wheel_types_get()[0];
 	ns->cache_color_wheel = 0;
+	ns->transformation_chain = nullptr;
 #if GTK_MAJOR_VERSION >= 3
 	ns->pointer_grab = nullptr;
 #endif
@@ -222,7 +224,7 @@ static void draw_dot(cairo_t *cr, double x, double y, double size)
 	cairo_set_line_width(cr, 1);
 	cairo_stroke(cr);
 }
-static void draw_sat_val_block(cairo_t *cr, double pos_x, double pos_y, double size, double hue)
+static void draw_sat_val_block(GtkColorWheelPrivate *ns, cairo_t *cr, double pos_x, double pos_y, double size, double hue)
 {
 	cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, static_cast<int>(std::ceil(size)), static_cast<int>(std::ceil(size)));
 	unsigned char *data = cairo_image_surface_get_data(surface);
@@ -246,6 +248,8 @@ static void draw_sat_val_block(cairo_t *cr, double pos_x, double pos_y, double s
 		}
 	}
 	cairo_surface_mark_dirty(surface);
+	if (ns->transformation_chain)
+		ns->transformation_chain->apply(surface);
 	cairo_save(cr);
 	cairo_set_source_surface(cr, surface, pos_x - size / 2, pos_y - size / 2);
 	cairo_surface_destroy(surface);
@@ -291,6 +295,10 @@ static void draw_wheel(GtkColorWheelPrivate *ns, cairo_t *cr, double radius, dou
 				line_data += 4;
 			}
 		}
+		cairo_surface_mark_dirty(surface);
+		// cached wheel is filtered once, cache is dropped when transformation chain is set again
+		if (ns->transformation_chain)
+			ns->transformation_chain->apply(surface);
 		ns->cache_color_wheel = surface;
 	}
 	cairo_surface_mark_dirty(surface);
@@ -377,7 +385,7 @@ static gboolean draw(GtkWidget *widget, cairo_t *cr)
 		double block_size = 2 * (ns->radius - ns->circle_width) * sin(math::PI / 4) - 6;
 		Color hsl;
 		ns->color_wheel_type->hue_to_hsl(ns->selected->hue, &hsl);
-		draw_sat_val_block(cr, ns->radius, ns->radius, block_size, hsl.hsl.hue);
+		draw_sat_val_block(ns, cr, ns->radius, ns->radius, block_size, hsl.hsl.hue);
 		draw_dot(cr, ns->radius - block_size / 2 + block_size * ns->selected->saturation, ns->radius - block_size / 2 + block_size * ns->selected->lightness, 4);
 	}
 	for (uint32_t i = 0; i != ns->n_cpoint; i++){
@@ -455,3 +463,13 @@ static gboolean button_release(GtkWidget *widget, GdkEventButton *event)
 	ns->grab_block = false;
 	return false;
 }
+void gtk_color_wheel_set_transformation_chain(GtkColorWheel *color_wheel, transformation::Chain *chain)
+{
+	GtkColorWheelPrivate *ns = GET_PRIVATE(color_wheel);
+	ns->transformation_chain = chain;
+	if (ns->cache_color_wheel){
+		cairo_surface_destroy(ns->cache_color_wheel);
+		ns->cache_color_wheel = 0;
+	}
+	gtk_widget_queue_draw(GTK_WIDGET(color_wheel));
+}
@@ -22,6 +22,7 @@
 #include <gtk/gtk.h>
 #include "Color.h"
 #include "ColorWheelType.h"
+#include "transformation/Chain.h"
 
 #define GTK_TYPE_COLOR_WHEEL (gtk_color_wheel_get_type())
 #define GTK_COLOR_WHEEL(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), GTK_TYPE_COLOR_WHEEL, GtkColorWheel))
@@ -53,6 +54,7 @@ bool gtk_color_wheel_get_block_editable(GtkColorWheel *color_wheel);
 int gtk_color_wheel_get_at(GtkColorWheel *color_wheel, int x, int y);
 void gtk_color_wheel_set_n_colors(GtkColorWheel *color_wheel, guint32 number_of_colors);
 void gtk_color_wheel_set_color_wheel_type(GtkColorWheel *color_wheel, const ColorWheelType *color_wheel_type);
+void gtk_color_wheel_set_transformation_chain(GtkColorWheel *color_wheel, transformation::Chain *chain);
 GType gtk_color_wheel_get_type();
 
 #endif /* GPICK_GTK_COLOR_WHEEL_H_ */
@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PaletteListModel.h"
+#include "ColorObject.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+struct Row {
+	ColorObject *colorObject;
+	std::string text;
+	bool textValid;
+	explicit Row(ColorObject *colorObject):
+		colorObject(colorObject->reference()),
+		textValid(false) {
+	}
+};
+}
+struct GtkPaletteListModelPrivate {
+	std::vector<Row> *rows;
+	PaletteListFormatter *formatter;
+	gint stamp;
+	// Rows in gap are not visible through tree model. Gap is only used while rows are inserted or removed one signal at a time, so that each row is moved only once.
+	size_t gapPosition, gapSize;
+};
+static void tree_model_init(GtkTreeModelIface *iface);
+#define GET_PRIVATE(obj) reinterpret_cast<GtkPaletteListModelPrivate *>(gtk_palette_list_model_get_instance_private(GTK_PALETTE_LIST_MODEL(obj)))
+G_DEFINE_TYPE_WITH_CODE(GtkPaletteListModel, gtk_palette_list_model, G_TYPE_OBJECT, G_ADD_PRIVATE(GtkPaletteListModel) G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_MODEL, tree_model_init));
+static void finalize(GObject *model_obj);
+static void gtk_palette_list_model_class_init(GtkPaletteListModelClass *model_class)
+{
+	GObjectClass *obj_class = G_OBJECT_CLASS(model_class);
+	obj_class->finalize = finalize;
+}
+static void gtk_palette_list_model_init(GtkPaletteListModel *model)
+{
+	GtkPaletteListModelPrivate *ns = GET_PRIVATE(model);
+	ns->rows = new std::vector<Row>();
+	ns->formatter = nullptr;
+	ns->stamp = g_random_int();
+	ns->gapPosition = 0;
+	ns->gapSize = 0;
+}
+static void finalize(GObject *model_obj)
+{
+	GtkPaletteListModelPrivate *ns = GET_PRIVATE(model_obj);
+	for (auto &row: *ns->rows)
+		row.colorObject->release();
+	delete ns->rows;
+	delete ns->formatter;
+	G_OBJECT_CLASS(gtk_palette_list_model_parent_class)->finalize(model_obj);
+}
+static size_t toIndex(GtkTreeIter *iter)
+{
+	return GPOINTER_TO_SIZE(iter->user_data);
+}
+static void setIter(GtkPaletteListModelPrivate *ns, size_t index, GtkTreeIter *iter)
+{
+	iter->stamp = ns->stamp;
+	iter->user_data = GSIZE_TO_POINTER(index);
+	iter->user_data2 = nullptr;
+	iter->user_data3 = nullptr;
+}
+static size_t rowCount(GtkPaletteListModelPrivate *ns)
+{
+	return ns->rows->size() - ns->gapSize;
+}
+static Row &rowAt(GtkPaletteListModelPrivate *ns, size_t index)
+{
+	return (*ns->rows)[index < ns->gapPosition ? index : index + ns->gapSize];
+}
+static bool validIter(GtkPaletteListModelPrivate *ns, GtkTreeIter *iter)
+{
+	return iter->stamp == ns->stamp && toIndex(iter) < rowCount(ns);
+}
+static GtkTreeModelFlags get_flags(GtkTreeModel *)
+{
+	return GTK_TREE_MODEL_LIST_ONLY;
+}
+static gint get_n_columns(GtkTreeModel *)
+{
+	return 3;
+}
+static GType get_column_type(GtkTreeModel *, gint index)
+{
+	switch (static_cast<PaletteListColumn>(index)) {
+	case PaletteListColumn::colorObject:
+		return G_TYPE_POINTER;
+	case PaletteListColumn::text:
+	case PaletteListColumn::name:
+		return G_TYPE_STRING;
+	}
+	return G_TYPE_INVALID;
+}
+static gboolean get_iter(GtkTreeModel *model, GtkTreeIter *iter, GtkTreePath *path)
+{
+	GtkPaletteListModelPrivate *ns = GET_PRIVATE(model);
+	if (gtk_tree_path_get_depth(path) != 1)
+		return false;
+	gint index = gtk_tree_path_get_indices(path)[0];
+	if (index < 0 || static_cast<size_t>(index) >= rowCount(ns))
+		return false;
+	setIter(ns, index, iter);
+	return true;
+}
+static GtkTreePath *get_path(GtkTreeModel *model, GtkTreeIter *iter)
+{
+	GtkPaletteListModelPrivate *ns = GET_PRIVATE(model);
+	g_return_val_if_fail(validIter(ns, iter), nullptr);
+	GtkTreePath *path = gtk_tree_path_new();
+	gtk_tree_path_append_index(path, static_cast<gint>(toIndex(iter)));
+	return path;
+}
+static void get_value(GtkTreeModel *model, GtkTreeIter *iter, gint column, GValue *value)
+{
+	GtkPaletteListModelPrivate *ns = GET_PRIVATE(model);
+	g_return_if_fail(validIter(ns, iter));
+	auto &row = rowAt(ns, toIndex(iter));
+	switch (static_cast<PaletteListColumn>(column)) {
+	case PaletteListColumn::colorObject:
+		g_value_init(value, G_TYPE_POINTER);
+		g_value_set_pointer(value, row.colorObject);
+		break;
+	case PaletteListColumn::text:
+		if (!row.textValid) {
+			row.text = ns->formatter ? (*ns->formatter)(*row.colorObject) : std::string();
+			row.textValid = true;
+		}
+		g_value_init(value, G_TYPE_STRING);
+		g_value_set_string(value, row.text.c_str());
+		break;
+	case PaletteListColumn::name:
+		g_value_init(value, G_TYPE_STRING);
+		g_value_set_string(value, row.colorObject->getName().c_str());
+		break;
+	}
+}
+static gboolean iter_next(GtkTreeModel *model, GtkTreeIter *iter)
+{
+	GtkPaletteListModelPrivate *ns = GET_PRIVATE(model);
+	size_t index = toIndex(iter) + 1;
+	if (iter->stamp != ns->stamp || index >= rowCount(ns)) {
+		iter->stamp = 0;
+		return false;
+	}
+	setIter(ns, index, iter);
+	return true;
+}
+static gboolean iter_nth_child(GtkTreeModel *model, GtkTreeIter *iter, GtkTreeIter *parent, gint n)
+{
+	GtkPaletteListModelPrivate *ns = GET_PRIVATE(model);
+	if (parent || n < 0 || static_cast<size_t>(n) >= rowCount(ns))
+		return false;
+	setIter(ns, n, iter);
+	return true;
+}
+static gboolean iter_children(GtkTreeModel *model, GtkTreeIter *iter, GtkTreeIter *parent)
+{
+	return iter_nth_child(model, iter, parent, 0);
+}
+static gboolean iter_has_child(GtkTreeModel *, GtkTreeIter *)
+{
+	return false;
+}
+static gint iter_n_children(GtkTreeModel *model, GtkTreeIter *iter)
+{
+	GtkPaletteListModelPrivate *ns = GET_PRIVATE(model);
+	if (iter)
+		return 0;
+	return static_cast<gint>(rowCount(ns));
+}
+static gboolean iter_parent(GtkTreeModel *, GtkTreeIter *, GtkTreeIter *)
+{
+	return false;
+}
+static void tree_model_init(GtkTreeModelIface *iface)
+{
+	iface->get_flags = get_flags;
+	iface->get_n_columns = get_n_columns;
+	iface->get_column_type = get_column_type;
+	iface->get_iter = get_iter;
+	iface->get_path = get_path;
+	iface->get_value = get_value;
+	iface->iter_next = iter_next;
+	iface->iter_children = iter_children;
+	iface->iter_has_child = iter_has_child;
+	iface->iter_n_children = iter_n_children;
+	iface->iter_nth_child = iter_nth_child;
+	iface->iter_parent = iter_parent;
+}
+static void emitRow(GtkPaletteListModel *model, size_t index, void (*emit)(GtkTreeModel *, GtkTreePath *, GtkTreeIter *))
+{
+	GtkTreeIter iter;
+	gtk_palette_list_model_get_iter(model, index, &iter);
+	GtkTreePath *path = gtk_tree_path_new_from_indices(static_cast<gint>(index), -1);
+	emit(GTK_TREE_MODEL(model), path, &iter);
+	gtk_tree_path_free(path);
+}
+static void emitRowDeleted(GtkPaletteListModel *model, size_t index)
+{
+	GtkTreePath *path = gtk_tree_path_new_from_indices(static_cast<gint>(index), -1);
+	gtk_tree_model_row_deleted(GTK_TREE_MODEL(model), path);
+	gtk_tree_path_free(path);
+}
+GtkTreeModel *gtk_palette_list_model_new(PaletteListFormatter &&formatter)
+{
+	GObject *model = G_OBJECT(g_object_new(GTK_TYPE_PALETTE_LIST_MODEL, nullptr));
+	GtkPaletteListModelPrivate *ns = GET_PRIVATE(model);
+	ns->formatter = new PaletteListFormatter(std::move(formatter));
+	return GTK_TREE_MODEL(model);
+}
+size_t gtk_palette_list_model_size(GtkPaletteListModel *model)
+{
+	return rowCount(GET_PRIVATE(model));
+}
+ColorObject *gtk_palette_list_model_get(GtkPaletteListModel *model, size_t index)
+{
+	return rowAt(GET_PRIVATE(model), index).colorObject;
+}
+size_t gtk_palette_list_model_get_index(GtkPaletteListModel *model, GtkTreeIter *iter)
+{
+	return toIndex(iter);
+}
+void gtk_palette_list_model_get_iter(GtkPaletteListModel *model, size_t index, GtkTreeIter *iter)
+{
+	setIter(GET_PRIVATE(model), index, iter);
+}
+void gtk_palette_list_model_insert(GtkPaletteListModel *model, size_t position, ColorObject *const *colorObjects, size_t count, bool notify)
+{
+	GtkPaletteListModelPrivate *ns = GET_PRIVATE(model);
+	auto &rows = *ns->rows;
+	position = std::min(position, rows.size());
+	rows.insert(rows.begin() + position, colorObjects, colorObjects + count);
+	ns->stamp++;
+	if (!notify)
+		return;
+	// Inserted rows are hidden in gap and shown one by one, so that tree model matches the state reported by each row-inserted signal.
+	ns->gapPosition = position;
+	ns->gapSize = count;
+	for (size_t i = 0; i < count; i++) {
+		ns->gapPosition++;
+		ns->gapSize--;
+		ns->stamp++;
+		emitRow(model, position + i, gtk_tree_model_row_inserted);
+	}
+	ns->gapPosition = 0;
+}
+void gtk_palette_list_model_set(GtkPaletteListModel *model, size_t index, ColorObject *colorObject, bool notify)
+{
+	GtkPaletteListModelPrivate *ns = GET_PRIVATE(model);
+	auto &row = rowAt(ns, index);
+	if (row.colorObject != colorObject) {
+		colorObject->reference();
+		row.colorObject->release();
+		row.colorObject = colorObject;
+	}
+	row.textValid = false;
+	if (notify)
+		emitRow(model, index, gtk_tree_model_row_changed);
+}
+size_t gtk_palette_list_model_remove_if(GtkPaletteListModel *model, const std::function<bool(size_t index, ColorObject *colorObject)> &predicate, bool notify)
+{
+	GtkPaletteListModelPrivate *ns = GET_PRIVATE(model);
+	auto &rows = *ns->rows;
+	if (notify) {
+		std::vector<size_t> removed;
+		for (size_t i = 0; i < rows.size(); i++) {
+			if (predicate(i, rows[i].colorObject))
+				removed.push_back(i);
+		}
+		// Rows are deleted one by one from the end, so that tree model matches the state reported by each row-deleted signal and paths of rows not yet deleted stay valid.
+		// Deleted rows are collected in gap, and rows kept after a deleted row are moved over the gap, so each row is moved only once.
+		ns->gapPosition = rows.size();
+		ns->gapSize = 0;
+		for (auto i = removed.rbegin(); i != removed.rend(); ++i) {
+			if (ns->gapSize != 0) {
+				for (size_t j = ns->gapPosition; j > *i + 1; j--)
+					rows[j - 1 + ns->gapSize] = std::move(rows[j - 1]);
+			}
+			rows[*i].colorObject->release();
+			ns->gapPosition = *i;
+			ns->gapSize++;
+			ns->stamp++;
+			emitRowDeleted(model, *i);
+		}
+		rows.erase(rows.begin() + ns->gapPosition, rows.begin() + ns->gapPosition + ns->gapSize);
+		ns->gapPosition = 0;
+		ns->gapSize = 0;
+		return removed.size();
+	}
+	size_t position = 0;
+	for (size_t i = 0; i < rows.size(); i++) {
+		if (predicate(i, rows[i].colorObject)) {
+			rows[i].colorObject->release();
+		} else {
+			if (position != i)
+				rows[position] = std::move(rows[i]);
+			position++;
+		}
+	}
+	size_t count = rows.size() - position;
+	rows.erase(rows.begin() + position, rows.end());
+	ns->stamp++;
+	return count;
+}
+void gtk_palette_list_model_reorder(GtkPaletteListModel *model, const size_t *order, size_t count, bool notify)
+{
+	GtkPaletteListModelPrivate *ns = GET_PRIVATE(model);
+	auto &rows = *ns->rows;
+	g_return_if_fail(count == rows.size());
+	std::vector<Row> reordered;
+	reordered.reserve(count);
+	for (size_t i = 0; i < count; i++)
+		reordered.push_back(std::move(rows[order[i]]));
+	rows.swap(reordered);
+	ns->stamp++;
+	if (!notify || count == 0)
+		return;
+	// Single signal for all rows, tree view keeps selection and cursor on moved rows.
+	std::vector<gint> newOrder(order, order + count);
+	GtkTreePath *path = gtk_tree_path_new();
+	gtk_tree_model_rows_reordered(GTK_TREE_MODEL(model), path, nullptr, newOrder.data());
+	gtk_tree_path_free(path);
+}
+void gtk_palette_list_model_clear(GtkPaletteListModel *model, bool notify)
+{
+	GtkPaletteListModelPrivate *ns = GET_PRIVATE(model);
+	auto &rows = *ns->rows;
+	if (!notify) {
+		for (auto &row: rows)
+			row.colorObject->release();
+		rows.clear();
+		ns->stamp++;
+		return;
+	}
+	while (!rows.empty()) {
+		rows.back().colorObject->release();
+		rows.pop_back();
+		ns->stamp++;
+		emitRowDeleted(model, rows.size());
+	}
+}
+void gtk_palette_list_model_invalidate(GtkPaletteListModel *model, size_t index, bool notify)
+{
+	GtkPaletteListModelPrivate *ns = GET_PRIVATE(model);
+	rowAt(ns, index).textValid = false;
+	if (notify)
+		emitRow(model, index, gtk_tree_model_row_changed);
+}
+void gtk_palette_list_model_invalidate_all(GtkPaletteListModel *model)
+{
+	GtkPaletteListModelPrivate *ns = GET_PRIVATE(model);
+	for (auto &row: *ns->rows)
+		row.textValid = false;
+}
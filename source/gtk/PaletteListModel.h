@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef GPICK_GTK_PALETTE_LIST_MODEL_H_
+#define GPICK_GTK_PALETTE_LIST_MODEL_H_
+
+#include <gtk/gtk.h>
+#include <functional>
+#include <string>
+#include <cstddef>
+struct ColorObject;
+
+#define GTK_TYPE_PALETTE_LIST_MODEL (gtk_palette_list_model_get_type())
+#define GTK_PALETTE_LIST_MODEL(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), GTK_TYPE_PALETTE_LIST_MODEL, GtkPaletteListModel))
+#define GTK_PALETTE_LIST_MODEL_CLASS(obj) (G_TYPE_CHECK_CLASS_CAST((obj), GTK_TYPE_PALETTE_LIST_MODEL, GtkPaletteListModelClass))
+#define GTK_IS_PALETTE_LIST_MODEL(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), GTK_TYPE_PALETTE_LIST_MODEL))
+#define GTK_IS_PALETTE_LIST_MODEL_CLASS(obj) (G_TYPE_CHECK_CLASS_TYPE((obj), GTK_TYPE_PALETTE_LIST_MODEL))
+#define GTK_PALETTE_LIST_MODEL_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS((obj), GTK_TYPE_PALETTE_LIST_MODEL, GtkPaletteListModelClass))
+/** \struct GtkPaletteListModel
+ * \brief List model of color objects with columns: color object pointer, color text and name.
+ *
+ * Model keeps a reference to each color object. Color text is formatted only when a row is read, for example when it becomes visible, and is kept until row or all rows are invalidated.
+ * Functions changing rows take notify argument. Without notifications model can be changed while detached from views, which is much faster for large changes.
+ */
+struct GtkPaletteListModel
+{
+	GObject parent;
+};
+struct GtkPaletteListModelClass
+{
+	GObjectClass parent_class;
+};
+enum struct PaletteListColumn {
+	colorObject = 0,
+	text,
+	name,
+};
+using PaletteListFormatter = std::function<std::string(const ColorObject &)>;
+GtkTreeModel *gtk_palette_list_model_new(PaletteListFormatter &&formatter);
+size_t gtk_palette_list_model_size(GtkPaletteListModel *model);
+ColorObject *gtk_palette_list_model_get(GtkPaletteListModel *model, size_t index);
+size_t gtk_palette_list_model_get_index(GtkPaletteListModel *model, GtkTreeIter *iter);
+void gtk_palette_list_model_get_iter(GtkPaletteListModel *model, size_t index, GtkTreeIter *iter);
+void gtk_palette_list_model_insert(GtkPaletteListModel *model, size_t position, ColorObject *const *colorObjects, size_t count, bool notify);
+void gtk_palette_list_model_set(GtkPaletteListModel *model, size_t index, ColorObject *colorObject, bool notify);
+size_t gtk_palette_list_model_remove_if(GtkPaletteListModel *model, const std::function<bool(size_t index, ColorObject *colorObject)> &predicate, bool notify);
+void gtk_palette_list_model_reorder(GtkPaletteListModel *model, const size_t *order, size_t count, bool notify);
+void gtk_palette_list_model_clear(GtkPaletteListModel *model, bool notify);
+void gtk_palette_list_model_invalidate(GtkPaletteListModel *model, size_t index, bool notify);
+void gtk_palette_list_model_invalidate_all(GtkPaletteListModel *model);
+GType gtk_palette_list_model_get_type();
+
+#endif /* GPICK_GTK_PALETTE_LIST_MODEL_H_ */
@@ -43,6 +43,7 @@ struct GtkZoomedPrivate {
 	math::Vector2i pointer;
 	math::Rectangle<int> screen_rect;
 	bool fade;
+	transformation::Chain *transformation_chain;
 #if GTK_MAJOR_VERSION >= 3
 	GtkStyleContext *context;
 #endif
@@ -96,6 +97,7 @@ GtkWidget* gtk_zoomed_new()
 	GtkWidget* widget = (GtkWidget*)g_object_new(GTK_TYPE_ZOOMED, nullptr);
 	GtkZoomedPrivate *ns = GET_PRIVATE(widget);
 	ns->fade = false;
+	ns->transformation_chain = nullptr;
 	ns->zoom = 20;
 	ns->point.x = 0;
 	ns->point.y = 0;
@@ -265,6 +267,14 @@ void gtk_zoomed_update(GtkZoomed *zoomed, math::Vector2i &pointer, math::Rectang
 	cairo_rectangle(cr, 0, 0, ns->width_height, ns->width_height);
 	cairo_fill(cr);
 	cairo_destroy(cr);
+	if (ns->transformation_chain)
+		ns->transformation_chain->apply(ns->surface);
+	gtk_widget_queue_draw(GTK_WIDGET(zoomed));
+}
+void gtk_zoomed_set_transformation_chain(GtkZoomed *zoomed, transformation::Chain *chain)
+{
+	GtkZoomedPrivate *ns = GET_PRIVATE(zoomed);
+	ns->transformation_chain = chain;
 	gtk_widget_queue_draw(GTK_WIDGET(zoomed));
 }
 void gtk_zoomed_set_zoom(GtkZoomed *zoomed, gfloat zoom)
@@ -24,6 +24,7 @@
 #include "Color.h"
 #include "math/Rectangle.h"
 #include "math/Vector.h"
+#include "transformation/Chain.h"
 
 #define GTK_TYPE_ZOOMED (gtk_zoomed_get_type())
 #define GTK_ZOOMED(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), GTK_TYPE_ZOOMED, GtkZoomed))
@@ -45,6 +46,7 @@ GtkWidget* gtk_zoomed_new();
 void gtk_zoomed_set_zoom(GtkZoomed* zoomed, gfloat zoom);
 gfloat gtk_zoomed_get_zoom(GtkZoomed* zoomed);
 void gtk_zoomed_set_fade(GtkZoomed* zoomed, bool fade);
+void gtk_zoomed_set_transformation_chain(GtkZoomed *zoomed, transformation::Chain *chain);
 int32_t gtk_zoomed_get_size(GtkZoomed *zoomed);
 void gtk_zoomed_set_size(GtkZoomed *zoomed, int32_t width_height);
 void gtk_zoomed_set_mark(GtkZoomed *zoomed, int index, math::Vector2i &position);
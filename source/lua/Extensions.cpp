@@ -31,6 +31,7 @@
 #include "../layout/Layout.h"
 #include "../Converters.h"
 #include "../Converter.h"
+#include "../ColorSort.h"
 #include "version/Version.h"
 namespace lua
 {
@@ -55,12 +56,71 @@ static int addConverter(lua_State *L)
 	const char *label = luaL_checkstring(L, 3);
 	checkArgumentIsFunctionOrNil(L, 4);
 	if (lua_gettop(L) >= 5) checkArgumentIsFunctionOrNil(L, 5);
+	if (lua_gettop(L) >= 6) checkArgumentIsFunctionOrNil(L, 6);
 	if (lua_gettop(L) == 4)
 		getGlobalState(L).converters().add(new Converter(name, label, Ref(L, 4), Ref()));
-	else if (lua_gettop(L) >= 5)
+	else if (lua_gettop(L) == 5)
 		getGlobalState(L).converters().add(new Converter(name, label, Ref(L, 4), Ref(L, 5)));
+	else if (lua_gettop(L) >= 6)
+		getGlobalState(L).converters().add(new Converter(name, label, Ref(L, 4), Ref(L, 5), Ref(L, 6)));
 	return 0;
 }
+static bool getBoolField(lua_State *L, int index, const char *name, bool defaultValue)
+{
+	lua_getfield(L, index, name);
+	bool value = lua_isnil(L, -1) ? defaultValue : lua_toboolean(L, -1);
+	lua_pop(L, 1);
+	return value;
+}
+static lua_Number getNumberField(lua_State *L, int index, const char *name, lua_Number defaultValue)
+{
+	lua_getfield(L, index, name);
+	lua_Number value = luaL_optnumber(L, -1, defaultValue);
+	lua_pop(L, 1);
+	return value;
+}
+static const ChannelDescription *getChannelField(lua_State *L, int index, const char *name)
+{
+	lua_getfield(L, index, name);
+	const ChannelDescription *channel = nullptr;
+	if (!lua_isnil(L, -1)) {
+		const char *id = luaL_checkstring(L, -1);
+		channel = findSortChannel(id);
+		if (channel == nullptr)
+			luaL_error(L, "unknown channel \"%s\"", id);
+	}
+	lua_pop(L, 1);
+	return channel;
+}
+static int sortColorObjects(lua_State *L)
+{
+	luaL_checktype(L, 2, LUA_TTABLE);
+	std::vector<ColorObject *> colorObjects(lua_rawlen(L, 2));
+	for (size_t i = 0; i < colorObjects.size(); i++) {
+		lua_rawgeti(L, 2, static_cast<int>(i + 1));
+		colorObjects[i] = checkColorObject(L, -1);
+		lua_pop(L, 1);
+	}
+	ColorSorter::Options options;
+	if (!lua_isnoneornil(L, 3)) {
+		luaL_checktype(L, 3, LUA_TTABLE);
+		options.sortChannel = getChannelField(L, 3, "sortBy");
+		options.groupChannel = getChannelField(L, 3, "groupBy");
+		options.maxGroups = static_cast<size_t>(getNumberField(L, 3, "maxGroups", 10));
+		options.groupSensitivity = static_cast<float>(getNumberField(L, 3, "groupSensitivity", 50) / 100);
+		options.reverse = getBoolField(L, 3, "reverse", false);
+		options.reverseGroups = getBoolField(L, 3, "reverseGroups", false);
+		options.tieBreakByName = getBoolField(L, 3, "tieBreakByName", false);
+	}
+	ColorSorter sorter(std::move(colorObjects));
+	const auto &order = sorter.sort(options);
+	lua_createtable(L, static_cast<int>(order.size()), 0);
+	for (size_t i = 0; i < order.size(); i++) {
+		lua_rawgeti(L, 2, static_cast<int>(order[i] + 1));
+		lua_rawseti(L, -2, static_cast<int>(i + 1));
+	}
+	return 1;
+}
 static int setOptionChangeCallback(lua_State *L)
 {
 	getGlobalState(L).callbacks().optionChange(Ref(L, 2));
@@ -75,6 +135,7 @@ static const struct luaL_Reg functions[] =
 {
 	{"addLayout", addLayout},
 	{"addConverter", addConverter},
+	{"sortColorObjects", sortColorObjects},
 	{"setComponentToTextCallback", setComponentToTextCallback},
 	{"setOptionChangeCallback", setOptionChangeCallback},
 	{nullptr, nullptr}
@@ -63,6 +63,6 @@ Ref &Ref::operator=(Ref &&ref)
 }
 bool Ref::valid() const
 {
-	return m_L && m_ref != LUA_NOREF;
+	return m_L && m_ref != LUA_NOREF && m_ref != LUA_REFNIL;
 }
 }
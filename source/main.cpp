@@ -20,6 +20,7 @@
 #include "Paths.h"
 #include "uiAbout.h"
 #include "uiApp.h"
+#include "BatchMode.h"
 #include "I18N.h"
 #include "version/Version.h"
 #include "dynv/Map.h"
@@ -36,6 +37,7 @@ static gboolean output_without_newline = FALSE;
 static gboolean single_color_pick_mode = FALSE;
 static gboolean version_information = FALSE;
 static gboolean do_not_start = FALSE;
+static gboolean batch_mode = FALSE;
 static gchar *converter_name = nullptr;
 static GOptionEntry commandline_entries[] =
 {
@@ -47,12 +49,17 @@ static GOptionEntry commandline_entries[] =
 	{"no-start", 0, 0, G_OPTION_ARG_NONE, &do_not_start, "Do not start Gpick if it is not already running", nullptr},
 	{"converter-name", 'c', 0, G_OPTION_ARG_STRING, &converter_name, "Converter name used for floating picker mode", nullptr},
 	{"version", 'v', 0, G_OPTION_ARG_NONE, &version_information, "Print version information", nullptr},
+	{"batch", 0, 0, G_OPTION_ARG_NONE, &batch_mode, "Convert palette files without user interface, see --batch --help", nullptr},
 	{G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &commandline_filename, nullptr, "[FILE...]"},
 	{nullptr}
 };
 int main(int argc, char **argv)
 {
 	setlocale(LC_ALL, "");
+	if (isBatchMode(argc, argv)) {
+		initialize_i18n();
+		return runBatchMode(argc, argv);
+	}
 	gtk_init(&argc, &argv);
 	initialize_i18n();
 	g_set_application_name(program_name);
@@ -94,11 +101,11 @@ int main(int argc, char **argv)
 		if (!single_color_pick_mode){
 			if (commandline_filename){
 				app_load_file(args, commandline_filename[0]);
+				if (app_is_autoload_enabled(args))
+					app_start_autosave(args, false);
 			}else{
-				if (app_is_autoload_enabled(args)){
-					auto autosaveFile = buildConfigPath("autosave.gpa");
-					app_load_file(args, autosaveFile, true);
-				}
+				if (app_is_autoload_enabled(args))
+					app_start_autosave(args, true);
 			}
 		}
 		if (commandline_geometry) app_parse_geometry(args, commandline_geometry);
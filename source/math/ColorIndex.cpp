@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ColorIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+namespace math {
+struct ColorIndex::Query {
+	float values[4];
+	Query(const Color &color) {
+		values[0] = color.lab.L;
+		values[1] = color.lab.a;
+		values[2] = color.lab.b;
+		values[3] = std::sqrt(color.lab.a * color.lab.a + color.lab.b * color.lab.b);
+	}
+};
+ColorIndex::ColorIndex() {
+}
+void ColorIndex::clear() {
+	for (auto &values: m_values)
+		values.clear();
+	m_userValues.clear();
+	m_order.clear();
+	m_nodes.clear();
+}
+void ColorIndex::reserve(size_t count) {
+	for (auto &values: m_values)
+		values.reserve(count);
+	m_userValues.reserve(count);
+	m_order.reserve(count);
+}
+void ColorIndex::add(const Color &color, uint32_t value) {
+	Query query(color);
+	for (int i = 0; i < 4; i++)
+		m_values[i].push_back(query.values[i]);
+	m_order.push_back(static_cast<uint32_t>(m_userValues.size()));
+	m_userValues.push_back(value);
+	m_nodes.clear();
+}
+size_t ColorIndex::size() const {
+	return m_userValues.size();
+}
+bool ColorIndex::empty() const {
+	return m_userValues.empty();
+}
+void ColorIndex::build() {
+	m_nodes.clear();
+	if (m_userValues.empty())
+		return;
+	std::vector<uint32_t> permutation(m_userValues.size());
+	std::iota(permutation.begin(), permutation.end(), 0);
+	m_nodes.reserve(2 * (m_userValues.size() / leafSize + 1));
+	buildNode(0, static_cast<uint32_t>(permutation.size()), permutation);
+	for (auto &values: m_values) {
+		std::vector<float> orderedValues(values.size());
+		for (size_t i = 0; i < permutation.size(); i++)
+			orderedValues[i] = values[permutation[i]];
+		values.swap(orderedValues);
+	}
+	std::vector<uint32_t> order(m_order.size());
+	for (size_t i = 0; i < permutation.size(); i++)
+		order[i] = m_order[permutation[i]];
+	m_order.swap(order);
+}
+uint32_t ColorIndex::buildNode(uint32_t begin, uint32_t end, std::vector<uint32_t> &permutation) {
+	uint32_t nodeIndex = static_cast<uint32_t>(m_nodes.size());
+	m_nodes.emplace_back();
+	Node node;
+	node.begin = begin;
+	node.end = end;
+	node.left = node.right = 0;
+	for (int i = 0; i < 4; i++) {
+		node.min[i] = node.max[i] = m_values[i][permutation[begin]];
+		for (uint32_t j = begin + 1; j < end; j++) {
+			float value = m_values[i][permutation[j]];
+			node.min[i] = std::min(node.min[i], value);
+			node.max[i] = std::max(node.max[i], value);
+		}
+	}
+	if (end - begin > leafSize) {
+		int splitValue = 0;
+		for (int i = 1; i < 3; i++) {
+			if (node.max[i] - node.min[i] > node.max[splitValue] - node.min[splitValue])
+				splitValue = i;
+		}
+		if (node.max[splitValue] > node.min[splitValue]) {
+			uint32_t middle = begin + (end - begin) / 2;
+			const auto &values = m_values[splitValue];
+			std::nth_element(permutation.begin() + begin, permutation.begin() + middle, permutation.begin() + end, [&values](uint32_t a, uint32_t b) {
+				return values[a] < values[b];
+			});
+			node.left = buildNode(begin, middle, permutation);
+			node.right = buildNode(middle, end, permutation);
+		}
+	}
+	m_nodes[nodeIndex] = node;
+	return nodeIndex;
+}
+float ColorIndex::distance(size_t index, const Query &query) const {
+	float dL = query.values[0] - m_values[0][index];
+	float da = query.values[1] - m_values[1][index];
+	float db = query.values[2] - m_values[2][index];
+	float C = m_values[3][index];
+	float dC = query.values[3] - C;
+	float chroma = dC / (1 + 0.045f * C);
+	float hue = (da * da + db * db - dC) / (1 + 0.015f * C);
+	return std::sqrt(dL * dL + chroma * chroma + hue * hue);
+}
+// Smallest possible distance between query color and any color inside node bounding box.
+// Hue term numerator (E^2 - dC) is at least E^2 - E, because chroma difference dC can not exceed ab plane distance E.
+float ColorIndex::lowerBound(const Node &node, const Query &query) const {
+	float d[4];
+	for (int i = 0; i < 4; i++)
+		d[i] = std::max(0.0f, std::max(node.min[i] - query.values[i], query.values[i] - node.max[i]));
+	float chroma = d[3] / (1 + 0.045f * node.max[3]);
+	float e = std::sqrt(d[1] * d[1] + d[2] * d[2]);
+	float hue = e > 1 ? (e * e - e) / (1 + 0.015f * node.max[3]) : 0.0f;
+	return std::sqrt(d[0] * d[0] + chroma * chroma + hue * hue);
+}
+void ColorIndex::findNearest(uint32_t nodeIndex, const Query &query, size_t count, std::vector<std::pair<float, uint32_t>> &heap) const {
+	const Node &node = m_nodes[nodeIndex];
+	if (node.left == 0) {
+		for (uint32_t i = node.begin; i < node.end; i++) {
+			std::pair<float, uint32_t> item(distance(i, query), m_order[i]);
+			if (heap.size() < count) {
+				heap.push_back(item);
+				std::push_heap(heap.begin(), heap.end());
+			} else if (item < heap.front()) {
+				std::pop_heap(heap.begin(), heap.end());
+				heap.back() = item;
+				std::push_heap(heap.begin(), heap.end());
+			}
+		}
+		return;
+	}
+	float leftBound = lowerBound(m_nodes[node.left], query);
+	float rightBound = lowerBound(m_nodes[node.right], query);
+	uint32_t first = node.left, second = node.right;
+	if (rightBound < leftBound) {
+		std::swap(first, second);
+		std::swap(leftBound, rightBound);
+	}
+	if (heap.size() < count || leftBound <= heap.front().first)
+		findNearest(first, query, count, heap);
+	if (heap.size() < count || rightBound <= heap.front().first)
+		findNearest(second, query, count, heap);
+}
+void ColorIndex::findNearest(const Color &color, size_t count, std::vector<Result> &results) const {
+	results.clear();
+	if (m_nodes.empty() || count == 0)
+		return;
+	std::vector<std::pair<float, uint32_t>> heap;
+	heap.reserve(count);
+	findNearest(0, Query(color), count, heap);
+	std::sort_heap(heap.begin(), heap.end());
+	results.reserve(heap.size());
+	for (const auto &item: heap)
+		results.emplace_back(m_userValues[item.second], item.first);
+}
+std::optional<ColorIndex::Result> ColorIndex::findNearest(const Color &color) const {
+	std::vector<Result> results;
+	findNearest(color, 1, results);
+	if (results.empty())
+		return std::nullopt;
+	return results.front();
+}
+void ColorIndex::findWithin(uint32_t nodeIndex, const Query &query, float radius, std::vector<std::pair<float, uint32_t>> &results) const {
+	const Node &node = m_nodes[nodeIndex];
+	if (lowerBound(node, query) > radius)
+		return;
+	if (node.left == 0) {
+		for (uint32_t i = node.begin; i < node.end; i++) {
+			float value = distance(i, query);
+			if (value <= radius)
+				results.emplace_back(value, m_order[i]);
+		}
+		return;
+	}
+	findWithin(node.left, query, radius, results);
+	findWithin(node.right, query, radius, results);
+}
+void ColorIndex::findWithin(const Color &color, float radius, std::vector<Result> &results) const {
+	results.clear();
+	if (m_nodes.empty())
+		return;
+	std::vector<std::pair<float, uint32_t>> found;
+	findWithin(0, Query(color), radius, found);
+	std::sort(found.begin(), found.end());
+	results.reserve(found.size());
+	for (const auto &item: found)
+		results.emplace_back(m_userValues[item.second], item.first);
+}
+namespace {
+template<typename T>
+void append(std::vector<uint8_t> &data, const T *values, size_t count) {
+	auto bytes = reinterpret_cast<const uint8_t *>(values);
+	data.insert(data.end(), bytes, bytes + count * sizeof(T));
+}
+template<typename T>
+bool read(const uint8_t *&data, const uint8_t *end, T *values, size_t count) {
+	if (static_cast<size_t>(end - data) < count * sizeof(T))
+		return false;
+	std::memcpy(values, data, count * sizeof(T));
+	data += count * sizeof(T);
+	return true;
+}
+}
+void ColorIndex::save(std::vector<uint8_t> &data) const {
+	uint32_t counts[2] = { static_cast<uint32_t>(m_userValues.size()), static_cast<uint32_t>(m_nodes.size()) };
+	append(data, counts, 2);
+	for (const auto &values: m_values)
+		append(data, values.data(), values.size());
+	append(data, m_userValues.data(), m_userValues.size());
+	append(data, m_order.data(), m_order.size());
+	append(data, m_nodes.data(), m_nodes.size());
+}
+bool ColorIndex::load(const uint8_t *data, size_t size) {
+	clear();
+	const uint8_t *end = data + size;
+	uint32_t counts[2];
+	if (!read(data, end, counts, 2) || static_cast<size_t>(end - data) != counts[0] * (4 * sizeof(float) + 2 * sizeof(uint32_t)) + counts[1] * sizeof(Node)) {
+		return false;
+	}
+	for (auto &values: m_values) {
+		values.resize(counts[0]);
+		read(data, end, values.data(), counts[0]);
+	}
+	m_userValues.resize(counts[0]);
+	read(data, end, m_userValues.data(), counts[0]);
+	m_order.resize(counts[0]);
+	read(data, end, m_order.data(), counts[0]);
+	m_nodes.resize(counts[1]);
+	read(data, end, m_nodes.data(), counts[1]);
+	bool valid = (counts[0] == 0) == (counts[1] == 0);
+	for (auto order: m_order)
+		valid = valid && order < counts[0];
+	// children are always stored after their parent, so checking this also rules out cycles
+	for (uint32_t i = 0; i < counts[1]; i++) {
+		const auto &node = m_nodes[i];
+		valid = valid && node.begin <= node.end && node.end <= counts[0] && node.left < counts[1] && node.right < counts[1];
+		valid = valid && (node.left == 0 ? node.right == 0 : node.left > i && node.right > i);
+	}
+	if (!valid) {
+		clear();
+		return false;
+	}
+	return true;
+}
+}
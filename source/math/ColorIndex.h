@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_MATH_COLOR_INDEX_H_
+#define GPICK_MATH_COLOR_INDEX_H_
+#include "Color.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+namespace math {
+/** \struct ColorIndex
+ * \brief k-d tree over Lab colors for nearest neighbour searches.
+ *
+ * Distances are calculated the same way as Color::distanceLch(indexed color, query color) and search results are exact.
+ * Colors are kept in contiguous arrays ordered by tree leafs. Index has to be built after adding colors and before searching.
+ */
+struct ColorIndex {
+	/** Value and distance pair. */
+	using Result = std::pair<uint32_t, float>;
+	static constexpr size_t leafSize = 16;
+	ColorIndex();
+	void clear();
+	void reserve(size_t count);
+	/**
+	 * Add color to the index. Searches return no results until the index is built again.
+	 * @param[in] color Color in Lab color space.
+	 * @param[in] value Value returned by searches.
+	 */
+	void add(const Color &color, uint32_t value);
+	/**
+	 * Build tree from added colors.
+	 */
+	void build();
+	size_t size() const;
+	bool empty() const;
+	/**
+	 * Find nearest colors.
+	 * @param[in] color Color in Lab color space.
+	 * @param[in] count Maximum number of results.
+	 * @param[out] results Values and distances sorted by distance. Colors with equal distances are sorted by insertion order.
+	 */
+	void findNearest(const Color &color, size_t count, std::vector<Result> &results) const;
+	/**
+	 * Find nearest color.
+	 * @param[in] color Color in Lab color space.
+	 * @return Value and distance or nothing if index is empty.
+	 */
+	std::optional<Result> findNearest(const Color &color) const;
+	/**
+	 * Find all colors not further than radius.
+	 * @param[in] color Color in Lab color space.
+	 * @param[in] radius Maximum distance.
+	 * @param[out] results Values and distances sorted by distance. Colors with equal distances are sorted by insertion order.
+	 */
+	void findWithin(const Color &color, float radius, std::vector<Result> &results) const;
+	/**
+	 * Append built index to a buffer. Values are stored in native byte order.
+	 * @param[out] data Buffer.
+	 */
+	void save(std::vector<uint8_t> &data) const;
+	/**
+	 * Replace index with data written by save().
+	 * @param[in] data Index data.
+	 * @param[in] size Index data size in bytes.
+	 * @return True on success. Index is cleared if data is invalid.
+	 */
+	bool load(const uint8_t *data, size_t size);
+private:
+	struct Node {
+		float min[4], max[4];
+		uint32_t begin, end, left, right;
+	};
+	struct Query;
+	std::vector<float> m_values[4];
+	std::vector<uint32_t> m_userValues, m_order;
+	std::vector<Node> m_nodes;
+	uint32_t buildNode(uint32_t begin, uint32_t end, std::vector<uint32_t> &permutation);
+	float distance(size_t index, const Query &query) const;
+	float lowerBound(const Node &node, const Query &query) const;
+	void findNearest(uint32_t nodeIndex, const Query &query, size_t count, std::vector<std::pair<float, uint32_t>> &heap) const;
+	void findWithin(uint32_t nodeIndex, const Query &query, float radius, std::vector<std::pair<float, uint32_t>> &results) const;
+};
+}
+#endif /* GPICK_MATH_COLOR_INDEX_H_ */
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ColorQuantizer.h"
+#include "OctreeColorQuantization.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+namespace math {
+namespace {
+void toLab(const ColorBatch &samples, ColorBatch &lab) {
+	samples.nonLinearRgb(lab);
+	lab.rgbToLabD50(lab);
+}
+void setFromLab(ColorBatch &palette, size_t index, const Color &lab, float pixels) {
+	Color color = lab.labToRgbD50().normalizeRgbInplace().linearRgbInplace();
+	color.alpha = pixels;
+	palette.set(index, color);
+}
+uint8_t toUint8(float value) {
+	return static_cast<uint8_t>(std::max(std::min(static_cast<int>(value * 256), 255), 0));
+}
+template<typename Callback>
+void parallelFor(size_t count, size_t threads, Callback &&callback) {
+	constexpr size_t minChunkSize = 4096;
+	threads = std::max<size_t>(1, std::min(threads, (count + minChunkSize - 1) / minChunkSize));
+	size_t chunkSize = (count + threads - 1) / threads;
+	if (threads == 1) {
+		callback(0, count, 0);
+		return;
+	}
+	std::vector<std::thread> workers;
+	workers.reserve(threads);
+	for (size_t i = 0; i < threads; i++) {
+		size_t begin = std::min(count, i * chunkSize), end = std::min(count, begin + chunkSize);
+		workers.emplace_back([&callback, begin, end, i]() {
+			callback(begin, end, i);
+		});
+	}
+	for (auto &worker: workers)
+		worker.join();
+}
+}
+ColorQuantizer::~ColorQuantizer() {
+}
+std::unique_ptr<ColorQuantizer> ColorQuantizer::create(Method method) {
+	switch (method) {
+	case Method::octree:
+		return std::make_unique<OctreeQuantizer>();
+	case Method::medianCut:
+		return std::make_unique<MedianCutQuantizer>();
+	case Method::kMeans:
+		return std::make_unique<KMeansQuantizer>();
+	}
+	throw std::invalid_argument("method");
+}
+void ColorQuantizer::imageSamples(const uint8_t *pixels, int width, int height, int stride, int channels, ColorBatch &samples, int bits) {
+	bits = std::max(1, std::min(bits, 8));
+	int shift = 8 - bits;
+	std::vector<float> sums(size_t(3) << (bits * 3), 0.0f);
+	std::vector<uint32_t> counts(size_t(1) << (bits * 3), 0);
+	for (int y = 0; y < height; y++) {
+		const uint8_t *dataPointer = pixels + static_cast<ptrdiff_t>(stride) * y;
+		for (int x = 0; x < width; x++) {
+			uint8_t red = dataPointer[0], green = channels == 1 ? red : dataPointer[1], blue = channels == 1 ? red : dataPointer[2];
+			size_t bin = (size_t(red >> shift) << (bits * 2)) | (size_t(green >> shift) << bits) | size_t(blue >> shift);
+			sums[bin * 3] += Color::linearRgbValue(red);
+			sums[bin * 3 + 1] += Color::linearRgbValue(green);
+			sums[bin * 3 + 2] += Color::linearRgbValue(blue);
+			counts[bin]++;
+			dataPointer += channels;
+		}
+	}
+	samples.resize(static_cast<size_t>(counts.size() - std::count(counts.begin(), counts.end(), 0u)));
+	size_t index = 0;
+	for (size_t bin = 0; bin < counts.size(); bin++) {
+		if (counts[bin] == 0)
+			continue;
+		float count = static_cast<float>(counts[bin]);
+		samples.set(index++, Color(sums[bin * 3] / count, sums[bin * 3 + 1] / count, sums[bin * 3 + 2] / count, count));
+	}
+}
+float ColorQuantizer::meanDistance(const ColorBatch &samples, const ColorBatch &palette) {
+	if (samples.empty() || palette.empty())
+		return 0.0f;
+	ColorBatch labSamples, labPalette;
+	toLab(samples, labSamples);
+	toLab(palette, labPalette);
+	std::vector<uint32_t> indices(samples.size());
+	std::vector<float> distances(samples.size());
+	labSamples.nearest(labPalette, 0, samples.size(), indices.data(), distances.data());
+	double sum = 0, weight = 0;
+	for (size_t i = 0; i < samples.size(); i++) {
+		sum += std::sqrt(distances[i]) * samples[3][i];
+		weight += samples[3][i];
+	}
+	return weight > 0 ? static_cast<float>(sum / weight) : 0.0f;
+}
+void OctreeQuantizer::quantize(const ColorBatch &samples, size_t numberOfColors, ColorBatch &palette) {
+	OctreeColorQuantization octree;
+	for (size_t i = 0; i < samples.size(); i++) {
+		Color color = samples.get(i);
+		Color nonLinearColor = color.nonLinearRgbFast();
+		auto pixels = static_cast<size_t>(std::lround(color.alpha));
+		if (pixels == 0)
+			continue;
+		octree.add(color, pixels, { toUint8(nonLinearColor.red), toUint8(nonLinearColor.green), toUint8(nonLinearColor.blue) });
+	}
+	octree.reduce(numberOfColors);
+	palette.resize(octree.size());
+	size_t index = 0;
+	octree.visit([&](const float sum[3], size_t pixels) {
+		palette.set(index++, Color(sum[0] / pixels, sum[1] / pixels, sum[2] / pixels, static_cast<float>(pixels)));
+	});
+	palette.resize(index);
+}
+namespace {
+struct Box {
+	size_t begin, end;
+	double weight, mean[3], error[3];
+	double totalError() const {
+		return error[0] + error[1] + error[2];
+	}
+};
+void updateBox(Box &box, const ColorBatch &lab, const std::vector<uint32_t> &order) {
+	double sum[3] = { 0, 0, 0 }, squares[3] = { 0, 0, 0 };
+	box.weight = 0;
+	for (size_t i = box.begin; i < box.end; i++) {
+		double weight = lab[3][order[i]];
+		box.weight += weight;
+		for (int j = 0; j < 3; j++) {
+			double value = lab[j][order[i]];
+			sum[j] += value * weight;
+			squares[j] += value * value * weight;
+		}
+	}
+	for (int j = 0; j < 3; j++) {
+		box.mean[j] = box.weight > 0 ? sum[j] / box.weight : 0;
+		box.error[j] = std::max(0.0, squares[j] - sum[j] * box.mean[j]);
+	}
+}
+}
+void MedianCutQuantizer::quantize(const ColorBatch &samples, size_t numberOfColors, ColorBatch &palette) {
+	ColorBatch lab;
+	toLab(samples, lab);
+	std::vector<uint32_t> order(samples.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::vector<Box> boxes;
+	if (!samples.empty() && numberOfColors > 0) {
+		boxes.push_back(Box { 0, samples.size() });
+		updateBox(boxes.back(), lab, order);
+	}
+	while (boxes.size() < numberOfColors) {
+		Box *selected = nullptr;
+		for (auto &box: boxes) {
+			if (box.end - box.begin > 1 && box.totalError() > 0 && (!selected || box.totalError() > selected->totalError()))
+				selected = &box;
+		}
+		if (!selected)
+			break;
+		int axis = static_cast<int>(std::max_element(selected->error, selected->error + 3) - selected->error);
+		const float *values = lab[axis];
+		std::sort(order.begin() + selected->begin, order.begin() + selected->end, [values](uint32_t a, uint32_t b) {
+			return values[a] < values[b];
+		});
+		double half = selected->weight / 2, weight = 0;
+		size_t split = selected->begin;
+		while (split < selected->end - 1 && weight + lab[3][order[split]] <= half)
+			weight += lab[3][order[split++]];
+		split = std::max(split, selected->begin + 1);
+		Box second { split, selected->end };
+		selected->end = split;
+		updateBox(*selected, lab, order);
+		updateBox(second, lab, order);
+		boxes.push_back(second);
+	}
+	palette.resize(boxes.size());
+	for (size_t i = 0; i < boxes.size(); i++) {
+		const auto &box = boxes[i];
+		setFromLab(palette, i, Color(static_cast<float>(box.mean[0]), static_cast<float>(box.mean[1]), static_cast<float>(box.mean[2])), static_cast<float>(box.weight));
+	}
+}
+KMeansQuantizer::KMeansQuantizer(size_t maxIterations, float tolerance, size_t threads):
+	m_maxIterations(maxIterations),
+	m_threads(threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads),
+	m_tolerance(tolerance) {
+}
+void KMeansQuantizer::quantize(const ColorBatch &samples, size_t numberOfColors, ColorBatch &palette) {
+	OctreeQuantizer().quantize(samples, numberOfColors, palette);
+	refine(samples, palette);
+}
+size_t KMeansQuantizer::refine(const ColorBatch &samples, ColorBatch &palette) const {
+	if (samples.empty() || palette.empty())
+		return 0;
+	ColorBatch lab, centers;
+	toLab(samples, lab);
+	toLab(palette, centers);
+	size_t colors = centers.size();
+	struct Accumulator {
+		std::vector<double> sums;
+		void reset(size_t colors) {
+			sums.assign(colors * 4, 0.0);
+		}
+	};
+	std::vector<Accumulator> accumulators(m_threads);
+	std::vector<uint32_t> indices(samples.size());
+	std::vector<float> distances(samples.size());
+	std::vector<double> sums(colors * 4);
+	size_t iteration = 0;
+	while (iteration < m_maxIterations) {
+		++iteration;
+		parallelFor(samples.size(), m_threads, [&](size_t begin, size_t end, size_t thread) {
+			auto &sums = accumulators[thread].sums;
+			accumulators[thread].reset(colors);
+			lab.nearest(centers, begin, end - begin, indices.data() + begin, distances.data() + begin);
+			for (size_t i = begin; i < end; i++) {
+				double weight = lab[3][i];
+				double *sum = &sums[indices[i] * 4];
+				sum[0] += lab[0][i] * weight;
+				sum[1] += lab[1][i] * weight;
+				sum[2] += lab[2][i] * weight;
+				sum[3] += weight;
+			}
+		});
+		std::fill(sums.begin(), sums.end(), 0.0);
+		for (auto &accumulator: accumulators) {
+			if (accumulator.sums.empty())
+				continue;
+			for (size_t i = 0; i < sums.size(); i++)
+				sums[i] += accumulator.sums[i];
+			accumulator.sums.clear();
+		}
+		float maxShift = 0;
+		for (size_t i = 0; i < colors; i++) {
+			if (sums[i * 4 + 3] <= 0)
+				continue;
+			float shift = 0;
+			for (int j = 0; j < 3; j++) {
+				float value = static_cast<float>(sums[i * 4 + j] / sums[i * 4 + 3]);
+				shift += (value - centers[j][i]) * (value - centers[j][i]);
+				centers[j][i] = value;
+			}
+			maxShift = std::max(maxShift, shift);
+		}
+		if (maxShift <= m_tolerance * m_tolerance)
+			break;
+	}
+	size_t index = 0;
+	for (size_t i = 0; i < colors; i++) {
+		if (sums[i * 4 + 3] <= 0)
+			continue;
+		setFromLab(palette, index++, centers.get(i), static_cast<float>(sums[i * 4 + 3]));
+	}
+	palette.resize(index);
+	return iteration;
+}
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_MATH_COLOR_QUANTIZER_H_
+#define GPICK_MATH_COLOR_QUANTIZER_H_
+#include "ColorBatch.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+namespace math {
+/** \struct ColorQuantizer
+ * \brief Palette extraction algorithm interface.
+ *
+ * Colors are passed in ColorBatch objects: RGB values are linear and alpha values hold pixel counts.
+ */
+struct ColorQuantizer {
+	/** \enum Method
+	 * \brief Available palette extraction algorithms, from fastest to most accurate.
+	 */
+	enum class Method {
+		octree,
+		medianCut,
+		kMeans,
+	};
+	virtual ~ColorQuantizer();
+	/**
+	 * Find palette for weighted colors.
+	 * @param[in] samples Linear RGB colors with pixel counts as alpha values.
+	 * @param[in] numberOfColors Maximum number of palette colors.
+	 * @param[out] palette Linear RGB palette colors with pixel counts as alpha values.
+	 */
+	virtual void quantize(const ColorBatch &samples, size_t numberOfColors, ColorBatch &palette) = 0;
+	/**
+	 * Create quantizer.
+	 * @param[in] method Palette extraction algorithm.
+	 * @return Quantizer instance.
+	 */
+	static std::unique_ptr<ColorQuantizer> create(Method method);
+	/**
+	 * Build weighted samples from an 8 bit per channel image by averaging pixels in a color histogram.
+	 * @param[in] pixels Image data.
+	 * @param[in] width Image width.
+	 * @param[in] height Image height.
+	 * @param[in] stride Number of bytes between rows.
+	 * @param[in] channels Number of channels per pixel. Single channel images are treated as grayscale.
+	 * @param[out] samples Linear RGB colors with pixel counts as alpha values.
+	 * @param[in] bits Number of histogram bits per channel (1-8).
+	 */
+	static void imageSamples(const uint8_t *pixels, int width, int height, int stride, int channels, ColorBatch &samples, int bits = 5);
+	/**
+	 * Get weighted mean CIE76 color difference between samples and their nearest palette colors.
+	 * @param[in] samples Linear RGB colors with pixel counts as alpha values.
+	 * @param[in] palette Linear RGB palette colors.
+	 * @return Mean color difference.
+	 */
+	static float meanDistance(const ColorBatch &samples, const ColorBatch &palette);
+};
+/** \struct OctreeQuantizer
+ * \brief Greedy octree leaf merging, see OctreeColorQuantization.
+ */
+struct OctreeQuantizer: public ColorQuantizer {
+	virtual void quantize(const ColorBatch &samples, size_t numberOfColors, ColorBatch &palette) override;
+};
+/** \struct MedianCutQuantizer
+ * \brief Median cut in Lab color space. Box with the largest squared error is split at the weighted median of its widest dimension.
+ */
+struct MedianCutQuantizer: public ColorQuantizer {
+	virtual void quantize(const ColorBatch &samples, size_t numberOfColors, ColorBatch &palette) override;
+};
+/** \struct KMeansQuantizer
+ * \brief k-means (Lloyd) refinement in Lab color space, seeded from octree result.
+ *
+ * Nearest centers are found with vectorized ColorBatch::nearest and samples are split into chunks processed by multiple threads.
+ */
+struct KMeansQuantizer: public ColorQuantizer {
+	/**
+	 * @param[in] maxIterations Maximum number of refinement iterations.
+	 * @param[in] tolerance Refinement stops when no center moves further than this distance in Lab color space.
+	 * @param[in] threads Number of threads. Zero selects the number of hardware threads.
+	 */
+	KMeansQuantizer(size_t maxIterations = 20, float tolerance = 0.1f, size_t threads = 0);
+	virtual void quantize(const ColorBatch &samples, size_t numberOfColors, ColorBatch &palette) override;
+	/**
+	 * Refine existing palette. Palette colors without any samples are removed.
+	 * @param[in] samples Linear RGB colors with pixel counts as alpha values.
+	 * @param[in,out] palette Linear RGB palette colors with pixel counts as alpha values.
+	 * @return Number of iterations done.
+	 */
+	size_t refine(const ColorBatch &samples, ColorBatch &palette) const;
+private:
+	size_t m_maxIterations, m_threads;
+	float m_tolerance;
+};
+}
+#endif /* GPICK_MATH_COLOR_QUANTIZER_H_ */
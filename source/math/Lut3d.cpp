@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Lut3d.h"
+#include <algorithm>
+#include <stdexcept>
+namespace math {
+Lut3d::Lut3d():
+	m_size(0) {
+}
+void Lut3d::build(int size, const Function &function) {
+	if (size < 2)
+		throw std::invalid_argument("size");
+	m_size = size;
+	m_values.resize(static_cast<size_t>(size) * size * size * 3);
+	float *value = m_values.data();
+	Color input, output;
+	input.alpha = 1;
+	for (int r = 0; r < size; r++) {
+		input.rgb.red = r / float(size - 1);
+		for (int g = 0; g < size; g++) {
+			input.rgb.green = g / float(size - 1);
+			for (int b = 0; b < size; b++) {
+				input.rgb.blue = b / float(size - 1);
+				output = input;
+				function(input, output);
+				*value++ = output.rgb.red;
+				*value++ = output.rgb.green;
+				*value++ = output.rgb.blue;
+			}
+		}
+	}
+}
+void Lut3d::clear() {
+	m_size = 0;
+	m_values.clear();
+}
+bool Lut3d::empty() const {
+	return m_size == 0;
+}
+int Lut3d::size() const {
+	return m_size;
+}
+Color Lut3d::apply(const Color &input) const {
+	Color output;
+	apply(&input, &output, 1);
+	return output;
+}
+void Lut3d::apply(const Color *input, Color *output, size_t count) const {
+	const int last = m_size - 1;
+	const float scale = static_cast<float>(last);
+	const size_t strideB = 3, strideG = m_size * strideB, strideR = m_size * strideG;
+	for (size_t i = 0; i < count; i++) {
+		const float values[3] = { input[i].rgb.red, input[i].rgb.green, input[i].rgb.blue };
+		float fraction[3];
+		int index[3];
+		for (int j = 0; j < 3; j++) {
+			float position = std::clamp(values[j], 0.0f, 1.0f) * scale;
+			index[j] = std::min(static_cast<int>(position), last - 1);
+			fraction[j] = position - index[j];
+		}
+		float fr = fraction[0], fg = fraction[1], fb = fraction[2];
+		const float *c000 = m_values.data() + index[0] * strideR + index[1] * strideG + index[2] * strideB;
+		const float *c111 = c000 + strideR + strideG + strideB;
+		// Each tetrahedron is a path from c000 to c111 moving along one axis at a time, ordered by decreasing fraction.
+		const float *a, *b;
+		float w0, w1, w2, w3;
+		if (fr >= fg) {
+			if (fg >= fb) {
+				a = c000 + strideR;
+				b = a + strideG;
+				w1 = fr - fg; w2 = fg - fb; w3 = fb; w0 = 1 - fr;
+			} else if (fr >= fb) {
+				a = c000 + strideR;
+				b = a + strideB;
+				w1 = fr - fb; w2 = fb - fg; w3 = fg; w0 = 1 - fr;
+			} else {
+				a = c000 + strideB;
+				b = a + strideR;
+				w1 = fb - fr; w2 = fr - fg; w3 = fg; w0 = 1 - fb;
+			}
+		} else {
+			if (fr >= fb) {
+				a = c000 + strideG;
+				b = a + strideR;
+				w1 = fg - fr; w2 = fr - fb; w3 = fb; w0 = 1 - fg;
+			} else if (fg >= fb) {
+				a = c000 + strideG;
+				b = a + strideB;
+				w1 = fg - fb; w2 = fb - fr; w3 = fr; w0 = 1 - fg;
+			} else {
+				a = c000 + strideB;
+				b = a + strideG;
+				w1 = fb - fg; w2 = fg - fr; w3 = fr; w0 = 1 - fb;
+			}
+		}
+		float alpha = input[i].alpha;
+		output[i].rgb.red = w0 * c000[0] + w1 * a[0] + w2 * b[0] + w3 * c111[0];
+		output[i].rgb.green = w0 * c000[1] + w1 * a[1] + w2 * b[1] + w3 * c111[1];
+		output[i].rgb.blue = w0 * c000[2] + w1 * a[2] + w2 * b[2] + w3 * c111[2];
+		output[i].alpha = alpha;
+	}
+}
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_MATH_LUT3D_H_
+#define GPICK_MATH_LUT3D_H_
+#include "Color.h"
+#include <cstddef>
+#include <functional>
+#include <vector>
+namespace math {
+/** \struct Lut3d
+ * \brief Three dimensional lookup table of RGB color transformation.
+ *
+ * Transformation is sampled on a regular grid covering RGB values from 0 to 1. Colors between grid points are calculated using tetrahedral interpolation, so neutral colors are interpolated only from neutral grid points.
+ * Input values outside the 0 to 1 range are clamped. Alpha is copied from input color.
+ */
+struct Lut3d {
+	using Function = std::function<void(const Color &input, Color &output)>;
+	Lut3d();
+	/**
+	 * Sample transformation into the table.
+	 * @param[in] size Number of grid points per channel, at least 2.
+	 * @param[in] function Transformation function.
+	 */
+	void build(int size, const Function &function);
+	void clear();
+	bool empty() const;
+	int size() const;
+	/**
+	 * Transform color.
+	 * @param[in] input RGB color.
+	 * @return Transformed RGB color.
+	 */
+	Color apply(const Color &input) const;
+	/**
+	 * Transform an array of colors.
+	 * @param[in] input RGB colors.
+	 * @param[out] output Transformed RGB colors. Can be the same array as input.
+	 * @param[in] count Number of colors.
+	 */
+	void apply(const Color *input, Color *output, size_t count) const;
+private:
+	int m_size;
+	std::vector<float> m_values;
+};
+}
+#endif /* GPICK_MATH_LUT3D_H_ */
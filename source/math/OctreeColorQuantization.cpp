@@ -179,6 +179,38 @@ size_t OctreeColorQuantization::Node::totalPixels() const {
 	}
 	return result;
 }
+void OctreeColorQuantization::Node::sum(float colorSum[3], size_t &pixels) const {
+	pixels += m_pixels;
+	colorSum[0] += m_colorSum[0];
+	colorSum[1] += m_colorSum[1];
+	colorSum[2] += m_colorSum[2];
+	for (uint8_t i = 0; i < children; i++) {
+		if (m_children[i])
+			m_children[i]->sum(colorSum, pixels);
+	}
+}
+void OctreeColorQuantization::Node::merge(const Node *a, const Node *b, uint8_t depth, OctreeColorQuantization &ocq) {
+	if ((a && a->isLeaf()) || (b && b->isLeaf())) {
+		// leaf in one octree absorbs the whole subtree from the other octree
+		if (a)
+			a->sum(m_colorSum, m_pixels);
+		if (b)
+			b->sum(m_colorSum, m_pixels);
+		if (m_pixels > 0)
+			ocq.m_leafs++;
+		return;
+	}
+	for (uint8_t i = 0; i < children; i++) {
+		const Node *childA = a ? a->m_children[i] : nullptr;
+		const Node *childB = b ? b->m_children[i] : nullptr;
+		if (!childA && !childB)
+			continue;
+		m_children[i] = newNode(ocq.m_allocator, ocq.m_freeNodes);
+		if (depth < maxDepth - 1)
+			ocq.m_levels[depth].push_back(m_children[i]);
+		m_children[i]->merge(childA, childB, depth + 1, ocq);
+	}
+}
 OctreeColorQuantization::OctreeColorQuantization():
 	m_leafs(0),
 	m_memory(maxTotalNodes<maxNodesPerLevel>(1, maxDepth) * sizeof(Node)),
@@ -198,6 +230,43 @@ void OctreeColorQuantization::add(const Color &color, const Position position) {
 void OctreeColorQuantization::add(const Color &color, size_t pixels, const Position position) {
 	m_root.add(color, pixels, position, 0, *this);
 }
+void OctreeColorQuantization::addImage(const uint8_t *pixels, int width, int height, int stride, int channels) {
+	Color color;
+	for (int y = 0; y < height; y++) {
+		const uint8_t *dataPointer = pixels + static_cast<ptrdiff_t>(stride) * y;
+		for (int x = 0; x < width; x++) {
+			if (channels == 1) {
+				color.rgb.red = color.rgb.green = color.rgb.blue = Color::linearRgbValue(dataPointer[0]);
+				add(color, Position { dataPointer[0], dataPointer[0], dataPointer[0] });
+			} else {
+				color.rgb.red = Color::linearRgbValue(dataPointer[0]);
+				color.rgb.green = Color::linearRgbValue(dataPointer[1]);
+				color.rgb.blue = Color::linearRgbValue(dataPointer[2]);
+				add(color, Position { dataPointer[0], dataPointer[1], dataPointer[2] });
+			}
+			dataPointer += channels;
+		}
+	}
+}
+void OctreeColorQuantization::addImage(const uint8_t *pixels, int width, int height, int stride, int channels, size_t threads) {
+	if (threads == 1 || height <= tileRows) {
+		addImage(pixels, width, height, stride, channels);
+		return;
+	}
+	OctreeImageBuilder builder(threads);
+	builder.addImage(pixels, width, height, stride, channels);
+	builder.finish(*this);
+}
+void OctreeColorQuantization::merge(OctreeColorQuantization &a, OctreeColorQuantization &b) {
+	if (&a == this || &b == this)
+		throw std::invalid_argument("octree can not be merged into itself");
+	if (a.m_leafs > maxNodesPerLevel / 2)
+		a.reduce(maxNodesPerLevel / 2);
+	if (b.m_leafs > maxNodesPerLevel / 2)
+		b.reduce(maxNodesPerLevel / 2);
+	clear();
+	m_root.merge(&a.m_root, &b.m_root, 0, *this);
+}
 void OctreeColorQuantization::clear() {
 	m_root.clear();
 	m_bufferResource.release();
@@ -261,4 +330,114 @@ void OctreeColorQuantization::reduce(size_t numberOfColors, bool accurate) {
 size_t OctreeColorQuantization::size() const {
 	return m_leafs;
 }
+OctreeImageBuilder::OctreeImageBuilder(size_t threads):
+	m_threads(threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads),
+	m_generation(0),
+	m_busy(0),
+	m_stop(false) {
+}
+OctreeImageBuilder::~OctreeImageBuilder() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_start.notify_all();
+	for (auto &worker: m_workers)
+		worker.join();
+}
+static std::unique_ptr<OctreeColorQuantization> takeOctree(std::vector<std::unique_ptr<OctreeColorQuantization>> &spareOctrees) {
+	if (spareOctrees.empty())
+		return std::make_unique<OctreeColorQuantization>();
+	auto octree = std::move(spareOctrees.back());
+	spareOctrees.pop_back();
+	return octree;
+}
+void OctreeImageBuilder::run(const std::function<void(size_t)> &job) {
+	if (m_workers.empty()) {
+		for (size_t i = 1; i < m_threads; i++) {
+			m_workers.emplace_back([this, i, generation = m_generation]() mutable {
+				std::unique_lock<std::mutex> lock(m_mutex);
+				for (;;) {
+					m_start.wait(lock, [&]() {
+						return m_stop || m_generation != generation;
+					});
+					if (m_stop)
+						return;
+					generation = m_generation;
+					lock.unlock();
+					m_job(i);
+					lock.lock();
+					if (--m_busy == 0)
+						m_finished.notify_one();
+				}
+			});
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_job = job;
+		m_busy = m_workers.size();
+		m_generation++;
+	}
+	m_start.notify_all();
+	job(0);
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_finished.wait(lock, [this]() {
+		return m_busy == 0;
+	});
+	m_job = nullptr;
+}
+void OctreeImageBuilder::addImage(const uint8_t *pixels, int width, int height, int stride, int channels) {
+	if (m_octrees.empty())
+		m_octrees.push_back(takeOctree(m_spareOctrees));
+	int tiles = (height + OctreeColorQuantization::tileRows - 1) / OctreeColorQuantization::tileRows;
+	if (m_threads <= 1 || tiles <= 1) {
+		// small parts are added by the calling thread, so workers are not woken up for a few rows
+		m_octrees.front()->addImage(pixels, width, height, stride, channels);
+		return;
+	}
+	while (m_octrees.size() < m_threads)
+		m_octrees.push_back(takeOctree(m_spareOctrees));
+	std::atomic<int> nextTile(0);
+	run([&](size_t index) {
+		int tile;
+		while ((tile = nextTile.fetch_add(1, std::memory_order_relaxed)) < tiles) {
+			int y = tile * OctreeColorQuantization::tileRows;
+			m_octrees[index]->addImage(pixels + static_cast<ptrdiff_t>(stride) * y, width, std::min(OctreeColorQuantization::tileRows, height - y), stride, channels);
+		}
+	});
+}
+void OctreeImageBuilder::finish(OctreeColorQuantization &octree) {
+	if (m_octrees.empty())
+		return;
+	while (m_octrees.size() > 1) {
+		size_t pairs = m_octrees.size() / 2;
+		std::vector<std::unique_ptr<OctreeColorQuantization>> merged(pairs);
+		for (auto &mergedOctree: merged)
+			mergedOctree = takeOctree(m_spareOctrees);
+		std::atomic<size_t> nextPair(0);
+		run([&](size_t) {
+			size_t pair;
+			while ((pair = nextPair.fetch_add(1, std::memory_order_relaxed)) < pairs)
+				merged[pair]->merge(*m_octrees[pair * 2], *m_octrees[pair * 2 + 1]);
+		});
+		if (m_octrees.size() % 2 == 1)
+			merged.push_back(std::move(m_octrees.back()));
+		for (size_t i = 0; i < pairs * 2; i++) {
+			m_octrees[i]->clear();
+			m_spareOctrees.push_back(std::move(m_octrees[i]));
+		}
+		m_octrees.swap(merged);
+	}
+	OctreeColorQuantization current(octree);
+	octree.merge(current, *m_octrees.front());
+	clear();
+}
+void OctreeImageBuilder::clear() {
+	for (auto &octree: m_octrees) {
+		octree->clear();
+		m_spareOctrees.push_back(std::move(octree));
+	}
+	m_octrees.clear();
+}
 }
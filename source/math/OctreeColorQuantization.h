@@ -20,15 +20,22 @@
 #define GPICK_MATH_OCTREE_COLOR_QUANTIZATION_H_
 #include "Color.h"
 #include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <memory_resource>
+#include <mutex>
+#include <thread>
 #include <vector>
 namespace math {
 struct OctreeColorQuantization {
 	static constexpr uint8_t children = 8;
 	static constexpr uint8_t maxDepth = 8;
 	static constexpr size_t maxNodesPerLevel = 4096;
+	static constexpr int tileRows = 64;
 	struct Node;
 	using Allocator = std::pmr::polymorphic_allocator<Node>;
 	using Position = std::array<uint8_t, 3>;
@@ -44,6 +51,8 @@ struct OctreeColorQuantization {
 		size_t leafs() const;
 		bool isLeaf() const;
 		size_t totalPixels() const;
+		void sum(float colorSum[3], size_t &pixels) const;
+		void merge(const Node *a, const Node *b, uint8_t depth, OctreeColorQuantization &ocq);
 		template<typename Callback>
 		void visit(Callback &&callback) const {
 			if (isLeaf()) {
@@ -65,6 +74,33 @@ struct OctreeColorQuantization {
 	OctreeColorQuantization(const OctreeColorQuantization &ocq);
 	void add(const Color &color, const Position position);
 	void add(const Color &color, size_t pixels, const Position position);
+	/**
+	 * Add all pixels of an 8 bit per channel image.
+	 * @param[in] pixels Image data.
+	 * @param[in] width Image width.
+	 * @param[in] height Image height.
+	 * @param[in] stride Number of bytes between rows.
+	 * @param[in] channels Number of channels per pixel. Single channel images are treated as grayscale, channels after the third one are ignored.
+	 */
+	void addImage(const uint8_t *pixels, int width, int height, int stride, int channels);
+	/**
+	 * Add all pixels of an 8 bit per channel image using multiple threads.
+	 * Convenience wrapper around OctreeImageBuilder for images which are available as a whole. Threads and private octrees are created for each call, use OctreeImageBuilder directly when image is added in multiple parts.
+	 * @param[in] pixels Image data.
+	 * @param[in] width Image width.
+	 * @param[in] height Image height.
+	 * @param[in] stride Number of bytes between rows.
+	 * @param[in] channels Number of channels per pixel.
+	 * @param[in] threads Number of worker threads. Zero selects the number of hardware threads.
+	 */
+	void addImage(const uint8_t *pixels, int width, int height, int stride, int channels, size_t threads);
+	/**
+	 * Replace octree contents with all colors from two other octrees.
+	 * Octrees with more than maxNodesPerLevel / 2 colors are reduced first, so the result never has to be reduced while merging.
+	 * @param[in,out] a First octree.
+	 * @param[in,out] b Second octree.
+	 */
+	void merge(OctreeColorQuantization &a, OctreeColorQuantization &b);
 	void clear();
 	void reduce(size_t numberOfColors, bool accurate = true);
 	size_t size() const;
@@ -83,5 +119,47 @@ private:
 	void rebuildLevel(uint8_t level);
 	friend struct Node;
 };
+/** \struct OctreeImageBuilder
+ * \brief Adds image parts to private per-thread octrees using persistent worker threads.
+ *
+ * Each added part is split into bands of OctreeColorQuantization::tileRows rows which the calling thread and worker threads take from a shared counter. Worker threads and private octrees are kept between calls and private octrees are merged pairwise in parallel only once, when finish is called.
+ */
+struct OctreeImageBuilder {
+	/**
+	 * @param[in] threads Number of threads, including the calling thread. Zero selects the number of hardware threads.
+	 */
+	OctreeImageBuilder(size_t threads = 0);
+	OctreeImageBuilder(const OctreeImageBuilder &) = delete;
+	~OctreeImageBuilder();
+	OctreeImageBuilder &operator=(const OctreeImageBuilder &) = delete;
+	/**
+	 * Add all pixels of an 8 bit per channel image part. Returns after all pixels are added, so image data can be released afterwards.
+	 * @param[in] pixels Image data.
+	 * @param[in] width Image width.
+	 * @param[in] height Number of image rows.
+	 * @param[in] stride Number of bytes between rows.
+	 * @param[in] channels Number of channels per pixel. Single channel images are treated as grayscale, channels after the third one are ignored.
+	 */
+	void addImage(const uint8_t *pixels, int width, int height, int stride, int channels);
+	/**
+	 * Merge all added pixels into an octree, keeping existing octree contents. Builder is cleared and can be reused afterwards.
+	 * @param[in,out] octree Destination octree.
+	 */
+	void finish(OctreeColorQuantization &octree);
+	/**
+	 * Drop all added pixels.
+	 */
+	void clear();
+private:
+	size_t m_threads;
+	std::vector<std::unique_ptr<OctreeColorQuantization>> m_octrees, m_spareOctrees;
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_start, m_finished;
+	std::function<void(size_t)> m_job;
+	size_t m_generation, m_busy;
+	bool m_stop;
+	void run(const std::function<void(size_t)> &job);
+};
 }
 #endif /* GPICK_MATH_OCTREE_COLOR_QUANTIZATION_H_ */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "RadixSort.h"
+#include <algorithm>
+#include <array>
+#include <thread>
+namespace math {
+namespace {
+constexpr size_t digitBits = 8, buckets = 1 << digitBits, passes = 32 / digitBits;
+// Starting a thread costs more than sorting a few thousand keys.
+constexpr size_t minChunkSize = 32768;
+using Histogram = std::array<size_t, buckets>;
+inline size_t digit(uint32_t key, size_t pass) {
+	return (key >> (pass * digitBits)) & (buckets - 1);
+}
+template<typename Callback>
+void parallelFor(size_t chunks, Callback &&callback) {
+	if (chunks == 1) {
+		callback(0);
+		return;
+	}
+	std::vector<std::thread> workers;
+	workers.reserve(chunks - 1);
+	for (size_t i = 1; i < chunks; i++) {
+		workers.emplace_back([&callback, i]() {
+			callback(i);
+		});
+	}
+	callback(0);
+	for (auto &worker: workers)
+		worker.join();
+}
+}
+void radixSort(std::vector<uint32_t> &keys, std::vector<uint32_t> &values, size_t threads) {
+	size_t count = keys.size();
+	if (count < 2)
+		return;
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	size_t chunks = std::max<size_t>(1, std::min(threads, count / minChunkSize));
+	size_t chunkSize = (count + chunks - 1) / chunks;
+	auto chunkBegin = [count, chunkSize](size_t chunk) {
+		return std::min(count, chunk * chunkSize);
+	};
+	// Digits of all passes are counted at once to find passes which would not move anything.
+	std::vector<std::array<Histogram, passes>> chunkHistograms(chunks);
+	parallelFor(chunks, [&](size_t chunk) {
+		auto &histograms = chunkHistograms[chunk];
+		for (auto &histogram: histograms)
+			histogram.fill(0);
+		for (size_t i = chunkBegin(chunk), end = chunkBegin(chunk + 1); i < end; i++) {
+			for (size_t pass = 0; pass < passes; pass++)
+				histograms[pass][digit(keys[i], pass)]++;
+		}
+	});
+	std::vector<uint32_t> sortedKeys(count), sortedValues(count);
+	std::vector<Histogram> offsets(chunks);
+	bool reordered = false;
+	for (size_t pass = 0; pass < passes; pass++) {
+		Histogram total {};
+		for (const auto &histograms: chunkHistograms) {
+			for (size_t bucket = 0; bucket < buckets; bucket++)
+				total[bucket] += histograms[pass][bucket];
+		}
+		if (std::find(total.begin(), total.end(), count) != total.end())
+			continue;
+		if (reordered) {
+			// Chunk contents changed in previous pass, so chunk histograms have to be counted again.
+			parallelFor(chunks, [&](size_t chunk) {
+				auto &histogram = chunkHistograms[chunk][pass];
+				histogram.fill(0);
+				for (size_t i = chunkBegin(chunk), end = chunkBegin(chunk + 1); i < end; i++)
+					histogram[digit(keys[i], pass)]++;
+			});
+		}
+		// Equal digits are placed in chunk order, which keeps the sort stable.
+		size_t offset = 0;
+		for (size_t bucket = 0; bucket < buckets; bucket++) {
+			for (size_t chunk = 0; chunk < chunks; chunk++) {
+				offsets[chunk][bucket] = offset;
+				offset += chunkHistograms[chunk][pass][bucket];
+			}
+		}
+		parallelFor(chunks, [&](size_t chunk) {
+			auto &chunkOffsets = offsets[chunk];
+			for (size_t i = chunkBegin(chunk), end = chunkBegin(chunk + 1); i < end; i++) {
+				size_t position = chunkOffsets[digit(keys[i], pass)]++;
+				sortedKeys[position] = keys[i];
+				sortedValues[position] = values[i];
+			}
+		});
+		keys.swap(sortedKeys);
+		values.swap(sortedValues);
+		reordered = true;
+	}
+}
+}
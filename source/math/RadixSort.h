@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef GPICK_MATH_RADIX_SORT_H_
+#define GPICK_MATH_RADIX_SORT_H_
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+namespace math {
+/**
+ * Convert float value into an unsigned integer key, so that keys compare in the same order as float values.
+ * Negative zero is ordered before positive zero, NaN values are ordered before negative infinity or after positive infinity depending on their sign bit.
+ * @param[in] value Float value.
+ * @return Sortable key.
+ */
+inline uint32_t sortableKey(float value) {
+	uint32_t bits;
+	static_assert(sizeof(bits) == sizeof(value));
+	std::memcpy(&bits, &value, sizeof(bits));
+	return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+/**
+ * Stable LSD radix sort of values by 32 bit keys. Passes where all keys have the same digit are skipped.
+ * Large inputs are split into chunks, which are counted and scattered by multiple threads without changing the order of equal keys.
+ * @param[in,out] keys Keys, sorted in ascending order on return.
+ * @param[in,out] values Values, reordered together with keys. Must have the same size as keys.
+ * @param[in] threads Number of threads. Zero selects the number of hardware threads.
+ */
+void radixSort(std::vector<uint32_t> &keys, std::vector<uint32_t> &values, size_t threads = 0);
+}
+#endif /* GPICK_MATH_RADIX_SORT_H_ */
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "AutoSaveJournal.h"
+#include "ColorList.h"
+#include "ColorObject.h"
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+namespace fs = std::filesystem;
+namespace {
+struct TemporaryDirectory {
+	TemporaryDirectory():
+		path(fs::temp_directory_path() / "gpick-test-autosave") {
+		fs::remove_all(path);
+		fs::create_directories(path);
+	}
+	~TemporaryDirectory() {
+		std::error_code ec;
+		fs::remove_all(path, ec);
+	}
+	std::string file(const char *name) const {
+		return (path / name).string();
+	}
+	fs::path path;
+};
+using Contents = std::vector<std::pair<std::string, std::vector<float>>>;
+Contents contents(const ColorList &colorList) {
+	Contents result;
+	for (auto *colorObject: colorList) {
+		const auto &color = colorObject->getColor();
+		result.emplace_back(colorObject->getName(), std::vector<float> { color[0], color[1], color[2], color[3] });
+	}
+	return result;
+}
+Contents restore(const std::string &snapshot, const std::string &journal) {
+	ColorList colorList;
+	AutoSaveJournal autoSave(snapshot, journal);
+	auto result = autoSave.restore(colorList);
+	BOOST_REQUIRE_MESSAGE(result, result.error());
+	return contents(colorList);
+}
+void addColors(ColorList &colorList, int first, int count) {
+	for (int i = first; i < first + count; i++)
+		colorList.add(ColorObject("color " + std::to_string(i), Color(i / 100.0f, 0.5f, 1.0f - i / 100.0f, 1.0f)));
+}
+}
+BOOST_AUTO_TEST_SUITE(autoSaveJournal)
+BOOST_AUTO_TEST_CASE(replay) {
+	TemporaryDirectory directory;
+	auto snapshot = directory.file("autosave.gpa"), journal = directory.file("autosave.journal");
+	ColorList colorList;
+	addColors(colorList, 0, 10);
+	AutoSaveJournal autoSave(snapshot, journal);
+	autoSave.start(colorList);
+	BOOST_CHECK(!autoSave.flush());
+	addColors(colorList, 10, 5);
+	BOOST_CHECK(autoSave.flush());
+	colorList.removeIf([](ColorObject *colorObject) {
+		return colorObject->getName() == "color 3" || colorObject->getName() == "color 12";
+	});
+	std::vector<size_t> order;
+	for (size_t i = colorList.size(); i > 0; i--)
+		order.push_back(i - 1);
+	colorList.reorder(common::Span<const size_t>(order.data(), order.size()));
+	colorList.front()->setName("renamed");
+	colorList.back()->setColor(Color(0.25f));
+	addColors(colorList, 20, 1);
+	BOOST_CHECK(autoSave.flush());
+	autoSave.wait();
+	BOOST_CHECK(restore(snapshot, journal) == contents(colorList));
+	autoSave.close();
+	BOOST_CHECK_EQUAL(autoSave.snapshotCount(), 1);
+	BOOST_CHECK(restore(snapshot, journal) == contents(colorList));
+}
+BOOST_AUTO_TEST_CASE(truncated) {
+	TemporaryDirectory directory;
+	auto snapshot = directory.file("autosave.gpa"), journal = directory.file("autosave.journal");
+	ColorList colorList;
+	addColors(colorList, 0, 5);
+	AutoSaveJournal autoSave(snapshot, journal);
+	autoSave.start(colorList);
+	addColors(colorList, 5, 5);
+	autoSave.flush();
+	autoSave.wait();
+	auto firstState = contents(colorList);
+	auto firstSize = fs::file_size(journal);
+	colorList.front()->setName("renamed");
+	autoSave.flush();
+	autoSave.close();
+	BOOST_REQUIRE_GT(fs::file_size(journal), firstSize);
+	fs::resize_file(journal, fs::file_size(journal) - 1); // last record cut short as if writing was interrupted
+	BOOST_CHECK(restore(snapshot, journal) == firstState);
+	ColorList restored;
+	AutoSaveJournal restoredAutoSave(snapshot, journal);
+	BOOST_REQUIRE(restoredAutoSave.restore(restored));
+	restoredAutoSave.start(restored);
+	restoredAutoSave.close();
+	BOOST_CHECK_EQUAL(restoredAutoSave.snapshotCount(), 1); // damaged journal is replaced
+	BOOST_CHECK(restore(snapshot, journal) == firstState);
+}
+BOOST_AUTO_TEST_CASE(compaction) {
+	TemporaryDirectory directory;
+	auto snapshot = directory.file("autosave.gpa"), journal = directory.file("autosave.journal");
+	ColorList colorList;
+	addColors(colorList, 0, 2000);
+	AutoSaveJournal autoSave(snapshot, journal);
+	autoSave.start(colorList);
+	for (int i = 0; i < 20; i++) {
+		for (auto *colorObject: colorList)
+			colorObject->setName("edit " + std::to_string(i));
+		autoSave.flush();
+	}
+	autoSave.close();
+	BOOST_CHECK_GT(autoSave.snapshotCount(), 1);
+	BOOST_CHECK(restore(snapshot, journal) == contents(colorList));
+}
+BOOST_AUTO_TEST_CASE(changes_before_flush) {
+	TemporaryDirectory directory;
+	auto snapshot = directory.file("autosave.gpa"), journal = directory.file("autosave.journal");
+	ColorList colorList;
+	addColors(colorList, 0, 5);
+	AutoSaveJournal autoSave(snapshot, journal);
+	autoSave.start(colorList);
+	addColors(colorList, 5, 5);
+	colorList.removeIf([](ColorObject *colorObject) {
+		return colorObject->getName() == "color 6";
+	});
+	std::vector<size_t> order;
+	for (size_t i = colorList.size(); i > 0; i--)
+		order.push_back(i - 1);
+	colorList.reorder(common::Span<const size_t>(order.data(), order.size()));
+	colorList.front()->setColor(Color(0.75f));
+	ColorObject unrelated;
+	unrelated.setName("unrelated");
+	BOOST_CHECK(autoSave.flush());
+	autoSave.wait();
+	BOOST_CHECK(restore(snapshot, journal) == contents(colorList));
+	unrelated.setName("unrelated edit");
+	BOOST_CHECK(!autoSave.flush());
+	std::vector<ColorObject *> colorObjects(colorList.begin(), colorList.begin() + 3);
+	colorList.replaceAll(common::Span<ColorObject *const>(colorObjects.data(), colorObjects.size()));
+	colorList.back()->setName("replaced");
+	BOOST_CHECK(autoSave.flush());
+	autoSave.close();
+	BOOST_CHECK_EQUAL(autoSave.snapshotCount(), 1);
+	BOOST_CHECK(restore(snapshot, journal) == contents(colorList));
+}
+BOOST_AUTO_TEST_CASE(other_snapshot) {
+	TemporaryDirectory directory;
+	auto snapshot = directory.file("autosave.gpa"), journal = directory.file("autosave.journal");
+	ColorList colorList;
+	addColors(colorList, 0, 3);
+	{
+		AutoSaveJournal autoSave(snapshot, journal);
+		autoSave.start(colorList);
+		addColors(colorList, 3, 3);
+		autoSave.close();
+	}
+	ColorList other;
+	addColors(other, 50, 2);
+	{
+		AutoSaveJournal autoSave(snapshot, directory.file("other.journal"));
+		autoSave.start(other);
+		autoSave.close();
+	}
+	BOOST_CHECK(restore(snapshot, journal) == contents(other));
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -156,6 +156,22 @@ BOOST_AUTO_TEST_CASE(lch) {
 	Color result = testColor.rgbToLchD50().lchToRgbD50();
 	BOOST_CHECK_EQUAL(result, testColor);
 }
+BOOST_AUTO_TEST_CASE(linearRgbTable) {
+	for (int i = 0; i < 256; i++) {
+		BOOST_CHECK_EQUAL(Color::linearRgbValue(static_cast<uint8_t>(i)), Color(i, i, i).linearRgb().red);
+	}
+}
+BOOST_AUTO_TEST_CASE(nonLinearRgbTable) {
+	for (int i = -10; i <= 10010; i++) {
+		Color color(i / 10000.0f, 0.0f, 0.0f);
+		BOOST_CHECK_SMALL(color.nonLinearRgbFast().red - color.nonLinearRgb().red, 2e-5f);
+	}
+	Color result = testColor.linearRgb().nonLinearRgbFastInplace();
+	BOOST_CHECK_SMALL(result.red - testColor.red, 2e-5f);
+	BOOST_CHECK_SMALL(result.green - testColor.green, 2e-5f);
+	BOOST_CHECK_SMALL(result.blue - testColor.blue, 2e-5f);
+	BOOST_CHECK_EQUAL(result.alpha, testColor.alpha);
+}
 BOOST_AUTO_TEST_CASE(sRGBMatrix) {
 	auto result = Color(Color::sRGBInvertedMatrix * (Color::sRGBMatrix * testColor.rgbVector<double>()));
 	BOOST_CHECK_EQUAL(result, testColor);
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "Common.h"
+#include "ColorBatch.h"
+#include <cmath>
+#include <functional>
+namespace {
+struct Initialize {
+	Initialize() {
+		Color::initialize();
+		for (int r = 0; r <= 10; r++) {
+			for (int g = 0; g <= 10; g++) {
+				for (int b = 0; b <= 10; b++) {
+					colors.emplace_back(r / 10.0f, g / 10.0f, b / 10.0f, (r + g + b) / 30.0f);
+				}
+			}
+		}
+		colors.emplace_back(0.01f, 0.002f, 0.0f, 1.0f);
+		colors.emplace_back(0.5f, 0.25f, 0.1f, 1.0f);
+		colors.emplace_back(1.0f, 0.2f, 0.6f, 1.0f);
+	}
+	~Initialize() {
+		ColorBatch::setInstructions(ColorBatch::supportedInstructions());
+	}
+	ColorBatch batch() const {
+		ColorBatch result(colors.size());
+		for (size_t i = 0; i < colors.size(); i++)
+			result.set(i, colors[i]);
+		return result;
+	}
+	void compare(std::function<void(const ColorBatch &, ColorBatch &)> convert, std::function<Color(const Color &)> expected, float tolerance, int hueIndex = -1, float huePeriod = 1.0f) {
+		for (auto instructions: { ColorBatch::Instructions::scalar, ColorBatch::Instructions::sse2, ColorBatch::Instructions::avx2 }) {
+			ColorBatch::setInstructions(instructions);
+			ColorBatch input = batch(), output;
+			convert(input, output);
+			BOOST_REQUIRE_EQUAL(output.size(), colors.size());
+			for (size_t i = 0; i < colors.size(); i++) {
+				Color value = output.get(i), expectedValue = expected(colors[i]);
+				for (int j = 0; j < 3; j++) {
+					float difference = std::abs(value[j] - expectedValue[j]);
+					if (j == hueIndex)
+						difference = std::min(difference, huePeriod - difference);
+					BOOST_CHECK_SMALL(difference, tolerance);
+				}
+				BOOST_CHECK_EQUAL(value.alpha, expectedValue.alpha);
+			}
+		}
+	}
+	std::vector<Color> colors;
+};
+}
+BOOST_FIXTURE_TEST_SUITE(colorBatch, Initialize)
+BOOST_AUTO_TEST_CASE(storage) {
+	ColorBatch batch(3);
+	batch.set(1, Color(0.1f, 0.2f, 0.3f, 0.4f));
+	BOOST_CHECK_EQUAL(batch.get(1), Color(0.1f, 0.2f, 0.3f, 0.4f));
+	BOOST_CHECK_EQUAL(batch[2][1], 0.3f);
+	batch.resize(20);
+	BOOST_CHECK_EQUAL(batch.size(), 20);
+	BOOST_CHECK_EQUAL(batch.get(1), Color(0.1f, 0.2f, 0.3f, 0.4f));
+	BOOST_CHECK_EQUAL(batch.get(19), Color(0.0f));
+	batch.resize(1);
+	batch.resize(2);
+	BOOST_CHECK_EQUAL(batch.get(1), Color(0.0f));
+}
+BOOST_AUTO_TEST_CASE(linearRgb) {
+	compare([](const ColorBatch &input, ColorBatch &output) {
+		input.linearRgb(output);
+	}, [](const Color &color) {
+		return color.linearRgb();
+	}, ColorBatch::rgbTolerance);
+}
+BOOST_AUTO_TEST_CASE(nonLinearRgb) {
+	compare([](const ColorBatch &input, ColorBatch &output) {
+		input.nonLinearRgb(output);
+	}, [](const Color &color) {
+		return color.nonLinearRgb();
+	}, ColorBatch::rgbTolerance);
+}
+BOOST_AUTO_TEST_CASE(inplace) {
+	compare([](const ColorBatch &input, ColorBatch &output) {
+		output = input;
+		output.linearRgb(output);
+		output.nonLinearRgb(output);
+	}, [](const Color &color) {
+		return color;
+	}, ColorBatch::rgbTolerance);
+}
+BOOST_AUTO_TEST_CASE(hsv) {
+	compare([](const ColorBatch &input, ColorBatch &output) {
+		input.rgbToHsv(output);
+	}, [](const Color &color) {
+		return color.rgbToHsv();
+	}, ColorBatch::rgbTolerance, 0);
+}
+BOOST_AUTO_TEST_CASE(hsl) {
+	compare([](const ColorBatch &input, ColorBatch &output) {
+		input.rgbToHsl(output);
+	}, [](const Color &color) {
+		return color.rgbToHsl();
+	}, ColorBatch::rgbTolerance, 0);
+}
+BOOST_AUTO_TEST_CASE(xyz) {
+	compare([](const ColorBatch &input, ColorBatch &output) {
+		input.rgbToXyz(Color::sRGBMatrix, output);
+	}, [](const Color &color) {
+		return color.rgbToXyz(Color::sRGBMatrix);
+	}, ColorBatch::labTolerance);
+}
+BOOST_AUTO_TEST_CASE(lab) {
+	compare([](const ColorBatch &input, ColorBatch &output) {
+		input.rgbToLabD50(output);
+	}, [](const Color &color) {
+		return color.rgbToLabD50();
+	}, ColorBatch::labTolerance);
+}
+BOOST_AUTO_TEST_CASE(lch) {
+	compare([](const ColorBatch &input, ColorBatch &output) {
+		input.rgbToLchD50(output);
+		// hue is undefined for gray colors
+		for (size_t i = 0; i < output.size(); i++) {
+			if (output[1][i] < 0.01f)
+				output[2][i] = 0;
+		}
+	}, [](const Color &color) {
+		auto lch = color.rgbToLchD50();
+		if (lch.lch.C < 0.01f)
+			lch.lch.h = 0;
+		return lch;
+	}, ColorBatch::labTolerance, 2, 360.0f);
+}
+BOOST_AUTO_TEST_CASE(distanceLch) {
+	for (auto instructions: { ColorBatch::Instructions::scalar, ColorBatch::Instructions::sse2, ColorBatch::Instructions::avx2 }) {
+		ColorBatch::setInstructions(instructions);
+		ColorBatch lab;
+		batch().rgbToLabD50(lab);
+		std::vector<float> distances(lab.size());
+		Color color = Color(0.3f, 0.6f, 0.2f).rgbToLabD50();
+		lab.distanceLch(color, distances.data());
+		for (size_t i = 0; i < colors.size(); i++) {
+			float expected = Color::distanceLch(color, colors[i].rgbToLabD50());
+			BOOST_CHECK_SMALL(std::abs(distances[i] - expected) / std::max(expected, 1.0f), ColorBatch::rgbTolerance);
+		}
+	}
+}
+BOOST_AUTO_TEST_CASE(nearest) {
+	ColorBatch lab, palette(7);
+	batch().rgbToLabD50(lab);
+	for (size_t i = 0; i < palette.size(); i++)
+		palette.set(i, lab.get(i * 97 % lab.size()));
+	for (auto instructions: { ColorBatch::Instructions::scalar, ColorBatch::Instructions::sse2, ColorBatch::Instructions::avx2 }) {
+		ColorBatch::setInstructions(instructions);
+		size_t offset = 3, count = lab.size() - 5;
+		std::vector<uint32_t> indices(count);
+		std::vector<float> distances(count);
+		lab.nearest(palette, offset, count, indices.data(), distances.data());
+		for (size_t i = 0; i < count; i++) {
+			Color color = lab.get(offset + i);
+			float best = 0;
+			uint32_t bestIndex = 0;
+			for (uint32_t j = 0; j < palette.size(); j++) {
+				Color paletteColor = palette.get(j);
+				float distance = 0;
+				for (int k = 0; k < 3; k++)
+					distance += (color[k] - paletteColor[k]) * (color[k] - paletteColor[k]);
+				if (j == 0 || distance < best) {
+					best = distance;
+					bestIndex = j;
+				}
+			}
+			BOOST_CHECK_EQUAL(indices[i], bestIndex);
+			BOOST_CHECK_SMALL(distances[i] - best, ColorBatch::labTolerance);
+		}
+	}
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "math/ColorIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+using namespace math;
+namespace {
+struct Initialize {
+	Initialize() {
+		Color::initialize();
+		std::srand(1);
+		for (int i = 0; i < 2000; i++)
+			colors.push_back(randomColor());
+		// duplicates and a dense cluster
+		for (int i = 0; i < 50; i++)
+			colors.push_back(colors[i]);
+		for (int i = 0; i < 200; i++)
+			colors.push_back(Color(0.5f + i * 0.0001f, 0.5f, 0.5f).rgbToLabD50());
+		for (size_t i = 0; i < colors.size(); i++)
+			index.add(colors[i], static_cast<uint32_t>(i));
+		index.build();
+	}
+	static Color randomColor() {
+		return Color(std::rand() / static_cast<float>(RAND_MAX), std::rand() / static_cast<float>(RAND_MAX), std::rand() / static_cast<float>(RAND_MAX)).rgbToLabD50();
+	}
+	std::vector<ColorIndex::Result> bruteForce(const Color &color) const {
+		std::vector<std::pair<float, uint32_t>> distances;
+		for (size_t i = 0; i < colors.size(); i++)
+			distances.emplace_back(Color::distanceLch(colors[i], color), static_cast<uint32_t>(i));
+		std::sort(distances.begin(), distances.end());
+		std::vector<ColorIndex::Result> results;
+		for (const auto &item: distances)
+			results.emplace_back(item.second, item.first);
+		return results;
+	}
+	std::vector<Color> colors;
+	ColorIndex index;
+};
+}
+BOOST_FIXTURE_TEST_SUITE(colorIndex, Initialize)
+BOOST_AUTO_TEST_CASE(empty) {
+	ColorIndex emptyIndex;
+	emptyIndex.build();
+	BOOST_CHECK(emptyIndex.empty());
+	BOOST_CHECK(!emptyIndex.findNearest(colors[0]));
+	std::vector<ColorIndex::Result> results;
+	emptyIndex.findWithin(colors[0], 100.0f, results);
+	BOOST_CHECK(results.empty());
+}
+BOOST_AUTO_TEST_CASE(findNearest) {
+	BOOST_CHECK_EQUAL(index.size(), colors.size());
+	std::vector<ColorIndex::Result> results;
+	for (int i = 0; i < 200; i++) {
+		Color color = i < 100 ? randomColor() : colors[i * 7];
+		auto expected = bruteForce(color);
+		index.findNearest(color, 10, results);
+		BOOST_REQUIRE_EQUAL(results.size(), 10);
+		for (size_t j = 0; j < results.size(); j++)
+			BOOST_CHECK_SMALL(std::abs(results[j].second - expected[j].second), 1e-3f);
+		auto nearest = index.findNearest(color);
+		BOOST_REQUIRE(nearest);
+		BOOST_CHECK_SMALL(std::abs(nearest->second - expected[0].second), 1e-3f);
+	}
+	index.findNearest(colors[0], colors.size() + 10, results);
+	BOOST_CHECK_EQUAL(results.size(), colors.size());
+}
+BOOST_AUTO_TEST_CASE(findWithin) {
+	std::vector<ColorIndex::Result> results;
+	for (int i = 0; i < 100; i++) {
+		Color color = randomColor();
+		float radius = 2.0f + i * 0.2f;
+		auto expected = bruteForce(color);
+		size_t count = 0;
+		while (count < expected.size() && expected[count].second <= radius)
+			count++;
+		index.findWithin(color, radius, results);
+		BOOST_REQUIRE_EQUAL(results.size(), count);
+		for (size_t j = 0; j < results.size(); j++)
+			BOOST_CHECK_SMALL(std::abs(results[j].second - expected[j].second), 1e-3f);
+	}
+}
+BOOST_AUTO_TEST_CASE(saveAndLoad) {
+	std::vector<uint8_t> data;
+	index.save(data);
+	ColorIndex loadedIndex;
+	BOOST_REQUIRE(loadedIndex.load(data.data(), data.size()));
+	BOOST_CHECK_EQUAL(loadedIndex.size(), index.size());
+	std::vector<ColorIndex::Result> results, expected;
+	for (int i = 0; i < 20; i++) {
+		Color color = randomColor();
+		index.findNearest(color, 5, expected);
+		loadedIndex.findNearest(color, 5, results);
+		BOOST_CHECK(results == expected);
+	}
+	BOOST_CHECK(!loadedIndex.load(data.data(), data.size() - 1));
+	BOOST_CHECK(loadedIndex.empty());
+	data[8 + sizeof(float) * 4 * colors.size() + sizeof(uint32_t) * 2 * colors.size() + 43] = 0xff; // root node left child index
+	BOOST_CHECK(!loadedIndex.load(data.data(), data.size()));
+}
+BOOST_AUTO_TEST_SUITE_END()
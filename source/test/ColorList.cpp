@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <boost/test/unit_test.hpp>
+#include "ColorList.h"
+#include "ColorObject.h"
+#include "IPalette.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+namespace {
+struct RecordingPalette: public IPalette {
+	std::vector<ColorListChange::Type> changes;
+	std::vector<std::pair<size_t, size_t>> ranges;
+	size_t adds = 0;
+	virtual void add(ColorList &, ColorObject *) override {
+		adds++;
+	}
+	virtual void change(ColorList &, const ColorListChange &change) override {
+		changes.push_back(change.type);
+		ranges.assign(change.ranges.data(), change.ranges.data() + change.ranges.size());
+	}
+	virtual void clear(ColorList &) override {
+	}
+	virtual void update(ColorList &) override {
+	}
+};
+std::string names(const ColorList &colorList) {
+	std::string result;
+	for (auto *colorObject: colorList)
+		result += colorObject->getName();
+	return result;
+}
+}
+BOOST_AUTO_TEST_SUITE(colorList)
+BOOST_AUTO_TEST_CASE(bulkOperations) {
+	RecordingPalette palette;
+	ColorList colorList(palette);
+	std::vector<ColorObject> storage;
+	std::vector<ColorObject *> colorObjects;
+	storage.reserve(6);
+	for (auto name: { "a", "b", "c", "d", "e", "f" }) {
+		storage.emplace_back(name, Color());
+		colorObjects.push_back(&storage.back());
+	}
+	colorList.addRange(common::Span<ColorObject *const>(colorObjects.data(), 4));
+	colorList.addRange(1, common::Span<ColorObject *const>(colorObjects.data() + 4, 2));
+	BOOST_CHECK_EQUAL(names(colorList), "aefbcd");
+	BOOST_CHECK_EQUAL(palette.adds, 0);
+	BOOST_CHECK_EQUAL(palette.changes.size(), 2);
+	BOOST_CHECK_EQUAL(colorList.removeIf([](ColorObject *colorObject) {
+		return colorObject->getName() != "f" && colorObject->getName() != "d";
+	}), 4);
+	BOOST_CHECK_EQUAL(names(colorList), "fd");
+	BOOST_CHECK(palette.ranges == (std::vector<std::pair<size_t, size_t>>{ { 0, 2 }, { 3, 5 } }));
+	const size_t order[] = { 1, 0 };
+	colorList.reorder(common::Span<const size_t>(order, 2));
+	BOOST_CHECK_EQUAL(names(colorList), "df");
+	const size_t invalidOrder[] = { 1, 1 };
+	BOOST_CHECK_THROW(colorList.reorder(common::Span<const size_t>(invalidOrder, 2)), std::invalid_argument);
+	colorList.replaceAll(common::Span<ColorObject *const>(colorObjects.data(), 3));
+	BOOST_CHECK_EQUAL(names(colorList), "abc");
+	BOOST_CHECK(palette.changes == (std::vector<ColorListChange::Type>{ ColorListChange::Type::insert, ColorListChange::Type::insert, ColorListChange::Type::remove, ColorListChange::Type::reorder, ColorListChange::Type::replace }));
+	colorList.replaceAll(common::Span<ColorObject *const>());
+	for (auto &colorObject: storage)
+		BOOST_CHECK_EQUAL(colorObject.references(), 1u);
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "ColorObject.h"
+#include "Common.h"
+BOOST_AUTO_TEST_SUITE(colorObject)
+BOOST_AUTO_TEST_CASE(convertedColors) {
+	Color::initialize();
+	Color color(0.7f, 0.25f, 0.5f, 0.75f);
+	ColorObject colorObject("", color);
+	BOOST_CHECK_EQUAL(colorObject.getColor(ColorSpace::rgb), color.linearRgb());
+	BOOST_CHECK_EQUAL(colorObject.getColor(ColorSpace::hsl), color.rgbToHsl());
+	BOOST_CHECK_EQUAL(colorObject.getColor(ColorSpace::hsv), color.rgbToHsv());
+	BOOST_CHECK_EQUAL(colorObject.getColor(ColorSpace::cmyk), color.rgbToCmyk());
+	BOOST_CHECK_EQUAL(colorObject.getColor(ColorSpace::lab), color.rgbToLabD50());
+	BOOST_CHECK_EQUAL(colorObject.getColor(ColorSpace::lch), color.rgbToLchD50());
+	BOOST_CHECK_EQUAL(&colorObject.getColor(ColorSpace::lab), &colorObject.getColor(ColorSpace::lab));
+}
+BOOST_AUTO_TEST_CASE(invalidation) {
+	Color color(0.7f, 0.25f, 0.5f), otherColor(0.1f, 0.9f, 0.3f);
+	ColorObject colorObject("", color), otherColorObject("", otherColor);
+	BOOST_CHECK_EQUAL(colorObject.getColor(ColorSpace::lab), color.rgbToLabD50());
+	colorObject.setColor(otherColor);
+	BOOST_CHECK_EQUAL(colorObject.getColor(ColorSpace::lab), otherColor.rgbToLabD50());
+	colorObject = ColorObject("", color);
+	BOOST_CHECK_EQUAL(colorObject.getColor(ColorSpace::lab), color.rgbToLabD50());
+	ColorObject copy(otherColorObject);
+	BOOST_CHECK_EQUAL(copy.getColor(ColorSpace::hsv), otherColor.rgbToHsv());
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "Common.h"
+#include "math/ColorQuantizer.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+using namespace math;
+namespace {
+struct Initialize {
+	Initialize() {
+		Color::initialize();
+	}
+	static std::vector<uint8_t> makeImage(int width, int height) {
+		std::vector<uint8_t> image(static_cast<size_t>(width) * height * 3);
+		uint32_t state = 7;
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				uint8_t *pixel = &image[(static_cast<size_t>(y) * width + x) * 3];
+				state = state * 1664525 + 1013904223;
+				int noise = static_cast<int>(state >> 28) - 8;
+				pixel[0] = static_cast<uint8_t>(std::clamp(x * 255 / width + noise, 0, 255));
+				pixel[1] = static_cast<uint8_t>(std::clamp((y * 4 / height) * 80 + noise, 0, 255));
+				pixel[2] = static_cast<uint8_t>(std::clamp(((x / 16 + y / 16) % 3) * 100 + noise, 0, 255));
+			}
+		}
+		return image;
+	}
+	static float totalPixels(const ColorBatch &colors) {
+		float result = 0;
+		for (size_t i = 0; i < colors.size(); i++)
+			result += colors[3][i];
+		return result;
+	}
+};
+}
+BOOST_FIXTURE_TEST_SUITE(colorQuantizer, Initialize)
+BOOST_AUTO_TEST_CASE(imageSamples) {
+	const uint8_t pixels[] = { 255, 0, 0, 255, 0, 0, 0, 0, 255, 1, 1, 1 };
+	ColorBatch samples;
+	ColorQuantizer::imageSamples(pixels, 2, 2, 6, 3, samples);
+	BOOST_REQUIRE_EQUAL(samples.size(), 3);
+	BOOST_CHECK_EQUAL(totalPixels(samples), 4.0f);
+	BOOST_CHECK_EQUAL(samples.get(2), Color(1.0f, 0.0f, 0.0f, 2.0f));
+}
+BOOST_AUTO_TEST_CASE(exactColors) {
+	std::vector<uint8_t> image;
+	const uint8_t colors[4][3] = { { 250, 20, 20 }, { 20, 200, 20 }, { 20, 20, 250 }, { 240, 240, 240 } };
+	for (int i = 0; i < 1000; i++)
+		image.insert(image.end(), colors[i % 4], colors[i % 4] + 3);
+	ColorBatch samples, palette;
+	ColorQuantizer::imageSamples(image.data(), 1000, 1, 3000, 3, samples, 8);
+	for (auto method: { ColorQuantizer::Method::octree, ColorQuantizer::Method::medianCut, ColorQuantizer::Method::kMeans }) {
+		ColorQuantizer::create(method)->quantize(samples, 4, palette);
+		BOOST_CHECK_EQUAL(palette.size(), 4);
+		BOOST_CHECK_CLOSE(totalPixels(palette), 1000.0f, 0.001f);
+		BOOST_CHECK_SMALL(ColorQuantizer::meanDistance(samples, palette), 0.05f);
+	}
+}
+BOOST_AUTO_TEST_CASE(quality) {
+	const int width = 256, height = 256;
+	auto image = makeImage(width, height);
+	ColorBatch samples, octreePalette, medianCutPalette, kMeansPalette;
+	ColorQuantizer::imageSamples(image.data(), width, height, width * 3, 3, samples);
+	OctreeQuantizer().quantize(samples, 16, octreePalette);
+	MedianCutQuantizer().quantize(samples, 16, medianCutPalette);
+	KMeansQuantizer(20, 0.1f, 3).quantize(samples, 16, kMeansPalette);
+	for (const auto *palette: { &octreePalette, &medianCutPalette, &kMeansPalette }) {
+		BOOST_CHECK_LE(palette->size(), 16);
+		BOOST_CHECK_CLOSE(totalPixels(*palette), static_cast<float>(width * height), 0.01f);
+	}
+	float octreeDistance = ColorQuantizer::meanDistance(samples, octreePalette);
+	float kMeansDistance = ColorQuantizer::meanDistance(samples, kMeansPalette);
+	BOOST_CHECK_LT(kMeansDistance, octreeDistance);
+	BOOST_CHECK_LT(ColorQuantizer::meanDistance(samples, medianCutPalette), octreeDistance * 1.5f);
+}
+BOOST_AUTO_TEST_CASE(threads) {
+	const int width = 512, height = 256;
+	auto image = makeImage(width, height);
+	ColorBatch samples, palette1, palette2;
+	ColorQuantizer::imageSamples(image.data(), width, height, width * 3, 3, samples, 6);
+	KMeansQuantizer(10, 0.0f, 1).quantize(samples, 32, palette1);
+	KMeansQuantizer(10, 0.0f, 4).quantize(samples, 32, palette2);
+	BOOST_REQUIRE_EQUAL(palette1.size(), palette2.size());
+	for (size_t i = 0; i < palette1.size(); i++) {
+		for (int j = 0; j < 3; j++)
+			BOOST_CHECK_SMALL(palette1[j][i] - palette2[j][i], 1e-4f);
+	}
+}
+BOOST_AUTO_TEST_CASE(benchmark, *boost::unit_test::disabled()) {
+	const int width = 4000, height = 3000;
+	auto image = makeImage(width, height);
+	ColorBatch samples, palette;
+	auto start = std::chrono::steady_clock::now();
+	ColorQuantizer::imageSamples(image.data(), width, height, width * 3, 3, samples, 6);
+	auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+	std::cout << "samples: " << samples.size() << ", time: " << duration.count() << " ms\n";
+	const char *methodNames[] = { "octree", "median cut", "k-means" };
+	for (size_t colors: { 8, 32, 128 }) {
+		for (auto method: { ColorQuantizer::Method::octree, ColorQuantizer::Method::medianCut, ColorQuantizer::Method::kMeans }) {
+			auto quantizer = ColorQuantizer::create(method);
+			start = std::chrono::steady_clock::now();
+			quantizer->quantize(samples, colors, palette);
+			duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+			std::cout << "method: " << methodNames[static_cast<int>(method)] << ", colors: " << colors << ", mean delta E: " << ColorQuantizer::meanDistance(samples, palette) << ", time: " << duration.count() << " ms\n";
+		}
+	}
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <boost/test/unit_test.hpp>
+#include "ColorSort.h"
+#include "ColorObject.h"
+#include "common/Format.h"
+#include "math/RadixSort.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+BOOST_AUTO_TEST_SUITE(colorSort)
+BOOST_AUTO_TEST_CASE(sortableKey) {
+	const float values[] = { -std::numeric_limits<float>::infinity(), -1e10f, -1.0f, -1e-30f, -0.0f, 0.0f, 1e-30f, 0.5f, 1.0f, 1e10f, std::numeric_limits<float>::infinity() };
+	for (size_t i = 1; i < std::size(values); i++)
+		BOOST_CHECK_LT(math::sortableKey(values[i - 1]), math::sortableKey(values[i]));
+}
+BOOST_AUTO_TEST_CASE(radixSortIsStable) {
+	for (size_t count: { 0, 1, 1000, 200000 }) {
+		std::mt19937 random(count);
+		std::vector<uint32_t> keys(count), values(count);
+		for (auto &key: keys)
+			key = random() & 0x0f0f00ff;
+		std::iota(values.begin(), values.end(), 0);
+		std::vector<uint32_t> expected = values;
+		std::stable_sort(expected.begin(), expected.end(), [&keys](uint32_t a, uint32_t b) {
+			return keys[a] < keys[b];
+		});
+		math::radixSort(keys, values, 4);
+		BOOST_CHECK(std::is_sorted(keys.begin(), keys.end()));
+		BOOST_CHECK(values == expected);
+	}
+}
+// Channel values are normalized into range [0, 1], which can make close values equal.
+static float lightness(const ColorObject *colorObject) {
+	return colorObject->getColor().rgbToLabD50().lab.L / 100.0f;
+}
+BOOST_AUTO_TEST_CASE(groupAndSort) {
+	Color::initialize();
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+	std::vector<ColorObject> storage;
+	std::vector<ColorObject *> colorObjects;
+	storage.reserve(50000);
+	for (size_t i = 0; i < 50000; i++) {
+		storage.emplace_back(common::format("{}", i % 97), Color(distribution(random), distribution(random), distribution(random)));
+		colorObjects.push_back(&storage.back());
+	}
+	ColorSorter::Options options;
+	options.sortChannel = findSortChannel("lab_lightness");
+	options.groupChannel = findSortChannel("hsv_hue");
+	options.maxGroups = 6;
+	options.groupSensitivity = 0.01f;
+	options.reverse = true;
+	options.tieBreakByName = true;
+	ColorSorter sorter(colorObjects, 4);
+	auto order = sorter.sort(options);
+	math::BinaryTreeQuantization<float> tree;
+	for (auto *colorObject: colorObjects)
+		tree.add(colorObject->getColor().rgbToHsv().hsv.hue);
+	tree.reduce(options.maxGroups);
+	tree.reduceByMinDistance(options.groupSensitivity);
+	std::vector<uint32_t> expected(colorObjects.size());
+	std::iota(expected.begin(), expected.end(), 0);
+	std::stable_sort(expected.begin(), expected.end(), [&](uint32_t a, uint32_t b) {
+		const auto &colorA = colorObjects[a]->getColor(), &colorB = colorObjects[b]->getColor();
+		float groupA = tree.find(colorA.rgbToHsv().hsv.hue), groupB = tree.find(colorB.rgbToHsv().hsv.hue);
+		if (groupA != groupB)
+			return groupA < groupB;
+		float sortA = lightness(colorObjects[a]), sortB = lightness(colorObjects[b]);
+		if (sortA != sortB)
+			return sortA > sortB;
+		return colorObjects[a]->getName() < colorObjects[b]->getName();
+	});
+	BOOST_CHECK(order == expected);
+	options.groupChannel = nullptr;
+	options.reverse = false;
+	order = sorter.sort(options);
+	BOOST_CHECK(std::is_sorted(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		return lightness(colorObjects[a]) < lightness(colorObjects[b]);
+	}));
+}
+BOOST_AUTO_TEST_CASE(unknownChannel) {
+	BOOST_CHECK(findSortChannel("unknown") == nullptr);
+	BOOST_CHECK(findSortChannel("rgb_grayscale") != nullptr);
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "Converter.h"
+#include "Converters.h"
+#include "ConverterOptions.h"
+#include "ColorObject.h"
+#include "ColorList.h"
+#include "EventBus.h"
+#include "dynv/Map.h"
+#include "lua/Script.h"
+#include "lua/Ref.h"
+#include "lua/Lua.h"
+#include <string>
+static const char *serializeCode = "serializeCalls = 0\n"
+	"return function(colorObject, position)\n"
+	"	serializeCalls = serializeCalls + 1\n"
+	"	return 'color ' .. position.index\n"
+	"end";
+static const char *serializeBatchCode = "serializeBatchCalls = 0\n"
+	"return function(colorObjects, indexes, count)\n"
+	"	serializeBatchCalls = serializeBatchCalls + 1\n"
+	"	local result = {}\n"
+	"	for i = 1, #colorObjects do\n"
+	"		result[i] = 'color ' .. indexes[i]\n"
+	"	end\n"
+	"	return result\n"
+	"end";
+static const char *failingSerializeBatchCode = "serializeBatchCalls = 0\n"
+	"return function(colorObjects, indexes, count)\n"
+	"	serializeBatchCalls = serializeBatchCalls + 1\n"
+	"	return nil\n"
+	"end";
+static lua::Ref loadFunction(lua::Script &script, const char *code) {
+	BOOST_REQUIRE(script.loadCode(code));
+	BOOST_REQUIRE(script.run(0, 1));
+	lua::Ref function(script, -1);
+	lua_pop(script, 1);
+	return function;
+}
+static int getCalls(lua::Script &script, const char *name) {
+	lua_State *L = script;
+	lua_getglobal(L, name);
+	int calls = static_cast<int>(lua_tointeger(L, -1));
+	lua_pop(L, 1);
+	return calls;
+}
+static ColorObject makeColorObject(size_t index) {
+	Color color(static_cast<float>(index) / 4096, 0.5f, 0.25f);
+	return ColorObject("", color);
+}
+BOOST_AUTO_TEST_SUITE(converter)
+BOOST_AUTO_TEST_CASE(cacheHit) {
+	lua::Script script;
+	Converter converter("test", "Test", loadFunction(script, serializeCode), lua::Ref());
+	auto colorObject = makeColorObject(1);
+	ConverterSerializePosition position(3, 10);
+	BOOST_CHECK_EQUAL(converter.serialize(colorObject, position), "color 3");
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeCalls"), 1);
+	BOOST_CHECK_EQUAL(converter.serialize(colorObject, position), "color 3");
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeCalls"), 1);
+	BOOST_CHECK_EQUAL(converter.serialize(colorObject, ConverterSerializePosition(4, 10)), "color 4");
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeCalls"), 2);
+	colorObject.setName("name");
+	BOOST_CHECK_EQUAL(converter.serialize(colorObject, position), "color 3");
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeCalls"), 3);
+}
+BOOST_AUTO_TEST_CASE(cacheEviction) {
+	lua::Script script;
+	Converter converter("test", "Test", loadFunction(script, serializeCode), lua::Ref());
+	ConverterSerializePosition position;
+	for (size_t i = 0; i <= Converter::cacheSize; i++)
+		converter.serialize(makeColorObject(i), position);
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeCalls"), static_cast<int>(Converter::cacheSize + 1));
+	converter.serialize(makeColorObject(Converter::cacheSize), position);
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeCalls"), static_cast<int>(Converter::cacheSize + 1));
+	converter.serialize(makeColorObject(1), position);
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeCalls"), static_cast<int>(Converter::cacheSize + 1));
+	converter.serialize(makeColorObject(0), position);
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeCalls"), static_cast<int>(Converter::cacheSize + 2));
+	converter.serialize(makeColorObject(1), position);
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeCalls"), static_cast<int>(Converter::cacheSize + 2));
+	converter.serialize(makeColorObject(2), position);
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeCalls"), static_cast<int>(Converter::cacheSize + 3));
+}
+BOOST_AUTO_TEST_CASE(clearCache) {
+	lua::Script script;
+	Converter converter("test", "Test", loadFunction(script, serializeCode), lua::Ref());
+	auto colorObject = makeColorObject(1);
+	converter.serialize(colorObject);
+	converter.clearCache();
+	converter.serialize(colorObject);
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeCalls"), 2);
+}
+BOOST_AUTO_TEST_CASE(batchOnly) {
+	lua::Script script;
+	Converter converter("test", "Test", lua::Ref(), lua::Ref(), loadFunction(script, serializeBatchCode));
+	BOOST_CHECK(converter.hasSerialize());
+	BOOST_CHECK_EQUAL(converter.serialize(makeColorObject(1), ConverterSerializePosition(2, 5)), "color 2");
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeBatchCalls"), 1);
+	ColorList colorList;
+	for (size_t i = 0; i < Converter::batchSize + 1; i++)
+		colorList.add(makeColorObject(i));
+	std::string output;
+	converter.serialize(colorList, output, ",");
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeBatchCalls"), 3);
+	BOOST_CHECK(output.compare(0, 16, "color 0,color 1,") == 0);
+	output.clear();
+	converter.serialize(colorList, output, ",");
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeBatchCalls"), 3);
+	BOOST_CHECK(output.compare(0, 16, "color 0,color 1,") == 0);
+}
+BOOST_AUTO_TEST_CASE(batchFallback) {
+	lua::Script script;
+	Converter converter("test", "Test", loadFunction(script, serializeCode), lua::Ref(), loadFunction(script, failingSerializeBatchCode));
+	ColorList colorList;
+	for (size_t i = 0; i < 3; i++)
+		colorList.add(makeColorObject(i));
+	std::string output;
+	converter.serialize(colorList, output, ",");
+	BOOST_CHECK_EQUAL(output, "color 0,color 1,color 2");
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeBatchCalls"), 1);
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeCalls"), 3);
+	output.clear();
+	converter.serialize(colorList, output, ",");
+	BOOST_CHECK_EQUAL(output, "color 0,color 1,color 2");
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeBatchCalls"), 1);
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeCalls"), 3);
+}
+BOOST_AUTO_TEST_CASE(invalidateOnEvents) {
+	lua::Script script;
+	Converters converters;
+	auto converter = new Converter("test", "Test", loadFunction(script, serializeCode), lua::Ref());
+	converters.add(converter);
+	dynv::Map settings;
+	settings.set("gpick.options.hex_case", "lower");
+	ConverterOptions options(settings, converters);
+	EventBus eventBus;
+	eventBus.subscribe(EventType::optionsUpdate, options);
+	eventBus.subscribe(EventType::convertersUpdate, options);
+	auto colorObject = makeColorObject(1);
+	converter->serialize(colorObject);
+	converter->serialize(colorObject);
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeCalls"), 1);
+	settings.set("gpick.options.hex_case", "upper");
+	eventBus.trigger(EventType::optionsUpdate);
+	BOOST_CHECK(options.upperCaseHex);
+	converter->serialize(colorObject);
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeCalls"), 2);
+	eventBus.trigger(EventType::convertersUpdate);
+	converter->serialize(colorObject);
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeCalls"), 3);
+	eventBus.trigger(EventType::displayFiltersUpdate);
+	converter->serialize(colorObject);
+	BOOST_CHECK_EQUAL(getCalls(script, "serializeCalls"), 3);
+	eventBus.unsubscribe(options);
+}
+BOOST_AUTO_TEST_SUITE_END()
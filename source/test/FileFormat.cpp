@@ -24,6 +24,10 @@
 #include <string_view>
 #include <sstream>
 #include <fstream>
+#include <filesystem>
+#include <vector>
+#include <cmath>
+#include <algorithm>
 BOOST_AUTO_TEST_SUITE(fileFormat)
 const struct ColorAndName {
 	Color color;
@@ -110,4 +114,221 @@ BOOST_AUTO_TEST_CASE(load) {
 		BOOST_CHECK_MESSAGE(loaded[i].name == savedColors[i].name, "loaded wrong name at index " << i << ", " << loaded[i].name << " != " << savedColors[i].name);
 	}
 }
+static std::string savedPalette() {
+	ColorList colors;
+	for (size_t i = 0; i < sizeof(savedColors) / sizeof(savedColors[0]); ++i) {
+		colors.add(ColorObject(std::string(savedColors[i].name), savedColors[i].color));
+	}
+	std::stringstream output(std::ios::out | std::ios::binary);
+	paletteStreamSave(output, colors);
+	return output.str();
+}
+static void appendPositions(std::string &data, const std::vector<uint32_t> &positions) {
+	char type[16] = "color_positions";
+	data.append(type, sizeof(type));
+	uint64_t size = positions.size() * sizeof(uint32_t);
+	for (int i = 0; i < 8; ++i)
+		data.push_back(static_cast<char>((size >> (i * 8)) & 0xff));
+	for (auto position: positions) {
+		for (int i = 0; i < 4; ++i)
+			data.push_back(static_cast<char>((position >> (i * 8)) & 0xff));
+	}
+}
+BOOST_AUTO_TEST_CASE(load_permutation_positions) {
+	auto data = savedPalette();
+	const size_t count = sizeof(savedColors) / sizeof(savedColors[0]);
+	std::vector<uint32_t> positions;
+	for (size_t i = 0; i < count; ++i)
+		positions.push_back(static_cast<uint32_t>(count - 1 - i));
+	appendPositions(data, positions);
+	ColorList colors;
+	auto result = paletteBufferLoad(reinterpret_cast<const uint8_t *>(data.data()), data.size(), colors);
+	BOOST_REQUIRE_MESSAGE(result, result.error());
+	BOOST_REQUIRE_EQUAL(colors.size(), count);
+	size_t i = 0;
+	for (auto *colorObject: colors) {
+		BOOST_CHECK(colorObject->getColor() == savedColors[count - 1 - i].color);
+		BOOST_CHECK_EQUAL(colorObject->getName(), savedColors[count - 1 - i].name);
+		++i;
+	}
+}
+BOOST_AUTO_TEST_CASE(load_sparse_positions) {
+	auto data = savedPalette();
+	appendPositions(data, { 10, 5, 5, 0 });
+	ColorList colors;
+	auto result = paletteBufferLoad(reinterpret_cast<const uint8_t *>(data.data()), data.size(), colors);
+	BOOST_REQUIRE_MESSAGE(result, result.error());
+	BOOST_REQUIRE_EQUAL(colors.size(), 4);
+	const size_t expected[] = { 3, 1, 2, 0 };
+	size_t i = 0;
+	for (auto *colorObject: colors)
+		BOOST_CHECK_EQUAL(colorObject->getName(), savedColors[expected[i++]].name);
+}
+BOOST_AUTO_TEST_CASE(load_truncated) {
+	auto data = savedPalette();
+	for (size_t length: { size_t(0), size_t(10), data.size() - 1 }) {
+		ColorList colors;
+		auto result = paletteBufferLoad(reinterpret_cast<const uint8_t *>(data.data()), length, colors);
+		BOOST_CHECK(!result);
+		BOOST_CHECK_EQUAL(colors.size(), 0);
+	}
+}
+static std::string savedPalette(const PaletteSaveOptions &options) {
+	ColorList colors;
+	for (size_t i = 0; i < sizeof(savedColors) / sizeof(savedColors[0]); ++i) {
+		colors.add(ColorObject(std::string(savedColors[i].name), savedColors[i].color));
+	}
+	std::stringstream output(std::ios::out | std::ios::binary);
+	auto result = paletteStreamSave(output, colors, options);
+	BOOST_REQUIRE_MESSAGE(result, result.error());
+	return output.str();
+}
+static void checkSavedColors(ColorList &colors) {
+	BOOST_REQUIRE_EQUAL(colors.size(), sizeof(savedColors) / sizeof(savedColors[0]));
+	size_t i = 0;
+	for (auto *colorObject: colors) {
+		BOOST_CHECK_MESSAGE(colorObject->getColor() == savedColors[i].color, "loaded wrong color at index " << i << ", " << colorObject->getColor() << " != " << savedColors[i].color);
+		BOOST_CHECK_EQUAL(colorObject->getName(), savedColors[i].name);
+		++i;
+	}
+}
+BOOST_AUTO_TEST_CASE(columns) {
+	for (auto precision: { PaletteSaveOptions::Precision::float32, PaletteSaveOptions::Precision::float16 }) {
+		for (bool compress: { false, true }) {
+			for (size_t blockSize: { 4096, 5, 1 }) {
+				PaletteSaveOptions options;
+				options.layout = PaletteSaveOptions::Layout::columns;
+				options.precision = precision;
+				options.compress = compress;
+				options.blockSize = blockSize;
+				auto data = savedPalette(options);
+				ColorList colors;
+				auto result = paletteBufferLoad(reinterpret_cast<const uint8_t *>(data.data()), data.size(), colors);
+				BOOST_REQUIRE_MESSAGE(result, result.error());
+				checkSavedColors(colors);
+			}
+		}
+	}
+}
+BOOST_AUTO_TEST_CASE(columns_half_precision) {
+	std::vector<float> values;
+	for (int i = 0; i <= 255; ++i)
+		values.push_back(i / 255.0f);
+	for (float value: { 0.1f, 1.0f / 3.0f, 0.999f, 1.5f, -0.25f, 1e-3f, 6.1e-5f, 3e-5f, 1e-6f, 6e-8f, 2e-8f, 1e-10f })
+		values.push_back(value);
+	ColorList colors;
+	for (size_t i = 0; i < values.size(); ++i)
+		colors.add(ColorObject(std::to_string(i), Color(values[i], -values[i], values[values.size() - 1 - i], 1.0f - values[i])));
+	PaletteSaveOptions options;
+	options.layout = PaletteSaveOptions::Layout::columns;
+	options.precision = PaletteSaveOptions::Precision::float16;
+	options.compress = true;
+	options.blockSize = 100;
+	std::stringstream output(std::ios::out | std::ios::binary);
+	BOOST_REQUIRE(paletteStreamSave(output, colors, options));
+	auto data = output.str();
+	ColorList loaded;
+	auto result = paletteBufferLoad(reinterpret_cast<const uint8_t *>(data.data()), data.size(), loaded);
+	BOOST_REQUIRE_MESSAGE(result, result.error());
+	BOOST_REQUIRE_EQUAL(loaded.size(), colors.size());
+	auto check = [](float expected, float value) {
+		// rounding to nearest half keeps relative error within 2^-11, subnormal halves are spaced by 2^-24
+		float tolerance = std::max(std::abs(expected) / 2048.0f, 1.0f / 33554432.0f);
+		BOOST_CHECK_MESSAGE(std::abs(value - expected) <= tolerance, "half precision value " << value << " too far from " << expected);
+	};
+	for (size_t i = 0; i < colors.size(); ++i) {
+		Color expected = (*(colors.begin() + i))->getColor();
+		Color value = (*(loaded.begin() + i))->getColor();
+		for (int j = 0; j < 4; ++j)
+			check(expected[j], value[j]);
+	}
+}
+BOOST_AUTO_TEST_CASE(columns_smaller) {
+	PaletteSaveOptions options;
+	auto records = savedPalette(options);
+	options.layout = PaletteSaveOptions::Layout::columns;
+	options.precision = PaletteSaveOptions::Precision::float16;
+	options.compress = true;
+	auto columns = savedPalette(options);
+	BOOST_CHECK_LT(columns.size() * 2, records.size());
+}
+BOOST_AUTO_TEST_CASE(columns_damaged) {
+	PaletteSaveOptions options;
+	options.layout = PaletteSaveOptions::Layout::columns;
+	options.compress = true;
+	options.blockSize = 8;
+	auto data = savedPalette(options);
+	for (size_t i = 24 + 4 + 24; i < data.size(); i++) {
+		auto damaged = data;
+		damaged[i] = static_cast<char>(damaged[i] ^ 0x5a);
+		ColorList colors;
+		paletteBufferLoad(reinterpret_cast<const uint8_t *>(damaged.data()), damaged.size(), colors); // must not crash, result depends on damaged byte
+	}
+	ColorList colors;
+	BOOST_CHECK(!paletteBufferLoad(reinterpret_cast<const uint8_t *>(data.data()), data.size() - 1, colors));
+}
+static size_t findColumnsChunk(const std::string &data, size_t &size) {
+	size_t position = data.find("color_columns");
+	BOOST_REQUIRE(position != std::string::npos);
+	size = 0;
+	for (int i = 0; i < 8; ++i)
+		size |= static_cast<size_t>(static_cast<uint8_t>(data[position + 16 + i])) << (i * 8);
+	return position + 24;
+}
+static void storeUint32(std::string &data, size_t position, uint32_t value) {
+	for (int i = 0; i < 4; ++i)
+		data[position + i] = static_cast<char>((value >> (i * 8)) & 0xff);
+}
+BOOST_AUTO_TEST_CASE(columns_huge_sizes) {
+	PaletteSaveOptions options;
+	options.layout = PaletteSaveOptions::Layout::columns;
+	options.compress = true;
+	auto data = savedPalette(options);
+	size_t chunkSize, chunk = findColumnsChunk(data, chunkSize);
+	size_t indexOffset = 0;
+	for (int i = 0; i < 8; ++i)
+		indexOffset |= static_cast<size_t>(static_cast<uint8_t>(data[chunk + chunkSize - 16 + i])) << (i * 8);
+	// raw size of the only block larger than compressed data can expand to
+	auto damaged = data;
+	storeUint32(damaged, chunk + indexOffset + 12, 0xfffffff0u);
+	ColorList colors;
+	BOOST_CHECK(!paletteBufferLoad(reinterpret_cast<const uint8_t *>(damaged.data()), damaged.size(), colors));
+	BOOST_CHECK_EQUAL(colors.size(), 0);
+	// color count and block size so large that all colors are in the only block
+	damaged = data;
+	storeUint32(damaged, chunk, 0xfffffff0u);
+	storeUint32(damaged, chunk + 4, 0xfffffff0u);
+	BOOST_CHECK(!paletteBufferLoad(reinterpret_cast<const uint8_t *>(damaged.data()), damaged.size(), colors));
+	BOOST_CHECK_EQUAL(colors.size(), 0);
+}
+BOOST_AUTO_TEST_CASE(random_access) {
+	PaletteSaveOptions options;
+	options.layout = PaletteSaveOptions::Layout::columns;
+	options.compress = true;
+	options.blockSize = 4;
+	auto data = savedPalette(options);
+	auto filename = (std::filesystem::temp_directory_path() / "gpick-test-random-access.gpa").string();
+	{
+		std::ofstream file(filename, std::ios::binary);
+		file.write(data.data(), data.size());
+	}
+	PaletteReader reader;
+	auto result = reader.open(filename.c_str());
+	BOOST_REQUIRE_MESSAGE(result, result.error());
+	const size_t count = sizeof(savedColors) / sizeof(savedColors[0]);
+	BOOST_REQUIRE_EQUAL(reader.size(), count);
+	for (size_t i: { size_t(26), size_t(0), size_t(13), size_t(14), size_t(3), size_t(4) }) {
+		Color color;
+		std::string name;
+		result = reader.read(i, color, name);
+		BOOST_REQUIRE_MESSAGE(result, result.error());
+		BOOST_CHECK(color == savedColors[i].color);
+		BOOST_CHECK_EQUAL(name, savedColors[i].name);
+	}
+	Color color;
+	std::string name;
+	BOOST_CHECK(!reader.read(count, color, name));
+	reader.close();
+	std::filesystem::remove(filename);
+}
 BOOST_AUTO_TEST_SUITE_END()
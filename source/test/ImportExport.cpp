@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <boost/test/unit_test.hpp>
+#include "ImportExport.h"
+#include "ImportExportTask.h"
+#include "ColorList.h"
+#include "ColorObject.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+namespace fs = std::filesystem;
+namespace {
+struct TemporaryFile {
+	TemporaryFile(const char *name):
+		path((fs::temp_directory_path() / name).string()) {
+		std::error_code ec;
+		fs::remove(path, ec);
+	}
+	~TemporaryFile() {
+		std::error_code ec;
+		fs::remove(path, ec);
+	}
+	std::string path;
+};
+void addColors(ColorList &colorList, int count) {
+	for (int i = 0; i < count; i++)
+		colorList.add(ColorObject("color " + std::to_string(i), Color((i % 256) / 255.0f, (i / 256 % 256) / 255.0f, 0.5f)));
+}
+void writeFile(const std::string &path, FileType type, int count) {
+	ColorList colorList;
+	addColors(colorList, count);
+	ImportExport importExport(colorList, path.c_str());
+	BOOST_REQUIRE(importExport.exportType(type));
+}
+void checkMonotonic(const std::vector<float> &values) {
+	BOOST_REQUIRE(!values.empty());
+	for (size_t i = 0; i < values.size(); i++) {
+		BOOST_CHECK_GE(values[i], 0.0f);
+		BOOST_CHECK_LE(values[i], 1.0f);
+		if (i > 0)
+			BOOST_CHECK_GE(values[i], values[i - 1]);
+	}
+}
+const FileType types[] = { FileType::gpa, FileType::gpl, FileType::ase, FileType::css, FileType::mtl };
+const FileType importTypes[] = { FileType::gpa, FileType::gpl, FileType::ase };
+}
+BOOST_AUTO_TEST_SUITE(importExport)
+BOOST_AUTO_TEST_CASE(cancelled_export_removes_file) {
+	for (auto type: types) {
+		TemporaryFile file("gpick-test-cancelled-export");
+		ColorList colorList;
+		addColors(colorList, 2000);
+		ImportExport importExport(colorList, file.path.c_str());
+		int calls = 0;
+		importExport.setProgressCallback([&calls](float) {
+			return ++calls < 3;
+		});
+		BOOST_CHECK(!importExport.exportType(type));
+		BOOST_CHECK(importExport.getLastError() == ImportExport::Error::cancelled);
+		BOOST_CHECK(!fs::exists(file.path));
+	}
+}
+BOOST_AUTO_TEST_CASE(cancelled_import) {
+	for (auto type: importTypes) {
+		TemporaryFile file("gpick-test-cancelled-import");
+		writeFile(file.path, type, 2000);
+		ColorList colorList;
+		ImportExport importExport(colorList, file.path.c_str());
+		importExport.setProgressCallback([](float) {
+			return false;
+		});
+		BOOST_CHECK(!importExport.importType(type));
+		BOOST_CHECK(importExport.getLastError() == ImportExport::Error::cancelled);
+	}
+}
+BOOST_AUTO_TEST_CASE(progress_monotonic) {
+	for (auto type: types) {
+		TemporaryFile file("gpick-test-progress");
+		ColorList colorList;
+		addColors(colorList, 2000);
+		std::vector<float> values;
+		ImportExport exporter(colorList, file.path.c_str());
+		exporter.setProgressCallback([&values](float value) {
+			values.push_back(value);
+			return true;
+		});
+		BOOST_REQUIRE(exporter.exportType(type));
+		checkMonotonic(values);
+	}
+	for (auto type: importTypes) {
+		TemporaryFile file("gpick-test-progress");
+		writeFile(file.path, type, 2000);
+		ColorList colorList;
+		std::vector<float> values;
+		ImportExport importer(colorList, file.path.c_str());
+		importer.setProgressCallback([&values](float value) {
+			values.push_back(value);
+			return true;
+		});
+		BOOST_REQUIRE(importer.importType(type));
+		BOOST_CHECK_EQUAL(colorList.size(), 2000);
+		checkMonotonic(values);
+	}
+}
+BOOST_AUTO_TEST_CASE(gpa_columns_progress) {
+	TemporaryFile file("gpick-test-gpa-columns");
+	ColorList colorList;
+	addColors(colorList, 2000);
+	PaletteSaveOptions options;
+	options.layout = PaletteSaveOptions::Layout::columns;
+	options.compress = true;
+	options.blockSize = 100;
+	{
+		ImportExport exporter(colorList, file.path.c_str());
+		exporter.setPaletteSaveOptions(options);
+		int calls = 0;
+		exporter.setProgressCallback([&calls](float) {
+			return ++calls < 3;
+		});
+		BOOST_CHECK(!exporter.exportType(FileType::gpa));
+		BOOST_CHECK(exporter.getLastError() == ImportExport::Error::cancelled);
+		BOOST_CHECK(!fs::exists(file.path));
+	}
+	std::vector<float> values;
+	ImportExport exporter(colorList, file.path.c_str());
+	exporter.setPaletteSaveOptions(options);
+	exporter.setProgressCallback([&values](float value) {
+		values.push_back(value);
+		return true;
+	});
+	BOOST_REQUIRE(exporter.exportType(FileType::gpa));
+	BOOST_CHECK_GE(values.size(), 20);
+	checkMonotonic(values);
+	values.clear();
+	ColorList imported;
+	ImportExport importer(imported, file.path.c_str());
+	int calls = 0;
+	importer.setProgressCallback([&calls](float) {
+		return ++calls < 3;
+	});
+	BOOST_CHECK(!importer.importType(FileType::gpa));
+	BOOST_CHECK(importer.getLastError() == ImportExport::Error::cancelled);
+	BOOST_CHECK_EQUAL(imported.size(), 0);
+	importer.setProgressCallback([&values](float value) {
+		values.push_back(value);
+		return true;
+	});
+	BOOST_REQUIRE(importer.importType(FileType::gpa));
+	BOOST_CHECK_EQUAL(imported.size(), 2000);
+	BOOST_CHECK_GE(values.size(), 20);
+	checkMonotonic(values);
+}
+BOOST_AUTO_TEST_CASE(task_progress_monotonic) {
+	TemporaryFile file("gpick-test-task-progress");
+	writeFile(file.path, FileType::gpl, 2000);
+	ColorList colorList;
+	auto task = ImportExportTask::startImport(colorList, file.path, FileType::gpl);
+	std::vector<float> values;
+	ImportExportTask::State state;
+	while ((state = task->poll(std::chrono::milliseconds(0))) == ImportExportTask::State::running)
+		values.push_back(task->progress());
+	values.push_back(task->progress());
+	BOOST_CHECK(state == ImportExportTask::State::finished);
+	BOOST_CHECK_EQUAL(values.back(), 1.0f);
+	BOOST_CHECK_EQUAL(colorList.size(), 2000);
+	checkMonotonic(values);
+}
+BOOST_AUTO_TEST_CASE(task_cancelled_import_rolls_back) {
+	TemporaryFile file("gpick-test-task-cancelled-import");
+	writeFile(file.path, FileType::gpl, 2000);
+	ColorList colorList;
+	colorList.add(ColorObject("existing", Color(0.25f)));
+	auto task = ImportExportTask::startImport(colorList, file.path, FileType::gpl);
+	while (task->count() == 0)
+		BOOST_REQUIRE(task->poll(std::chrono::milliseconds(0)) == ImportExportTask::State::running);
+	BOOST_REQUIRE_LT(colorList.size(), 2001);
+	task->cancel();
+	BOOST_CHECK(task->poll() == ImportExportTask::State::cancelled);
+	BOOST_CHECK_EQUAL(task->count(), 0);
+	BOOST_REQUIRE_EQUAL(colorList.size(), 1);
+	BOOST_CHECK_EQUAL(colorList.front()->getName(), "existing");
+}
+BOOST_AUTO_TEST_CASE(task_export_finished_when_destroyed) {
+	TemporaryFile file("gpick-test-task-destroyed-export");
+	ColorList colorList;
+	addColors(colorList, 2000);
+	ImportExportTask::startExport(colorList, file.path, FileType::gpl).reset();
+	ColorList imported;
+	ImportExport importExport(imported, file.path.c_str());
+	BOOST_CHECK(importExport.importType(FileType::gpl));
+	BOOST_CHECK_EQUAL(imported.size(), 2000);
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -21,7 +21,9 @@
 #include "Converters.h"
 #include "InternalConverters.h"
 #include "ColorObject.h"
+#include "ColorList.h"
 #include "Common.h"
+#include <cstdio>
 BOOST_AUTO_TEST_SUITE(internalConverters)
 BOOST_AUTO_TEST_CASE(webHex) {
 	Converter::Options options = {};
@@ -534,4 +536,118 @@ BOOST_AUTO_TEST_CASE(valueRgba) {
 			BOOST_CHECK_MESSAGE(colorObject.getColor() == colors[i].color, "wrong color at index " << i << ", " << colorObject.getColor() << " != " << colors[i].color);
 	}
 }
+BOOST_AUTO_TEST_CASE(serialize) {
+	Converter::Options options = {};
+	Converters converters;
+	addInternalConverters(converters, options);
+	ColorObject colorObject("", Color(0.7f, 0.25f, 0.5f, 0.75f));
+	const struct {
+		const char *name;
+		const char *text;
+	} results[] = {
+		{ "color_web_hex", "#b34080" },
+		{ "color_web_hex_with_alpha", "#b34080c0" },
+		{ "color_web_hex_no_hash", "b34080" },
+		{ "color_web_hex_short", "#b48" },
+		{ "color_web_hex_short_with_alpha", "#b48c" },
+		{ "color_css_rgb", "rgb(179, 64, 128)" },
+		{ "color_css_rgba", "rgba(179, 64, 128, 0.750)" },
+		{ "css_background_color_hex", "background-color: #b34080" },
+		{ "csv_rgb", "0.700,0.250,0.500" },
+		{ "csv_rgba_tab", "0.700\t0.250\t0.500\t0.750" },
+		{ "csv_rgba_semicolon", "0.700;0.250;0.500;0.750" },
+		{ "value_rgb", "0.700, 0.250, 0.500" },
+	};
+	for (size_t i = 0; i < sizeof(results) / sizeof(results[0]); ++i) {
+		auto *converter = converters.byName(results[i].name);
+		BOOST_REQUIRE(converter != nullptr);
+		BOOST_CHECK_EQUAL(converter->serialize(colorObject), results[i].text);
+	}
+	options.upperCaseHex = true;
+	options.cssPercentages = true;
+	options.cssAlphaPercentage = true;
+	BOOST_CHECK_EQUAL(converters.byName("color_web_hex_with_alpha")->serialize(colorObject), "#B34080C0");
+	BOOST_CHECK_EQUAL(converters.byName("color_web_hex_short")->serialize(colorObject), "#B48");
+	BOOST_CHECK_EQUAL(converters.byName("color_css_rgb")->serialize(colorObject), "rgb(70%, 25%, 50%)");
+	BOOST_CHECK_EQUAL(converters.byName("color_css_rgba")->serialize(colorObject), "rgba(70%, 25%, 50%, 75%)");
+}
+BOOST_AUTO_TEST_CASE(serializeMatchesPrintf) {
+	Converter::Options options = {};
+	Converters converters;
+	addInternalConverters(converters, options);
+	auto *hsla = converters.byName("color_css_hsla"), *csv = converters.byName("csv_rgba");
+	BOOST_REQUIRE(hsla != nullptr && csv != nullptr);
+	char expected[64];
+	std::vector<Color> colors = {
+		{ 0.0625f, 0.3125f, 0.5625f, 0.9375f },
+		{ 0.0005f, 0.0015f, 0.9995f, 1.0f },
+		{ -0.0001f, -0.25f, 1.5f, -0.0f },
+	};
+	for (int i = 0; i <= 1000; i++)
+		colors.emplace_back(i / 1000.0f, (i * 7 % 1001) / 1000.0f, (i * 13 % 1001) / 1000.0f, (i * 31 % 1001) / 1000.0f);
+	for (const auto &color: colors) {
+		ColorObject colorObject("", color);
+		std::snprintf(expected, sizeof(expected), "%0.3f,%0.3f,%0.3f,%0.3f", color.red, color.green, color.blue, color.alpha);
+		BOOST_CHECK_EQUAL(csv->serialize(colorObject), expected);
+		auto hsl = color.rgbToHsl();
+		auto toInteger = [](float value, int scale) {
+			return std::max(std::min(static_cast<int>(value * (scale + 1)), scale), 0);
+		};
+		std::snprintf(expected, sizeof(expected), "hsla(%d, %d%%, %d%%, %0.3f)", toInteger(hsl.hsl.hue, 360), toInteger(hsl.hsl.saturation, 100), toInteger(hsl.hsl.lightness, 100), color.alpha);
+		BOOST_CHECK_EQUAL(hsla->serialize(colorObject), expected);
+	}
+}
+BOOST_AUTO_TEST_CASE(serializeColorList) {
+	Converter::Options options = {};
+	Converters converters;
+	addInternalConverters(converters, options);
+	ColorList colorList;
+	colorList.add(ColorObject("red", Color(1.0f, 0.0f, 0.0f)));
+	colorList.add(ColorObject("green", Color(0.0f, 1.0f, 0.0f)));
+	colorList.add(ColorObject("blue", Color(0.0f, 0.0f, 1.0f)));
+	std::string text = "start:";
+	converters.byName("color_web_hex")->serialize(colorList, text);
+	BOOST_CHECK_EQUAL(text, "start:#ff0000\n#00ff00\n#0000ff");
+	text.clear();
+	converters.byName("color_web_hex")->serialize(colorList, text, ";", true);
+	BOOST_CHECK_EQUAL(text, "#ff0000 red;#00ff00 green;#0000ff blue");
+	text.clear();
+	converters.byName("color_css_block")->serialize(colorList, text);
+	BOOST_CHECK(text.find("/**\n") == 0);
+	BOOST_CHECK_EQUAL(text.find("/**", 1), std::string::npos);
+	BOOST_CHECK(text.rfind("\n */") == text.length() - 4);
+	text.clear();
+	converters.colorList(converters.byName("csv_rgb"));
+	converters.serialize(colorList, Converters::Type::colorList, text);
+	BOOST_CHECK_EQUAL(text, "1.000,0.000,0.000\n0.000,1.000,0.000\n0.000,0.000,1.000");
+}
+BOOST_AUTO_TEST_CASE(converterInput) {
+	using Features = ConverterInputFeatures;
+	BOOST_CHECK(ConverterInput("").features() == Features::none);
+	BOOST_CHECK(ConverterInput("#abc").features() == (Features::hash | Features::hexDigit));
+	BOOST_CHECK(ConverterInput("rgb(1, 2, 3)").features() == (Features::rgbFunction | Features::digit | Features::hexDigit));
+	BOOST_CHECK(ConverterInput("x hsla(").has(Features::hslaFunction));
+	BOOST_CHECK(!ConverterInput("x hsla(").has(Features::hslFunction));
+	BOOST_CHECK(!ConverterInput("rgb()").has(Features::rgbFunction | Features::digit));
+}
+BOOST_AUTO_TEST_CASE(deserializeList) {
+	Converter::Options options = {};
+	Converters converters;
+	addInternalConverters(converters, options);
+	for (auto *converter: converters.all())
+		converter->paste(true);
+	converters.rebuildCopyPasteArrays();
+	ColorObject colorObject;
+	BOOST_REQUIRE(converters.deserialize("rgba(32, 64, 128, 0.5)", colorObject));
+	BOOST_CHECK_EQUAL(colorObject.getColor(), Color(32 / 255.0f, 64 / 255.0f, 128 / 255.0f, 0.5f));
+	BOOST_CHECK(!converters.deserialize("none", colorObject));
+	ColorList colorList;
+	std::vector<std::string> values = { "#204080", "none", "hsl(0, 0%, 100%)", "0.125, 0.25, 0.5" };
+	BOOST_REQUIRE_EQUAL(converters.deserialize(values, colorList), 3);
+	BOOST_REQUIRE_EQUAL(colorList.size(), 3);
+	auto i = colorList.begin();
+	BOOST_CHECK_EQUAL((*i++)->getColor(), Color(32, 64, 128));
+	BOOST_CHECK_EQUAL((*i++)->getColor(), Color(1.0f, 1.0f, 1.0f));
+	BOOST_CHECK_EQUAL((*i++)->getColor(), Color(0.125f, 0.25f, 0.5f));
+}
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "Common.h"
+#include "math/Lut3d.h"
+#include <cmath>
+using namespace math;
+namespace {
+void compare(const Lut3d &lut, const Lut3d::Function &function, float tolerance) {
+	for (int r = 0; r <= 20; r++) {
+		for (int g = 0; g <= 20; g++) {
+			for (int b = 0; b <= 20; b++) {
+				Color input(r / 20.0f, g / 20.0f, b / 20.0f, 0.5f), expected;
+				function(input, expected);
+				Color output = lut.apply(input);
+				for (int i = 0; i < 3; i++)
+					BOOST_CHECK_SMALL(output[i] - expected[i], tolerance);
+				BOOST_CHECK_EQUAL(output.alpha, 0.5f);
+			}
+		}
+	}
+}
+}
+BOOST_AUTO_TEST_SUITE(lut3d)
+BOOST_AUTO_TEST_CASE(identity) {
+	Lut3d lut;
+	BOOST_CHECK(lut.empty());
+	auto function = [](const Color &input, Color &output) {
+		output = input;
+	};
+	lut.build(5, function);
+	BOOST_CHECK_EQUAL(lut.size(), 5);
+	compare(lut, function, 1e-6f);
+}
+BOOST_AUTO_TEST_CASE(affine) {
+	// Tetrahedral interpolation reproduces affine transformations exactly.
+	auto function = [](const Color &input, Color &output) {
+		output.rgb.red = 0.2f * input.rgb.red + 0.7f * input.rgb.green + 0.1f * input.rgb.blue;
+		output.rgb.green = 1.0f - input.rgb.green;
+		output.rgb.blue = 0.5f * input.rgb.blue + 0.25f;
+	};
+	Lut3d lut;
+	lut.build(3, function);
+	compare(lut, function, 1e-5f);
+}
+BOOST_AUTO_TEST_CASE(smooth) {
+	auto function = [](const Color &input, Color &output) {
+		for (int i = 0; i < 3; i++)
+			output[i] = std::pow(input[i], 1.5f);
+	};
+	Lut3d lut;
+	lut.build(33, function);
+	compare(lut, function, 1e-3f);
+}
+BOOST_AUTO_TEST_CASE(clamp) {
+	Lut3d lut;
+	lut.build(2, [](const Color &input, Color &output) {
+		output = input;
+	});
+	BOOST_CHECK_EQUAL(lut.apply(Color(-1.0f, 2.0f, 0.5f, 1.0f)), Color(0.0f, 1.0f, 0.5f, 1.0f));
+	std::vector<Color> colors = { Color(0.25f, 0.5f, 1.0f, 0.0f), Color(1.0f, 0.0f, 0.0f, 1.0f) };
+	lut.apply(colors.data(), colors.data(), colors.size());
+	BOOST_CHECK_EQUAL(colors[0], Color(0.25f, 0.5f, 1.0f, 0.0f));
+	BOOST_CHECK_EQUAL(colors[1], Color(1.0f, 0.0f, 0.0f, 1.0f));
+}
+BOOST_AUTO_TEST_SUITE_END()
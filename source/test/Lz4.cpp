@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "common/Lz4.h"
+#include <random>
+#include <vector>
+using namespace common;
+BOOST_AUTO_TEST_SUITE(lz4Compression)
+static std::vector<uint8_t> roundTrip(const std::vector<uint8_t> &input) {
+	std::vector<uint8_t> compressed(lz4::compressBound(input.size()));
+	size_t size = lz4::compress(input.data(), input.size(), compressed.data(), compressed.size());
+	BOOST_REQUIRE(size > 0);
+	compressed.resize(size);
+	std::vector<uint8_t> output(input.size());
+	BOOST_REQUIRE(lz4::decompress(compressed.data(), compressed.size(), output.data(), output.size()));
+	BOOST_CHECK(output == input);
+	return compressed;
+}
+BOOST_AUTO_TEST_CASE(empty) {
+	roundTrip({});
+}
+BOOST_AUTO_TEST_CASE(repetitive) {
+	std::vector<uint8_t> input;
+	for (int i = 0; i < 10000; i++)
+		input.push_back(static_cast<uint8_t>(i % 7));
+	auto compressed = roundTrip(input);
+	BOOST_CHECK_LT(compressed.size(), input.size() / 20);
+}
+BOOST_AUTO_TEST_CASE(random) {
+	std::mt19937 generator(1);
+	for (size_t size: { 1, 5, 12, 13, 100, 70000 }) {
+		std::vector<uint8_t> input(size);
+		for (auto &value: input)
+			value = static_cast<uint8_t>(generator() % 4); // small alphabet gives short matches
+		roundTrip(input);
+	}
+}
+BOOST_AUTO_TEST_CASE(small_capacity) {
+	std::vector<uint8_t> input(1000);
+	std::mt19937 generator(2);
+	for (auto &value: input)
+		value = static_cast<uint8_t>(generator());
+	std::vector<uint8_t> compressed(100);
+	BOOST_CHECK_EQUAL(lz4::compress(input.data(), input.size(), compressed.data(), compressed.size()), 0);
+}
+BOOST_AUTO_TEST_CASE(decompress_bound) {
+	std::vector<uint8_t> input(1 << 20, 0);
+	auto compressed = roundTrip(input);
+	BOOST_CHECK_LE(input.size(), lz4::decompressBound(compressed.size()));
+	BOOST_CHECK_LT(lz4::decompressBound(compressed.size()), input.size() * 2);
+}
+BOOST_AUTO_TEST_CASE(damaged) {
+	std::vector<uint8_t> input;
+	for (int i = 0; i < 1000; i++)
+		input.push_back(static_cast<uint8_t>(i % 13));
+	auto compressed = roundTrip(input);
+	std::vector<uint8_t> output(input.size());
+	BOOST_CHECK(!lz4::decompress(compressed.data(), compressed.size() - 1, output.data(), output.size()));
+	BOOST_CHECK(!lz4::decompress(compressed.data(), compressed.size(), output.data(), output.size() - 1));
+	std::mt19937 generator(3);
+	for (int i = 0; i < 1000; i++) {
+		auto damaged = compressed;
+		damaged[generator() % damaged.size()] = static_cast<uint8_t>(generator());
+		lz4::decompress(damaged.data(), damaged.size(), output.data(), output.size()); // must stay inside buffers
+	}
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -19,6 +19,10 @@
 #include <boost/test/unit_test.hpp>
 #include "math/OctreeColorQuantization.h"
 #include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
 using namespace math;
 BOOST_AUTO_TEST_SUITE(octreeColorQuantization)
 template<typename T>
@@ -92,4 +96,107 @@ BOOST_AUTO_TEST_CASE(merge) {
 	});
 	BOOST_CHECK_EQUAL(mergedOctree.size(), 200);
 }
+static std::vector<uint8_t> makeImage(int width, int height, int channels) {
+	std::vector<uint8_t> image(static_cast<size_t>(width) * height * channels);
+	uint32_t state = 1;
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			uint8_t *pixel = &image[(static_cast<size_t>(y) * width + x) * channels];
+			state = state * 1664525 + 1013904223;
+			pixel[0] = static_cast<uint8_t>(x * 255 / width);
+			pixel[1] = static_cast<uint8_t>(y * 255 / height);
+			pixel[2] = static_cast<uint8_t>((x + y) / 4 + (state >> 29));
+		}
+	}
+	return image;
+}
+static void totals(OctreeColorQuantization &octree, float sum[3], size_t &pixels) {
+	sum[0] = sum[1] = sum[2] = 0;
+	pixels = 0;
+	octree.visit([&](const float colorSum[3], size_t colorPixels) {
+		sum[0] += colorSum[0];
+		sum[1] += colorSum[1];
+		sum[2] += colorSum[2];
+		pixels += colorPixels;
+	});
+}
+BOOST_AUTO_TEST_CASE(addImage) {
+	const int width = 300, height = 400, channels = 3;
+	auto image = makeImage(width, height, channels);
+	OctreeColorQuantization singleThreaded, multiThreaded;
+	singleThreaded.addImage(image.data(), width, height, width * channels, channels);
+	multiThreaded.addImage(image.data(), width, height, width * channels, channels, 5);
+	float sum1[3], sum2[3];
+	size_t pixels1, pixels2;
+	totals(singleThreaded, sum1, pixels1);
+	totals(multiThreaded, sum2, pixels2);
+	BOOST_CHECK_EQUAL(pixels1, static_cast<size_t>(width * height));
+	BOOST_CHECK_EQUAL(pixels2, static_cast<size_t>(width * height));
+	for (int i = 0; i < 3; i++)
+		BOOST_CHECK_CLOSE(sum1[i], sum2[i], 0.01f);
+	BOOST_CHECK_LE(multiThreaded.size(), OctreeColorQuantization::maxNodesPerLevel);
+	multiThreaded.reduce(100);
+	BOOST_CHECK_EQUAL(multiThreaded.size(), 100);
+}
+BOOST_AUTO_TEST_CASE(imageBuilder) {
+	const int width = 300, height = 400, channels = 3, stride = width * channels;
+	auto image = makeImage(width, height, channels);
+	OctreeColorQuantization singleThreaded, built;
+	singleThreaded.addImage(image.data(), width, height, stride, channels);
+	OctreeImageBuilder builder(4);
+	// parts of different sizes, some of them smaller than a single band
+	const int parts[] = { 1, 63, 64, 150, 2, 120 };
+	int y = 0;
+	for (auto rows: parts) {
+		builder.addImage(image.data() + stride * y, width, rows, stride, channels);
+		y += rows;
+	}
+	BOOST_REQUIRE_EQUAL(y, height);
+	built.add(Color(0.5f, 0.5f, 0.5f), 7, { 128, 128, 128 });
+	builder.finish(built);
+	float sum1[3], sum2[3];
+	size_t pixels1, pixels2;
+	totals(singleThreaded, sum1, pixels1);
+	totals(built, sum2, pixels2);
+	BOOST_CHECK_EQUAL(pixels2, pixels1 + 7);
+	for (int i = 0; i < 3; i++)
+		BOOST_CHECK_CLOSE(sum1[i] + 0.5f * 7, sum2[i], 0.01f);
+	// builder is empty after finish and can be reused
+	OctreeColorQuantization reused;
+	builder.addImage(image.data(), width, height, stride, channels);
+	builder.clear();
+	builder.addImage(image.data(), width, height, stride, channels);
+	builder.finish(reused);
+	totals(reused, sum2, pixels2);
+	BOOST_CHECK_EQUAL(pixels2, pixels1);
+	for (int i = 0; i < 3; i++)
+		BOOST_CHECK_CLOSE(sum1[i], sum2[i], 0.01f);
+}
+BOOST_AUTO_TEST_CASE(mergeKeepsColors) {
+	OctreeColorQuantization octree1, octree2, merged;
+	Color color(0.2f, 0.4f, 0.6f);
+	octree1.add(color, 10, { 10, 20, 30 });
+	octree2.add(color, 5, { 10, 20, 30 });
+	octree2.add(color, 1, { 200, 20, 30 });
+	merged.merge(octree1, octree2);
+	BOOST_CHECK_EQUAL(merged.size(), 2);
+	float sum[3];
+	size_t pixels;
+	totals(merged, sum, pixels);
+	BOOST_CHECK_EQUAL(pixels, 16);
+	BOOST_CHECK_CLOSE(sum[1], 0.4f * 16, 0.001f);
+	BOOST_CHECK_THROW(merged.merge(merged, octree1), std::invalid_argument);
+}
+BOOST_AUTO_TEST_CASE(addImageScaling, *boost::unit_test::disabled()) {
+	const int width = 8660, height = 5774, channels = 3;
+	auto image = makeImage(width, height, channels);
+	unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+		OctreeColorQuantization octree;
+		auto start = std::chrono::steady_clock::now();
+		octree.addImage(image.data(), width, height, width * channels, channels, threads);
+		auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+		std::cout << "threads: " << threads << ", time: " << duration.count() << " ms, colors: " << octree.size() << '\n';
+	}
+}
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "math/Rectangle.h"
+BOOST_AUTO_TEST_SUITE(rectangle)
+BOOST_AUTO_TEST_CASE(equality) {
+	BOOST_CHECK(math::Rectanglei(0, 0, 2, 3) == math::Rectanglei(0, 0, 2, 3));
+	BOOST_CHECK(math::Rectanglei(0, 0, 2, 3) != math::Rectanglei(1, 0, 2, 3));
+	BOOST_CHECK(math::Rectanglei() == math::Rectanglei());
+	BOOST_CHECK(math::Rectanglei() != math::Rectanglei(0, 0, 0, 0));
+}
+BOOST_AUTO_TEST_CASE(intersect) {
+	BOOST_CHECK(math::Rectanglei(0, 0, 10, 10).intersect(math::Rectanglei(5, -5, 15, 5)) == math::Rectanglei(5, 0, 10, 5));
+	BOOST_CHECK(math::Rectanglei(0, 0, 10, 10).intersect(math::Rectanglei(2, 2, 4, 4)) == math::Rectanglei(2, 2, 4, 4));
+	BOOST_CHECK(math::Rectanglei(0, 0, 10, 10).intersect(math::Rectanglei(10, 0, 20, 10)).isEmpty());
+	BOOST_CHECK(math::Rectanglei(0, 0, 10, 10).intersect(math::Rectanglei()).isEmpty());
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -18,6 +18,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include "common/Result.h"
+#include <string>
 using namespace common;
 BOOST_AUTO_TEST_SUITE(result);
 BOOST_AUTO_TEST_CASE(booleanValue) {
@@ -90,4 +91,17 @@ BOOST_AUTO_TEST_CASE(movable) {
 	BOOST_CHECK(returnMovableValueWithError());
 	BOOST_CHECK(!returnMovableErrorWithValue());
 }
+BOOST_AUTO_TEST_CASE(moveAssignment) {
+	Result<void, std::string> errorResult;
+	BOOST_CHECK(errorResult);
+	errorResult = Result<void, std::string>("error");
+	BOOST_CHECK(!errorResult);
+	errorResult = Result<void, std::string>();
+	BOOST_CHECK(errorResult);
+	Result<std::string, void> valueResult;
+	valueResult = Result<std::string, void>("value");
+	BOOST_CHECK(valueResult);
+	valueResult = Result<std::string, void>();
+	BOOST_CHECK(!valueResult);
+}
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <boost/test/unit_test.hpp>
+#include "common/SlabAllocator.h"
+#include "ColorObject.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+using namespace common;
+BOOST_AUTO_TEST_SUITE(slabAllocator)
+BOOST_AUTO_TEST_CASE(consecutiveBlocks) {
+	SlabAllocator allocator(40, 4096);
+	BOOST_CHECK_EQUAL(allocator.blockSize() % alignof(std::max_align_t), 0);
+	std::vector<char *> blocks;
+	for (size_t i = 0; i < 1000; i++)
+		blocks.push_back(static_cast<char *>(allocator.allocate()));
+	BOOST_CHECK_EQUAL(blocks[1] - blocks[0], static_cast<ptrdiff_t>(allocator.blockSize()));
+	auto sorted = blocks;
+	std::sort(sorted.begin(), sorted.end());
+	BOOST_CHECK(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+	size_t slabs = allocator.slabCount();
+	BOOST_CHECK_GT(slabs, 1);
+	allocator.deallocate(blocks[500]);
+	BOOST_CHECK_EQUAL(allocator.allocate(), blocks[500]);
+	for (auto block: blocks)
+		allocator.deallocate(block);
+	BOOST_CHECK_EQUAL(allocator.slabCount(), 1);
+}
+BOOST_AUTO_TEST_CASE(invalidSizes) {
+	BOOST_CHECK_THROW(SlabAllocator(16, 1000), std::invalid_argument);
+	BOOST_CHECK_THROW(SlabAllocator(8192, 4096), std::invalid_argument);
+}
+BOOST_AUTO_TEST_CASE(colorObjects) {
+	auto first = new ColorObject("first", Color());
+	auto second = new ColorObject("second", Color());
+	BOOST_CHECK_EQUAL(second->getName(), "second");
+	first->release();
+	second->release();
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -246,6 +246,7 @@ struct BackgroundColorPicker: public IEventHandler {
 		gtk_layout_preview_set_transformation_chain(GTK_LAYOUT_PREVIEW(layoutView), chain);
 		for (auto &adjustableColor: adjustableColors) {
 			gtk_color_set_transformation_chain(GTK_COLOR(adjustableColor.colorWidget), chain);
+			gtk_color_component_set_transformation_chain(GTK_COLOR_COMPONENT(adjustableColor.colorComponent), chain);
 		}
 	}
 	virtual void onEvent(EventType eventType) override {
@@ -138,7 +138,7 @@ static void calc(ColorSpaceSamplerArgs *args, bool preview, size_t limit)
 				break;
 		}
 		if (args->linearization)
-			t.nonLinearRgbInplace();
+			t.nonLinearRgbFastInplace();
 		t.normalizeRgbInplace();
 		ColorObject colorObject(t);
 		nameAssigner.assign(colorObject);
@@ -26,12 +26,18 @@
 #include "I18N.h"
 #include "dynv/Map.h"
 #include "math/OctreeColorQuantization.h"
+#include "math/ColorQuantizer.h"
 #include "common/Guard.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <thread>
-#include <mutex>
+#include <vector>
 
 struct PaletteColorNameAssigner: public ToolColorNameAssigner {
 	PaletteColorNameAssigner(GlobalState &gs):
@@ -53,115 +59,252 @@ protected:
 	std::string_view m_fileName;
 	int m_index;
 };
-struct PaletteFromImageArgs {
-	GtkWidget *fileBrowser, *rangeColors, *previewExpander;
-	std::string filename, previousFilename;
-	uint32_t numberOfColors;
-	math::OctreeColorQuantization octree;
-	common::Ref<ColorList> previewColorList;
-	dynv::Ref options;
-	GlobalState *gs;
-	static uint8_t toUint8(float value) {
-		return static_cast<uint8_t>(std::max(std::min(static_cast<int>(value * 256), 255), 0));
+/** Decodes image file in chunks and adds decoded rows to the octree while the rest of the file is still being read.
+ * Rows are added in bands to a single OctreeImageBuilder when the loader produces them top to bottom, so worker threads and private octrees are reused for all bands and merged once.
+ * Interlaced and progressive images report already decoded rows again, in that case the whole image is added after decoding finishes.
+ * Progress callback is checked before each band, so loading stops within one chunk or band after it is cancelled.
+ */
+struct ImageStreamLoader {
+	static constexpr int bandRows = math::OctreeColorQuantization::tileRows * 8;
+	static constexpr size_t chunkSize = 1 << 16;
+	ImageStreamLoader(math::OctreeColorQuantization &octree, std::function<bool(float)> progress):
+		m_octree(octree),
+		m_progress(progress),
+		m_readyRows(0),
+		m_addedRows(0),
+		m_progressValue(0.0f),
+		m_sequential(true),
+		m_cancelled(false) {
 	}
-	void processImage() {
-		previousFilename = filename;
-		octree.clear();
+	/**
+	 * Load image and add its pixels to the octree.
+	 * @param[in] filename Image filename.
+	 * @return True on success, false if image could not be decoded or loading was cancelled by progress callback.
+	 */
+	bool load(const std::string &filename) {
+		std::ifstream file(filename, std::ios::in | std::ios::binary);
+		if (!file.is_open()) {
+			std::cout << "could not open image \"" << filename << "\"" << '\n';
+			return false;
+		}
+		file.seekg(0, std::ios::end);
+		auto fileSize = static_cast<size_t>(file.tellg());
+		file.seekg(0, std::ios::beg);
+		GdkPixbufLoader *loader = gdk_pixbuf_loader_new();
+		g_signal_connect(G_OBJECT(loader), "area-updated", G_CALLBACK(onAreaUpdated), this);
+		std::vector<char> buffer(chunkSize);
 		GError *error = nullptr;
-		GdkPixbuf *pixbuf = gdk_pixbuf_new_from_file(filename.c_str(), &error);
+		size_t bytesRead = 0;
+		while (file.read(buffer.data(), buffer.size()).gcount() > 0) {
+			bytesRead += static_cast<size_t>(file.gcount());
+			if (!gdk_pixbuf_loader_write(loader, reinterpret_cast<const guchar *>(buffer.data()), static_cast<gsize>(file.gcount()), &error))
+				break;
+			if (!reportProgress(fileSize > 0 ? 0.9f * bytesRead / fileSize : 0.0f))
+				break;
+		}
+		gdk_pixbuf_loader_close(loader, error || m_cancelled ? nullptr : &error);
+		GdkPixbuf *pixbuf = error || m_cancelled ? nullptr : gdk_pixbuf_loader_get_pixbuf(loader);
 		if (error) {
 			std::cout << error->message << '\n';
 			g_error_free(error);
-			return;
 		}
+		if (pixbuf) {
+			if (!m_sequential) {
+				m_builder.clear();
+				m_addedRows = 0;
+			}
+			int height = gdk_pixbuf_get_height(pixbuf);
+			while (m_addedRows < height && reportProgress(0.9f + 0.1f * m_addedRows / height))
+				addRows(pixbuf, std::min(m_addedRows + bandRows, height));
+		}
+		bool loaded = pixbuf && !m_cancelled;
+		// decoded image is released before private octrees are merged
+		g_object_unref(loader);
+		if (loaded)
+			m_builder.finish(m_octree);
+		return loaded;
+	}
+private:
+	math::OctreeColorQuantization &m_octree;
+	math::OctreeImageBuilder m_builder;
+	std::function<bool(float)> m_progress;
+	int m_readyRows, m_addedRows;
+	float m_progressValue;
+	bool m_sequential, m_cancelled;
+	bool reportProgress(float value) {
+		m_progressValue = value;
+		if (!m_cancelled && m_progress && !m_progress(value))
+			m_cancelled = true;
+		return !m_cancelled;
+	}
+	void addRows(GdkPixbuf *pixbuf, int endRow) {
+		if (endRow <= m_addedRows)
+			return;
 		int channels = gdk_pixbuf_get_n_channels(pixbuf);
 		int width = gdk_pixbuf_get_width(pixbuf);
-		int height = gdk_pixbuf_get_height(pixbuf);
 		int stride = gdk_pixbuf_get_rowstride(pixbuf);
-		guchar *imageData = gdk_pixbuf_get_pixels(pixbuf);
-		if (width * height < (1 << 16) || std::max(1u, std::thread::hardware_concurrency()) == 1) {
-			guchar *dataPointer = imageData;
-			Color color;
-			for (int y = 0; y < height; y++) {
-				dataPointer = imageData + stride * y;
-				for (int x = 0; x < width; x++) {
-					if (channels == 1) {
-						color.xyz.x = color.xyz.y = color.xyz.z = dataPointer[0] / 255.0f;
-					} else {
-						color.xyz.x = dataPointer[0] / 255.0f;
-						color.xyz.y = dataPointer[1] / 255.0f;
-						color.xyz.z = dataPointer[2] / 255.0f;
-					}
-					color.alpha = 1.0f;
-					color.linearRgbInplace();
-					std::array<uint8_t, 3> position = { dataPointer[0], dataPointer[1], dataPointer[2] };
-					octree.add(color, position);
-					dataPointer += channels;
-				}
-			}
-		} else {
-			size_t threadCount = std::min(8u, std::thread::hardware_concurrency());
-			std::mutex octreeMutex;
-			std::vector<std::thread> threads(threadCount);
-			size_t index = 0;
-			for (auto &thread: threads) {
-				thread = std::thread([this, &octreeMutex, index, threadCount, imageData, channels, width, height, stride]() {
-					math::OctreeColorQuantization threadOctree;
-					guchar *dataPointer = imageData + stride * index;
-					Color color;
-					for (int y = 0; y < height; y += threadCount) {
-						dataPointer = imageData + stride * y;
-						for (int x = 0; x < width; x++) {
-							if (channels == 1) {
-								color.xyz.x = color.xyz.y = color.xyz.z = dataPointer[0] / 255.0f;
-							} else {
-								color.xyz.x = dataPointer[0] / 255.0f;
-								color.xyz.y = dataPointer[1] / 255.0f;
-								color.xyz.z = dataPointer[2] / 255.0f;
-							}
-							color.alpha = 1.0f;
-							color.linearRgbInplace();
-							std::array<uint8_t, 3> position = { dataPointer[0], dataPointer[1], dataPointer[2] };
-							threadOctree.add(color, position);
-							dataPointer += channels;
-						}
-					}
-					threadOctree.reduce(1000);
-					std::scoped_lock<std::mutex> lock(octreeMutex);
-					threadOctree.visit([this](const float sum[3], size_t pixels) {
-						Color color(sum[0] / pixels, sum[1] / pixels, sum[2] / pixels, 1.0f);
-						Color nonLinearColor = color.nonLinearRgb();
-						std::array<uint8_t, 3> position = { toUint8(nonLinearColor.red), toUint8(nonLinearColor.green), toUint8(nonLinearColor.blue) };
-						octree.add(color, pixels, position);
-					});
-				});
-				++index;
-			}
-			for (auto &thread: threads) {
-				thread.join();
-			}
+		const guchar *imageData = gdk_pixbuf_get_pixels(pixbuf) + static_cast<ptrdiff_t>(stride) * m_addedRows;
+		m_builder.addImage(imageData, width, endRow - m_addedRows, stride, channels);
+		m_addedRows = endRow;
+	}
+	static void onAreaUpdated(GdkPixbufLoader *loader, gint x, gint y, gint width, gint height, ImageStreamLoader *imageStreamLoader) {
+		auto &self = *imageStreamLoader;
+		if (!self.m_sequential || self.m_cancelled)
+			return;
+		GdkPixbuf *pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
+		if (x != 0 || width != gdk_pixbuf_get_width(pixbuf) || y < self.m_readyRows) {
+			self.m_sequential = false;
+			return;
 		}
-		g_object_unref(pixbuf);
-		octree.reduce(1000);
+		self.m_readyRows = y + height;
+		while (self.m_readyRows - self.m_addedRows >= bandRows && self.reportProgress(self.m_progressValue))
+			self.addRows(pixbuf, self.m_addedRows + bandRows);
 	}
-	void update(bool preview) {
-		int index = 0;
-		gchar *name = g_path_get_basename(filename.c_str());
-		PaletteColorNameAssigner nameAssigner(*gs);
-		if (!filename.empty() && previousFilename != filename)
-			processImage();
-		ColorList &colorList = preview ? *previewColorList : gs->colorList();
-		math::OctreeColorQuantization reducedOctree(octree);
+};
+/** Image loading state shared by the dialog and the worker thread.
+ * Worker thread is detached and keeps its own reference, so the dialog never waits for it: cancelled workers stop after the current chunk or band and release the state themselves.
+ */
+struct ImageJob {
+	std::string filename;
+	math::OctreeColorQuantization octree;
+	std::atomic<bool> cancel, done;
+	std::atomic<float> progress;
+	ImageJob(const std::string &filename):
+		filename(filename),
+		cancel(false),
+		done(false),
+		progress(0.0f) {
+	}
+	/**
+	 * Start loading image in a worker thread.
+	 * @param[in] filename Image filename.
+	 * @return Job state. Octree can be used after done is set.
+	 */
+	static std::shared_ptr<ImageJob> start(const std::string &filename) {
+		auto job = std::make_shared<ImageJob>(filename);
+		std::thread([job]() {
+			ImageStreamLoader loader(job->octree, [&job](float value) {
+				job->progress = value;
+				return !job->cancel;
+			});
+			if (loader.load(job->filename))
+				job->octree.reduce(1000);
+			else
+				job->octree.clear();
+			job->done = true;
+		}).detach();
+		return job;
+	}
+};
+static void addColors(ImageJob &job, uint32_t numberOfColors, math::ColorQuantizer::Method method, GlobalState &gs, ColorList &colorList) {
+	int index = 0;
+	gchar *name = g_path_get_basename(job.filename.c_str());
+	PaletteColorNameAssigner nameAssigner(gs);
+	common::Guard colorListGuard = colorList.changeGuard();
+	auto addColor = [&](Color color) {
+		color.alpha = 1.0f;
+		color.nonLinearRgbFastInplace();
+		ColorObject colorObject(color);
+		nameAssigner.assign(colorObject, name, index);
+		colorList.add(colorObject);
+		index++;
+	};
+	if (method == math::ColorQuantizer::Method::octree) {
+		math::OctreeColorQuantization reducedOctree(job.octree);
 		reducedOctree.reduce(numberOfColors);
-		common::Guard colorListGuard = colorList.changeGuard();
 		reducedOctree.visit([&](const float sum[3], size_t pixels) {
-			Color color(sum[0] / pixels, sum[1] / pixels, sum[2] / pixels, 1.0f);
-			color.nonLinearRgbInplace();
-			ColorObject colorObject(color);
-			nameAssigner.assign(colorObject, name, index);
-			colorList.add(colorObject);
-			index++;
+			addColor(Color(sum[0] / pixels, sum[1] / pixels, sum[2] / pixels));
+		});
+	} else {
+		// octree leafs are used as weighted samples
+		ColorBatch samples(job.octree.size()), palette;
+		size_t sampleIndex = 0;
+		job.octree.visit([&](const float sum[3], size_t pixels) {
+			samples.set(sampleIndex++, Color(sum[0] / pixels, sum[1] / pixels, sum[2] / pixels, static_cast<float>(pixels)));
 		});
+		samples.resize(sampleIndex);
+		math::ColorQuantizer::create(method)->quantize(samples, numberOfColors, palette);
+		for (size_t i = 0; i < palette.size(); i++)
+			addColor(palette.get(i));
+	}
+	g_free(name);
+}
+/** Colors requested with Add button before the dialog was closed, added to the palette once loading finishes.
+ */
+struct PendingColors {
+	std::shared_ptr<ImageJob> job;
+	uint32_t numberOfColors;
+	math::ColorQuantizer::Method method;
+	GlobalState *gs;
+	static gboolean onTimeout(PendingColors *pendingColors) {
+		if (!pendingColors->job->done)
+			return true;
+		addColors(*pendingColors->job, pendingColors->numberOfColors, pendingColors->method, *pendingColors->gs, pendingColors->gs->colorList());
+		delete pendingColors;
+		return false;
+	}
+};
+struct PaletteFromImageArgs {
+	GtkWidget *fileBrowser, *rangeColors, *comboMethod, *previewExpander, *progressBar;
+	std::string filename, previousFilename;
+	uint32_t numberOfColors;
+	math::ColorQuantizer::Method method;
+	std::shared_ptr<ImageJob> job;
+	common::Ref<ColorList> previewColorList;
+	dynv::Ref options;
+	GlobalState *gs;
+	guint progressTimeout;
+	bool processing, addWhenDone;
+	void startProcessing() {
+		cancelProcessing();
+		addWhenDone = false;
+		previousFilename = filename;
+		processing = true;
+		job = ImageJob::start(filename);
+		gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(progressBar), 0.0);
+		gtk_widget_show(progressBar);
+		progressTimeout = g_timeout_add(100, reinterpret_cast<GSourceFunc>(onProgress), this);
+	}
+	void cancelProcessing() {
+		if (!processing)
+			return;
+		job->cancel = true;
+		job.reset();
+		g_source_remove(progressTimeout);
+		processing = false;
+	}
+	void finishProcessing() {
+		processing = false;
+		gtk_widget_hide(progressBar);
+		previewColorList->removeAll();
+		addColors(*previewColorList);
+		if (addWhenDone) {
+			addWhenDone = false;
+			addColors(gs->colorList());
+		}
+	}
+	void addColors(ColorList &colorList) {
+		if (job)
+			::addColors(*job, numberOfColors, method, *gs, colorList);
+	}
+	void update(bool preview) {
+		if (!filename.empty() && previousFilename != filename)
+			startProcessing();
+		if (processing) {
+			// preview is filled and requested colors are added when processing finishes, so UI thread does not wait for the worker
+			if (!preview)
+				addWhenDone = true;
+			return;
+		}
+		addColors(preview ? *previewColorList : gs->colorList());
+	}
+	static gboolean onProgress(PaletteFromImageArgs *args) {
+		if (!args->job->done) {
+			gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(args->progressBar), args->job->progress);
+			return true;
+		}
+		args->finishProcessing();
+		return false;
 	}
 	void getSettings() {
 		gchar *filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(fileBrowser));
@@ -172,9 +315,11 @@ struct PaletteFromImageArgs {
 			this->filename.clear();
 		}
 		numberOfColors = static_cast<int>(gtk_spin_button_get_value(GTK_SPIN_BUTTON(rangeColors)));
+		method = static_cast<math::ColorQuantizer::Method>(std::max(0, gtk_combo_box_get_active(GTK_COMBO_BOX(comboMethod))));
 	}
 	void saveSettings() {
 		options->set("colors", static_cast<int32_t>(numberOfColors));
+		options->set("method", static_cast<int32_t>(method));
 		gchar *currentFolder = gtk_file_chooser_get_current_folder(GTK_FILE_CHOOSER(fileBrowser));
 		if (currentFolder) {
 			options->set("current_folder", currentFolder);
@@ -192,6 +337,13 @@ struct PaletteFromImageArgs {
 		args->update(true);
 	}
 	static void onDestroy(GtkWidget *widget, PaletteFromImageArgs *args) {
+		if (args->processing && args->addWhenDone) {
+			// loading continues without the dialog, so colors requested with Add button are not lost
+			g_source_remove(args->progressTimeout);
+			g_timeout_add(100, reinterpret_cast<GSourceFunc>(PendingColors::onTimeout), new PendingColors { args->job, args->numberOfColors, args->method, args->gs });
+		} else {
+			args->cancelProcessing();
+		}
 		delete args;
 	}
 	static void onResponse(GtkWidget *widget, gint responseId, PaletteFromImageArgs *args) {
@@ -218,13 +370,15 @@ void tools_palette_from_image_show(GtkWindow *parent, GlobalState *gs) {
 	PaletteFromImageArgs *args = new PaletteFromImageArgs;
 	args->previousFilename = "";
 	args->gs = gs;
+	args->processing = false;
+	args->addWhenDone = false;
 	args->options = args->gs->settings().getOrCreateMap("gpick.tools.palette_from_image");
 	GtkWidget *dialog = gtk_dialog_new_with_buttons(_("Palette from image"), parent, GtkDialogFlags(GTK_DIALOG_DESTROY_WITH_PARENT), GTK_STOCK_CLOSE, GTK_RESPONSE_CLOSE, GTK_STOCK_ADD, GTK_RESPONSE_APPLY, nullptr);
 	gtk_window_set_default_size(GTK_WINDOW(dialog), args->options->getInt32("window.width", -1),
 		args->options->getInt32("window.height", -1));
 	gtk_dialog_set_alternative_button_order(GTK_DIALOG(dialog), GTK_RESPONSE_APPLY, GTK_RESPONSE_CLOSE, -1);
 
-	Grid grid(2, 3);
+	Grid grid(2, 5);
 	grid.addLabel(_("Image:"));
 	GtkWidget *widget;
 	args->fileBrowser = widget = grid.add(gtk_file_chooser_button_new(_("Image file"), GTK_FILE_CHOOSER_ACTION_OPEN), true);
@@ -274,8 +428,17 @@ void tools_palette_from_image_show(GtkWindow *parent, GlobalState *gs) {
 	args->rangeColors = widget = grid.add(gtk_spin_button_new_with_range(1, 1000, 1), true);
 	gtk_spin_button_set_value(GTK_SPIN_BUTTON(widget), args->options->getInt32("colors", 3));
 	g_signal_connect(G_OBJECT(widget), "value-changed", G_CALLBACK(PaletteFromImageArgs::onUpdate), args);
+	grid.addLabel(_("Method:"));
+	args->comboMethod = widget = grid.add(gtk_combo_box_text_new(), true);
+	gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(widget), _("Octree"));
+	gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(widget), _("Median cut"));
+	gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(widget), _("K-means"));
+	gtk_combo_box_set_active(GTK_COMBO_BOX(widget), std::clamp(args->options->getInt32("method", 0), 0, 2));
+	g_signal_connect(G_OBJECT(widget), "changed", G_CALLBACK(PaletteFromImageArgs::onUpdate), args);
+	args->progressBar = grid.add(gtk_progress_bar_new(), true, 2);
 	args->previewExpander = grid.add(palette_list_preview_new(*gs, true, args->options->getBool("show_preview", true), args->previewColorList), true, 2, true);
 	gtk_widget_show_all(grid);
+	gtk_widget_hide(args->progressBar);
 	setDialogContent(dialog, grid);
 	g_signal_connect(G_OBJECT(dialog), "destroy", G_CALLBACK(PaletteFromImageArgs::onDestroy), args);
 	g_signal_connect(G_OBJECT(dialog), "response", G_CALLBACK(PaletteFromImageArgs::onResponse), args);
@@ -17,15 +17,31 @@
  */
 
 #include "Chain.h"
+#include <cairo/cairo.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
 namespace transformation {
 Chain::Chain():
-	m_enabled(true) {
+	m_enabled(true),
+	m_lutSize(0),
+	m_lutValid(false),
+	m_lutUsable(false) {
 }
 void Chain::apply(const Color *input, Color *output) {
 	if (!m_enabled) {
 		*output = *input;
 		return;
 	}
+	updateLut();
+	if (m_lutUsable) {
+		*output = m_lut.apply(*input);
+		return;
+	}
+	applyTransformations(input, output);
+}
+void Chain::applyTransformations(const Color *input, Color *output) {
 	Color tmp[2];
 	Color *tmp_p[3];
 	tmp[0] = *input;
@@ -39,19 +55,167 @@ void Chain::apply(const Color *input, Color *output) {
 	}
 	*output = *tmp_p[0];
 }
+bool Chain::isActive() const {
+	return m_enabled && !m_transformationChain.empty();
+}
+void Chain::apply(cairo_surface_t *surface) {
+	if (!isActive() || !surface || cairo_surface_get_type(surface) != CAIRO_SURFACE_TYPE_IMAGE)
+		return;
+	if (cairo_image_surface_get_format(surface) != CAIRO_FORMAT_ARGB32)
+		return;
+	cairo_surface_flush(surface);
+	apply(cairo_image_surface_get_data(surface), cairo_image_surface_get_width(surface), cairo_image_surface_get_height(surface), cairo_image_surface_get_stride(surface));
+	cairo_surface_mark_dirty(surface);
+}
+void Chain::apply(uint8_t *data, int width, int height, int stride, size_t threads) {
+	if (!isActive() || width <= 0 || height <= 0)
+		return;
+	// Lookup table is built before starting threads, so threads only read shared state.
+	updateLut();
+	// Starting threads costs more than transforming small images.
+	const int minRowsPerThread = std::max(1, 16384 / width);
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = std::min<size_t>(threads, (height + minRowsPerThread - 1) / minRowsPerThread);
+	if (threads <= 1) {
+		applyRows(data, width, stride, 0, height);
+		return;
+	}
+	const int rowsPerBlock = minRowsPerThread;
+	std::atomic<int> nextRow(0);
+	auto worker = [this, data, width, height, stride, rowsPerBlock, &nextRow]() {
+		for (;;) {
+			int begin = nextRow.fetch_add(rowsPerBlock);
+			if (begin >= height)
+				break;
+			applyRows(data, width, stride, begin, std::min(height, begin + rowsPerBlock));
+		}
+	};
+	std::vector<std::thread> workers;
+	workers.reserve(threads - 1);
+	for (size_t i = 1; i < threads; i++)
+		workers.emplace_back(worker);
+	worker();
+	for (auto &thread: workers)
+		thread.join();
+}
+static inline void unpackPixel(uint32_t pixel, Color &color) {
+	uint32_t alpha = pixel >> 24;
+	float scale = 1.0f / alpha;
+	color.rgb.red = ((pixel >> 16) & 0xff) * scale;
+	color.rgb.green = ((pixel >> 8) & 0xff) * scale;
+	color.rgb.blue = (pixel & 0xff) * scale;
+	color.alpha = alpha * (1 / 255.0f);
+}
+static inline uint32_t packPixel(uint32_t pixel, const Color &color) {
+	float alpha = static_cast<float>(pixel >> 24);
+	uint32_t red = static_cast<uint32_t>(std::clamp(color.rgb.red, 0.0f, 1.0f) * alpha + 0.5f);
+	uint32_t green = static_cast<uint32_t>(std::clamp(color.rgb.green, 0.0f, 1.0f) * alpha + 0.5f);
+	uint32_t blue = static_cast<uint32_t>(std::clamp(color.rgb.blue, 0.0f, 1.0f) * alpha + 0.5f);
+	return (pixel & 0xff000000) | (red << 16) | (green << 8) | blue;
+}
+void Chain::applyRows(uint8_t *data, int width, int stride, int begin, int end) {
+	if (!m_lutUsable) {
+		// Without lookup table transformations are expensive, so runs of equal pixels, which are common in magnified images, are transformed once.
+		uint32_t previousInput = 0, previousOutput = 0;
+		Color color;
+		for (int y = begin; y < end; y++) {
+			uint32_t *row = reinterpret_cast<uint32_t *>(data + static_cast<size_t>(y) * stride);
+			for (int x = 0; x < width; x++) {
+				uint32_t pixel = row[x];
+				if (pixel == previousInput) {
+					row[x] = previousOutput;
+					continue;
+				}
+				previousInput = pixel;
+				if (pixel >> 24) {
+					unpackPixel(pixel, color);
+					applyTransformations(&color, &color);
+					pixel = packPixel(pixel, color);
+				}
+				previousOutput = row[x] = pixel;
+			}
+		}
+		return;
+	}
+	// Pixels are converted to colors in blocks, so the lookup table interpolation runs over contiguous arrays.
+	// Only the first pixel of each run of equal pixels is converted, as magnified images consist mostly of such runs.
+	constexpr int blockSize = 256;
+	Color colors[blockSize];
+	uint32_t uniquePixels[blockSize];
+	for (int y = begin; y < end; y++) {
+		uint32_t *row = reinterpret_cast<uint32_t *>(data + static_cast<size_t>(y) * stride);
+		for (int x = 0; x < width; x += blockSize) {
+			int count = std::min(blockSize, width - x);
+			uint32_t *pixels = row + x;
+			int unique = 0;
+			for (int i = 0; i < count; i++) {
+				if (unique > 0 && pixels[i] == uniquePixels[unique - 1])
+					continue;
+				uniquePixels[unique] = pixels[i];
+				if (pixels[i] >> 24)
+					unpackPixel(pixels[i], colors[unique]);
+				else
+					colors[unique] = Color(0.0f, 0.0f, 0.0f, 0.0f);
+				unique++;
+			}
+			m_lut.apply(colors, colors, unique);
+			int current = -1;
+			uint32_t result = 0;
+			for (int i = 0; i < count; i++) {
+				if (current < 0 || pixels[i] != uniquePixels[current]) {
+					current++;
+					result = uniquePixels[current] >> 24 ? packPixel(uniquePixels[current], colors[current]) : uniquePixels[current];
+				}
+				pixels[i] = result;
+			}
+		}
+	}
+}
+void Chain::updateLut() {
+	if (m_lutValid)
+		return;
+	m_lutValid = true;
+	m_lutUsable = m_lutSize >= 2 && !m_transformationChain.empty();
+	for (auto &transformation: m_transformationChain) {
+		if (!transformation->isContinuous()) {
+			m_lutUsable = false;
+			break;
+		}
+	}
+	if (!m_lutUsable) {
+		m_lut.clear();
+		return;
+	}
+	m_lut.build(m_lutSize, [this](const Color &input, Color &output) {
+		applyTransformations(&input, &output);
+	});
+}
+void Chain::invalidate() {
+	m_lutValid = false;
+}
+void Chain::setLutSize(int size) {
+	if (m_lutSize == size)
+		return;
+	m_lutSize = size;
+	invalidate();
+}
 void Chain::add(std::unique_ptr<Transformation> transformation) {
 	m_transformationChain.push_back(std::move(transformation));
+	invalidate();
 }
 void Chain::remove(const Transformation *transformation) {
 	for (auto i = m_transformationChain.begin(), end = m_transformationChain.end(); i != end; i++) {
 		if (i->get() == transformation) {
 			m_transformationChain.erase(i);
+			invalidate();
 			return;
 		}
 	}
 }
 void Chain::clear() {
 	m_transformationChain.clear();
+	invalidate();
 }
 Chain::TransformationList &Chain::getAll() {
 	return m_transformationChain;
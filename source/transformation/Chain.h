@@ -19,8 +19,12 @@
 #ifndef GPICK_TRANSFORMATION_CHAIN_H_
 #define GPICK_TRANSFORMATION_CHAIN_H_
 #include "Transformation.h"
+#include "math/Lut3d.h"
 #include <list>
 #include <memory>
+#include <cstddef>
+#include <cstdint>
+typedef struct _cairo_surface cairo_surface_t;
 
 /** \file source/transformation/Chain.h
  * \brief Struct for transformation object list handling.
@@ -37,11 +41,32 @@ struct Chain {
 	Chain();
 	/**
 	* Apply transformation chain to color.
+	* When lookup table is enabled and all transformations are continuous, the result is interpolated from the lookup table.
 	* @param[in] input Source color in RGB color space.
 	* @param[out] output Destination color in RGB color space.
 	*/
 	void apply(const Color *input, Color *output);
 	/**
+	* Apply transformation chain to every pixel of an image in place.
+	* Pixels are 32 bit premultiplied ARGB values in native byte order, as used by CAIRO_FORMAT_ARGB32 surfaces.
+	* @param[in,out] data Pixel data.
+	* @param[in] width Image width.
+	* @param[in] height Image height.
+	* @param[in] stride Number of bytes between rows.
+	* @param[in] threads Maximum number of threads, 0 to use all processors. Small images are always processed in the calling thread.
+	*/
+	void apply(uint8_t *data, int width, int height, int stride, size_t threads = 0);
+	/**
+	* Apply transformation chain to every pixel of cairo image surface in place.
+	* @param[in,out] surface Image surface in CAIRO_FORMAT_ARGB32 format. Other surfaces are not changed.
+	*/
+	void apply(cairo_surface_t *surface);
+	/**
+	* Check if applying transformation chain can change colors.
+	* @return True if chain is enabled and contains transformations.
+	*/
+	bool isActive() const;
+	/**
 	* Add transformation object into the list.
 	* @param[in] transformation Transformation object.
 	*/
@@ -61,6 +86,15 @@ struct Chain {
 	*/
 	void setEnabled(bool enabled);
 	/**
+	* Set lookup table size. Lookup table is built when the chain is applied for the first time after any change.
+	* @param[in] size Number of lookup table grid points per channel, 0 to disable lookup table.
+	*/
+	void setLutSize(int size);
+	/**
+	* Mark lookup table as outdated. Has to be called after transformation parameters are changed. Global state calls it on display filters update event.
+	*/
+	void invalidate();
+	/**
 	* Get the list of transformation objects.
 	* @return Transformation object list.
 	*/
@@ -68,6 +102,12 @@ struct Chain {
 private:
 	TransformationList m_transformationChain;
 	bool m_enabled;
+	int m_lutSize;
+	bool m_lutValid, m_lutUsable;
+	math::Lut3d m_lut;
+	void applyTransformations(const Color *input, Color *output);
+	void applyRows(uint8_t *data, int width, int stride, int begin, int end);
+	void updateLut();
 };
 }
 #endif /* GPICK_TRANSFORMATION_CHAIN_H_ */
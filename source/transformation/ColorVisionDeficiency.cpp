@@ -183,7 +183,7 @@ void ColorVisionDeficiency::apply(Color *input, Color *output) {
 		*output = *input;
 		return;
 	}
-	*output = linearOutput.nonLinearRgbInplace().normalizeRgbInplace();
+	*output = linearOutput.nonLinearRgbFastInplace().normalizeRgbInplace();
 	output->alpha = input->alpha;
 }
 ColorVisionDeficiency::ColorVisionDeficiency():
@@ -69,6 +69,9 @@ void Quantization::deserialize(const dynv::Map &system) {
 std::unique_ptr<IConfiguration> Quantization::getConfiguration() {
 	return std::make_unique<Configuration>(*this);
 }
+bool Quantization::isContinuous() const {
+	return false;
+}
 Quantization::Configuration::Configuration(Quantization &transformation) {
 	GtkWidget *table = gtk_table_new(2, 3, false);
 	GtkWidget *widget;
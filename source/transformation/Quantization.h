@@ -40,6 +40,7 @@ struct Quantization: public Transformation {
 	virtual void serialize(dynv::Map &system) override;
 	virtual void deserialize(const dynv::Map &system) override;
 	virtual std::unique_ptr<IConfiguration> getConfiguration() override;
+	virtual bool isContinuous() const override;
 private:
 	float value;
 	bool clip_top;
@@ -42,4 +42,7 @@ void Transformation::deserialize(const dynv::Map &options) {
 std::unique_ptr<IConfiguration> Transformation::getConfiguration() {
 	return std::unique_ptr<IConfiguration>();
 }
+bool Transformation::isContinuous() const {
+	return true;
+}
 }
@@ -82,6 +82,13 @@ struct Transformation {
 		 */
 		virtual std::unique_ptr<IConfiguration> getConfiguration();
 
+		/**
+		 * Check if transformation output changes continuously with input color.
+		 * Only continuous transformations can be approximated by an interpolated lookup table.
+		 * @return True if transformation is continuous.
+		 */
+		virtual bool isContinuous() const;
+
 		/**
 		 * Get transformation object system name.
 		 * @return Transformation object system name.
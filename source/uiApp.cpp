@@ -24,6 +24,7 @@
 #include "IColorSource.h"
 #include "Paths.h"
 #include "AutoSave.h"
+#include "AutoSaveJournal.h"
 #include "Converter.h"
 #include "Converters.h"
 #include "StandardMenu.h"
@@ -106,6 +107,8 @@ struct AppArgs
 	gint width, height;
 	bool initialization;
 	dbus::Control dbus_control;
+	std::unique_ptr<AutoSaveJournal> autoSaveJournal;
+	guint autoSaveTimeout;
 };
 
 static void app_release(AppArgs *args);
@@ -325,7 +328,7 @@ int app_save_file(AppArgs *args, const char *filename, const char *filter)
 		current_filename = args->current_filename;
 	}
 	FileType filetype;
-	ImportExport importExport(args->gs->colorList(), current_filename.c_str(), *args->gs);
+	ImportExport importExport(args->gs->colorList(), current_filename.c_str());
 	importExport.fixFileExtension(filter);
 	current_filename = importExport.getFilename();
 	bool returnValue = false;
@@ -364,7 +367,7 @@ int app_load_file(AppArgs *args, const std::string &filename, ColorList &colorLi
 {
 	bool imported = false;
 	bool returnValue = false;
-	ImportExport importExport(colorList, filename.c_str(), *args->gs);
+	ImportExport importExport(colorList, filename.c_str());
 	switch (ImportExport::getFileType(filename.c_str())){
 		case FileType::gpl:
 			returnValue = importExport.importGPL();
@@ -404,10 +407,8 @@ int app_load_file(AppArgs *args, const std::string &filename, bool autoload)
 	int result = 0;
 	ColorList colorList;
 	if ((result = app_load_file(args, filename, colorList, autoload)) == 0){
-		auto &destination = args->gs->colorList();
-		common::Guard colorListGuard = destination.changeGuard();
-		destination.removeAll();
-		destination.add(colorList);
+		std::vector<ColorObject *> colorObjects(colorList.begin(), colorList.end());
+		args->gs->colorList().replaceAll(common::Span<ColorObject *const>(colorObjects.data(), colorObjects.size()));
 	}
 	return result;
 }
@@ -1124,9 +1125,9 @@ static void palette_popup_menu_remove_all(GtkWidget *widget, AppArgs *args) {
 }
 static void palette_popup_menu_remove_selected(GtkWidget *widget, AppArgs *args) {
 	auto selected = palette_list_get_selected(args->paletteWidget);
-	args->gs->colorList().remove([&](ColorObject *colorObject) {
+	args->gs->colorList().removeIf([&](ColorObject *colorObject) {
 		return selected.count(colorObject) != 0;
-	}, true, true);
+	});
 }
 static void palette_popup_menu_clear_names(GtkWidget *widget, AppArgs *args) {
 	palette_list_foreach(args->paletteWidget, true, [](ColorObject *colorObject) {
@@ -1501,6 +1502,30 @@ bool app_is_autoload_enabled(AppArgs *args)
 {
 	return args->options->getBool("main.save_restore_palette", true);
 }
+static gboolean onAutoSaveTimeout(AppArgs *args) {
+	if (app_is_autoload_enabled(args))
+		args->autoSaveJournal->flush();
+	return true;
+}
+void app_start_autosave(AppArgs *args, bool restore) {
+	args->autoSaveJournal = openAutoSaveJournal();
+	if (!args->autoSaveJournal) {
+		if (restore)
+			app_load_file(args, buildConfigPath("autosave.gpa"), true); // another instance owns the journal, so only load the last full autosave
+		return;
+	}
+	if (restore) {
+		ColorList colorList;
+		if (args->autoSaveJournal->restore(colorList)) {
+			std::vector<ColorObject *> colorObjects(colorList.begin(), colorList.end());
+			args->gs->colorList().replaceAll(common::Span<ColorObject *const>(colorObjects.data(), colorObjects.size()));
+		}
+		args->current_filename_set = false;
+		app_update_program_name(args);
+	}
+	args->autoSaveJournal->start(args->gs->colorList());
+	args->autoSaveTimeout = g_timeout_add_seconds(2, (GSourceFunc)onAutoSaveTimeout, args);
+}
 
 static void app_initialize_variables(AppArgs *args)
 {
@@ -1510,6 +1535,7 @@ static void app_initialize_variables(AppArgs *args)
 	args->current_color_source = nullptr;
 	args->secondary_source_widget = 0;
 	args->secondary_source_scrolled_viewpoint = 0;
+	args->autoSaveTimeout = 0;
 	args->gs->loadAll();
 	dialog_options_update(args->gs);
 	args->options = args->gs->settings().getOrCreateMap("gpick.main");
@@ -1750,9 +1776,17 @@ static void app_release(AppArgs *args) {
 	args->colorSourceIndex.clear();
 	floating_picker_free(args->floatingPicker);
 	if (!args->startupOptions.single_color_pick_mode){
+		if (args->autoSaveTimeout) {
+			g_source_remove(args->autoSaveTimeout);
+			args->autoSaveTimeout = 0;
+		}
 		if (app_is_autoload_enabled(args)){
-			autoSave(args->gs->colorList());
+			if (args->autoSaveJournal)
+				args->autoSaveJournal->close();
+			else
+				autoSave(args->gs->colorList());
 		}
+		args->autoSaveJournal.reset();
 		args->gs->colorList().removeAll();
 	}
 }
@@ -41,4 +41,10 @@ int app_load_file(AppArgs *args, const std::string &filename, bool autoload = fa
 int app_run(AppArgs *args);
 int app_parse_geometry(AppArgs *args, const char *geometry);
 bool app_is_autoload_enabled(AppArgs *args);
+/**
+ * Start recording palette changes to autosave journal.
+ * @param[in] args Application.
+ * @param[in] restore Load autosaved palette before starting.
+ */
+void app_start_autosave(AppArgs *args, bool restore);
 #endif /* GPICK_UI_APP_H_ */
@@ -101,8 +101,6 @@ struct EqualizeDialog: public DialogBase {
 		options->set("strength", static_cast<float>(gtk_spin_button_get_value(GTK_SPIN_BUTTON(strengthSpinButton))) / 100);
 	}
 	virtual void apply(bool preview) override {
-		if (preview)
-			previewColorList->removeAll();
 		colorSpace = &colorSpaces()[gtk_combo_box_get_active(GTK_COMBO_BOX(colorSpaceComboBox))];
 		channel = channelsInComboBox[gtk_combo_box_get_active(GTK_COMBO_BOX(channelComboBox))];
 		type = &types[gtk_combo_box_get_active(GTK_COMBO_BOX(typeComboBox))];
@@ -114,8 +112,7 @@ struct EqualizeDialog: public DialogBase {
 		float commonValue = 0;
 		for (auto *colorObject: selectedColorList) {
 			++count;
-			Color color = colorObject->getColor();
-			float value = std::invoke(colorSpace->convertTo, color).data[channel->index];
+			float value = colorObject->getColor(colorSpace->type).data[channel->index];
 			if (first) {
 				commonValue = value;
 				first = false;
@@ -133,8 +130,11 @@ struct EqualizeDialog: public DialogBase {
 				}
 			}
 		}
-		if (count == 0)
+		if (count == 0) {
+			if (preview)
+				previewColorList->removeAll();
 			return;
+		}
 		switch (type->type) {
 		case Type::average:
 			commonValue /= count;
@@ -144,10 +144,10 @@ struct EqualizeDialog: public DialogBase {
 		case Type::maximum:
 			break;
 		}
+		std::vector<ColorObject *> previewColors;
 		for (auto *colorObject: selectedColorList) {
-			Color color = colorObject->getColor();
-			float alpha = color.alpha;
-			color = std::invoke(colorSpace->convertTo, color);
+			float alpha = colorObject->getColor().alpha;
+			Color color = colorObject->getColor(colorSpace->type);
 			float value = color.data[channel->index];
 			value = math::mix(value, commonValue, strength);
 			color.data[channel->index] = value;
@@ -156,11 +156,16 @@ struct EqualizeDialog: public DialogBase {
 				color.alpha = alpha;
 			}
 			if (preview) {
-				colorList.add(ColorObject(colorObject->getName(), color));
+				previewColors.push_back(new ColorObject(colorObject->getName(), color));
 			} else {
 				colorObject->setColor(color);
 			}
 		}
+		if (preview) {
+			colorList.replaceAll(common::Span<ColorObject *const>(previewColors.data(), previewColors.size()));
+			for (auto *colorObject: previewColors)
+				colorObject->release();
+		}
 	}
 	void selectChannel() {
 		if (!channel->allColorSpaces() && colorSpace->type != channel->colorSpace) {
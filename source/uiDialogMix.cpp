@@ -27,6 +27,7 @@
 #include "ToolColorNaming.h"
 #include "I18N.h"
 #include <sstream>
+#include <vector>
 namespace {
 struct MixColorNameAssigner: public ToolColorNameAssigner {
 	MixColorNameAssigner(GlobalState &gs):
@@ -103,8 +104,17 @@ struct MixDialog: public DialogBase {
 		options->set<bool>("show_preview", gtk_expander_get_expanded(GTK_EXPANDER(previewExpander)));
 	}
 	virtual void apply(bool preview) override {
+		std::vector<ColorObject *> colors;
+		mix(preview, colors);
+		common::Span<ColorObject *const> mixedColors(colors.data(), colors.size());
 		if (preview)
-			previewColorList->removeAll();
+			previewColorList->replaceAll(mixedColors);
+		else
+			gs.colorList().addRange(mixedColors);
+		for (auto *colorObject: colors)
+			colorObject->release();
+	}
+	void mix(bool preview, std::vector<ColorObject *> &colors) {
 		int steps = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(mixStepsSpin));
 		int type = gtk_combo_box_get_active(GTK_COMBO_BOX(mixTypeCombo));
 		bool withEndpoints = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(endpointsToggle));
@@ -124,8 +134,6 @@ struct MixDialog: public DialogBase {
 		s.precision(0);
 		s.setf(std::ios::fixed, std::ios::floatfield);
 		Color a, b;
-		ColorList &colorList = preview ? *previewColorList : gs.colorList();
-		common::Guard colorListGuard = colorList.changeGuard();
 		ColorList::iterator j;
 		int count = 0;
 		for (auto i = selectedColorList.begin(); i != selectedColorList.end(); ++i) {
@@ -147,7 +155,7 @@ struct MixDialog: public DialogBase {
 					for (int stepIndex = startStep; stepIndex < maxStep; ++stepIndex) {
 						r = math::mix(a, b, stepIndex / (float)(steps - 1));
 						r.nonLinearRgbInplace();
-						addColor(colorList, r, stepIndex, nameAssigner);
+						addColor(colors, r, stepIndex, nameAssigner);
 						if (preview) {
 							++count;
 							if (count >= 100)
@@ -171,7 +179,7 @@ struct MixDialog: public DialogBase {
 						r_hsv = math::mix(a_hsv, b_hsv, stepIndex / (float)(steps - 1));
 						if (r_hsv.hsv.hue < 0) r_hsv.hsv.hue += 1;
 						r = r_hsv.hsvToRgb();
-						addColor(colorList, r, stepIndex, nameAssigner);
+						addColor(colors, r, stepIndex, nameAssigner);
 						if (preview) {
 							++count;
 							if (count >= 100)
@@ -187,7 +195,7 @@ struct MixDialog: public DialogBase {
 					for (int stepIndex = startStep; stepIndex < maxStep; ++stepIndex) {
 						r_lab = math::mix(a_lab, b_lab, stepIndex / (float)(steps - 1));
 						r = r_lab.labToRgbD50().normalizeRgbInplace();
-						addColor(colorList, r, stepIndex, nameAssigner);
+						addColor(colors, r, stepIndex, nameAssigner);
 						if (preview) {
 							++count;
 							if (count >= 100)
@@ -211,7 +219,7 @@ struct MixDialog: public DialogBase {
 						r_lch = math::mix(a_lch, b_lch, stepIndex / (float)(steps - 1));
 						if (r_lch.lch.h < 0) r_lch.lch.h += 360;
 						r = r_lch.lchToRgbD50().normalizeRgbInplace();
-						addColor(colorList, r, stepIndex, nameAssigner);
+						addColor(colors, r, stepIndex, nameAssigner);
 						if (preview) {
 							++count;
 							if (count >= 100)
@@ -223,10 +231,10 @@ struct MixDialog: public DialogBase {
 			}
 		}
 	}
-	static void addColor(ColorList &colorList, const Color &color, int step, MixColorNameAssigner &nameAssigner) {
-		ColorObject colorObject(color);
-		nameAssigner.assign(colorObject, step);
-		colorList.add(colorObject);
+	static void addColor(std::vector<ColorObject *> &colors, const Color &color, int step, MixColorNameAssigner &nameAssigner) {
+		auto *colorObject = new ColorObject(color);
+		nameAssigner.assign(*colorObject, step);
+		colors.push_back(colorObject);
 	}
 };
 }
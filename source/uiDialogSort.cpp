@@ -23,41 +23,47 @@
 #include "ColorList.h"
 #include "ColorObject.h"
 #include "Channels.h"
+#include "ColorSort.h"
 #include "ColorSpaces.h"
 #include "dynv/Map.h"
 #include "GlobalState.h"
 #include "I18N.h"
 #include "common/Match.h"
 #include "common/Format.h"
-#include "common/Unused.h"
-#include "math/BinaryTreeQuantization.h"
-#include <tuple>
 #include <algorithm>
+#include <deque>
+#include <unordered_map>
 namespace {
-static float toGrayscale(const Color &color) {
-	Color r = color.linearRgb();
-	return (r.red + r.green + r.blue) / 3;
-}
 static const ChannelDescription channelNone = { "none" };
-static const ChannelDescription virtualChannels[] = {
-	{ "rgb_grayscale", N_("RGB Grayscale"), ColorSpace::rgb, Channel::userDefined, ChannelFlags::useConvertTo, { .convertTo = toGrayscale }, 0, 1 },
-};
+// Text is read directly, so that preview is updated while value is being typed.
+static double spinValue(GtkWidget *widget) {
+	double value, min, max;
+	const char *text = gtk_entry_get_text(GTK_ENTRY(widget));
+	char *end = nullptr;
+	value = g_strtod(text, &end);
+	if (end == text)
+		return gtk_spin_button_get_value(GTK_SPIN_BUTTON(widget));
+	gtk_spin_button_get_range(GTK_SPIN_BUTTON(widget), &min, &max);
+	return std::clamp(value, min, max);
+}
 struct SortDialog: public DialogBase {
-	GtkWidget *groupComboBox, *groupSensitivitySpin, *maxGroupsSpin, *sortComboBox, *reverseCheck, *reverseGroupsCheck, *previewExpander;
+	GtkWidget *groupComboBox, *groupSensitivitySpin, *maxGroupsSpin, *sortComboBox, *reverseCheck, *tieBreakByNameCheck, *reverseGroupsCheck, *previewExpander;
 	ColorList &selectedColors, &sortedColors;
+	ColorSorter sorter;
 	std::vector<const ChannelDescription *> sortChannelsInComboBox, groupChannelsInComboBox;
 	const ChannelDescription *groupChannel, *sortChannel;
 	SortDialog(ColorList &selectedColors, ColorList &sortedColors, GlobalState &gs, GtkWindow *parent):
 		DialogBase(gs, "gpick.group_and_sort", _("Group and sort"), parent),
 		selectedColors(selectedColors),
-		sortedColors(sortedColors) {
+		sortedColors(sortedColors),
+		sorter(selectedColors) {
 		groupChannel = &common::matchById(channels(), options->getString("group_type", "rgb_red"), [](std::string_view id) -> const ChannelDescription & {
 			if (id.empty() || id == "none")
 				return channelNone;
-			return common::matchById(virtualChannels, id, channels()[0]);
+			return common::matchById(sortChannels(), id, channels()[0]);
 		});
 		sortChannel = &common::matchById(channels(), options->getString("sort_type", "rgb_red"), [](std::string_view id) -> const ChannelDescription & {
-			return common::matchById(virtualChannels, id, channels()[0]);
+			return common::matchById(sortChannels(), id, channels()[0]);
 		});
 		Grid grid(2, 8);
 		grid.addLabel(_("Sort by:"));
@@ -69,7 +75,7 @@ struct SortDialog: public DialogBase {
 			if (&i == sortChannel)
 				gtk_combo_box_set_active(GTK_COMBO_BOX(sortComboBox), sortChannelsInComboBox.size() - 1);
 		}
-		for (const auto &i: virtualChannels) {
+		for (const auto &i: sortChannels()) {
 			sortChannelsInComboBox.emplace_back(&i);
 			gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(sortComboBox), _(i.name));
 			if (&i == sortChannel)
@@ -82,6 +88,11 @@ struct SortDialog: public DialogBase {
 		gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(reverseCheck), options->getBool("reverse", false));
 		g_signal_connect(G_OBJECT(reverseCheck), "toggled", G_CALLBACK(onUpdate), this);
 
+		grid.nextColumn();
+		grid.add(tieBreakByNameCheck = gtk_check_button_new_with_mnemonic(_("Sort equal values by _name")), true);
+		gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(tieBreakByNameCheck), options->getBool("tie_break_by_name", false));
+		g_signal_connect(G_OBJECT(tieBreakByNameCheck), "toggled", G_CALLBACK(onUpdate), this);
+
 		grid.addLabel(_("Group by:"));
 		grid.add(groupComboBox = gtk_combo_box_text_new(), true);
 		groupChannelsInComboBox.emplace_back(&channelNone);
@@ -95,7 +106,7 @@ struct SortDialog: public DialogBase {
 			if (&i == groupChannel)
 				gtk_combo_box_set_active(GTK_COMBO_BOX(groupComboBox), groupChannelsInComboBox.size() - 1);
 		}
-		for (const auto &i: virtualChannels) {
+		for (const auto &i: sortChannels()) {
 			groupChannelsInComboBox.emplace_back(&i);
 			gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(groupComboBox), _(i.name));
 			if (&i == groupChannel)
@@ -106,12 +117,12 @@ struct SortDialog: public DialogBase {
 		grid.addLabel(_("Maximum number of groups:"));
 		grid.add(maxGroupsSpin = gtk_spin_button_new_with_range(1, 255, 1), true);
 		gtk_spin_button_set_value(GTK_SPIN_BUTTON(maxGroupsSpin), options->getInt32("max_groups", 10));
-		g_signal_connect(G_OBJECT(maxGroupsSpin), "value-changed", G_CALLBACK(onUpdate), this);
+		g_signal_connect(G_OBJECT(maxGroupsSpin), "changed", G_CALLBACK(onUpdate), this);
 
 		grid.addLabel(_("Grouping sensitivity:"));
 		grid.add(groupSensitivitySpin = gtk_spin_button_new_with_range(0, 100, 0.1), true);
 		gtk_spin_button_set_value(GTK_SPIN_BUTTON(groupSensitivitySpin), options->getFloat("group_sensitivity", 50));
-		g_signal_connect(G_OBJECT(groupSensitivitySpin), "value-changed", G_CALLBACK(onUpdate), this);
+		g_signal_connect(G_OBJECT(groupSensitivitySpin), "changed", G_CALLBACK(onUpdate), this);
 
 		grid.nextColumn();
 		grid.add(reverseGroupsCheck = gtk_check_button_new_with_mnemonic(_("_Reverse group order")), true);
@@ -133,9 +144,10 @@ struct SortDialog: public DialogBase {
 	virtual void apply(bool preview) override {
 		groupChannel = groupChannelsInComboBox[gtk_combo_box_get_active(GTK_COMBO_BOX(groupComboBox))];
 		sortChannel = sortChannelsInComboBox[gtk_combo_box_get_active(GTK_COMBO_BOX(sortComboBox))];
-		float groupSensitivity = static_cast<float>(gtk_spin_button_get_value(GTK_SPIN_BUTTON(groupSensitivitySpin)));
-		int maxGroups = static_cast<int>(gtk_spin_button_get_value(GTK_SPIN_BUTTON(maxGroupsSpin)));
+		float groupSensitivity = static_cast<float>(spinValue(groupSensitivitySpin));
+		int maxGroups = static_cast<int>(spinValue(maxGroupsSpin));
 		bool reverse = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(reverseCheck));
+		bool tieBreakByName = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(tieBreakByNameCheck));
 		bool reverseGroups = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(reverseGroupsCheck));
 		if (!preview) {
 			options->set("group_type", groupChannel->id);
@@ -143,80 +155,54 @@ struct SortDialog: public DialogBase {
 			options->set("max_groups", maxGroups);
 			options->set("sort_type", sortChannel->id);
 			options->set("reverse", reverse);
+			options->set("tie_break_by_name", tieBreakByName);
 			options->set("reverse_groups", reverseGroups);
 		} else {
 			previewColorList->removeAll();
 			enableGroupInputs(groupChannel != &channelNone);
 		}
-		ColorList &colorList = preview ? *previewColorList : sortedColors;
-		using ColorWithProperties = std::tuple<float, float, ColorObject *>;
-		std::vector<ColorWithProperties> colors;
-		colors.reserve(selectedColors.size());
-		if (maxGroups == 1 || groupChannel == &channelNone) {
-			auto sortConvertTo = sortChannel->useConvertTo() ? nullptr : colorSpace(sortChannel->colorSpace).convertTo;
-			for (auto *colorObject: selectedColors) {
-				Color color = colorObject->getColor();
-				float sortValue = sortConvertTo ? (std::invoke(sortConvertTo, color).data[sortChannel->index] - sortChannel->min) / (sortChannel->max - sortChannel->min) : sortChannel->convertTo(color);
-				colors.emplace_back(0, sortValue, colorObject);
-			}
-			std::stable_sort(colors.begin(), colors.end(), [reverse](const ColorWithProperties &a, const ColorWithProperties &b) -> bool {
-				float aSort, bSort;
-				std::tie(std::ignore, aSort, std::ignore) = a;
-				std::tie(std::ignore, bSort, std::ignore) = b;
-				return (aSort < bSort) ^ reverse;
-			});
-		} else {
-			math::BinaryTreeQuantization<float> tree;
-			auto groupConvertTo = groupChannel->useConvertTo() ? nullptr : colorSpace(groupChannel->colorSpace).convertTo;
-			for (auto *colorObject: selectedColors) {
-				Color color = colorObject->getColor();
-				float value = groupConvertTo ? (std::invoke(groupConvertTo, color).data[groupChannel->index] - groupChannel->min) / (groupChannel->max - groupChannel->min) : groupChannel->convertTo(color);
-				tree.add(value);
-			}
-			tree.reduce(maxGroups);
-			tree.reduceByMinDistance(groupSensitivity / 100.0f);
-			auto sortConvertTo = sortChannel->useConvertTo() ? nullptr : colorSpace(sortChannel->colorSpace).convertTo;
-			for (auto *colorObject: selectedColors) {
-				Color color = colorObject->getColor();
-				float groupValue = tree.find(groupConvertTo ? (std::invoke(groupConvertTo, color).data[groupChannel->index] - groupChannel->min) / (groupChannel->max - groupChannel->min) : groupChannel->convertTo(color));
-				float sortValue = sortConvertTo ? (std::invoke(sortConvertTo, color).data[sortChannel->index] - sortChannel->min) / (sortChannel->max - sortChannel->min) : sortChannel->convertTo(color);
-				colors.emplace_back(groupValue, sortValue, colorObject);
-			}
-			std::stable_sort(colors.begin(), colors.end(), [reverse, reverseGroups](const ColorWithProperties &a, const ColorWithProperties &b) -> bool {
-				float aGroup, aSort, bGroup, bSort;
-				std::tie(aGroup, aSort, std::ignore) = a;
-				std::tie(bGroup, bSort, std::ignore) = b;
-				if (aGroup != bGroup) {
-					return (aGroup < bGroup) ^ reverseGroups;
-				}
-				return (aSort < bSort) ^ reverse;
-			});
-		}
-		common::Guard colorListGuard = colorList.changeGuard();
-		for (auto [group, sort, colorObject]: colors) {
-			common::maybeUnused(group, sort);
-			colorList.add(colorObject);
-		}
+		ColorSorter::Options sortOptions;
+		sortOptions.sortChannel = sortChannel;
+		sortOptions.groupChannel = groupChannel != &channelNone ? groupChannel : nullptr;
+		sortOptions.maxGroups = maxGroups;
+		sortOptions.groupSensitivity = groupSensitivity / 100.0f;
+		sortOptions.reverse = reverse;
+		sortOptions.reverseGroups = reverseGroups;
+		sortOptions.tieBreakByName = tieBreakByName;
+		sorter.sort(sortOptions, preview ? *previewColorList : sortedColors);
 	}
 };
 }
 void dialog_sort_show(GtkWindow *parent, GtkWidget *paletteWidget, GlobalState &gs) {
 	ColorList colorList, sortedColorList;
 	palette_list_get_selected(paletteWidget, colorList);
-	if (SortDialog(colorList, sortedColorList, gs, parent).run()) {
-		auto i = sortedColorList.begin();
-		palette_list_foreach(paletteWidget, true, [&i](ColorObject **colorObject) {
-			*colorObject = *i;
-			++i;
-			return Update::none;
-		});
-		auto selected = palette_list_get_selected(paletteWidget);
-		i = sortedColorList.begin();
-		for (auto *&colorObject: gs.colorList()) {
-			if (selected.count(colorObject) != 0) {
-				colorObject = *i;
-				++i;
-			}
+	if (!SortDialog(colorList, sortedColorList, gs, parent).run())
+		return;
+	// Sorted colors take places of selected colors, other colors stay where they are.
+	std::unordered_map<ColorObject *, size_t> unassigned;
+	for (auto *colorObject: colorList)
+		unassigned[colorObject]++;
+	auto &paletteColorList = gs.colorList();
+	std::unordered_map<ColorObject *, std::deque<size_t>> selectedIndexes;
+	std::vector<size_t> slots, order(paletteColorList.size());
+	size_t index = 0;
+	for (auto *colorObject: paletteColorList) {
+		order[index] = index;
+		auto i = unassigned.find(colorObject);
+		if (i != unassigned.end() && i->second != 0) {
+			i->second--;
+			slots.push_back(index);
+			selectedIndexes[colorObject].push_back(index);
 		}
+		index++;
+	}
+	auto slot = slots.begin();
+	for (auto *colorObject: sortedColorList) {
+		auto &indexes = selectedIndexes[colorObject];
+		if (slot == slots.end() || indexes.empty())
+			return;
+		order[*slot++] = indexes.front();
+		indexes.pop_front();
 	}
+	paletteColorList.reorder(common::Span<const size_t>(order.data(), order.size()));
 }
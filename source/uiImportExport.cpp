@@ -21,6 +21,7 @@
 #include "uiListPalette.h"
 #include "dynv/Map.h"
 #include "ImportExport.h"
+#include "ImportExportTask.h"
 #include "StringUtils.h"
 #include "ColorList.h"
 #include "Converters.h"
@@ -30,6 +31,7 @@
 #include "parser/TextFile.h"
 #include "common/Guard.h"
 #include <functional>
+#include <memory>
 namespace {
 struct ImportExportFormat {
 	const char *name;
@@ -290,6 +292,66 @@ struct ImportExportDialogOptions {
 		import_export_dialog->afterFilterChanged();
 	}
 };
+// Polls import or export task from the main loop. Progress window is only shown when task takes longer than a moment.
+struct ImportExportProgress {
+	std::unique_ptr<ImportExportTask> m_task;
+	GtkWindow *m_parent;
+	GtkWidget *m_window, *m_progressBar;
+	const char *m_title, *m_errorMessage;
+	guint m_timeout;
+	gint64 m_showTime;
+	ImportExportProgress(GtkWindow *parent, std::unique_ptr<ImportExportTask> task, const char *title, const char *errorMessage):
+		m_task(std::move(task)),
+		m_parent(parent),
+		m_title(title),
+		m_errorMessage(errorMessage) {
+		m_window = gtk_dialog_new_with_buttons(title, parent, GTK_DIALOG_DESTROY_WITH_PARENT, GTK_STOCK_CANCEL, GTK_RESPONSE_CANCEL, nullptr);
+		gtk_window_set_default_size(GTK_WINDOW(m_window), 320, -1);
+		GtkWidget *vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
+		gtk_container_set_border_width(GTK_CONTAINER(vbox), 5);
+		gchar *name = g_path_get_basename(m_task->filename().c_str());
+		GtkWidget *label = gtk_label_new(name);
+		g_free(name);
+		gtk_label_set_ellipsize(GTK_LABEL(label), PANGO_ELLIPSIZE_MIDDLE);
+		gtk_box_pack_start(GTK_BOX(vbox), label, false, false, 0);
+		m_progressBar = gtk_progress_bar_new();
+		gtk_box_pack_start(GTK_BOX(vbox), m_progressBar, false, false, 0);
+		gtk_box_pack_start(GTK_BOX(gtk_dialog_get_content_area(GTK_DIALOG(m_window))), vbox, true, true, 0);
+		g_signal_connect(G_OBJECT(m_window), "response", G_CALLBACK(onResponse), this);
+		g_signal_connect(G_OBJECT(m_window), "destroy", G_CALLBACK(onDestroy), this);
+		m_showTime = g_get_monotonic_time() + 300000;
+		m_timeout = g_timeout_add(50, reinterpret_cast<GSourceFunc>(onTimeout), this);
+	}
+	static void start(GtkWindow *parent, std::unique_ptr<ImportExportTask> task, const char *title, const char *errorMessage) {
+		new ImportExportProgress(parent, std::move(task), title, errorMessage); // deleted when window is destroyed
+	}
+	static gboolean onTimeout(ImportExportProgress *progress) {
+		auto state = progress->m_task->poll();
+		if (state == ImportExportTask::State::running) {
+			gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(progress->m_progressBar), progress->m_task->progress());
+			if (!gtk_widget_get_visible(progress->m_window) && g_get_monotonic_time() >= progress->m_showTime)
+				gtk_widget_show_all(progress->m_window);
+			return true;
+		}
+		progress->m_timeout = 0;
+		if (state == ImportExportTask::State::failed) {
+			GtkWidget *message = gtk_message_dialog_new(progress->m_parent, GTK_DIALOG_MODAL, GTK_MESSAGE_ERROR, GTK_BUTTONS_OK, "%s", progress->m_errorMessage);
+			gtk_window_set_title(GTK_WINDOW(message), progress->m_title);
+			gtk_dialog_run(GTK_DIALOG(message));
+			gtk_widget_destroy(message);
+		}
+		gtk_widget_destroy(progress->m_window);
+		return false;
+	}
+	static void onResponse(GtkWidget *, gint, ImportExportProgress *progress) {
+		progress->m_task->cancel();
+	}
+	static void onDestroy(GtkWidget *, ImportExportProgress *progress) {
+		if (progress->m_timeout)
+			g_source_remove(progress->m_timeout);
+		delete progress; // import is cancelled, export which was not cancelled is finished, for example when window is destroyed with main window on exit
+	}
+};
 }
 ImportExportDialog::ImportExportDialog(GtkWindow *parent, ColorList &colorList, GlobalState &gs):
 	m_parent(parent),
@@ -370,18 +432,11 @@ bool ImportExportDialog::showImport() {
 			} else {
 				for (size_t i = 0; i != n_formats; ++i) {
 					if (formats[i].type == type) {
-						ColorList colorList;
-						ImportExport importExport(colorList, filename, m_gs);
-						importExport.setConverters(&m_gs.converters());
-						if (importExport.importType(formats[i].type)) {
-							finished = true;
-							m_colorList.add(colorList);
-						} else {
-							message = gtk_message_dialog_new(GTK_WINDOW(dialog), GTK_DIALOG_MODAL, GTK_MESSAGE_ERROR, GTK_BUTTONS_OK, _("File could not be imported"));
-							gtk_window_set_title(GTK_WINDOW(message), _("Import"));
-							gtk_dialog_run(GTK_DIALOG(message));
-							gtk_widget_destroy(message);
-						}
+						auto task = ImportExportTask::startImport(m_colorList, filename, formats[i].type, [this](ImportExport &importExport) {
+							importExport.setConverters(&m_gs.converters());
+						});
+						ImportExportProgress::start(m_parent, std::move(task), _("Import"), _("File could not be imported"));
+						finished = true;
 						const char *identification = (const char *)g_object_get_data(G_OBJECT(gtk_file_chooser_get_filter(GTK_FILE_CHOOSER(dialog))), "identification");
 						m_gs.settings().set("gpick.import.filter", identification);
 						break;
@@ -413,11 +468,7 @@ bool ImportExportDialog::showImportTextFile() {
 			m_gs.settings().set("gpick.import_text_file.path", path);
 			g_free(path);
 			importExportDialogOptions.saveState();
-			GtkWidget *message;
 			gchar *filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
-			ColorList colorList;
-			ImportExport importExport(colorList, filename, m_gs);
-			importExport.setConverters(&m_gs.converters());
 			text_file_parser::Configuration configuration;
 			configuration.singleLineCComments = importExportDialogOptions.isSingleLineCCommentsEnabled();
 			configuration.multiLineCComments = importExportDialogOptions.isMultiLineCCommentsEnabled();
@@ -432,15 +483,9 @@ bool ImportExportDialog::showImportTextFile() {
 			configuration.shortHexWithAlpha = importExportDialogOptions.isShortHexWithAlphaEnabled();
 			configuration.intValues = importExportDialogOptions.isIntValuesEnabled();
 			configuration.floatValues = importExportDialogOptions.isFloatValuesEnabled();
-			if (importExport.importTextFile(configuration)) {
-				finished = true;
-				m_colorList.add(colorList);
-			} else {
-				message = gtk_message_dialog_new(GTK_WINDOW(dialog), GTK_DIALOG_MODAL, GTK_MESSAGE_ERROR, GTK_BUTTONS_OK, _("File could not be imported"));
-				gtk_window_set_title(GTK_WINDOW(message), _("Import text file"));
-				gtk_dialog_run(GTK_DIALOG(message));
-				gtk_widget_destroy(message);
-			}
+			auto task = ImportExportTask::startImportTextFile(m_colorList, filename, configuration);
+			ImportExportProgress::start(m_parent, std::move(task), _("Import text file"), _("File could not be imported"));
+			finished = true;
 			g_free(filename);
 		} else
 			break;
@@ -494,22 +539,18 @@ bool ImportExportDialog::showExport() {
 			std::string formatName = gtk_file_filter_get_name(gtk_file_chooser_get_filter(GTK_FILE_CHOOSER(dialog)));
 			for (size_t i = 0; i != n_formats; ++i) {
 				if (formats[i].name == formatName) {
-					ImportExport importExport(m_colorList, filename, m_gs);
-					importExport.fixFileExtension(formats[i].pattern);
-					importExport.setConverter(importExportDialogOptions.getSelectedConverter());
-					std::string itemSize = importExportDialogOptions.getSelectedItemSize();
-					importExport.setItemSize(itemSize.c_str());
-					std::string background = importExportDialogOptions.getSelectedBackground();
-					importExport.setBackground(background.c_str());
-					importExport.setIncludeColorNames(importExportDialogOptions.isIncludeColorNamesEnabled());
-					if (importExport.exportType(formats[i].type)) {
-						finished = true;
-					} else {
-						GtkWidget *message = gtk_message_dialog_new(GTK_WINDOW(dialog), GTK_DIALOG_MODAL, GTK_MESSAGE_ERROR, GTK_BUTTONS_OK, _("File could not be exported"));
-						gtk_window_set_title(GTK_WINDOW(dialog), _("Export"));
-						gtk_dialog_run(GTK_DIALOG(message));
-						gtk_widget_destroy(message);
-					}
+					auto task = ImportExportTask::startExport(m_colorList, filename, formats[i].type, [&](ImportExport &importExport) {
+						importExport.fixFileExtension(formats[i].pattern);
+						importExport.setConverter(importExportDialogOptions.getSelectedConverter());
+						std::string itemSize = importExportDialogOptions.getSelectedItemSize();
+						importExport.setItemSize(itemSize.c_str());
+						std::string background = importExportDialogOptions.getSelectedBackground();
+						importExport.setBackground(background.c_str());
+						importExport.setIncludeColorNames(importExportDialogOptions.isIncludeColorNamesEnabled());
+						importExport.setUpperCaseHex(m_gs.settings().getString("gpick.options.hex_case", "upper") == "upper");
+					});
+					ImportExportProgress::start(m_parent, std::move(task), _("Export"), _("File could not be exported"));
+					finished = true;
 					m_gs.settings().set("gpick.export.filter", formats[i].pattern);
 				}
 			}
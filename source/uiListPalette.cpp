@@ -19,6 +19,7 @@
 #include "uiListPalette.h"
 #include "uiUtilities.h"
 #include "gtk/ColorCell.h"
+#include "gtk/PaletteListModel.h"
 #include "ColorObject.h"
 #include "ColorList.h"
 #include "IColorSource.h"
@@ -40,7 +41,10 @@
 #include "IContainerUI.h"
 #include "IPalette.h"
 #include <boost/algorithm/string/find.hpp>
+#include <algorithm>
 #include <unordered_set>
+#include <optional>
+#include <vector>
 #include <sstream>
 #include <iomanip>
 #include <string_view>
@@ -54,9 +58,9 @@ enum struct Type {
 struct ListPaletteArgs;
 static void foreachSelectedItem(GtkTreeView *treeView, std::function<bool(ColorObject *)> callback);
 static void foreachItem(GtkTreeView *treeView, std::function<bool(ColorObject *)> callback);
-static void updateAll(GtkTreeView *treeView, GlobalState &gs);
-static void set(GtkListStore* store, GtkTreeIter *iter, ColorObject* colorObject, ListPaletteArgs* args);
 const int scrollEdgeSize = 15; //SCROLL_EDGE_SIZE from gtktreeview.c
+// Tree view handles row notifications one by one, so for larger changes model is detached and all rows are rebuilt at once.
+const size_t bulkChangeRows = 1000;
 struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public IDroppableColorsUI, public IDraggableColorUI, public IEventHandler, public IPalette {
 	GtkWidget *treeview;
 	gint scrollTimeout;
@@ -66,6 +70,8 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 	bool countUpdateBlocked;
 	Type type;
 	ColorList &colorList;
+	GtkPaletteListModel *model;
+	std::vector<ColorObject *> pendingRows;
 	ListPaletteArgs(GlobalState &gs, GtkWidget *countLabel, Type type, ColorList &colorList):
 		scrollTimeout(0),
 		countLabel(countLabel),
@@ -99,11 +105,46 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 	virtual ~ListPaletteArgs() {
 		gs.eventBus().unsubscribe(*this);
 	}
+	GtkTreeModel *newModel() {
+		auto store = gtk_palette_list_model_new([this](const ColorObject &colorObject) {
+			return gs.converters().serialize(colorObject, Converters::Type::colorList);
+		});
+		model = GTK_PALETTE_LIST_MODEL(store);
+		return store;
+	}
+	template<typename Callback>
+	void changeRows(size_t rows, Callback &&callback) {
+		if (rows < bulkChangeRows) {
+			callback(true);
+			return;
+		}
+		auto adjustment = gtk_tree_view_get_vadjustment(GTK_TREE_VIEW(treeview));
+		double position = gtk_adjustment_get_value(adjustment);
+		g_object_ref(model);
+		gtk_tree_view_set_model(GTK_TREE_VIEW(treeview), nullptr);
+		callback(false);
+		gtk_tree_view_set_model(GTK_TREE_VIEW(treeview), GTK_TREE_MODEL(model));
+		g_object_unref(model);
+		gtk_adjustment_set_value(adjustment, position);
+	}
+	void queueRow(ColorObject *colorObject) {
+		pendingRows.push_back(colorObject->reference());
+	}
+	void flushRows() {
+		if (pendingRows.empty())
+			return;
+		changeRows(pendingRows.size(), [this](bool notify) {
+			gtk_palette_list_model_insert(model, gtk_palette_list_model_size(model), pendingRows.data(), pendingRows.size(), notify);
+		});
+		for (auto *colorObject: pendingRows)
+			colorObject->release();
+		pendingRows.clear();
+	}
 	void buildPalette() {
 		treeview = gtk_tree_view_new();
 		gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(treeview), true);
 		gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(treeview), true);
-		auto store = gtk_list_store_new (3, G_TYPE_POINTER, G_TYPE_STRING, G_TYPE_STRING);
+		auto store = newModel();
 		g_object_set_data_full(G_OBJECT(store), "arguments", this, nullptr);
 		auto col = gtk_tree_view_column_new();
 		gtk_tree_view_column_set_sizing(col, GTK_TREE_VIEW_COLUMN_FIXED);
@@ -160,7 +201,7 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 		treeview = gtk_tree_view_new();
 		gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(treeview), 0);
 		gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(treeview), true);
-		auto store = gtk_list_store_new(3, G_TYPE_POINTER, G_TYPE_STRING, G_TYPE_STRING);
+		auto store = newModel();
 		auto col = gtk_tree_view_column_new();
 		gtk_tree_view_column_set_sizing(col, GTK_TREE_VIEW_COLUMN_FIXED);
 		gtk_tree_view_column_set_resizable(col, 0);
@@ -251,9 +292,9 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 	virtual void removeColors(bool selected) override {
 		if (selected) {
 			auto selected = palette_list_get_selected(treeview);
-			colorList.remove([&](ColorObject *colorObject) {
+			colorList.removeIf([&](ColorObject *colorObject) {
 				return selected.count(colorObject) != 0;
-			}, true, true);
+			});
 		} else {
 			colorList.removeAll();
 		}
@@ -284,45 +325,29 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 	virtual void setColorsAt(const std::vector<ColorObject> &colorObjects, int x, int y) override {
 		droppedColors.clear();
 		removeScrollTimeout();
-		auto model = gtk_tree_view_get_model(GTK_TREE_VIEW(treeview));
-		std::optional<GtkTreeIter> insertIterator;
+		flushRows();
 		GtkTreePath* path;
 		GtkTreeViewDropPosition pos;
 		size_t position;
-		bool before = false;
 		if (getPathAt(GTK_TREE_VIEW(treeview), x, y, path, pos)) {
-			GtkTreeIter iter;
-			gtk_tree_model_get_iter(model, &iter, path);
 			position = gtk_tree_path_get_indices(path)[0];
 			gtk_tree_path_free(path);
-			insertIterator = iter;
-			if (pos == GTK_TREE_VIEW_DROP_AFTER || pos == GTK_TREE_VIEW_DROP_INTO_OR_AFTER) {
+			if (pos == GTK_TREE_VIEW_DROP_AFTER || pos == GTK_TREE_VIEW_DROP_INTO_OR_AFTER)
 				position += 1;
-			} else {
-				before = true;
-			}
 		} else {
-			position = gtk_tree_model_iter_n_children(model, nullptr);
+			position = gtk_palette_list_model_size(model);
 		}
 		dropGuard.emplace(std::move(colorList.changeGuard()));
+		std::vector<ColorObject *> newColorObjects;
+		newColorObjects.reserve(colorObjects.size());
 		for (auto &colorObject: colorObjects) {
-			GtkTreeIter iter;
-			if (insertIterator) {
-				if (before) {
-					gtk_list_store_insert_before(GTK_LIST_STORE(model), &iter, &*insertIterator);
-				} else {
-					gtk_list_store_insert_after(GTK_LIST_STORE(model), &iter, &*insertIterator);
-					insertIterator = iter;
-				}
-			} else {
-				gtk_list_store_append(GTK_LIST_STORE(model), &iter);
-			}
-			auto newColorObject = colorObject.copy();
-			set(GTK_LIST_STORE(model), &iter, newColorObject.pointer(), this);
-			droppedColors.emplace(newColorObject.pointer());
-			colorList.add(newColorObject.pointer(), position);
-			++position;
+			auto *newColorObject = colorObject.copy().unwrap();
+			newColorObjects.push_back(newColorObject);
+			droppedColors.emplace(newColorObject);
 		}
+		colorList.addRange(position, common::Span<ColorObject *const>(newColorObjects.data(), newColorObjects.size()));
+		for (auto *colorObject: newColorObjects)
+			colorObject->release();
 	}
 	std::unordered_set<ColorObject *> draggingColors;
 	virtual std::vector<ColorObject> getColors(bool selected) override {
@@ -379,22 +404,18 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 		}else{
 			int tx, ty;
 			gtk_tree_view_convert_widget_to_tree_coords(treeView, x, y, &tx, &ty);
-			GtkTreeModel *model = gtk_tree_view_get_model(treeView);
-			GtkTreeIter last, iter;
-			if (!gtk_tree_model_get_iter_first(model, &iter)) {
+			gint count = gtk_tree_model_iter_n_children(gtk_tree_view_get_model(treeView), nullptr);
+			if (count == 0) {
 				position = GTK_TREE_VIEW_DROP_AFTER;
 				return false;
 			}
 			if (ty >= 0) {
-				do {
-					last = iter;
-				} while (gtk_tree_model_iter_next(model, &iter));
 				position = GTK_TREE_VIEW_DROP_AFTER;
-				iter = last;
+				path = gtk_tree_path_new_from_indices(count - 1, -1);
 			} else {
 				position = GTK_TREE_VIEW_DROP_BEFORE;
+				path = gtk_tree_path_new_first();
 			}
-			path = gtk_tree_model_get_path(model, &iter);
 			return true;
 		}
 	}
@@ -424,23 +445,19 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 		auto *selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(treeview));
 		gtk_tree_selection_set_select_function(selection, nullptr, nullptr, nullptr);
 		gtk_tree_selection_unselect_all(selection);
-		auto model = gtk_tree_view_get_model(GTK_TREE_VIEW(treeview));
-		GtkTreeIter iter;
-		bool valid = gtk_tree_model_get_iter_first(GTK_TREE_MODEL(model), &iter);
 		bool first = true;
-		while (valid) {
-			ColorObject *colorObject;
-			gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
-			if (droppedColors.count(colorObject) != 0) {
-				gtk_tree_selection_select_iter(selection, &iter);
-				if (first) {
-					first = false;
-					auto path = gtk_tree_model_get_path(model, &iter);
-					gtk_tree_view_set_cursor(GTK_TREE_VIEW(treeview), path, nullptr, false);
-					gtk_tree_path_free(path);
-				}
+		for (size_t i = 0, count = gtk_palette_list_model_size(model); i < count; i++) {
+			if (droppedColors.count(gtk_palette_list_model_get(model, i)) == 0)
+				continue;
+			GtkTreeIter iter;
+			gtk_palette_list_model_get_iter(model, i, &iter);
+			gtk_tree_selection_select_iter(selection, &iter);
+			if (first) {
+				first = false;
+				auto path = gtk_tree_path_new_from_indices(static_cast<gint>(i), -1);
+				gtk_tree_view_set_cursor(GTK_TREE_VIEW(treeview), path, nullptr, false);
+				gtk_tree_path_free(path);
 			}
-			valid = gtk_tree_model_iter_next(GTK_TREE_MODEL(model), &iter);
 		}
 		droppedColors.clear();
 		if (self) {
@@ -463,22 +480,9 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 			return;
 		}
 		if (move) {
-			GtkListStore *store = GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(treeview)));;
-			GtkTreeIter iter;
-			gboolean valid = gtk_tree_model_get_iter_first(GTK_TREE_MODEL(store), &iter);
-			ColorObject *colorObject;
-			while (valid) {
-				gtk_tree_model_get(GTK_TREE_MODEL(store), &iter, 0, &colorObject, -1);
-				if (draggingColors.count(colorObject) != 0) {
-					valid = gtk_list_store_remove(GTK_LIST_STORE(store), &iter);
-					colorObject->release();
-				}else{
-					valid = gtk_tree_model_iter_next(GTK_TREE_MODEL(store), &iter);
-				}
-			}
-			colorList.remove([&](ColorObject *colorObject) {
+			colorList.removeIf([this](ColorObject *colorObject) {
 				return draggingColors.count(colorObject) != 0;
-			}, false, false);
+			});
 			if (type == Type::main)
 				gs.eventBus().trigger(EventType::paletteChanged);
 		} else {
@@ -517,7 +521,6 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 			return;
 		std::stringstream ss;
 		GtkTreeSelection *sel;
-		GtkTreeModel *model = gtk_tree_view_get_model(GTK_TREE_VIEW(treeview));
 		SelectionBoundsArgs bounds;
 		int selected_count;
 		int total_colors;
@@ -526,7 +529,7 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 		}
 		sel = gtk_tree_view_get_selection(GTK_TREE_VIEW(treeview));
 		selected_count = gtk_tree_selection_count_selected_rows(sel);
-		total_colors = gtk_tree_model_iter_n_children(model, nullptr);
+		total_colors = static_cast<int>(gtk_palette_list_model_size(model));
 		bounds.discontinuous = false;
 		bounds.minIndex = 0x7fffffff;
 		bounds.lastIndex = 0x7fffffff;
@@ -565,7 +568,8 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 		switch (eventType) {
 		case EventType::optionsUpdate:
 		case EventType::convertersUpdate:
-			updateAll(GTK_TREE_VIEW(treeview), gs);
+			gtk_palette_list_model_invalidate_all(model);
+			gtk_widget_queue_draw(treeview);
 			break;
 		case EventType::displayFiltersUpdate:
 		case EventType::colorDictionaryUpdate:
@@ -604,11 +608,8 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 	virtual void add(ColorList &colorList, ColorObject *colorObject) override {
 		palette_list_add_entry(treeview, colorObject, !colorList.blocked());
 	}
-	virtual void remove(ColorList &colorList, ColorObject *colorObject) override {
-		palette_list_remove_entry(treeview, colorObject, !colorList.blocked());
-	}
-	virtual void removeSelected(ColorList &colorList) override {
-		palette_list_remove_selected_entries(treeview, !colorList.blocked());
+	virtual void change(ColorList &colorList, const ColorListChange &change) override {
+		palette_list_change(treeview, colorList, change, !colorList.blocked());
 	}
 	virtual void clear(ColorList &colorList) override {
 		palette_list_remove_all_entries(treeview, !colorList.blocked());
@@ -638,13 +639,11 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 		GtkTreeIter iter;
 		GtkTreeModel *model = GTK_TREE_MODEL(userData);
 		ListPaletteArgs *args = reinterpret_cast<ListPaletteArgs *>(g_object_get_data(G_OBJECT(model), "arguments"));
-		gtk_tree_model_get_iter_from_string(model, &iter, path);
-		gtk_list_store_set(GTK_LIST_STORE(model), &iter,
-				2, new_text,
-				-1);
-		ColorObject *colorObject;
-		gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
-		colorObject->setName(new_text);
+		if (!gtk_tree_model_get_iter_from_string(model, &iter, path))
+			return;
+		size_t index = gtk_palette_list_model_get_index(args->model, &iter);
+		gtk_palette_list_model_get(args->model, index)->setName(new_text);
+		gtk_palette_list_model_invalidate(args->model, index, true);
 		args->onChange();
 	}
 	static void onPreviewActivate(GtkTreeView *treeView, GtkTreePath *path, GtkTreeViewColumn *column, ListPaletteArgs *args) {
@@ -683,7 +682,11 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 	}
 	static void onDestroy(GtkWidget* widget, ListPaletteArgs *args){
 		args->removeScrollTimeout();
-		palette_list_remove_all_entries(widget, false);
+		for (auto *colorObject: args->pendingRows)
+			colorObject->release();
+		args->pendingRows.clear();
+		gtk_tree_view_set_model(GTK_TREE_VIEW(widget), nullptr);
+		args->model = nullptr;
 	}
 	static gboolean onButtonPress(GtkTreeView *treeView, GdkEventButton *event, ListPaletteArgs *args) {
 		if (event->button == 1 && !(event->state & (GDK_SHIFT_MASK | GDK_CONTROL_MASK))) {
@@ -709,46 +712,27 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 	static gboolean onSearchEqual(GtkTreeModel *model, gint, const gchar *key, GtkTreeIter *iter, gpointer) {
 		gchar *code, *name;
 		gtk_tree_model_get(model, iter, 1, &code, 2, &name, -1);
-		return !(contains(code, key) || contains(name, key));
+		bool found = contains(code, key) || contains(name, key);
+		g_free(code);
+		g_free(name);
+		return !found;
 	}
 	ColorObject colorObject;
 };
-static void set(GtkListStore *store, GtkTreeIter *iter, ColorObject *colorObject, ListPaletteArgs *args) {
-	std::string text = args->gs.converters().serialize(*colorObject, Converters::Type::colorList);
-	gtk_list_store_set(store, iter, 0, colorObject->reference(), 1, text.c_str(), 2, colorObject->getName().c_str(), -1);
-}
-static void setName(GtkListStore *store, GtkTreeIter *iter, ColorObject *colorObject) {
-	gtk_list_store_set(store, iter, 2, colorObject->getName().c_str(), -1);
-}
-static void setAll(GtkListStore *store, GtkTreeIter *iter, ColorObject *colorObject, ListPaletteArgs *args) {
-	std::string text = args->gs.converters().serialize(*colorObject, Converters::Type::colorList);
-	gtk_list_store_set(store, iter, 1, text.c_str(), 2, colorObject->getName().c_str(), -1);
+static ListPaletteArgs *getArgs(GtkWidget *widget) {
+	auto args = reinterpret_cast<ListPaletteArgs *>(g_object_get_data(G_OBJECT(widget), "arguments"));
+	args->flushRows();
+	return args;
 }
 static void foreachItem(GtkTreeView *treeView, std::function<bool(ColorObject *)> callback) {
-	auto model = gtk_tree_view_get_model(treeView);
-	GtkTreeIter iter;
-	auto valid = gtk_tree_model_get_iter_first(model, &iter);
-	while (valid) {
-		ColorObject *colorObject;
-		gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
-		if (!callback(colorObject))
+	auto args = getArgs(GTK_WIDGET(treeView));
+	for (size_t i = 0, count = gtk_palette_list_model_size(args->model); i < count; i++) {
+		if (!callback(gtk_palette_list_model_get(args->model, i)))
 			break;
-		valid = gtk_tree_model_iter_next(model, &iter);
-	}
-}
-static void updateAll(GtkTreeView *treeView, GlobalState &gs) {
-	auto model = gtk_tree_view_get_model(treeView);
-	GtkTreeIter iter;
-	auto valid = gtk_tree_model_get_iter_first(model, &iter);
-	while (valid) {
-		ColorObject *colorObject;
-		gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
-		std::string text = gs.converters().serialize(*colorObject, Converters::Type::colorList);
-		gtk_list_store_set(GTK_LIST_STORE(model), &iter, 1, text.c_str(), -1);
-		valid = gtk_tree_model_iter_next(model, &iter);
 	}
 }
 static void foreachSelectedItem(GtkTreeView *treeView, std::function<bool(ColorObject *)> callback) {
+	getArgs(GTK_WIDGET(treeView));
 	auto model = gtk_tree_view_get_model(treeView);
 	auto selection = gtk_tree_view_get_selection(treeView);
 	GList *list = gtk_tree_selection_get_selected_rows(selection, nullptr);
@@ -803,16 +787,12 @@ GtkWidget* palette_list_preview_new(GlobalState &gs, bool expander, bool expande
 
 void palette_list_remove_all_entries(GtkWidget* widget, bool allowUpdate) {
 	ListPaletteArgs* args = (ListPaletteArgs*)g_object_get_data(G_OBJECT(widget), "arguments");
-	GtkListStore *store = GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(widget)));
-	GtkTreeIter iter;
-	gboolean valid = gtk_tree_model_get_iter_first(GTK_TREE_MODEL(store), &iter);
-	while (valid) {
-		ColorObject *colorObject;
-		gtk_tree_model_get(GTK_TREE_MODEL(store), &iter, 0, &colorObject, -1);
+	for (auto *colorObject: args->pendingRows)
 		colorObject->release();
-		valid = gtk_tree_model_iter_next(GTK_TREE_MODEL(store), &iter);
-	}
-	gtk_list_store_clear(GTK_LIST_STORE(store));
+	args->pendingRows.clear();
+	args->changeRows(gtk_palette_list_model_size(args->model), [args](bool notify) {
+		gtk_palette_list_model_clear(args->model, notify);
+	});
 	if (allowUpdate) {
 		args->updateCounts();
 		args->onChange();
@@ -822,200 +802,130 @@ int palette_list_get_selected_count(GtkWidget* widget) {
 	return gtk_tree_selection_count_selected_rows(gtk_tree_view_get_selection(GTK_TREE_VIEW(widget)));
 }
 int palette_list_get_count(GtkWidget* widget) {
-	return gtk_tree_model_iter_n_children(gtk_tree_view_get_model(GTK_TREE_VIEW(widget)), nullptr);
-}
-void palette_list_remove_selected_entries(GtkWidget* widget, bool allowUpdate) {
-	auto *args = reinterpret_cast<ListPaletteArgs *>(g_object_get_data(G_OBJECT(widget), "arguments"));
-	auto model = gtk_tree_view_get_model(GTK_TREE_VIEW(widget));
-	auto selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(widget));
-	GList *list = gtk_tree_selection_get_selected_rows(selection, nullptr), *referenceList = nullptr;
-	GList *i = list;
-	while (i) {
-		referenceList = g_list_prepend(referenceList, gtk_tree_row_reference_new(model, reinterpret_cast<GtkTreePath *>(i->data)));
-		i = g_list_next(i);
-	}
-	i = referenceList;
-	while (i) {
-		GtkTreePath *path = gtk_tree_row_reference_get_path(reinterpret_cast<GtkTreeRowReference *>(i->data));
-		if (path) {
-			GtkTreeIter iter;
-			gtk_tree_model_get_iter(model, &iter, path);
-			gtk_tree_path_free(path);
-			ColorObject *colorObject;
-			gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
-			colorObject->release();
-			gtk_list_store_remove(GTK_LIST_STORE(model), &iter);
-		}
-		i = g_list_next(i);
-	}
-	g_list_foreach(referenceList, (GFunc)gtk_tree_row_reference_free, nullptr);
-	g_list_free(referenceList);
-	g_list_foreach(list, (GFunc)gtk_tree_path_free, nullptr);
-	g_list_free(list);
-	if (allowUpdate) {
-		args->updateCounts();
-		args->onChange();
-	}
+	auto args = getArgs(widget);
+	return static_cast<int>(gtk_palette_list_model_size(args->model));
 }
 void palette_list_add_entry(GtkWidget* widget, ColorObject* colorObject, bool allowUpdate)
 {
 	ListPaletteArgs* args = (ListPaletteArgs*)g_object_get_data(G_OBJECT(widget), "arguments");
-	GtkTreeIter iter1;
-	GtkListStore *store;
-	store = GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(widget)));
-	gtk_list_store_append(store, &iter1);
-	set(store, &iter1, colorObject, args);
+	args->queueRow(colorObject);
+	// Rows added while updates are not allowed are inserted together when update is done or model is used.
 	if (allowUpdate) {
+		args->flushRows();
 		args->updateCounts();
 		args->onChange();
 	}
 }
-int palette_list_remove_entry(GtkWidget* widget, ColorObject* r_color_object, bool allowUpdate)
-{
-	ListPaletteArgs* args = (ListPaletteArgs*)g_object_get_data(G_OBJECT(widget), "arguments");
-	GtkTreeIter iter;
-	GtkListStore *store;
-	gboolean valid;
-	store = GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(widget)));
-	valid = gtk_tree_model_get_iter_first(GTK_TREE_MODEL(store), &iter);
-	ColorObject* colorObject;
-	while (valid){
-		gtk_tree_model_get(GTK_TREE_MODEL(store), &iter, 0, &colorObject, -1);
-		if (colorObject == r_color_object){
-			valid = gtk_list_store_remove(GTK_LIST_STORE(store), &iter);
-			colorObject->release();
-			if (allowUpdate) {
-				args->updateCounts();
-				args->onChange();
-			}
-			return 0;
-		}
-		valid = gtk_tree_model_iter_next(GTK_TREE_MODEL(store), &iter);
+void palette_list_change(GtkWidget *widget, ColorList &colorList, const ColorListChange &change, bool allowUpdate) {
+	auto args = getArgs(widget);
+	auto model = args->model;
+	switch (change.type) {
+	case ColorListChange::Type::insert:
+		args->changeRows(change.count, [&](bool notify) {
+			gtk_palette_list_model_insert(model, change.position, &*(colorList.begin() + change.position), change.count, notify);
+		});
+		break;
+	case ColorListChange::Type::remove:
+		args->changeRows(change.count, [&](bool notify) {
+			size_t range = 0;
+			gtk_palette_list_model_remove_if(model, [&](size_t index, ColorObject *) {
+				while (range < change.ranges.size() && change.ranges[range].second <= index)
+					range++;
+				return range < change.ranges.size() && change.ranges[range].first <= index;
+			}, notify);
+		});
+		break;
+	case ColorListChange::Type::reorder:
+		gtk_palette_list_model_reorder(model, change.order.data(), change.order.size(), true);
+		break;
+	case ColorListChange::Type::replace:
+		args->changeRows(std::max(gtk_palette_list_model_size(model), change.count), [&](bool notify) {
+			gtk_palette_list_model_clear(model, notify);
+			if (change.count != 0)
+				gtk_palette_list_model_insert(model, 0, &*colorList.begin(), change.count, notify);
+		});
+		break;
+	}
+	if (allowUpdate) {
+		args->updateCounts();
+		args->onChange();
 	}
-	return -1;
 }
-ColorObject *palette_list_get_first_selected(GtkWidget *widget) {
-	GtkTreeSelection *selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(widget));
-	GtkTreeModel *model = gtk_tree_view_get_model(GTK_TREE_VIEW(widget));
+static std::optional<size_t> firstSelectedIndex(ListPaletteArgs *args) {
+	GtkTreeSelection *selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(args->treeview));
 	GList *list = gtk_tree_selection_get_selected_rows(selection, nullptr);
-	GList *i = list;
-	ColorObject *colorObject = nullptr;
-	if (i) {
-		GtkTreeIter iter;
-		gtk_tree_model_get_iter(model, &iter, reinterpret_cast<GtkTreePath*>(i->data));
-		gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
-	}
+	std::optional<size_t> result;
+	if (list)
+		result = gtk_tree_path_get_indices(reinterpret_cast<GtkTreePath*>(list->data))[0];
 	g_list_foreach(list, (GFunc)gtk_tree_path_free, nullptr);
 	g_list_free(list);
-	return colorObject;
+	return result;
+}
+ColorObject *palette_list_get_first_selected(GtkWidget *widget) {
+	auto args = getArgs(widget);
+	auto index = firstSelectedIndex(args);
+	if (!index)
+		return nullptr;
+	return gtk_palette_list_model_get(args->model, *index);
 }
 void palette_list_update_first_selected(GtkWidget *widget, bool onlyName, bool allowUpdate) {
-	ListPaletteArgs* args = (ListPaletteArgs*)g_object_get_data(G_OBJECT(widget), "arguments");
-	GtkTreeSelection *selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(widget));
-	GtkTreeModel *model = gtk_tree_view_get_model(GTK_TREE_VIEW(widget));
-	GList *list = gtk_tree_selection_get_selected_rows(selection, nullptr);
-	GList *i = list;
-	ColorObject *colorObject = nullptr;
-	bool changed = false;
-	if (i) {
-		GtkTreeIter iter;
-		gtk_tree_model_get_iter(model, &iter, reinterpret_cast<GtkTreePath*>(i->data));
-		gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
-		if (onlyName)
-			setName(GTK_LIST_STORE(model), &iter, colorObject);
-		else
-			setAll(GTK_LIST_STORE(model), &iter, colorObject, args);
-		changed = true;
-	}
-	g_list_foreach(list, (GFunc)gtk_tree_path_free, nullptr);
-	g_list_free(list);
-	if (changed && allowUpdate)
+	auto args = getArgs(widget);
+	auto index = firstSelectedIndex(args);
+	if (!index)
+		return;
+	gtk_palette_list_model_invalidate(args->model, *index, true);
+	if (allowUpdate)
 		args->onChange();
 }
 void palette_list_append_copy_menu(GtkWidget* widget, GtkWidget *menu) {
-	auto args = reinterpret_cast<ListPaletteArgs *>(g_object_get_data(G_OBJECT(widget), "arguments"));
+	auto args = getArgs(widget);
 	StandardMenu::appendMenu(menu, args, &args->gs);
 }
 void palette_list_after_update(GtkWidget* widget) {
-	auto args = reinterpret_cast<ListPaletteArgs *>(g_object_get_data(G_OBJECT(widget), "arguments"));
+	auto args = getArgs(widget);
 	args->updateCounts();
 	args->onChange();
 }
 template<bool Replace, typename Callback>
 void forEach(GtkWidget *widget, bool selected, Callback &&callback, bool allowUpdate) {
-	auto args = reinterpret_cast<ListPaletteArgs *>(g_object_get_data(G_OBJECT(widget), "arguments"));
-	auto model = gtk_tree_view_get_model(GTK_TREE_VIEW(widget));
-	GtkTreeIter iter;
+	auto args = getArgs(widget);
+	auto model = args->model;
 	bool changed = false;
+	auto visit = [&](size_t index) {
+		ColorObject *colorObject = gtk_palette_list_model_get(model, index);
+		Update result;
+		if constexpr (Replace) {
+			ColorObject *newColorObject = colorObject;
+			colorObject->reference();
+			result = callback(&newColorObject);
+			if (newColorObject != colorObject) {
+				gtk_palette_list_model_set(model, index, newColorObject, false);
+				result = Update::none;
+				changed = true;
+			}
+			colorObject->release();
+		} else {
+			result = callback(colorObject);
+		}
+		if (result != Update::none) {
+			gtk_palette_list_model_invalidate(model, index, false);
+			changed = true;
+		}
+	};
 	if (selected) {
 		auto selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(widget));
 		GList *list = gtk_tree_selection_get_selected_rows(selection, nullptr);
-		GList *i = list;
-		while (i) {
-			gtk_tree_model_get_iter(model, &iter, reinterpret_cast<GtkTreePath *>(i->data));
-			ColorObject *colorObject;
-			gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
-			if constexpr (Replace) {
-				ColorObject *newColorObject = colorObject;
-				auto result = callback(&newColorObject);
-				if (newColorObject != colorObject) {
-					set(GTK_LIST_STORE(model), &iter, newColorObject, args);
-					changed = true;
-					colorObject->release();
-				} else if (result == Update::name) {
-					setName(GTK_LIST_STORE(model), &iter, colorObject);
-					changed = true;
-				} else if (result == Update::row) {
-					setAll(GTK_LIST_STORE(model), &iter, colorObject, args);
-					changed = true;
-				}
-			} else {
-				auto result = callback(colorObject);
-				if (result == Update::name) {
-					setName(GTK_LIST_STORE(model), &iter, colorObject);
-					changed = true;
-				} else if (result == Update::row) {
-					setAll(GTK_LIST_STORE(model), &iter, colorObject, args);
-					changed = true;
-				}
-			}
-			i = g_list_next(i);
-		}
+		for (GList *i = list; i; i = g_list_next(i))
+			visit(gtk_tree_path_get_indices(reinterpret_cast<GtkTreePath *>(i->data))[0]);
 		g_list_foreach(list, (GFunc)gtk_tree_path_free, nullptr);
 		g_list_free(list);
 	} else {
-		auto valid = gtk_tree_model_get_iter_first(model, &iter);
-		while (valid) {
-			ColorObject *colorObject;
-			gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
-			if constexpr (Replace) {
-				ColorObject *newColorObject = colorObject;
-				colorObject->reference();
-				auto result = callback(&newColorObject);
-				if (newColorObject != colorObject) {
-					set(GTK_LIST_STORE(model), &iter, newColorObject, args);
-					changed = true;
-				} else if (result == Update::name) {
-					setName(GTK_LIST_STORE(model), &iter, colorObject);
-					changed = true;
-				} else if (result == Update::row) {
-					setAll(GTK_LIST_STORE(model), &iter, colorObject, args);
-					changed = true;
-				}
-				colorObject->release();
-			} else {
-				auto result = callback(colorObject);
-				if (result == Update::name) {
-					setName(GTK_LIST_STORE(model), &iter, colorObject);
-					changed = true;
-				} else if (result == Update::row) {
-					setAll(GTK_LIST_STORE(model), &iter, colorObject, args);
-					changed = true;
-				}
-			}
-			valid = gtk_tree_model_iter_next(model, &iter);
-		}
+		for (size_t i = 0, count = gtk_palette_list_model_size(model); i < count; i++)
+			visit(i);
 	}
+	// Rows keep their height, so redrawing is enough instead of notifying about each changed row.
+	if (changed)
+		gtk_widget_queue_draw(widget);
 	if (changed && allowUpdate)
 		args->onChange();
 }
@@ -24,13 +24,13 @@
 struct GlobalState;
 struct ColorObject;
 struct ColorList;
+struct ColorListChange;
 GtkWidget* palette_list_new(GlobalState &gs, GtkWidget *countLabel);
 GtkWidget* palette_list_temporary_new(GlobalState &gs, GtkWidget* countLabel, ColorList &colorList);
 void palette_list_add_entry(GtkWidget* widget, ColorObject *color_object, bool allowUpdate);
 GtkWidget* palette_list_preview_new(GlobalState &gs, bool expander, bool expanded, common::Ref<ColorList> &outColorList);
 void palette_list_remove_all_entries(GtkWidget* widget, bool allowUpdate);
-void palette_list_remove_selected_entries(GtkWidget* widget, bool allowUpdate);
-int palette_list_remove_entry(GtkWidget* widget, ColorObject *color_object, bool allowUpdate);
+void palette_list_change(GtkWidget *widget, ColorList &colorList, const ColorListChange &change, bool allowUpdate);
 int palette_list_get_selected_count(GtkWidget* widget);
 int palette_list_get_count(GtkWidget* widget);
 ColorObject *palette_list_get_first_selected(GtkWidget* widget);
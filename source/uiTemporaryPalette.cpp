@@ -99,11 +99,8 @@ struct TemporaryPalette: public IPalette {
 	virtual void add(ColorList &colorList, ColorObject *colorObject) override {
 		palette_list_add_entry(palette, colorObject, !colorList.blocked());
 	}
-	virtual void remove(ColorList &colorList, ColorObject *colorObject) override {
-		palette_list_remove_entry(palette, colorObject, !colorList.blocked());
-	}
-	virtual void removeSelected(ColorList &colorList) override {
-		palette_list_remove_selected_entries(palette, !colorList.blocked());
+	virtual void change(ColorList &colorList, const ColorListChange &change) override {
+		palette_list_change(palette, colorList, change, !colorList.blocked());
 	}
 	virtual void clear(ColorList &colorList) override {
 		palette_list_remove_all_entries(palette, !colorList.blocked());
@@ -213,6 +213,7 @@ static void apply_configuration(TransformationsArgs *args) {
 		dynv::Map options;
 		args->configuration->apply(options);
 		args->transformation->deserialize(options);
+		args->gs->eventBus().trigger(EventType::displayFiltersUpdate);
 	}
 }
 